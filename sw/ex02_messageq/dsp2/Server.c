@@ -45,6 +45,7 @@
 #include <xdc/runtime/Diags.h>
 #include <xdc/runtime/Log.h>
 #include <xdc/runtime/Registry.h>
+#include <xdc/runtime/Timestamp.h>
 
 #include <stdio.h>
 
@@ -65,12 +66,31 @@
 typedef struct {
     UInt16              hostProcId;         // host processor id
     MessageQ_Handle     slaveQue;           // created locally
+    UInt32              tsFreq;             // Timestamp ticks per second
+    UInt32              lastEnd;            // Timestamp at the last job's end
 } Server_Module;
 
+/* a kernel of the job table, arg is its amount of work */
+typedef UInt32 (*Server_Kernel)(UInt32 arg);
+
+/* private functions */
+static UInt32 Server_nop(UInt32 arg);
+static UInt32 Server_spin(UInt32 arg);
+static UInt32 Server_sum(UInt32 arg);
+static UInt32 Server_crc(UInt32 arg);
+
 /* private data */
 Registry_Desc               Registry_CURDESC;
 static Server_Module        Module;
 
+/* job table, indexed by App_KERNEL_* */
+static const Server_Kernel  Server_kernels[App_NUM_KERNELS] = {
+    Server_nop,
+    Server_spin,
+    Server_sum,
+    Server_crc
+};
+
 
 /*
  *  ======== Server_init ========
@@ -88,6 +108,92 @@ Void Server_init(Void)
 }
 
 
+/*
+ *  ======== Server_nop ========
+ */
+static UInt32 Server_nop(UInt32 arg)
+{
+    return (arg);
+}
+
+/*
+ *  ======== Server_spin ========
+ *  Pure compute, one multiply and add per unit of work.
+ */
+static UInt32 Server_spin(UInt32 arg)
+{
+    UInt32 x = arg;
+    UInt32 i;
+
+    for (i = 0; i < arg; i++) {
+        x = x * 1664525 + 1013904223;
+    }
+
+    return (x);
+}
+
+/*
+ *  ======== Server_sum ========
+ */
+static UInt32 Server_sum(UInt32 arg)
+{
+    UInt32 sum = 0;
+    UInt32 i;
+
+    for (i = 0; i < arg; i++) {
+        sum += i * i;
+    }
+
+    return (sum);
+}
+
+/*
+ *  ======== Server_crc ========
+ *  CRC-32 of arg bytes counting up from 0, a bit at a time.
+ */
+static UInt32 Server_crc(UInt32 arg)
+{
+    UInt32 crc = 0xFFFFFFFF;
+    UInt32 i, bit;
+
+    for (i = 0; i < arg; i++) {
+        crc ^= i & 0xFF;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return (~crc);
+}
+
+/*
+ *  ======== Server_job ========
+ *  Run the message's kernel from the job table and time it, and report
+ *  how long the core waited for it.
+ */
+static Void Server_job(App_Msg *msg)
+{
+    UInt32 start;
+
+    msg->freq = Module.tsFreq;
+
+    if (msg->kernel >= App_NUM_KERNELS) {
+        msg->status = App_JOB_EKERNEL;
+        msg->result = 0;
+        msg->ticks = 0;
+        msg->idle = 0;
+        return;
+    }
+
+    start = Timestamp_get32();
+    msg->idle = (Module.lastEnd != 0) ? start - Module.lastEnd : 0;
+    msg->result = Server_kernels[msg->kernel](msg->arg);
+    Module.lastEnd = Timestamp_get32();
+    msg->ticks = Module.lastEnd - start;
+    msg->status = App_JOB_OK;
+}
+
+
 /*
  *  ======== Server_create ========
  */
@@ -96,10 +202,15 @@ Int Server_create()
     Int                 status = 0;
     MessageQ_Params     msgqParams;
     char                msgqName[32];
+    Types_FreqHz        freq;
 
     /* enable some log events */
     Diags_setMask(MODULE_NAME"+EXF");
 
+    Timestamp_getFreq(&freq);
+    Module.tsFreq = freq.lo;
+    Module.lastEnd = 0;
+
     /* create local message queue (inbound messages) */
     MessageQ_Params_init(&msgqParams);
     sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(MultiProc_self()));
@@ -145,6 +256,9 @@ Int Server_exec()
         if (msg->cmd == App_CMD_SHUTDOWN) {
             running = FALSE;
         }
+        else if (msg->cmd == App_CMD_JOB) {
+            Server_job(msg);
+        }
 
         /* process the message */
         Log_print1(Diags_INFO, "Server_exec: processed cmd=0x%x", msg->cmd);
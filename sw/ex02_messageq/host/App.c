@@ -32,76 +32,196 @@
 
 /*
  *  ======== App.c ========
+ *  Fan out to several remote cores at once. Either one poller thread
+ *  serves every core through a single host queue, each message's msgId
+ *  naming its core, or every core gets a host queue and a thread of its
+ *  own. Each core keeps a window of messages in flight; a reply is sent
+ *  straight back out until the core has had its share.
  *
+ *  App_dispatch instead hands out a list of jobs for the servers' job
+ *  table, each to whichever core the policy picks, through the poller's
+ *  host queue.
  */
 
 /* host header files */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 
 /* package header files */
 #include <ti/ipc/Std.h>
 #include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
 
 /* local header files */
 #include "../shared/AppCommon.h"
 #include "App.h"
+#include "JobSize.h"
 
-/* module structure */
+/* runs this short print every message, as the example always has */
+#define App_TRACE_MAX   32
+
+/* MessageQ_open attempts, a second apart, before App_probe gives up */
+#define App_PROBE_TRIES 3
+
+/* weight of the newest sample in a core's service time, 1 / App_EWMA */
+#define App_EWMA        8
+
+/* replies in a row without idling before a core's window shrinks */
+#define App_CALM        16
+
+/* one remote core */
 typedef struct {
-    MessageQ_Handle         hostQue;    // created locally
+    UInt16                  procId;
+    UInt16                  index;      // msgId of its messages
+    String                  name;
+    MessageQ_Handle         hostQue;    // own queue, thread mode only
     MessageQ_QueueId        slaveQue;   // opened remotely
+    pthread_t               thread;
+    UInt32                  sent;
+    UInt32                  received;
+    struct timeval          done;       // last reply
+    Int                     status;
+    UInt32                  inFlight;   // dispatched jobs
+    UInt32                  window;     // dispatched jobs allowed in flight
+    UInt64                  pending;    // work of the jobs in flight
+    double                  usPerUnit;  // smoothed remote time per work
+    UInt32                  calm;       // replies since it last idled
+    double                  windowSum;  // window at each send
+    App_CoreLoad            load;
+} App_Core;
+
+/* module structure */
+typedef struct {
+    App_Core                cores[App_MAX_CORES];
+    UInt32                  numCores;   // created
+    Bool                    threads;    // a thread per core
+    MessageQ_Handle         hostQue;    // shared, poller mode only
     UInt16                  heapId;     // MessageQ heapId
     UInt32                  msgSize;
+    const App_Params *      params;     // the run in progress
+    pthread_mutex_t         gateLock;   // core threads start together
+    pthread_cond_t          gateCond;
+    Int                     gate;       // 0 wait, 1 run, -1 give up
+    UInt32 *                jobWork;    // each job's kernel arg
+    UInt64 *                jobSent;    // ns each job was sent
+    UInt32                  rotor;      // first core a pick looks at
 } App_Module;
 
+static String App_kernelNames[App_NUM_KERNELS] = {
+    "nop", "spin", "sum", "crc"
+};
+
+static String App_policyNames[App_NUM_POLICIES] = {
+    "static", "depth", "service"
+};
+
 /* private data */
-static App_Module Module;
+static App_Module Module = {
+    .gateLock = PTHREAD_MUTEX_INITIALIZER,
+    .gateCond = PTHREAD_COND_INITIALIZER
+};
+
 
+/*
+ *  ======== App_open ========
+ *  Open a remote core's queue, retrying a second apart; tries 0 waits
+ *  for as long as it takes.
+ */
+static Int App_open(UInt16 procId, MessageQ_QueueId *queue, Int tries)
+{
+    Int                 status;
+    char                msgqName[32];
+
+    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(procId));
+
+    do {
+        status = MessageQ_open(msgqName, queue);
+        if (status != MessageQ_E_NOTFOUND) {
+            break;
+        }
+        sleep(1);
+    } while (tries == 0 || --tries > 0);
+
+    return (status);
+}
 
 /*
  *  ======== App_create ========
  */
 
-Int App_create(UInt16 remoteProcId)
+Int App_create(const UInt16 *procIds, UInt32 numCores, Bool threads)
 {
     Int                 status = 0;
     MessageQ_Params     msgqParams;
     char                msgqName[32];
+    App_Core *          core;
+    UInt32              i;
 
     printf("--> App_create:\n");
 
     /* setting default values */
+    Module.numCores = 0;
+    Module.threads = threads;
     Module.hostQue = NULL;
-    Module.slaveQue = MessageQ_INVALIDMESSAGEQ;
     Module.heapId = App_MsgHeapId;
     Module.msgSize = sizeof(App_Msg);
 
     /* create local message queue (inbound messages) */
-    MessageQ_Params_init(&msgqParams);
+    if (!threads) {
+        MessageQ_Params_init(&msgqParams);
+        sprintf(msgqName, App_HostMsgQueName, 1);
 
-    Module.hostQue = MessageQ_create(App_HostMsgQueName, &msgqParams);
+        Module.hostQue = MessageQ_create(msgqName, &msgqParams);
 
-    if (Module.hostQue == NULL) {
-        printf("App_create: Failed creating MessageQ\n");
-        status = -1;
-        goto leave;
+        if (Module.hostQue == NULL) {
+            printf("App_create: Failed creating MessageQ\n");
+            status = -1;
+            goto leave;
+        }
     }
 
-    /* open the remote message queue */
-    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(remoteProcId));
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[i];
+        memset(core, 0, sizeof(App_Core));
+        core->procId = procIds[i];
+        core->index = i;
+        core->name = MultiProc_getName(procIds[i]);
+        core->slaveQue = MessageQ_INVALIDMESSAGEQ;
+        Module.numCores++;
 
-    do {
-        status = MessageQ_open(msgqName, &Module.slaveQue);
-        sleep(1);
-    } while (status == MessageQ_E_NOTFOUND);
+        if (threads) {
+            MessageQ_Params_init(&msgqParams);
+            sprintf(msgqName, App_HostMsgQueName, i + 1);
 
-    if (status < 0) {
-        printf("App_create: Failed opening MessageQ\n");
-        goto leave;
+            core->hostQue = MessageQ_create(msgqName, &msgqParams);
+
+            if (core->hostQue == NULL) {
+                printf("App_create: Failed creating MessageQ for %s\n",
+                    core->name);
+                status = -1;
+                goto leave;
+            }
+        }
+
+        /* open the remote message queue */
+        status = App_open(core->procId, &core->slaveQue, 0);
+
+        if (status < 0) {
+            printf("App_create: Failed opening MessageQ of %s\n",
+                core->name);
+            goto leave;
+        }
     }
 
-    printf("App_create: Host is ready\n");
+    printf("App_create: Host is ready, %u core%s, %s\n", numCores,
+        numCores > 1 ? "s" : "", threads ? "a thread per core" :
+        "one poller thread");
 
 leave:
     printf("<-- App_create:\n");
@@ -114,19 +234,37 @@ leave:
  */
 Int App_delete(Void)
 {
-    Int         status;
+    Int         status = 0;
+    App_Core *  core;
+    UInt32      i;
 
     printf("--> App_delete:\n");
 
-    /* close remote resources */
-    status = MessageQ_close(&Module.slaveQue);
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
 
-    if (status < 0) {
-        goto leave;
+        /* close remote resources */
+        if (core->slaveQue != MessageQ_INVALIDMESSAGEQ) {
+            status = MessageQ_close(&core->slaveQue);
+        }
+
+        if (status < 0) {
+            goto leave;
+        }
+
+        if (core->hostQue != NULL) {
+            status = MessageQ_delete(&core->hostQue);
+        }
+
+        if (status < 0) {
+            goto leave;
+        }
     }
 
     /* delete the host message queue */
-    status = MessageQ_delete(&Module.hostQue);
+    if (Module.hostQue != NULL) {
+        status = MessageQ_delete(&Module.hostQue);
+    }
 
     if (status < 0) {
         goto leave;
@@ -139,83 +277,706 @@ leave:
 
 
 /*
- *  ======== App_exec ========
+ *  ======== App_probe ========
+ *  Whether a core's server answers to its queue name.
  */
-Int App_exec(Void)
+Bool App_probe(UInt16 procId)
 {
-    Int         status;
-    Int         i;
-    App_Msg *   msg;
+    MessageQ_QueueId    queue;
 
-    printf("--> App_exec:\n");
+    if (App_open(procId, &queue, App_PROBE_TRIES) < 0) {
+        return (FALSE);
+    }
+    MessageQ_close(&queue);
 
-    /* fill process pipeline */
-    for (i = 1; i <= 3; i++) {
-        printf("App_exec: sending message %d\n", i);
+    return (TRUE);
+}
+
+
+/*
+ *  ======== App_Params_init ========
+ */
+Void App_Params_init(App_Params *params)
+{
+    params->numCores = 1;
+    params->numMsgs = 15;
+    params->window = 3;
+    params->shutdown = TRUE;
+}
+
+/*
+ *  ======== App_send ========
+ *  The core's next message, reusing msg.
+ */
+static Void App_send(App_Core *core, MessageQ_Handle hostQue, App_Msg *msg)
+{
+    const App_Params *params = Module.params;
+
+    core->sent++;
+
+    /* set the return address in the message header */
+    MessageQ_setReplyQueue(hostQue, (MessageQ_Msg)msg);
+    MessageQ_setMsgId(msg, core->index);
+
+    /* fill in message payload */
+    if (core->sent == params->numMsgs && params->shutdown) {
+        /* Last message will tell the slave to shutdown */
+        msg->cmd = App_CMD_SHUTDOWN;
+    }
+    else {
+        msg->cmd = App_CMD_NOP;
+    }
+
+    if (params->numMsgs <= App_TRACE_MAX) {
+        printf("App_exec: sending message %u to %s\n", core->sent,
+            core->name);
+    }
+
+    /* send message */
+    MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+}
+
+/*
+ *  ======== App_fill ========
+ *  Fill the core's window.
+ */
+static Int App_fill(App_Core *core, MessageQ_Handle hostQue)
+{
+    App_Msg *   msg;
+    UInt32      i;
+
+    for (i = 0; i < Module.params->window &&
+            core->sent < Module.params->numMsgs; i++) {
 
         /* allocate message */
         msg = (App_Msg *)MessageQ_alloc(Module.heapId, Module.msgSize);
 
         if (msg == NULL) {
-            status = -1;
-            goto leave;
+            return (-1);
         }
 
-        /* set the return address in the message header */
-        MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
+        App_send(core, hostQue, msg);
+    }
 
-        /* fill in message payload */
-        msg->cmd = App_CMD_NOP;
+    return (0);
+}
+
+/*
+ *  ======== App_reply ========
+ *  A reply from the core: send the next message or free it.
+ */
+static Void App_reply(App_Core *core, MessageQ_Handle hostQue, App_Msg *msg)
+{
+    core->received++;
+    if (Module.params->numMsgs <= App_TRACE_MAX) {
+        printf("App_exec: message received from %s\n", core->name);
+    }
+
+    if (core->sent < Module.params->numMsgs) {
+        App_send(core, hostQue, msg);
+    }
+    else {
+        /* free the message */
+        MessageQ_free((MessageQ_Msg)msg);
+    }
+
+    if (core->received == Module.params->numMsgs) {
+        gettimeofday(&core->done, NULL);
+    }
+}
+
+/*
+ *  ======== App_poll ========
+ *  One thread serves every core through the shared host queue.
+ */
+static Int App_poll(UInt32 numCores)
+{
+    Int         status = 0;
+    UInt32      i, left;
+    UInt16      index;
+    App_Msg *   msg;
 
-        /* send message */
-        MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
+    /* fill process pipeline */
+    for (i = 0; i < numCores; i++) {
+        status = App_fill(&Module.cores[i], Module.hostQue);
+
+        if (status < 0) {
+            return (status);
+        }
     }
 
     /* process steady state (keep pipeline full) */
-    for (i = 4; i <= 15; i++) {
+    for (left = numCores * Module.params->numMsgs; left > 0; left--) {
 
         /* wait for return message */
         status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg,
             MessageQ_FOREVER);
 
         if (status < 0) {
-            goto leave;
+            return (status);
         }
 
-        /* extract message payload */
+        index = MessageQ_getMsgId(msg);
+        if (index >= numCores) {
+            printf("App_poll: reply with unknown msgId %u\n", index);
+            MessageQ_free((MessageQ_Msg)msg);
+            return (-1);
+        }
 
-        /* free the message */
+        App_reply(&Module.cores[index], Module.hostQue, msg);
+    }
+
+    return (status);
+}
+
+/*
+ *  ======== App_coreThread ========
+ *  One core through its own host queue.
+ */
+static void *App_coreThread(void *arg)
+{
+    App_Core *  core = (App_Core *)arg;
+    App_Msg *   msg;
+    Int         status;
+    Int         gate;
+
+    /* wait until every core has a thread */
+    pthread_mutex_lock(&Module.gateLock);
+    while (Module.gate == 0) {
+        pthread_cond_wait(&Module.gateCond, &Module.gateLock);
+    }
+    gate = Module.gate;
+    pthread_mutex_unlock(&Module.gateLock);
+
+    status = (gate > 0) ? App_fill(core, core->hostQue) : -1;
+
+    while (status == 0 && core->received < Module.params->numMsgs) {
+
+        /* wait for return message */
+        status = MessageQ_get(core->hostQue, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+
+        if (status < 0) {
+            break;
+        }
+
+        App_reply(core, core->hostQue, msg);
+    }
+    core->status = status;
+
+    return (NULL);
+}
+
+/*
+ *  ======== App_irqCount ========
+ *  Host mailbox interrupts so far, the IPC doorbells from every core,
+ *  summed over the CPUs; 0 where /proc/interrupts has none.
+ */
+static UInt64 App_irqCount(Void)
+{
+    FILE *      file;
+    char        line[512];
+    char *      p;
+    char *      end;
+    UInt64      total = 0;
+    UInt64      count;
+
+    file = fopen("/proc/interrupts", "r");
+
+    if (file == NULL) {
+        return (0);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strstr(line, "mailbox") == NULL) {
+            continue;
+        }
+
+        /* "irq:" then one count per CPU */
+        p = strchr(line, ':');
+        if (p == NULL) {
+            continue;
+        }
+        for (p++; ; p = end) {
+            count = strtoull(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            total += count;
+        }
+    }
+    fclose(file);
+
+    return (total);
+}
+
+/*
+ *  ======== App_switches ========
+ */
+static UInt64 App_switches(Void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+        return (0);
+    }
+
+    return ((UInt64)ru.ru_nvcsw + (UInt64)ru.ru_nivcsw);
+}
+
+/*
+ *  ======== App_exec ========
+ */
+Int App_exec(const App_Params *params, App_Result *result)
+{
+    Int         status = 0;
+    UInt32      numCores = params->numCores;
+    UInt32      i, started = 0;
+    App_Core *  core;
+    struct timeval start, end;
+    UInt64      irqs, switches;
+    double      ms;
+
+    printf("--> App_exec:\n");
+
+    if (numCores == 0 || numCores > Module.numCores) {
+        printf("App_exec: %u cores, %u opened\n", numCores, Module.numCores);
+        status = -1;
+        goto leave;
+    }
+
+    Module.params = params;
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[i];
+        core->sent = 0;
+        core->received = 0;
+        core->status = 0;
+    }
+
+    if (Module.threads) {
+        Module.gate = 0;
+        for (i = 0; i < numCores; i++) {
+            core = &Module.cores[i];
+            if (pthread_create(&core->thread, NULL, App_coreThread,
+                    core) != 0) {
+                printf("App_exec: failed to start the %s thread\n",
+                    core->name);
+                break;
+            }
+            started++;
+        }
+        if (started < numCores) {
+            status = -1;
+        }
+    }
+
+    irqs = App_irqCount();
+    switches = App_switches();
+    gettimeofday(&start, NULL);
+
+    if (Module.threads) {
+        /* open the gate, or send the started threads home */
+        pthread_mutex_lock(&Module.gateLock);
+        Module.gate = (status == 0) ? 1 : -1;
+        pthread_cond_broadcast(&Module.gateCond);
+        pthread_mutex_unlock(&Module.gateLock);
+
+        for (i = 0; i < started; i++) {
+            pthread_join(Module.cores[i].thread, NULL);
+            if (Module.cores[i].status < 0) {
+                status = Module.cores[i].status;
+            }
+        }
+    }
+    else {
+        status = App_poll(numCores);
+    }
+
+    gettimeofday(&end, NULL);
+    irqs = App_irqCount() - irqs;
+    switches = App_switches() - switches;
+
+    if (status < 0) {
+        goto leave;
+    }
+
+    /* per core and in aggregate */
+    ms = (end.tv_sec - start.tv_sec) * 1000.0 +
+        (end.tv_usec - start.tv_usec) / 1000.0;
+    memset(result, 0, sizeof(App_Result));
+    result->numCores = numCores;
+    result->ms = ms;
+
+    printf("App_exec: %u messages per core, %u in flight, %s\n",
+        params->numMsgs, params->window, Module.threads ?
+        "a thread per core" : "one poller thread");
+    printf("    core   messages   time (ms)     msgs/s\n");
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[i];
+        ms = (core->done.tv_sec - start.tv_sec) * 1000.0 +
+            (core->done.tv_usec - start.tv_usec) / 1000.0;
+        result->coreMsgPerSec[i] = core->received / (ms / 1000.0);
+        result->numMsgs += core->received;
+        printf("    %-6s %-10u %-13.3f %.1f\n", core->name, core->received,
+            ms, result->coreMsgPerSec[i]);
+    }
+    result->msgPerSec = result->numMsgs / (result->ms / 1000.0);
+    result->irqs = irqs;
+    result->switches = switches;
+    printf("    total  %-10u %-13.3f %.1f\n", result->numMsgs, result->ms,
+        result->msgPerSec);
+    printf("Host mailbox interrupts: %llu, %.3f per message\n",
+        (unsigned long long)irqs, (double)irqs / result->numMsgs);
+    printf("Host context switches: %llu, %.3f per message\n",
+        (unsigned long long)switches, (double)switches / result->numMsgs);
+
+leave:
+    printf("<-- App_exec: %d\n", status);
+    return(status);
+}
+
+
+/*
+ *  ======== App_kernelName ========
+ *  NULL past the last kernel.
+ */
+String App_kernelName(UInt32 kernel)
+{
+    return (kernel < App_NUM_KERNELS ? App_kernelNames[kernel] : NULL);
+}
+
+/*
+ *  ======== App_policyName ========
+ *  NULL past the last policy.
+ */
+String App_policyName(UInt32 policy)
+{
+    return (policy < App_NUM_POLICIES ? App_policyNames[policy] : NULL);
+}
+
+/*
+ *  ======== App_DispatchParams_init ========
+ */
+Void App_DispatchParams_init(App_DispatchParams *params)
+{
+    params->numCores = 1;
+    params->numJobs = 1000;
+    params->kernel = App_KERNEL_SPIN;
+    params->work = 10000;
+    params->spread = 1;
+    params->seed = 1;
+    params->policy = App_POLICY_SERVICE;
+    params->window = 8;
+    params->shutdown = TRUE;
+}
+
+/*
+ *  ======== App_now ========
+ *  Time in nanoseconds, not slewed by NTP.
+ */
+static UInt64 App_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== App_jobSizes ========
+ *  Each job's work, log-uniform from work / spread to work * spread so
+ *  that the median job is work; the same seed gives the same jobs.
+ */
+static Void App_jobSizes(const App_DispatchParams *params)
+{
+    UInt32  seed = params->seed;
+    UInt32  i;
+
+    for (i = 0; i < params->numJobs; i++) {
+        Module.jobWork[i] = JobSize_next(&seed, params->work,
+            params->spread);
+    }
+}
+
+/*
+ *  ======== App_pick ========
+ *  The core for the next job, NULL when none has room for it. Static
+ *  waits for the job's own core; the others take any core with room,
+ *  depth the one with the fewest jobs in flight and service the one
+ *  expected to finish it first. A core not measured yet expects to
+ *  finish at once, so every core gets jobs from the start.
+ */
+static App_Core *App_pick(const App_DispatchParams *params,
+        UInt32 numCores, UInt32 job)
+{
+    App_Core *  core;
+    App_Core *  best = NULL;
+    double      finish, bestFinish = 0.0;
+    UInt32      i;
+
+    if (params->policy == App_POLICY_STATIC) {
+        core = &Module.cores[job % numCores];
+        return (core->inFlight < core->window ? core : NULL);
+    }
+
+    /* rotate the starting core so that ties take turns */
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[(Module.rotor + i) % numCores];
+
+        if (core->inFlight >= core->window) {
+            continue;
+        }
+
+        if (params->policy == App_POLICY_DEPTH) {
+            finish = core->inFlight;
+        }
+        else {
+            finish = (core->pending + Module.jobWork[job]) *
+                core->usPerUnit;
+        }
+
+        if (best == NULL || finish < bestFinish ||
+                (finish == bestFinish && core->inFlight < best->inFlight)) {
+            best = core;
+            bestFinish = finish;
+        }
+    }
+    Module.rotor++;
+
+    return (best);
+}
+
+/*
+ *  ======== App_sendJob ========
+ */
+static Int App_sendJob(App_Core *core, const App_DispatchParams *params,
+        UInt32 job)
+{
+    App_Msg *   msg;
+
+    /* allocate message */
+    msg = (App_Msg *)MessageQ_alloc(Module.heapId, Module.msgSize);
+
+    if (msg == NULL) {
+        printf("App_dispatch: MessageQ_alloc failed\n");
+        return (-1);
+    }
+
+    /* set the return address in the message header */
+    MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
+    MessageQ_setMsgId(msg, core->index);
+
+    /* fill in message payload */
+    msg->cmd = App_CMD_JOB;
+    msg->job = job;
+    msg->kernel = params->kernel;
+    msg->arg = Module.jobWork[job];
+    msg->result = 0;
+    msg->status = App_JOB_OK;
+    msg->ticks = 0;
+    msg->idle = 0;
+    msg->freq = 0;
+
+    core->inFlight++;
+    core->pending += msg->arg;
+    core->windowSum += core->window;
+    Module.jobSent[job] = App_now();
+
+    /* send message */
+    MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+
+    return (0);
+}
+
+/*
+ *  ======== App_adapt ========
+ *  A core that waited for its job longer than an eighth of the job's
+ *  time needs another job in flight to hide the round trip. One that
+ *  kept busy for App_CALM replies in a row tries one fewer, so it does
+ *  not hold jobs that another core could start sooner.
+ */
+static Void App_adapt(App_Core *core, const App_DispatchParams *params,
+        double busyUs, double idleUs)
+{
+    if (idleUs * 8.0 > busyUs) {
+        if (core->window < params->window) {
+            core->window++;
+        }
+        core->calm = 0;
+    }
+    else if (++core->calm >= App_CALM) {
+        if (core->window > 1) {
+            core->window--;
+        }
+        core->calm = 0;
+    }
+}
+
+/*
+ *  ======== App_jobDone ========
+ *  Account for a job's reply and free it.
+ */
+static Void App_jobDone(App_Core *core, const App_DispatchParams *params,
+        App_Msg *msg, UInt64 now)
+{
+    App_CoreLoad *  load = &core->load;
+    double          busyUs, idleUs, sample;
+    UInt32          freq = (msg->freq != 0) ? msg->freq : 1;
+
+    core->inFlight--;
+    core->pending -= msg->arg;
+    load->jobs++;
+    load->rttUs += (now - Module.jobSent[msg->job]) / 1e3;
+
+    if (msg->status != App_JOB_OK) {
+        load->errors++;
         MessageQ_free((MessageQ_Msg)msg);
+        return;
+    }
 
-        printf("App_exec: message received, sending message %d\n", i);
+    busyUs = msg->ticks * 1e6 / freq;
+    idleUs = msg->idle * 1e6 / freq;
+    load->work += msg->arg;
+    load->busyMs += busyUs / 1e3;
 
-        /* allocate message */
+    sample = busyUs / (msg->arg != 0 ? msg->arg : 1);
+    if (core->usPerUnit == 0.0) {
+        core->usPerUnit = sample;
+    }
+    else {
+        core->usPerUnit += (sample - core->usPerUnit) / App_EWMA;
+    }
+
+    /* the first job's wait started before the run */
+    if (load->jobs > 1) {
+        load->idleMs += idleUs / 1e3;
+        if (params->policy != App_POLICY_STATIC) {
+            App_adapt(core, params, busyUs, idleUs);
+        }
+    }
+
+    MessageQ_free((MessageQ_Msg)msg);
+}
+
+/*
+ *  ======== App_shutdown ========
+ *  Send each core the shutdown and wait for it to come back.
+ */
+static Int App_shutdown(UInt32 numCores)
+{
+    Int         status = 0;
+    App_Msg *   msg;
+    UInt32      i;
+
+    for (i = 0; i < numCores; i++) {
         msg = (App_Msg *)MessageQ_alloc(Module.heapId, Module.msgSize);
 
         if (msg == NULL) {
-            status = -1;
-            goto leave;
+            return (-1);
         }
 
-        /* set the return address in the message header */
         MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
+        MessageQ_setMsgId(msg, i);
+        msg->cmd = App_CMD_SHUTDOWN;
+        MessageQ_put(Module.cores[i].slaveQue, (MessageQ_Msg)msg);
+    }
 
-        /* fill in message payload */
-        if (i == 15) {
-            /* Last message will tell the slave to shutdown */
-            msg->cmd = App_CMD_SHUTDOWN;
-        }
-        else {
-            msg->cmd = App_CMD_NOP;
+    for (i = 0; i < numCores; i++) {
+        status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+
+        if (status < 0) {
+            return (status);
         }
+        MessageQ_free((MessageQ_Msg)msg);
+    }
 
-        /* send message */
-        MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
+    return (status);
+}
+
+/*
+ *  ======== App_dispatch ========
+ *  Hand out params->numJobs jobs to the first params->numCores cores,
+ *  sending while the policy finds a core with room and otherwise
+ *  waiting for a reply.
+ */
+Int App_dispatch(const App_DispatchParams *params, App_DispatchResult *result)
+{
+    Int             status = 0;
+    UInt32          numCores = params->numCores;
+    UInt32          next = 0, done;
+    UInt32          i;
+    UInt16          index;
+    App_Core *      core;
+    App_CoreLoad *  load;
+    App_Msg *       msg;
+    UInt64          start, end;
+    double          busiest = 0.0, meanBusy = 0.0;
+
+    printf("--> App_dispatch:\n");
+
+    if (Module.threads) {
+        printf("App_dispatch: needs the one poller thread\n");
+        status = -1;
+        goto leave;
+    }
+    if (numCores == 0 || numCores > Module.numCores) {
+        printf("App_dispatch: %u cores, %u opened\n", numCores,
+            Module.numCores);
+        status = -1;
+        goto leave;
+    }
+    if (params->numJobs == 0 || params->window == 0 ||
+            params->window > App_MAX_WINDOW ||
+            params->policy >= App_NUM_POLICIES) {
+        printf("App_dispatch: invalid parameters\n");
+        status = -1;
+        goto leave;
+    }
+
+    Module.jobWork = (UInt32 *)malloc(params->numJobs * sizeof(UInt32));
+    Module.jobSent = (UInt64 *)malloc(params->numJobs * sizeof(UInt64));
+
+    if (Module.jobWork == NULL || Module.jobSent == NULL) {
+        printf("App_dispatch: failed to allocate %u jobs\n", params->numJobs);
+        status = -1;
+        goto leave;
+    }
+    App_jobSizes(params);
+
+    /* an adaptive window starts small and grows while the core idles */
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[i];
+        core->inFlight = 0;
+        core->window = (params->policy == App_POLICY_STATIC) ?
+            params->window : (params->window < 2 ? params->window : 2);
+        core->pending = 0;
+        core->usPerUnit = 0.0;
+        core->calm = 0;
+        core->windowSum = 0.0;
+        memset(&core->load, 0, sizeof(App_CoreLoad));
     }
+    Module.rotor = 0;
 
-    /* drain process pipeline */
-    for (i = 1; i <= 3; i++) {
-        printf("App_exec: message received\n");
+    start = App_now();
+
+    for (done = 0; done < params->numJobs; done++) {
+
+        /* send while some core has room */
+        while (next < params->numJobs) {
+            core = App_pick(params, numCores, next);
+
+            if (core == NULL) {
+                break;
+            }
+
+            status = App_sendJob(core, params, next);
+
+            if (status < 0) {
+                goto leave;
+            }
+            next++;
+        }
 
         /* wait for return message */
         status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg,
@@ -225,13 +986,79 @@ Int App_exec(Void)
             goto leave;
         }
 
-        /* extract message payload */
+        index = MessageQ_getMsgId(msg);
+        if (index >= numCores || msg->cmd != App_CMD_JOB) {
+            printf("App_dispatch: unexpected reply, msgId %u\n", index);
+            MessageQ_free((MessageQ_Msg)msg);
+            status = -1;
+            goto leave;
+        }
 
-        /* free the message */
-        MessageQ_free((MessageQ_Msg)msg);
+        App_jobDone(&Module.cores[index], params, msg, App_now());
+    }
+
+    end = App_now();
+
+    /* per core and in aggregate */
+    memset(result, 0, sizeof(App_DispatchResult));
+    result->numCores = numCores;
+    result->numJobs = params->numJobs;
+    result->ms = (end - start) / 1e6;
+    result->jobsPerSec = params->numJobs / (result->ms / 1e3);
+
+    for (i = 0; i < numCores; i++) {
+        core = &Module.cores[i];
+        load = &core->load;
+        if (load->jobs > load->errors) {
+            load->serviceUs = load->busyMs * 1e3 / (load->jobs - load->errors);
+        }
+        if (load->jobs > 0) {
+            load->rttUs /= load->jobs;
+            load->meanWindow = core->windowSum / load->jobs;
+        }
+        load->utilization = load->busyMs / result->ms;
+        load->window = core->window;
+        result->errors += load->errors;
+        result->cores[i] = *load;
+
+        busiest = load->busyMs > busiest ? load->busyMs : busiest;
+        meanBusy += load->busyMs / numCores;
+    }
+    result->imbalance = (meanBusy > 0.0) ? busiest / meanBusy : 1.0;
+
+    printf("App_dispatch: %u %s jobs of %u", params->numJobs,
+        App_kernelName(params->kernel), params->work);
+    if (params->spread > 1) {
+        printf(", spread %u", params->spread);
+    }
+    printf(", %s policy, window %s%u\n", App_policyName(params->policy),
+        params->policy == App_POLICY_STATIC ? "" : "up to ", params->window);
+    printf("    core   jobs     work (k)   busy (ms)  idle (ms)  util    "
+        "service (us)  rtt (us)    window\n");
+    for (i = 0; i < numCores; i++) {
+        load = &result->cores[i];
+        printf("    %-6s %-8u %-10.1f %-10.3f %-10.3f %-7.3f %-13.3f %-11.3f "
+            "%.1f, now %u\n", Module.cores[i].name, load->jobs,
+            load->work / 1e3, load->busyMs, load->idleMs, load->utilization,
+            load->serviceUs, load->rttUs, load->meanWindow, load->window);
+    }
+    printf("    total  %u jobs in %.3f ms, %.1f jobs/s, imbalance %.3f\n",
+        result->numJobs, result->ms, result->jobsPerSec, result->imbalance);
+    if (result->errors > 0) {
+        printf("App_dispatch: %u jobs refused by the servers\n",
+            result->errors);
+    }
+
+    if (params->shutdown) {
+        status = App_shutdown(numCores);
     }
 
 leave:
-    printf("<-- App_exec: %d\n", status);
+    free(Module.jobWork);
+    free(Module.jobSent);
+    Module.jobWork = NULL;
+    Module.jobSent = NULL;
+
+    printf("<-- App_dispatch: %d\n", status);
     return(status);
 }
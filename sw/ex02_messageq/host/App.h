@@ -41,9 +41,82 @@
 extern "C" {
 #endif
 
-Int App_create(UInt16 remoteProcId);
+/* remote cores one host process drives at once */
+#define App_MAX_CORES   4
+
+typedef struct {
+    UInt32      numCores;       /* the first numCores of those created */
+    UInt32      numMsgs;        /* per core, counting the shutdown */
+    UInt32      window;         /* messages in flight per core */
+    Bool        shutdown;       /* the last message shuts the server down */
+} App_Params;
+
+/* what one run measured */
+typedef struct {
+    UInt32      numCores;
+    UInt32      numMsgs;        /* all cores */
+    double      ms;             /* first send to last reply */
+    double      msgPerSec;      /* all cores */
+    double      coreMsgPerSec[App_MAX_CORES];
+    UInt64      irqs;           /* host mailbox interrupts */
+    UInt64      switches;       /* host context switches */
+} App_Result;
+
+/* how App_dispatch picks the core for the next job */
+#define App_POLICY_STATIC   0   /* round robin, fixed window */
+#define App_POLICY_DEPTH    1   /* fewest jobs in flight */
+#define App_POLICY_SERVICE  2   /* earliest finish by measured service time */
+#define App_NUM_POLICIES    3
+
+/* the adaptive window's ceiling */
+#define App_MAX_WINDOW      64
+
+typedef struct {
+    UInt32      numCores;       /* the first numCores of those created */
+    UInt32      numJobs;
+    UInt32      kernel;         /* App_KERNEL_* */
+    UInt32      work;           /* kernel arg of an average job */
+    UInt32      spread;         /* jobs range from work / spread to
+                                   work * spread, 1 for even jobs */
+    UInt32      seed;           /* of the job sizes */
+    UInt32      policy;         /* App_POLICY_* */
+    UInt32      window;         /* static window, or the adaptive ceiling */
+    Bool        shutdown;       /* shut the servers down afterwards */
+} App_DispatchParams;
+
+/* one core's share of a dispatch run */
+typedef struct {
+    UInt32      jobs;
+    UInt32      errors;         /* jobs the server refused */
+    UInt64      work;           /* sum of the jobs' args */
+    double      busyMs;         /* remote kernel time */
+    double      idleMs;         /* remote time waiting for jobs */
+    double      utilization;    /* busyMs over the run */
+    double      serviceUs;      /* mean remote kernel time per job */
+    double      rttUs;          /* mean host send to reply */
+    double      meanWindow;     /* mean window at each send */
+    UInt32      window;         /* window at the end */
+} App_CoreLoad;
+
+typedef struct {
+    UInt32      numCores;
+    UInt32      numJobs;
+    UInt32      errors;
+    double      ms;             /* first send to last reply */
+    double      jobsPerSec;
+    double      imbalance;      /* busiest core's busyMs over the mean */
+    App_CoreLoad cores[App_MAX_CORES];
+} App_DispatchResult;
+
+Void App_Params_init(App_Params *params);
+Void App_DispatchParams_init(App_DispatchParams *params);
+Int App_create(const UInt16 *procIds, UInt32 numCores, Bool threads);
 Int App_delete();
-Int App_exec();
+Int App_exec(const App_Params *params, App_Result *result);
+Int App_dispatch(const App_DispatchParams *params, App_DispatchResult *result);
+Bool App_probe(UInt16 procId);
+String App_kernelName(UInt32 kernel);
+String App_policyName(UInt32 policy);
 
 
 #if defined (__cplusplus)
@@ -0,0 +1,34 @@
+/*
+ *  ======== JobSize.c ========
+ *  Job sizes spread log-uniformly around a median, the same sizes from
+ *  the same seed. The same file is in ex02_messageq/host and
+ *  remote_to_host_benchmark/host, keep the two the same.
+ */
+
+/* host header files */
+#include <math.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* module header file */
+#include "JobSize.h"
+
+/*
+ *  ======== JobSize_next ========
+ *  Step the LCG in seed and return the next job's work, log-uniform from
+ *  work / spread to work * spread so that the median job is work; a
+ *  spread of 1 or less gives every job work.
+ */
+UInt32 JobSize_next(UInt32 *seed, UInt32 work, UInt32 spread)
+{
+    double  u;
+
+    *seed = *seed * 1664525 + 1013904223;
+    if (spread <= 1) {
+        return (work);
+    }
+    u = (*seed >> 8) / 16777216.0;
+
+    return ((UInt32)(work * pow(spread, 2.0 * u - 1.0) + 0.5));
+}
@@ -0,0 +1,20 @@
+/*
+ *  ======== JobSize.h ========
+ *  Job sizes spread log-uniformly around a median, the same sizes from
+ *  the same seed. The same file is in ex02_messageq/host and
+ *  remote_to_host_benchmark/host, keep the two the same.
+ */
+
+#ifndef JobSize__include
+#define JobSize__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+UInt32 JobSize_next(UInt32 *seed, UInt32 work, UInt32 spread);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* JobSize__include */
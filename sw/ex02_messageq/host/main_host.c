@@ -38,6 +38,7 @@
 /* cstdlib header files */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* package header files */
 #include <ti/ipc/Std.h>
@@ -52,27 +53,63 @@
 /* private functions */
 static Int Main_main(Void);
 static Int Main_parseArgs(Int argc, Char *argv[]);
+static Void Main_printScaling(Void);
+static Void Main_printDispatch(Void);
+static Int Main_lookup(String (*name)(UInt32), String arg, UInt32 *value);
 
 
 #define Main_USAGE "\
 Usage:\n\
-    app_host [options] procName\n\
+    app_host [options] procName [procName...]\n\
 \n\
 Arguments:\n\
-    procName      : the name of the remote processor\n\
+    procName      : the name of a remote processor, up to 4, all driven\n\
+                    at once\n\
 \n\
 Options:\n\
     h   : print this help message\n\
     l   : list the available remote names\n\
+    a   : every remote processor whose server answers, instead of names\n\
+    t   : a host queue and thread per processor instead of one poller\n\
+          thread and host queue for all of them\n\
+    n [count] : messages per processor, the last one a shutdown, default 15\n\
+    w [window] : messages in flight per processor, default 3\n\
+    s   : scaling, run with the first 1, 2, ... of the processors and\n\
+          print messages/s, interrupts and context switches against the\n\
+          number of processors\n\
+\n\
+Job dispatch options, run jobs of a kernel from the servers' job table:\n\
+    j [count] : number of jobs, each to the processor the policy picks\n\
+    k [kernel] : nop, spin, sum or crc, default spin\n\
+    g [work] : kernel argument of the median job, default 10000\n\
+    u [spread] : jobs range from work / spread to work * spread,\n\
+          default 1 for even jobs\n\
+    b [policy] : static, depth, service or all, default service\n\
+    w [window] : jobs in flight per processor, the ceiling of the\n\
+          adaptive window but for static, default 8\n\
 \n\
 Examples:\n\
     app_host DSP\n\
+    app_host DSP1 DSP2 IPU2\n\
+    app_host -a -n 100000 -w 8\n\
+    app_host -a -s -t -n 100000\n\
+    app_host -a -j 2000 -k crc -g 4096 -u 8 -b all\n\
     app_host -l\n\
     app_host -h\n\
 \n"
 
 /* private data */
-static String   Main_remoteProcName = NULL;
+static String   Main_remoteProcNames[App_MAX_CORES];
+static UInt32   Main_numProcs = 0;
+static Bool     Main_all = FALSE;
+static Bool     Main_threads = FALSE;
+static Bool     Main_scaling = FALSE;
+static App_Params Main_params;
+static App_Result Main_results[App_MAX_CORES];
+static Bool     Main_dispatch = FALSE;
+static Bool     Main_allPolicies = FALSE;
+static App_DispatchParams Main_jobParams;
+static App_DispatchResult Main_jobResults[App_MAX_CORES][App_NUM_POLICIES];
 
 
 /*
@@ -122,25 +159,81 @@ leave:
  */
 Int Main_main(Void)
 {
-    UInt16      remoteProcId;
+    UInt16      remoteProcIds[App_MAX_CORES];
+    UInt16      procId;
     Int         status = 0;
+    UInt32      i, first, p, firstPolicy, lastPolicy;
 
     printf("--> Main_main:\n");
 
-    remoteProcId = MultiProc_getId(Main_remoteProcName);
+    /* every remote processor that answers */
+    if (Main_all) {
+        for (procId = 0; procId < MultiProc_getNumProcessors() &&
+                Main_numProcs < App_MAX_CORES; procId++) {
+            if (procId == MultiProc_self()) {
+                continue;
+            }
+            if (App_probe(procId)) {
+                Main_remoteProcNames[Main_numProcs++] =
+                    MultiProc_getName(procId);
+            }
+        }
+        if (Main_numProcs == 0) {
+            printf("Error: no remote processor answered\n");
+            status = -1;
+            goto leave;
+        }
+    }
+
+    for (i = 0; i < Main_numProcs; i++) {
+        remoteProcIds[i] = MultiProc_getId(Main_remoteProcNames[i]);
+
+        if (remoteProcIds[i] == MultiProc_INVALIDID) {
+            printf("Error: unknown processor %s\n", Main_remoteProcNames[i]);
+            status = -1;
+            goto leave;
+        }
+    }
 
     /* application create phase */
-    status = App_create(remoteProcId);
+    status = App_create(remoteProcIds, Main_numProcs, Main_threads);
 
     if (status < 0) {
         goto leave;
     }
 
-    /* application execute phase */
-    status = App_exec();
+    /* application execute phase, only the last run shuts the servers down */
+    first = Main_scaling ? 1 : Main_numProcs;
+    firstPolicy = Main_allPolicies ? 0 : Main_jobParams.policy;
+    lastPolicy = Main_allPolicies ? App_NUM_POLICIES - 1 : firstPolicy;
+    for (i = first; i <= Main_numProcs; i++) {
+        if (!Main_dispatch) {
+            Main_params.numCores = i;
+            Main_params.shutdown = (i == Main_numProcs);
+            status = App_exec(&Main_params, &Main_results[i - 1]);
+
+            if (status < 0) {
+                goto leave;
+            }
+            continue;
+        }
 
-    if (status < 0) {
-        goto leave;
+        for (p = firstPolicy; p <= lastPolicy; p++) {
+            Main_jobParams.numCores = i;
+            Main_jobParams.policy = p;
+            Main_jobParams.shutdown = (i == Main_numProcs && p == lastPolicy);
+            status = App_dispatch(&Main_jobParams, &Main_jobResults[i - 1][p]);
+
+            if (status < 0) {
+                goto leave;
+            }
+        }
+    }
+    if (Main_dispatch && (Main_scaling || Main_allPolicies)) {
+        Main_printDispatch();
+    }
+    else if (Main_scaling) {
+        Main_printScaling();
     }
 
     /* application delete phase */
@@ -158,6 +251,124 @@ leave:
 }
 
 
+/*
+ *  ======== Main_printScaling ========
+ *  Aggregate and per processor rates against the number of processors,
+ *  with the host's interrupts and context switches per message.
+ */
+static Void Main_printScaling(Void)
+{
+    App_Result *r;
+    UInt32 i, j;
+
+    printf("Scaling, %s, %u messages per processor, %u in flight:\n",
+        Main_threads ? "a thread per processor" : "one poller thread",
+        Main_params.numMsgs, Main_params.window);
+    printf("    procs  msgs/s        per proc      irqs/msg   "
+        "switches/msg\n");
+    for (i = 0; i < Main_numProcs; i++) {
+        r = &Main_results[i];
+        printf("    %-6u %-13.1f %-13.1f %-10.3f %.3f\n", r->numCores,
+            r->msgPerSec, r->msgPerSec / r->numCores,
+            (double)r->irqs / r->numMsgs, (double)r->switches / r->numMsgs);
+    }
+
+    printf("csvheader, Processors, Threads, Messages, Window, Time (ms), Messages/s, Host IRQs, Host Context Switches");
+    for (j = 0; j < Main_numProcs; j++) {
+        printf(", %s Messages/s", Main_remoteProcNames[j]);
+    }
+    printf("\n");
+    for (i = 0; i < Main_numProcs; i++) {
+        r = &Main_results[i];
+        printf("csv, %u, %s, %u, %u, %f, %f, %llu, %llu", r->numCores, Main_threads ? "yes" : "no", r->numMsgs, Main_params.window, r->ms, r->msgPerSec, (unsigned long long)r->irqs, (unsigned long long)r->switches);
+        for (j = 0; j < Main_numProcs; j++) {
+            printf(", %f", j < r->numCores ? r->coreMsgPerSec[j] : 0.0);
+        }
+        printf("\n");
+    }
+}
+
+
+/*
+ *  ======== Main_printDispatch ========
+ *  Jobs/s, imbalance and utilization of each dispatch run, by number of
+ *  processors and policy.
+ */
+static Void Main_printDispatch(Void)
+{
+    App_DispatchResult *r;
+    UInt32 first = Main_scaling ? 1 : Main_numProcs;
+    UInt32 i, p, c;
+    double lo, hi;
+
+    printf("Dispatch, %u %s jobs of %u, spread %u, window %u:\n",
+        Main_jobParams.numJobs, App_kernelName(Main_jobParams.kernel),
+        Main_jobParams.work, Main_jobParams.spread, Main_jobParams.window);
+    printf("    procs  policy    jobs/s        imbalance  util min   "
+        "util max\n");
+    for (i = first; i <= Main_numProcs; i++) {
+        for (p = 0; p < App_NUM_POLICIES; p++) {
+            r = &Main_jobResults[i - 1][p];
+            if (r->numJobs == 0) {
+                continue;
+            }
+            lo = hi = r->cores[0].utilization;
+            for (c = 1; c < r->numCores; c++) {
+                lo = r->cores[c].utilization < lo ? r->cores[c].utilization : lo;
+                hi = r->cores[c].utilization > hi ? r->cores[c].utilization : hi;
+            }
+            printf("    %-6u %-9s %-13.1f %-10.3f %-10.3f %.3f\n", i,
+                App_policyName(p), r->jobsPerSec, r->imbalance, lo, hi);
+        }
+    }
+
+    printf("csvheader, Processors, Policy, Kernel, Jobs, Work, Spread, Window, Time (ms), Jobs/s, Imbalance");
+    for (c = 0; c < Main_numProcs; c++) {
+        printf(", %s Jobs, %s Utilization", Main_remoteProcNames[c],
+            Main_remoteProcNames[c]);
+    }
+    printf("\n");
+    for (i = first; i <= Main_numProcs; i++) {
+        for (p = 0; p < App_NUM_POLICIES; p++) {
+            r = &Main_jobResults[i - 1][p];
+            if (r->numJobs == 0) {
+                continue;
+            }
+            printf("csv, %u, %s, %s, %u, %u, %u, %u, %f, %f, %f", i, App_policyName(p), App_kernelName(Main_jobParams.kernel), r->numJobs, Main_jobParams.work, Main_jobParams.spread, Main_jobParams.window, r->ms, r->jobsPerSec, r->imbalance);
+            for (c = 0; c < Main_numProcs; c++) {
+                if (c < r->numCores) {
+                    printf(", %u, %f", r->cores[c].jobs,
+                        r->cores[c].utilization);
+                }
+                else {
+                    printf(", 0, 0.000000");
+                }
+            }
+            printf("\n");
+        }
+    }
+}
+
+/*
+ *  ======== Main_lookup ========
+ *  The number whose name is arg, from a name function that returns NULL
+ *  past the last one.
+ */
+static Int Main_lookup(String (*name)(UInt32), String arg, UInt32 *value)
+{
+    UInt32 i;
+
+    for (i = 0; name(i) != NULL; i++) {
+        if (strcmp(name(i), arg) == 0) {
+            *value = i;
+            return (0);
+        }
+    }
+
+    return (-1);
+}
+
+
 /*
  *  ======== Main_parseArgs ========
  */
@@ -168,6 +379,8 @@ Int Main_parseArgs(Int argc, Char *argv[])
     String          name;
     Int             status = 0;
 
+    App_Params_init(&Main_params);
+    App_DispatchParams_init(&Main_jobParams);
 
     /* parse the command line options */
     for (opt = 1; (opt < argc) && (argv[opt][0] == '-'); opt++) {
@@ -201,6 +414,95 @@ Int Main_parseArgs(Int argc, Char *argv[])
                 exit(0);
                 break;
 
+            case 'a': /* -a */
+                Main_all = TRUE;
+                break;
+
+            case 't': /* -t */
+                Main_threads = TRUE;
+                break;
+
+            case 's': /* -s */
+                Main_scaling = TRUE;
+                break;
+
+            case 'n': /* -n */
+                if (opt + 1 >= argc) {
+                    printf("Error: -n needs a count\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_params.numMsgs = strtoul(argv[++opt], NULL, 10);
+                break;
+
+            case 'w': /* -w */
+                if (opt + 1 >= argc) {
+                    printf("Error: -w needs a window\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_params.window = strtoul(argv[++opt], NULL, 10);
+                Main_jobParams.window = Main_params.window;
+                break;
+
+            case 'j': /* -j */
+                if (opt + 1 >= argc) {
+                    printf("Error: -j needs a count\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_jobParams.numJobs = strtoul(argv[++opt], NULL, 10);
+                Main_dispatch = TRUE;
+                break;
+
+            case 'k': /* -k */
+                if (opt + 1 >= argc || Main_lookup(App_kernelName,
+                        argv[opt + 1], &Main_jobParams.kernel) < 0) {
+                    printf("Error: -k needs nop, spin, sum or crc\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                opt++;
+                break;
+
+            case 'g': /* -g */
+                if (opt + 1 >= argc) {
+                    printf("Error: -g needs the work per job\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_jobParams.work = strtoul(argv[++opt], NULL, 10);
+                break;
+
+            case 'u': /* -u */
+                if (opt + 1 >= argc) {
+                    printf("Error: -u needs a spread\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_jobParams.spread = strtoul(argv[++opt], NULL, 10);
+                break;
+
+            case 'b': /* -b */
+                if (opt + 1 < argc && strcmp(argv[opt + 1], "all") == 0) {
+                    Main_allPolicies = TRUE;
+                }
+                else if (opt + 1 >= argc || Main_lookup(App_policyName,
+                        argv[opt + 1], &Main_jobParams.policy) < 0) {
+                    printf("Error: -b needs static, depth, service or all\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                opt++;
+                break;
+
             default:
                 printf(
                     "Error: %s, line %d: invalid option, %c\n",
@@ -214,28 +516,50 @@ Int Main_parseArgs(Int argc, Char *argv[])
     /* parse the command line arguments */
     for (argNum = 1; opt < argc; argNum++, opt++) {
 
-        switch (argNum) {
-            case 1: /* name of proc #1 */
-                Main_remoteProcName = argv[opt];
-                break;
-
-            default:
-                printf(
-                    "Error: %s, line %d: too many arguments\n",
-                    __FILE__, __LINE__);
-                printf("%s", Main_USAGE);
-                status = -1;
-                goto leave;
+        if (argNum > App_MAX_CORES || Main_all) {
+            printf(
+                "Error: %s, line %d: too many arguments\n",
+                __FILE__, __LINE__);
+            printf("%s", Main_USAGE);
+            status = -1;
+            goto leave;
         }
+        Main_remoteProcNames[Main_numProcs++] = argv[opt];
     }
 
     /* validate command line arguments */
-    if (Main_remoteProcName == NULL) {
+    if (Main_numProcs == 0 && !Main_all) {
         printf("Error: missing procName argument\n");
         printf("%s", Main_USAGE);
         status = -1;
         goto leave;
     }
+    for (i = 0; i < Main_numProcs; i++) {
+        for (x = 0; x < (Int)i; x++) {
+            if (strcmp(Main_remoteProcNames[i], Main_remoteProcNames[x]) == 0) {
+                printf("Error: %s given twice\n", Main_remoteProcNames[i]);
+                status = -1;
+                goto leave;
+            }
+        }
+    }
+    if (Main_params.numMsgs == 0 || Main_params.window == 0) {
+        printf("Error: -n and -w need at least one message\n");
+        status = -1;
+        goto leave;
+    }
+    if (Main_dispatch && (Main_jobParams.numJobs == 0 ||
+            Main_jobParams.window > App_MAX_WINDOW)) {
+        printf("Error: -j needs at least one job and -w at most %u\n",
+            App_MAX_WINDOW);
+        status = -1;
+        goto leave;
+    }
+    if (Main_dispatch && Main_threads) {
+        printf("Error: -j dispatches from the one poller thread, not -t\n");
+        status = -1;
+        goto leave;
+    }
 
 leave:
     return(status);
@@ -50,15 +50,35 @@ extern "C" {
 #define App_CMD_MASK            0xFF000000
 #define App_CMD_NOP             0x00000000  /* cc------ */
 #define App_CMD_SHUTDOWN        0x02000000  /* cc------ */
+#define App_CMD_JOB             0x03000000  /* cc------ */
+
+/* kernels of the remote job table, App_Msg.kernel */
+#define App_KERNEL_NOP          0   /* result = arg */
+#define App_KERNEL_SPIN         1   /* arg LCG steps */
+#define App_KERNEL_SUM          2   /* sum of i * i for i < arg */
+#define App_KERNEL_CRC          3   /* CRC-32 of arg pattern bytes */
+#define App_NUM_KERNELS         4
+
+/* App_Msg.status of a job */
+#define App_JOB_OK              0
+#define App_JOB_EKERNEL         1   /* no such kernel */
 
 
 typedef struct {
     MessageQ_MsgHeader  reserved;
     UInt32              cmd;
+    UInt32              job;        /* host's job number, returned as is */
+    UInt32              kernel;     /* App_KERNEL_* */
+    UInt32              arg;        /* kernel input, its amount of work */
+    UInt32              result;     /* kernel output */
+    UInt32              status;     /* App_JOB_* */
+    UInt32              ticks;      /* remote Timestamp ticks of the kernel */
+    UInt32              idle;       /* remote ticks idle since the last job */
+    UInt32              freq;       /* remote Timestamp ticks per second */
 } App_Msg;
 
 #define App_MsgHeapId           0
-#define App_HostMsgQueName      "HOST:MsgQ:01"
+#define App_HostMsgQueName      "HOST:MsgQ:%02u"  /* %u counts from 1 */
 #define App_SlaveMsgQueName     "%s:MsgQ:01"  /* %s is each slave's Proc Name */
 
 
@@ -43,16 +43,23 @@
 #include <xdc/std.h>
 #include <xdc/runtime/Assert.h>
 #include <xdc/runtime/Diags.h>
+#include <xdc/runtime/Error.h>
 #include <xdc/runtime/Log.h>
+#include <xdc/runtime/Memory.h>
 #include <xdc/runtime/Registry.h>
+#include <xdc/runtime/Timestamp.h>
 
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
 
 /* package header files */
 #include <ti/ipc/MessageQ.h>
 #include <ti/ipc/MultiProc.h>
 
 #include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/heaps/HeapBuf.h>
+#include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Task.h>
 
 /* local header files */
@@ -61,15 +68,66 @@
 /* module header file */
 #include "Server.h"
 
+/* MessageQ_alloc attempts, a tick apart, before a reply is given up */
+#define Server_ALLOC_TRIES  100
+
+/* one queue served by one task */
+typedef struct {
+    UInt32              index;              // channel number - 1
+    MessageQ_Handle     slaveQue;           // created locally
+    Task_Handle         task;               // serves slaveQue
+    Semaphore_Handle    done;               // posted when the task ends
+    Int                 status;             // Server_serve's result
+    App_Msg *           pool[App_POOL_MAX]; // App_CMD_POOL replies
+    UInt32              poolCount;          // messages in the pool
+    UInt32              poolSize;           // bytes per pool message
+    App_Stats           stats;              // since the last App_CMD_STATS
+    UInt64              allocTicks;
+    UInt64              putTicks;
+    Int                 basePri;            // from App_CMD_PRIORITY
+    UInt                msgPri;             // class of the last message
+    App_HeapStats       heapStats[App_NUM_HEAPS]; // since App_CMD_HEAPS
+} Server_Channel;
+
+/* a size class heap, created and registered by Server_create */
+typedef struct {
+    HeapBuf_Handle      heap;               // NULL for heap 0
+    Ptr                 buf;                // the heap's blocks
+    UInt32              bufSize;
+} Server_Heap;
+
 /* module structure */
 typedef struct {
     UInt16              hostProcId;         // host processor id
-    MessageQ_Handle     slaveQue;           // created locally
+    UInt32              tsFreq;             // Timestamp ticks per second
+    Server_Channel      channels[App_MAX_CHANNELS];
+    Server_Heap         heaps[App_NUM_HEAPS];
 } Server_Module;
 
 /* private data */
 Registry_Desc               Registry_CURDESC;
 static Server_Module        Module;
+static String               Server_taskNames[App_MAX_CHANNELS] = {
+    "Server1", "Server2", "Server3", "Server4"
+};
+static const UInt32         Server_heapSizes[App_NUM_HEAPS] = App_HEAP_SIZES;
+static const UInt32         Server_heapBlocks[App_NUM_HEAPS] = App_HEAP_BLOCKS;
+
+/* private functions */
+static Void Server_task(UArg arg0, UArg arg1);
+static Int Server_serve(Server_Channel *ch);
+static App_Msg *Server_alloc(Server_Channel *ch, UInt32 size, Int tries);
+static Void Server_send(Server_Channel *ch, MessageQ_QueueId queId,
+        App_Msg *msg);
+static Void Server_fill(Server_Channel *ch, UInt32 size, UInt32 count);
+static Void Server_drain(Server_Channel *ch);
+static Void Server_getStats(Server_Channel *ch, App_Msg *msg);
+static Void Server_getHeaps(Server_Channel *ch, App_Msg *msg);
+static Int Server_createHeaps(Void);
+static Void Server_deleteHeaps(Void);
+static Int Server_classPri(Server_Channel *ch);
+static Void Server_setClass(Server_Channel *ch, UInt msgPri);
+static Void Server_work(UInt32 us);
 
 
 /*
@@ -90,27 +148,60 @@ Void Server_init(Void)
 
 /*
  *  ======== Server_create ========
+ *  A queue and a done semaphore for every channel.
  */
 Int Server_create()
 {
     Int                 status = 0;
     MessageQ_Params     msgqParams;
     char                msgqName[32];
+    Types_FreqHz        freq;
+    Error_Block         eb;
+    Server_Channel *    ch;
+    UInt32              i;
 
     /* enable some log events */
     Diags_setMask(MODULE_NAME"+EXF");
 
-    /* create local message queue (inbound messages) */
-    MessageQ_Params_init(&msgqParams);
-    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(MultiProc_self()));
-    Module.slaveQue = MessageQ_create(msgqName, &msgqParams);
+    Timestamp_getFreq(&freq);
+    Module.tsFreq = freq.lo;
+    Error_init(&eb);
 
-    if (Module.slaveQue == NULL) {
-        status = -1;
+    /* the size classes every channel allocates from */
+    status = Server_createHeaps();
+
+    if (status < 0) {
         goto leave;
     }
 
-    Log_print0(Diags_INFO,"Server_create: server is ready");
+    for (i = 0; i < App_MAX_CHANNELS; i++) {
+        ch = &Module.channels[i];
+        memset(ch, 0, sizeof(Server_Channel));
+        ch->index = i;
+        ch->basePri = 1;
+        ch->msgPri = MessageQ_NORMALPRI;
+
+        /* create local message queue (inbound messages) */
+        MessageQ_Params_init(&msgqParams);
+        sprintf(msgqName, App_SlaveMsgQueName,
+            MultiProc_getName(MultiProc_self()), i + 1);
+        ch->slaveQue = MessageQ_create(msgqName, &msgqParams);
+
+        if (ch->slaveQue == NULL) {
+            status = -1;
+            goto leave;
+        }
+
+        ch->done = Semaphore_create(0, NULL, &eb);
+
+        if (Error_check(&eb)) {
+            status = -1;
+            goto leave;
+        }
+    }
+
+    Log_print1(Diags_INFO,"Server_create: server is ready, %d channels",
+        (IArg)App_MAX_CHANNELS);
 
 leave:
     Log_print1(Diags_EXIT, "<-- Server_create: %d", (IArg)status);
@@ -122,44 +213,225 @@ leave:
 
 /*
  *  ======== Server_exec ========
+ *  Serve every channel from its own task. Channel 1 carries the shutdown,
+ *  the other channels are unblocked once it has ended.
  */
 Int Server_exec()
+{
+    Int                 status = 0;
+    Task_Params         taskParams;
+    Error_Block         eb;
+    Server_Channel *    ch;
+    UInt32              i, started;
+
+    Log_print0(Diags_ENTRY | Diags_INFO, "--> Server_exec:");
+
+    Error_init(&eb);
+
+    for (started = 0; started < App_MAX_CHANNELS; started++) {
+        ch = &Module.channels[started];
+        Task_Params_init(&taskParams);
+        taskParams.instance->name = Server_taskNames[started];
+        taskParams.arg0 = (UArg)ch;
+        taskParams.stackSize = 0x1000;
+        ch->task = Task_create(Server_task, &taskParams, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error1("Server_exec: failed to create task %d",
+                (IArg)(started + 1));
+            status = -1;
+            break;
+        }
+    }
+
+    /* wait for the shutdown unless a task failed to start */
+    i = 0;
+    if (status == 0) {
+        Semaphore_pend(Module.channels[0].done, BIOS_WAIT_FOREVER);
+        status = Module.channels[0].status;
+        i = 1;
+    }
+    for (; i < started; i++) {
+        ch = &Module.channels[i];
+        MessageQ_unblock(ch->slaveQue);
+        Semaphore_pend(ch->done, BIOS_WAIT_FOREVER);
+    }
+    for (i = 0; i < started; i++) {
+        Task_delete(&Module.channels[i].task);
+    }
+
+    Log_print1(Diags_EXIT, "<-- Server_exec: %d", (IArg)status);
+    return(status);
+}
+
+/*
+ *  ======== Server_task ========
+ */
+static Void Server_task(UArg arg0, UArg arg1)
+{
+    Server_Channel *ch = (Server_Channel *)arg0;
+
+    ch->status = Server_serve(ch);
+    Semaphore_post(ch->done);
+}
+
+/*
+ *  ======== Server_serve ========
+ *  Answer one channel's requests until it is shut down or unblocked.
+ */
+static Int Server_serve(Server_Channel *ch)
 {
     Int                 status;
     Bool                running = TRUE;
     App_Msg *           msg;
     MessageQ_QueueId    queId;
+    UInt32              count;
+    UInt32              size;
+    UInt32              work;
+    Bool                pooled;
+    UInt32              spare;
+    App_Msg *           reply;
     int i;
 
-    Log_print0(Diags_ENTRY | Diags_INFO, "--> Server_exec:");
+    Log_print1(Diags_ENTRY | Diags_INFO, "--> Server_serve: channel %d",
+        (IArg)(ch->index + 1));
 
     while (running) {
 
         /* wait for inbound message */
-        status = MessageQ_get(Module.slaveQue, (MessageQ_Msg *)&msg,
+        status = MessageQ_get(ch->slaveQue, (MessageQ_Msg *)&msg,
             MessageQ_FOREVER);
 
+        if (status == MessageQ_E_UNBLOCKED) {
+            status = 0;
+            goto leave;
+        }
         if (status < 0) {
             goto leave;
         }
 
+        /* the task runs at the priority of what it serves */
+        Server_setClass(ch, MessageQ_getMsgPri((MessageQ_Msg)msg));
+
+        /* ping-pong, the same message goes back untouched */
+        if (msg->cmd == App_CMD_ECHO) {
+            queId = MessageQ_getReplyQueue(msg);
+            MessageQ_put(queId, (MessageQ_Msg)msg);
+            continue;
+        }
+
+        /* counters since the last ask, then start again */
+        if (msg->cmd == App_CMD_STATS) {
+            Server_getStats(ch, msg);
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            continue;
+        }
+
+        /* the heaps' block use and this channel's allocations */
+        if (msg->cmd == App_CMD_HEAPS) {
+            Server_getHeaps(ch, msg);
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            continue;
+        }
+
+        /* this channel's task priority, the old one goes back in r1 */
+        if (msg->cmd == App_CMD_PRIORITY) {
+            if (msg->r1 >= 1 && msg->r1 <= App_PRI_MAX) {
+                count = ch->basePri;
+                ch->basePri = msg->r1;
+                msg->r1 = count;
+                Task_setPri(Task_self(), Server_classPri(ch));
+            }
+            else {
+                Log_error1("Server_serve: bad priority %d", (IArg)msg->r1);
+                msg->r1 = ch->basePri;
+            }
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            continue;
+        }
+
         if (msg->cmd == App_CMD_SHUTDOWN) {
             running = FALSE;
         }
 
+        count = App_BURST_DEFAULT;
+        size = App_MSG_MAX;
+        work = 0;
+        pooled = ((msg->cmd & App_CMD_MASK) == App_CMD_POOL);
+        if ((msg->cmd & App_CMD_MASK) == App_CMD_BURST || pooled) {
+            count = msg->r1;
+            size = msg->cmd & ~App_CMD_MASK;
+            if (size < App_MSG_MIN || size > App_MSG_MAX) {
+                Log_error1("Server_serve: bad burst message size %d",
+                    (IArg)size);
+                size = App_MSG_MAX;
+            }
+        }
+        else if ((msg->cmd & App_CMD_MASK) == App_CMD_WORK) {
+            count = msg->r1;
+            size = MessageQ_getMsgSize(msg);
+            work = msg->cmd & App_WORK_MAX;
+        }
+
         queId = MessageQ_getReplyQueue(msg); /* type-cast not needed */
+
+        if (pooled) {
+            /* a no-op unless the size or burst changed */
+            spare = (count > 0) ? count - 1 : 0;
+            Server_fill(ch, size, spare);
+
+            /* the request is the first reply when it is the right size */
+            if (count > 0 && MessageQ_getMsgSize(msg) == size) {
+                ch->stats.recycled++;
+                msg->cmd = App_CMD_NOP;
+                Server_send(ch, queId, msg);
+                i = 1;
+            }
+            else {
+                MessageQ_free((MessageQ_Msg)msg);
+                i = 0;
+            }
+            for (; i < count; i++) {
+                if (ch->poolCount > 0) {
+                    reply = ch->pool[--ch->poolCount];
+                }
+                else {
+                    /* a burst longer than the pool */
+                    ch->stats.replyAllocs++;
+                    reply = Server_alloc(ch, size, Server_ALLOC_TRIES);
+                    if (reply == NULL) {
+                        break;
+                    }
+                }
+                reply->cmd = App_CMD_NOP;
+                Server_send(ch, queId, reply);
+            }
+
+            /* ready for the next burst while the host takes this one */
+            Server_fill(ch, size, spare);
+            continue;
+        }
+
         MessageQ_free((MessageQ_Msg)msg);
-        for(i = 0; i < 64; i++)
+        for(i = 0; i < count; i++)
         {
-            msg = (App_Msg *)MessageQ_alloc(0, sizeof(App_Msg));
+            if (work > 0) {
+                Server_work(work);
+            }
+            ch->stats.replyAllocs++;
+            msg = Server_alloc(ch, size, Server_ALLOC_TRIES);
+            if (msg == NULL) {
+                break;
+            }
             msg->cmd = App_CMD_NOP;
             /* send message back */
-            MessageQ_put(queId, (MessageQ_Msg)msg);
+            Server_send(ch, queId, msg);
         }
     } /* while (running) */
 
 leave:
-    Log_print1(Diags_EXIT, "<-- Server_exec: %d", (IArg)status);
+    Log_print2(Diags_EXIT, "<-- Server_serve: channel %d, %d",
+        (IArg)(ch->index + 1), (IArg)status);
     return(status);
 }
 
@@ -169,17 +441,35 @@ leave:
 
 Int Server_delete()
 {
-    Int         status;
+    Int                 status = 0;
+    Server_Channel *    ch;
+    UInt32              i;
 
     Log_print0(Diags_ENTRY, "--> Server_delete:");
 
-    /* delete the video message queue */
-    status = MessageQ_delete(&Module.slaveQue);
+    for (i = 0; i < App_MAX_CHANNELS; i++) {
+        ch = &Module.channels[i];
 
-    if (status < 0) {
-        goto leave;
+        /* return the reply pool to the heap */
+        Server_drain(ch);
+
+        if (ch->done != NULL) {
+            Semaphore_delete(&ch->done);
+        }
+
+        /* delete the channel's message queue */
+        if (ch->slaveQue != NULL) {
+            status = MessageQ_delete(&ch->slaveQue);
+        }
+
+        if (status < 0) {
+            goto leave;
+        }
     }
 
+    /* every message of the classes is back now */
+    Server_deleteHeaps();
+
 leave:
     if (status < 0) {
         Log_error1("Server_finish: error=0x%x", (IArg)status);
@@ -192,6 +482,288 @@ leave:
     return(status);
 }
 
+/*
+ *  ======== Server_alloc ========
+ *  Timed MessageQ_alloc from the smallest size class that fits, or the
+ *  next one up while it is empty. The classes run dry only while the
+ *  transport still holds messages, so a failure waits a tick and tries
+ *  again; a reply given up on leaves the host short of a burst.
+ */
+static App_Msg *Server_alloc(Server_Channel *ch, UInt32 size, Int tries)
+{
+    App_Msg *   msg = NULL;
+    UInt32      start;
+    UInt16      first = App_heapId(size);
+    UInt16      heapId;
+
+    while (tries-- > 0) {
+        start = Timestamp_get32();
+        for (heapId = first; heapId < App_NUM_HEAPS; heapId++) {
+            msg = (App_Msg *)MessageQ_alloc(heapId, size);
+            if (msg != NULL) {
+                break;
+            }
+            ch->heapStats[heapId].fails++;
+        }
+        ch->allocTicks += Timestamp_get32() - start;
+
+        if (msg != NULL) {
+            ch->stats.allocs++;
+            ch->heapStats[heapId].allocs++;
+            if (heapId != first) {
+                ch->heapStats[heapId].spills++;
+            }
+            return (msg);
+        }
+        ch->stats.allocFails++;
+        if (tries > 0) {
+            Task_sleep(1);
+        }
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== Server_send ========
+ *  Timed MessageQ_put, the transport copies the message out and frees it.
+ */
+static Void Server_send(Server_Channel *ch, MessageQ_QueueId queId,
+        App_Msg *msg)
+{
+    UInt32      start;
+
+    start = Timestamp_get32();
+    MessageQ_put(queId, (MessageQ_Msg)msg);
+    ch->putTicks += Timestamp_get32() - start;
+    ch->stats.replies++;
+}
+
+/*
+ *  ======== Server_fill ========
+ *  Top the pool up to count messages of size bytes, at most App_POOL_MAX.
+ *  The channels share the heap, so a refill stops at the first failure
+ *  and the replies it could not cover are allocated inline.
+ */
+static Void Server_fill(Server_Channel *ch, UInt32 size, UInt32 count)
+{
+    App_Msg *   msg;
+
+    if (size != ch->poolSize) {
+        Server_drain(ch);
+        ch->poolSize = size;
+    }
+    if (count > App_POOL_MAX) {
+        count = App_POOL_MAX;
+    }
+
+    while (ch->poolCount < count) {
+        msg = Server_alloc(ch, size, 1);
+        if (msg == NULL) {
+            break;
+        }
+        ch->pool[ch->poolCount++] = msg;
+    }
+}
+
+/*
+ *  ======== Server_drain ========
+ */
+static Void Server_drain(Server_Channel *ch)
+{
+    while (ch->poolCount > 0) {
+        MessageQ_free((MessageQ_Msg)ch->pool[--ch->poolCount]);
+    }
+}
+
+/*
+ *  ======== Server_getStats ========
+ *  Copy the channel's counters into the message payload and clear them.
+ */
+static Void Server_getStats(Server_Channel *ch, App_Msg *msg)
+{
+    App_Stats *stats = (App_Stats *)msg->payload;
+
+    if (MessageQ_getMsgSize(msg) < App_MSG_MIN + sizeof(App_Stats)) {
+        Log_error1("Server_getStats: %d byte message is too small",
+            (IArg)MessageQ_getMsgSize(msg));
+        return;
+    }
+
+    *stats = ch->stats;
+    stats->allocTicksHi = (UInt32)(ch->allocTicks >> 32);
+    stats->allocTicksLo = (UInt32)ch->allocTicks;
+    stats->putTicksHi = (UInt32)(ch->putTicks >> 32);
+    stats->putTicksLo = (UInt32)ch->putTicks;
+    stats->tsFreq = Module.tsFreq;
+
+    memset(&ch->stats, 0, sizeof(ch->stats));
+    ch->allocTicks = 0;
+    ch->putTicks = 0;
+}
+
+/*
+ *  ======== Server_getHeaps ========
+ *  Every heap's size, blocks in use and high-water mark with the
+ *  channel's counters, into the message payload. The counters are
+ *  cleared.
+ */
+static Void Server_getHeaps(Server_Channel *ch, App_Msg *msg)
+{
+    App_HeapStats *         heaps = (App_HeapStats *)msg->payload;
+    HeapBuf_ExtendedStats   stats;
+    UInt32                  i;
+
+    if (MessageQ_getMsgSize(msg) <
+            App_MSG_MIN + App_NUM_HEAPS * sizeof(App_HeapStats)) {
+        Log_error1("Server_getHeaps: %d byte message is too small",
+            (IArg)MessageQ_getMsgSize(msg));
+        return;
+    }
+
+    for (i = 0; i < App_NUM_HEAPS; i++) {
+        heaps[i] = ch->heapStats[i];
+        heaps[i].blockSize = Server_heapSizes[i];
+        heaps[i].numBlocks = Server_heapBlocks[i];
+        heaps[i].inUse = App_HEAP_UNKNOWN;
+        heaps[i].highWater = App_HEAP_UNKNOWN;
+
+        if (Module.heaps[i].heap != NULL) {
+            HeapBuf_getExtendedStats(Module.heaps[i].heap, &stats);
+            heaps[i].inUse = stats.numAllocatedBlocks;
+            heaps[i].highWater = stats.maxAllocatedBlocks;
+        }
+    }
+
+    memset(ch->heapStats, 0, sizeof(ch->heapStats));
+}
+
+/*
+ *  ======== Server_createHeaps ========
+ *  A HeapBuf for every size class, its blocks from the default heap,
+ *  registered with MessageQ under the class's heap id.
+ */
+static Int Server_createHeaps(Void)
+{
+    Int                 status = 0;
+    HeapBuf_Params      heapParams;
+    Error_Block         eb;
+    Server_Heap *       heap;
+    UInt32              i;
+
+    Error_init(&eb);
+
+    for (i = App_MsgHeapId + 1; i < App_NUM_HEAPS; i++) {
+        heap = &Module.heaps[i];
+        heap->bufSize = Server_heapSizes[i] * Server_heapBlocks[i];
+        heap->buf = Memory_alloc(NULL, heap->bufSize, 8, &eb);
+
+        if (Error_check(&eb) || heap->buf == NULL) {
+            Log_error1("Server_createHeaps: no memory for heap %d", (IArg)i);
+            status = -1;
+            goto leave;
+        }
+
+        HeapBuf_Params_init(&heapParams);
+        heapParams.align = 8;
+        heapParams.blockSize = Server_heapSizes[i];
+        heapParams.numBlocks = Server_heapBlocks[i];
+        heapParams.buf = heap->buf;
+        heapParams.bufSize = heap->bufSize;
+        heap->heap = HeapBuf_create(&heapParams, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error1("Server_createHeaps: failed to create heap %d",
+                (IArg)i);
+            status = -1;
+            goto leave;
+        }
+
+        status = MessageQ_registerHeap(HeapBuf_Handle_upCast(heap->heap), i);
+
+        if (status < 0) {
+            Log_error2("Server_createHeaps: heap %d not registered, %d",
+                (IArg)i, (IArg)status);
+            goto leave;
+        }
+    }
+
+leave:
+    if (status < 0) {
+        Server_deleteHeaps();
+    }
+    return (status);
+}
+
+/*
+ *  ======== Server_deleteHeaps ========
+ */
+static Void Server_deleteHeaps(Void)
+{
+    Server_Heap *       heap;
+    UInt32              i;
+
+    for (i = App_MsgHeapId + 1; i < App_NUM_HEAPS; i++) {
+        heap = &Module.heaps[i];
+
+        if (heap->heap != NULL) {
+            MessageQ_unregisterHeap(i);
+            HeapBuf_delete(&heap->heap);
+        }
+        if (heap->buf != NULL) {
+            Memory_free(NULL, heap->buf, heap->bufSize);
+            heap->buf = NULL;
+        }
+    }
+}
+
+/*
+ *  ======== Server_classPri ========
+ *  The BIOS priority of the class the channel's task is serving.
+ */
+static Int Server_classPri(Server_Channel *ch)
+{
+    switch (ch->msgPri) {
+        case MessageQ_URGENTPRI:
+            return (App_PRI_MAX);
+
+        case MessageQ_HIGHPRI:
+            return (ch->basePri > App_PRI_HIGH ? ch->basePri : App_PRI_HIGH);
+
+        default:
+            return (ch->basePri);
+    }
+}
+
+/*
+ *  ======== Server_setClass ========
+ *  Move the task to the priority of a message's class. A class change
+ *  costs the first message of the new class the wait at the old
+ *  priority; the ones after it preempt everything below.
+ */
+static Void Server_setClass(Server_Channel *ch, UInt msgPri)
+{
+    if (msgPri == ch->msgPri) {
+        return;
+    }
+    ch->msgPri = msgPri;
+    Task_setPri(Task_self(), Server_classPri(ch));
+}
+
+/*
+ *  ======== Server_work ========
+ *  us microseconds of computation, the part of a long job that holds the
+ *  task; anything of a higher priority preempts it.
+ */
+static Void Server_work(UInt32 us)
+{
+    UInt32 ticks = (UInt32)((UInt64)us * Module.tsFreq / 1000000);
+    UInt32 start = Timestamp_get32();
+
+    while (Timestamp_get32() - start < ticks) {
+    }
+}
+
 /*
  *  ======== Server_exit ========
  */
@@ -34,10 +34,13 @@
  *  ======== App.c ========
  *
  */
-
 /* host header files */
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/time.h>
 
 /* package header files */
@@ -47,62 +50,109 @@
 /* local header files */
 #include "../shared/AppCommon.h"
 #include "App.h"
+#include "Receive.h"
+#include "Sched.h"
+#include "Rtt.h"
 
-/* module structure */
+/* round trips left out of a ping-pong run while the path warms up */
+#define App_PING_WARMUP 100
+
+/* round trips a control channel keeps while the data channels run */
+#define App_CONTROL_MAX 0x100000
+
+/* one queue pair and the host thread that drives it */
 typedef struct {
+    UInt32                  index;      // channel number - 1
     MessageQ_Handle         hostQue;    // created locally
     MessageQ_QueueId        slaveQue;   // opened remotely
-    UInt16                  heapId;     // MessageQ heapId
-    UInt32                  msgSize;
+    pthread_t               thread;
+    App_Params              params;     // this channel's share of a run
+    App_Result              result;
+    Int                     status;
+    Int                     priority;   // DSP task priority this run
+    Bool                    control;    // pings until the data is done
+    UInt                    msgPri;     // MessageQ priority of its messages
+    char                    name[16];   // Sched_thread name
+} App_Channel;
+
+/* module structure */
+typedef struct {
+    App_Channel             channels[App_MAX_CHANNELS];
+    UInt32                  numChannels;
+    pthread_mutex_t         lock;       // reports, dataLeft and the gate
+    pthread_cond_t          gateCond;
+    Int                     gate;       // 0 wait, 1 run, -1 give up
+    pthread_barrier_t       barrier;    // channels start measuring together
+    UInt32                  dataLeft;   // burst channels still running
 } App_Module;
 
 /* private data */
-static App_Module Module;
+static App_Module Module = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .gateCond = PTHREAD_COND_INITIALIZER
+};
+
+/* private functions */
+static Int App_run(App_Channel *ch);
+static void *App_channelThread(void *arg);
 
 
 /*
  *  ======== App_create ========
  */
 
-Int App_create(UInt16 remoteProcId)
+Int App_create(UInt16 remoteProcId, UInt32 numChannels)
 {
     Int                 status = 0;
     MessageQ_Params     msgqParams;
     char                msgqName[32];
+    App_Channel *       ch;
+    UInt32              i;
 
     printf("--> App_create:\n");
 
     /* setting default values */
-    Module.hostQue = NULL;
-    Module.slaveQue = MessageQ_INVALIDMESSAGEQ;
-    Module.heapId = App_MsgHeapId;
-    Module.msgSize = sizeof(App_Msg);
+    Module.numChannels = numChannels;
+    for (i = 0; i < App_MAX_CHANNELS; i++) {
+        ch = &Module.channels[i];
+        ch->index = i;
+        ch->hostQue = NULL;
+        ch->slaveQue = MessageQ_INVALIDMESSAGEQ;
+        snprintf(ch->name, sizeof(ch->name), "channel %u", i + 1);
+    }
 
-    /* create local message queue (inbound messages) */
-    MessageQ_Params_init(&msgqParams);
+    for (i = 0; i < numChannels; i++) {
+        ch = &Module.channels[i];
 
-    Module.hostQue = MessageQ_create(App_HostMsgQueName, &msgqParams);
+        /* create local message queue (inbound messages) */
+        MessageQ_Params_init(&msgqParams);
+        sprintf(msgqName, App_HostMsgQueName, i + 1);
 
-    if (Module.hostQue == NULL) {
-        printf("App_create: Failed creating MessageQ\n");
-        status = -1;
-        goto leave;
-    }
+        ch->hostQue = MessageQ_create(msgqName, &msgqParams);
 
-    /* open the remote message queue */
-    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(remoteProcId));
+        if (ch->hostQue == NULL) {
+            printf("App_create: Failed creating MessageQ %s\n", msgqName);
+            status = -1;
+            goto leave;
+        }
 
-    do {
-        status = MessageQ_open(msgqName, &Module.slaveQue);
-        sleep(1);
-    } while (status == MessageQ_E_NOTFOUND);
+        /* open the remote message queue */
+        sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(remoteProcId),
+            i + 1);
 
-    if (status < 0) {
-        printf("App_create: Failed opening MessageQ\n");
-        goto leave;
+        do {
+            status = MessageQ_open(msgqName, &ch->slaveQue);
+            sleep(1);
+        } while (status == MessageQ_E_NOTFOUND);
+
+        if (status < 0) {
+            printf("App_create: Failed opening MessageQ %s\n", msgqName);
+            goto leave;
+        }
     }
 
-    printf("App_create: Host is ready\n");
+    printf("App_create: Host is ready, %u channel%s\n", numChannels,
+        numChannels > 1 ? "s" : "");
 
 leave:
     printf("<-- App_create:\n");
@@ -115,81 +165,461 @@ leave:
  */
 Int App_delete(Void)
 {
-    Int         status;
+    Int         status = 0;
+    App_Channel *ch;
+    UInt32      i;
 
     printf("--> App_delete:\n");
 
-    /* close remote resources */
-    status = MessageQ_close(&Module.slaveQue);
+    for (i = 0; i < Module.numChannels; i++) {
+        ch = &Module.channels[i];
+
+        /* close remote resources */
+        if (ch->slaveQue != MessageQ_INVALIDMESSAGEQ) {
+            status = MessageQ_close(&ch->slaveQue);
+        }
+
+        if (status < 0) {
+            goto leave;
+        }
+
+        /* delete the host message queue */
+        if (ch->hostQue != NULL) {
+            status = MessageQ_delete(&ch->hostQue);
+        }
+
+        if (status < 0) {
+            goto leave;
+        }
+    }
+
+leave:
+    printf("<-- App_delete:\n");
+    return(status);
+}
+
+
+/*
+ *  ======== App_Params_init ========
+ */
+Void App_Params_init(App_Params *params)
+{
+    UInt32 i;
+
+    params->msgSize = App_MSG_MAX;
+    params->burst = App_BURST_DEFAULT;
+    params->numMsgs = 128 * 10000;
+    params->spinUs = 0;
+    params->outstanding = 0;
+    params->pool = FALSE;
+    params->control = FALSE;
+    params->urgent = TRUE;
+    params->workUs = 0;
+    for (i = 0; i < App_MAX_CHANNELS; i++) {
+        params->priorities[i] = 0;
+    }
+    params->dump = NULL;
+}
+
+/*
+ *  ======== App_request ========
+ *  Ask the DSP for the next burst, reusing msg.
+ */
+static Void App_request(App_Channel *ch, App_Msg *msg,
+        const App_Params *params)
+{
+    /* set the return address and class in the message header */
+    MessageQ_setReplyQueue(ch->hostQue, (MessageQ_Msg)msg);
+    MessageQ_setMsgPri((MessageQ_Msg)msg, ch->msgPri);
+
+    /* fill in message payload, a long job's replies are the request's size */
+    if (params->workUs > 0) {
+        msg->cmd = App_CMD_WORK | params->workUs;
+    }
+    else {
+        msg->cmd = (params->pool ? App_CMD_POOL : App_CMD_BURST) |
+            params->msgSize;
+    }
+    msg->r1 = params->burst;
+
+    /* send message */
+    MessageQ_put(ch->slaveQue, (MessageQ_Msg)msg);
+}
+
+/*
+ *  ======== App_command ========
+ *  Send cmd with r1 on the channel and wait for it to come back, the
+ *  reply's r1 and payload are left in *reply for the caller to free.
+ */
+static Int App_command(App_Channel *ch, UInt32 cmd, UInt32 r1,
+        App_Msg **reply)
+{
+    Int         status;
+    App_Msg *   msg;
+
+    msg = (App_Msg *)MessageQ_alloc(App_heapId(App_MSG_MAX),
+        App_MSG_MAX);
+
+    if (msg == NULL) {
+        return (-1);
+    }
+
+    MessageQ_setReplyQueue(ch->hostQue, (MessageQ_Msg)msg);
+    MessageQ_setMsgPri((MessageQ_Msg)msg, ch->msgPri);
+    msg->cmd = cmd;
+    msg->r1 = r1;
+    MessageQ_put(ch->slaveQue, (MessageQ_Msg)msg);
+
+    status = MessageQ_get(ch->hostQue, (MessageQ_Msg *)&msg,
+        MessageQ_FOREVER);
 
     if (status < 0) {
-        goto leave;
+        return (status);
     }
 
-    /* delete the host message queue */
-    status = MessageQ_delete(&Module.hostQue);
+    if (msg->cmd != cmd) {
+        printf("App_command: unexpected reply 0x%x to 0x%x\n", msg->cmd, cmd);
+        MessageQ_free((MessageQ_Msg)msg);
+        return (-1);
+    }
+    *reply = msg;
+
+    return (0);
+}
+
+/*
+ *  ======== App_getStats ========
+ *  The DSP's counters for the channel since the last call, which clears
+ *  them.
+ */
+static Int App_getStats(App_Channel *ch, App_Stats *stats)
+{
+    Int         status;
+    App_Msg *   msg;
+
+    status = App_command(ch, App_CMD_STATS, 0, &msg);
 
     if (status < 0) {
+        return (status);
+    }
+
+    if (stats != NULL) {
+        memcpy(stats, msg->payload, sizeof(App_Stats));
+    }
+    MessageQ_free((MessageQ_Msg)msg);
+
+    return (status);
+}
+
+/*
+ *  ======== App_setPriority ========
+ *  BIOS priority of the DSP task serving the channel.
+ */
+static Int App_setPriority(App_Channel *ch, Int priority)
+{
+    Int         status;
+    App_Msg *   msg;
+
+    status = App_command(ch, App_CMD_PRIORITY, (UInt32)priority, &msg);
+
+    if (status < 0) {
+        return (status);
+    }
+
+    if (msg->r1 != (UInt32)priority) {
+        printf("App_setPriority: channel %u DSP task priority %d, was %u\n",
+            ch->index + 1, priority, msg->r1);
+    }
+    ch->priority = priority;
+    MessageQ_free((MessageQ_Msg)msg);
+
+    return (status);
+}
+
+/*
+ *  ======== App_sync ========
+ *  Channels start measuring together.
+ */
+static Void App_sync(Void)
+{
+    if (Module.numChannels > 1) {
+        pthread_barrier_wait(&Module.barrier);
+    }
+}
+
+/*
+ *  ======== App_dataDone ========
+ */
+static Bool App_dataDone(Void)
+{
+    Bool done;
+
+    pthread_mutex_lock(&Module.lock);
+    done = (Module.dataLeft == 0);
+    pthread_mutex_unlock(&Module.lock);
+
+    return (done);
+}
+
+/*
+ *  ======== App_ping ========
+ *  Ping-pong: outstanding App_CMD_ECHO messages in flight, each one sent
+ *  again as soon as it comes back, every round trip timed. A control
+ *  channel stops resending once the data channels are done.
+ */
+static Int App_ping(App_Channel *ch, const App_Params *params,
+        App_Result *result)
+{
+    Int         status = 0;
+    UInt32      sent = 0, received = 0;
+    UInt32      numMsgs = params->numMsgs + App_PING_WARMUP;
+    UInt32      count = 0;
+    UInt32      slot;
+    UInt64      *sendNs = NULL;
+    UInt64      now, start = 0, end = 0;
+    Bool        synced = FALSE;
+    App_Msg *   msg;
+    Receive_Params receiveParams;
+    Receive_Handle receive = NULL;
+    Receive_Summary summary;
+    Rtt_Params rttParams;
+    Rtt_Handle rtt = NULL;
+    Rtt_Summary rttSummary;
+    Sched_Usage usage;
+    double elapsedTime = 0.0;
+
+    printf("--> App_ping:\n");
+    if (ch->control) {
+        printf("App_ping: channel %u, round trips of %u bytes, %u in flight "
+            "while the data channels run, first %u discarded\n",
+            ch->index + 1, params->msgSize, params->outstanding,
+            App_PING_WARMUP);
+    }
+    else {
+        printf("App_ping: %u round trips of %u bytes, %u in flight, first %u "
+            "discarded\n", params->numMsgs, params->msgSize,
+            params->outstanding, App_PING_WARMUP);
+    }
+
+    Receive_Params_init(&receiveParams);
+    receiveParams.queue = ch->hostQue;
+    receiveParams.maxSpinUs = params->spinUs;
+    receive = Receive_create(&receiveParams);
+
+    Rtt_Params_init(&rttParams);
+    rttParams.maxSamples = params->numMsgs;
+    rtt = Rtt_create(&rttParams);
+
+    sendNs = (UInt64 *)calloc(params->outstanding, sizeof(UInt64));
+
+    if (receive == NULL || rtt == NULL || sendNs == NULL) {
+        status = -1;
         goto leave;
     }
 
+    App_sync();
+    synced = TRUE;
+
+    /* fill the pipe, message r1 says which slot's send time it carries */
+    for (slot = 0; slot < params->outstanding && sent < numMsgs; slot++) {
+        msg = (App_Msg *)MessageQ_alloc(App_heapId(params->msgSize),
+            params->msgSize);
+        if (msg == NULL) {
+            status = -1;
+            goto leave;
+        }
+        MessageQ_setReplyQueue(ch->hostQue, (MessageQ_Msg)msg);
+        MessageQ_setMsgPri((MessageQ_Msg)msg, ch->msgPri);
+        msg->cmd = App_CMD_ECHO;
+        msg->r1 = slot;
+        sendNs[slot] = Rtt_now();
+        MessageQ_put(ch->slaveQue, (MessageQ_Msg)msg);
+        sent++;
+    }
+
+    while (received < sent) {
+        status = Receive_get(receive, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+        now = Rtt_now();
+
+        if (status < 0) {
+            goto leave;
+        }
+
+        slot = msg->r1;
+        if (msg->cmd != App_CMD_ECHO || slot >= params->outstanding) {
+            printf("App_ping: unexpected reply 0x%x, %u\n", msg->cmd, slot);
+            MessageQ_free((MessageQ_Msg)msg);
+            status = -1;
+            goto leave;
+        }
+
+        received++;
+        if (received == App_PING_WARMUP) {
+            Receive_resetStats(receive);
+            Sched_usage(&usage);
+            start = now;
+        }
+        else if (received > App_PING_WARMUP) {
+            Rtt_record(rtt, now - sendNs[slot]);
+            count++;
+            end = now;
+        }
+
+        if (sent < numMsgs && !(ch->control && App_dataDone())) {
+            sendNs[slot] = Rtt_now();
+            MessageQ_put(ch->slaveQue, (MessageQ_Msg)msg);
+            sent++;
+        }
+        else {
+            MessageQ_free((MessageQ_Msg)msg);
+        }
+    }
+    if (count > 0) {
+        Sched_usageSince(&usage, &usage);
+        elapsedTime = (end - start) / 1e6;
+    }
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.numChannels > 1) {
+        printf("Channel %u:\n", ch->index + 1);
+    }
+    if (count == 0) {
+        printf("No round trips after the warm-up\n");
+    }
+    else {
+        printf("time: %f\n", elapsedTime);
+        printf("Round trips per second: %f\n",
+            (double)count / (elapsedTime / 1000.0));
+    }
+    printf("Size of message: %d\n", params->msgSize);
+    printf("Messages in flight: %u\n", params->outstanding);
+    Rtt_report(rtt, &rttSummary);
+    Receive_report(receive, &summary);
+    Sched_report();
+    if (count > 0) {
+        printf("Host faults: %llu minor, %llu major, context switches: %llu "
+            "voluntary, %llu involuntary\n",
+            (unsigned long long)usage.minorFaults,
+            (unsigned long long)usage.majorFaults,
+            (unsigned long long)usage.voluntary,
+            (unsigned long long)usage.involuntary);
+    }
+
+    if (params->dump != NULL) {
+        Rtt_dump(rtt, params->dump, params->msgSize, params->outstanding);
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    if (result != NULL) {
+        memset(result, 0, sizeof(App_Result));
+        result->numMsgs = count;
+        result->ms = elapsedTime;
+        if (count > 0) {
+            result->msgPerSec = count / (elapsedTime / 1000.0);
+            result->mbps = (double)count * params->msgSize / 1e3 /
+                elapsedTime;
+        }
+        result->rttP50Us = rttSummary.p50Us;
+        result->rttP99Us = rttSummary.p99Us;
+        result->rttP999Us = rttSummary.p999Us;
+        result->rttMaxUs = rttSummary.maxUs;
+    }
+
 leave:
-    printf("<-- App_delete:\n");
+    if (!synced) {
+        App_sync();
+    }
+    free(sendNs);
+    Rtt_delete(&rtt);
+    Receive_delete(&receive);
+    printf("<-- App_ping: %d\n", status);
     return(status);
 }
 
-
-#define NUM_PACKETS (128*10000)
 /*
- *  ======== App_exec ========
+ *  ======== App_burst ========
+ *  Bursts of replies, the last reply of each asks for the next.
  */
-Int App_exec(Void)
+static Int App_burst(App_Channel *ch, const App_Params *params,
+        App_Result *result)
 {
-    Int         status;
-    Int         i;
+    Int         status = 0;
+    UInt32      i;
+    UInt32      numMsgs;
+    Bool        synced = FALSE;
     App_Msg *   msg;
     struct timeval t1, t2;
     double elapsedTime;
+    Receive_Params receiveParams;
+    Receive_Handle receive = NULL;
+    Receive_Summary summary;
+    Sched_Usage usage;
+    App_Stats   stats;
+    double      allocUs, putUs, usPerTick;
 
-    printf("--> App_exec:\n");
+    printf("--> App_burst:\n");
 
-    printf("App_exec: sending message %d\n", i);
+    /* whole bursts only, the DSP always sends all of one */
+    numMsgs = (params->numMsgs + params->burst - 1) / params->burst *
+        params->burst;
+
+    Receive_Params_init(&receiveParams);
+    receiveParams.queue = ch->hostQue;
+    receiveParams.maxSpinUs = params->spinUs;
+    receive = Receive_create(&receiveParams);
+
+    if (receive == NULL) {
+        status = -1;
+        goto leave;
+    }
+
+    printf("App_burst: requesting %u messages of %u bytes in bursts of %u%s\n",
+        numMsgs, params->msgSize, params->burst,
+        params->pool ? " from the DSP reply pool" : "");
+    if (params->workUs > 0) {
+        printf("App_burst: %u us of DSP work before each reply\n",
+            params->workUs);
+    }
+
+    /* start the DSP counters from here */
+    status = App_getStats(ch, NULL);
+
+    if (status < 0) {
+        goto leave;
+    }
 
     /* allocate message */
-    msg = (App_Msg *)MessageQ_alloc(Module.heapId, Module.msgSize);
+    msg = (App_Msg *)MessageQ_alloc(App_heapId(params->msgSize),
+        params->msgSize);
 
     if (msg == NULL) {
         status = -1;
         goto leave;
     }
 
-    /* set the return address in the message header */
-    MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
+    App_sync();
+    synced = TRUE;
 
-    /* fill in message payload */
-    msg->cmd = App_CMD_NOP;
-
-    /* send message */
-    MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
+    App_request(ch, msg, params);
 
     /* process steady state (keep pipeline full) */
+    Sched_usage(&usage);
     gettimeofday(&t1, NULL);
-    for (i = 0; i < NUM_PACKETS; i++) {
+    for (i = 0; i < numMsgs; i++) {
 
         /* wait for return message */
-        status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg,
+        status = Receive_get(receive, (MessageQ_Msg *)&msg,
             MessageQ_FOREVER);
 
         if (status < 0) {
             goto leave;
         }
 
-        /* extract message payload */
-        if(i+1 < NUM_PACKETS && ((i+1) % 64) == 0)
+        /* the last of a burst asks for the next one */
+        if(i+1 < numMsgs && ((i+1) % params->burst) == 0)
         {
-            /* set the return address in the message header */
-            MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
-            MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
+            App_request(ch, msg, params);
         }
         else
         {
@@ -198,14 +628,358 @@ Int App_exec(Void)
         }
     }
     gettimeofday(&t2, NULL);
+    Sched_usageSince(&usage, &usage);
+
+    /* what the DSP spent allocating against sending */
+    status = App_getStats(ch, &stats);
+
+    if (status < 0) {
+        goto leave;
+    }
+
     elapsedTime = (t2.tv_sec - t1.tv_sec) * 1000.0;      // sec to ms
     elapsedTime += (t2.tv_usec - t1.tv_usec) / 1000.0;   // us to ms
+    usPerTick = (stats.tsFreq > 0) ? 1e6 / stats.tsFreq : 0.0;
+    allocUs = (((UInt64)stats.allocTicksHi << 32) | stats.allocTicksLo) *
+        usPerTick / (stats.replies > 0 ? stats.replies : 1);
+    putUs = (((UInt64)stats.putTicksHi << 32) | stats.putTicksLo) *
+        usPerTick / (stats.replies > 0 ? stats.replies : 1);
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.numChannels > 1) {
+        printf("Channel %u:\n", ch->index + 1);
+    }
     printf("time: %f\n", elapsedTime);
-    printf("Packets per second: %f\n", (double)NUM_PACKETS/(elapsedTime/1000.0));
-    printf("Size of message: %d\n", Module.msgSize);
-    printf("Number of packets transferred: %d\n", NUM_PACKETS);
+    printf("Packets per second: %f\n", (double)numMsgs/(elapsedTime/1000.0));
+    printf("Size of message: %d\n", params->msgSize);
+    printf("Burst size: %u\n", params->burst);
+    printf("Number of packets transferred: %d\n", numMsgs);
+    printf("Throughput (MB/s): %f\n", (double)numMsgs * params->msgSize /
+        1e3 / elapsedTime);
+    Receive_report(receive, &summary);
+    Sched_report();
+    printf("Host faults: %llu minor, %llu major, context switches: %llu "
+        "voluntary, %llu involuntary\n",
+        (unsigned long long)usage.minorFaults,
+        (unsigned long long)usage.majorFaults,
+        (unsigned long long)usage.voluntary,
+        (unsigned long long)usage.involuntary);
+    printf("DSP: %u replies, %u allocs, %u between replies, %u failed, "
+        "%u requests recycled\n", stats.replies, stats.allocs,
+        stats.replyAllocs, stats.allocFails, stats.recycled);
+    printf("DSP per reply (us): alloc %.3f, put %.3f\n", allocUs, putUs);
+    pthread_mutex_unlock(&Module.lock);
+
+    if (result != NULL) {
+        memset(result, 0, sizeof(App_Result));
+        result->numMsgs = numMsgs;
+        result->ms = elapsedTime;
+        result->msgPerSec = numMsgs / (elapsedTime / 1000.0);
+        result->mbps = (double)numMsgs * params->msgSize / 1e3 / elapsedTime;
+        result->dspAllocUs = allocUs;
+        result->dspPutUs = putUs;
+        result->replyAllocs = stats.replyAllocs;
+        result->allocFails = stats.allocFails;
+    }
 
 leave:
+    if (!synced) {
+        App_sync();
+    }
+    Receive_delete(&receive);
+    printf("<-- App_burst: %d\n", status);
+    return(status);
+}
+
+/*
+ *  ======== App_run ========
+ *  One channel's share of a run; a burst channel counts itself out of
+ *  the data channels when it is done.
+ */
+static Int App_run(App_Channel *ch)
+{
+    Int status;
+
+    if (ch->params.outstanding > 0) {
+        return App_ping(ch, &ch->params, &ch->result);
+    }
+
+    status = App_burst(ch, &ch->params, &ch->result);
+
+    pthread_mutex_lock(&Module.lock);
+    Module.dataLeft--;
+    pthread_mutex_unlock(&Module.lock);
+
+    return (status);
+}
+
+/*
+ *  ======== App_channelThread ========
+ */
+static void *App_channelThread(void *arg)
+{
+    App_Channel *ch = (App_Channel *)arg;
+    Int gate;
+
+    Sched_thread(ch->name);
+
+    /* wait until every channel has a thread */
+    pthread_mutex_lock(&Module.lock);
+    while (Module.gate == 0) {
+        pthread_cond_wait(&Module.gateCond, &Module.lock);
+    }
+    gate = Module.gate;
+    pthread_mutex_unlock(&Module.lock);
+
+    ch->status = (gate > 0) ? App_run(ch) : -1;
+
+    return (NULL);
+}
+
+/*
+ *  ======== App_className ========
+ */
+static String App_className(UInt msgPri)
+{
+    switch (msgPri) {
+        case MessageQ_URGENTPRI:    return "urgent";
+        case MessageQ_HIGHPRI:      return "high";
+        default:                    return "normal";
+    }
+}
+
+/*
+ *  ======== App_printChannels ========
+ *  Per channel and aggregate rates, as a table and csv.
+ */
+static Void App_printChannels(const App_Result *total)
+{
+    App_Channel *ch;
+    App_Result *r;
+    char mode[16];
+    UInt32 i;
+
+    printf("Channels:\n");
+    printf("    channel  DSP pri  class    mode        messages    msgs/s        "
+        "MB/s       p50 (us)   p99 (us)   max (us)\n");
+    for (i = 0; i < Module.numChannels; i++) {
+        ch = &Module.channels[i];
+        r = &ch->result;
+        if (ch->params.outstanding > 0) {
+            snprintf(mode, sizeof(mode), "ping %u", ch->params.outstanding);
+            printf("    %-8u %-8d %-8s %-11s %-11u %-13.1f %-10.3f %-10.3f "
+                "%-10.3f %.3f\n", i + 1, ch->priority,
+                App_className(ch->msgPri), mode, r->numMsgs, r->msgPerSec,
+                r->mbps, r->rttP50Us, r->rttP99Us, r->rttMaxUs);
+        }
+        else {
+            snprintf(mode, sizeof(mode), "%s %u",
+                ch->params.workUs > 0 ? "work" : "burst", ch->params.burst);
+            printf("    %-8u %-8d %-8s %-11s %-11u %-13.1f %.3f\n", i + 1,
+                ch->priority, App_className(ch->msgPri), mode, r->numMsgs,
+                r->msgPerSec, r->mbps);
+        }
+    }
+    printf("    total                                  %-11u %-13.1f %.3f\n",
+        total->numMsgs, total->msgPerSec, total->mbps);
+
+    printf("csvchannelheader, Channel, DSP Priority, Outstanding, Burst, Message Size (B), Messages, Time (ms), Messages/s, MB/s, RTT p50 (us), RTT p99 (us), RTT p99.9 (us), RTT max (us), Message Class, DSP Work per Reply (us)\n");
+    for (i = 0; i < Module.numChannels; i++) {
+        ch = &Module.channels[i];
+        r = &ch->result;
+        printf("csvchannel, %u, %d, %u, %u, %u, %u, %f, %f, %f, %f, %f, %f, %f, %s, %u\n", i + 1, ch->priority, ch->params.outstanding, ch->params.outstanding > 0 ? 0 : ch->params.burst, ch->params.msgSize, r->numMsgs, r->ms, r->msgPerSec, r->mbps, r->rttP50Us, r->rttP99Us, r->rttP999Us, r->rttMaxUs, App_className(ch->msgPri), ch->params.outstanding > 0 ? 0 : ch->params.workUs);
+    }
+}
+
+/*
+ *  ======== App_printHeaps ========
+ *  The DSP's message heaps as the channels used them since the last call,
+ *  and how many blocks each size class needs: its high-water mark and a
+ *  quarter more, or twice what it has when it ran out.
+ */
+Int App_printHeaps(Void)
+{
+    Int             status = 0;
+    App_HeapStats   heaps[App_NUM_HEAPS];
+    App_HeapStats * h;
+    App_Msg *       msg;
+    UInt32          i, j, need, bytes = 0, needBytes = 0;
+
+    memset(heaps, 0, sizeof(heaps));
+    for (i = 0; i < Module.numChannels; i++) {
+        status = App_command(&Module.channels[i], App_CMD_HEAPS, 0, &msg);
+
+        if (status < 0) {
+            return (status);
+        }
+
+        /* the heaps are shared, the counters are per channel */
+        for (j = 0; j < App_NUM_HEAPS; j++) {
+            h = &((App_HeapStats *)msg->payload)[j];
+            heaps[j].blockSize = h->blockSize;
+            heaps[j].numBlocks = h->numBlocks;
+            heaps[j].inUse = h->inUse;
+            heaps[j].highWater = h->highWater;
+            heaps[j].allocs += h->allocs;
+            heaps[j].fails += h->fails;
+            heaps[j].spills += h->spills;
+        }
+        MessageQ_free((MessageQ_Msg)msg);
+    }
+
+    printf("DSP message heaps:\n");
+    printf("    heap  block (B)  blocks  in use  high-water  allocs      "
+        "empty       spilled     needs\n");
+    for (j = 0; j < App_NUM_HEAPS; j++) {
+        h = &heaps[j];
+        if (h->highWater == App_HEAP_UNKNOWN) {
+            printf("    %-5u %-10u %-7u %-7s %-11s %-11u %-11u %-11u %s\n", j,
+                h->blockSize, h->numBlocks, "-", "-", h->allocs, h->fails,
+                h->spills, "-");
+            continue;
+        }
+        need = (h->highWater >= h->numBlocks) ? h->numBlocks * 2 :
+            h->highWater + (h->highWater + 3) / 4;
+        bytes += h->blockSize * h->numBlocks;
+        needBytes += h->blockSize * need;
+        printf("    %-5u %-10u %-7u %-7u %-11u %-11u %-11u %-11u %u%s\n", j,
+            h->blockSize, h->numBlocks, h->inUse, h->highWater, h->allocs,
+            h->fails, h->spills, need,
+            h->highWater >= h->numBlocks ? ", ran out" : "");
+    }
+    printf("    size classes: %u bytes, %u needed\n", bytes, needBytes);
+
+    printf("csvheapheader, Heap, Block Size (B), Blocks, In Use, High-Water, Allocs, Empty, Spilled\n");
+    for (j = 0; j < App_NUM_HEAPS; j++) {
+        h = &heaps[j];
+        /* heap 0 has no levels the server can see, leave them empty */
+        if (h->highWater == App_HEAP_UNKNOWN) {
+            printf("csvheap, %u, %u, %u, , , %u, %u, %u\n", j, h->blockSize,
+                h->numBlocks, h->allocs, h->fails, h->spills);
+            continue;
+        }
+        printf("csvheap, %u, %u, %u, %u, %u, %u, %u, %u\n", j, h->blockSize,
+            h->numBlocks, h->inUse, h->highWater, h->allocs, h->fails,
+            h->spills);
+    }
+
+    return (status);
+}
+
+/*
+ *  ======== App_exec ========
+ *  Run every channel, each from its own thread when there are more than
+ *  one, and add up the channels' results: rates add, latencies and DSP
+ *  costs take the worst channel.
+ */
+Int App_exec(const App_Params *params, App_Result *result)
+{
+    Int         status = 0;
+    App_Channel *ch;
+    App_Result  total;
+    UInt32      i, started = 0;
+    Bool        barrier = FALSE;
+
+    printf("--> App_exec:\n");
+
+    Module.dataLeft = 0;
+    for (i = 0; i < Module.numChannels; i++) {
+        ch = &Module.channels[i];
+        ch->params = *params;
+        ch->control = (params->control && i == 0);
+        ch->msgPri = (ch->control && params->urgent) ? MessageQ_URGENTPRI :
+            MessageQ_NORMALPRI;
+        if (params->control) {
+            /* channel 1 pings one message while the others carry data */
+            ch->params.outstanding = ch->control ? 1 : 0;
+            ch->params.numMsgs = ch->control ? App_CONTROL_MAX :
+                params->numMsgs;
+        }
+        if (ch->params.outstanding == 0) {
+            Module.dataLeft++;
+        }
+        memset(&ch->result, 0, sizeof(App_Result));
+
+        status = App_setPriority(ch, params->priorities[i] > 0 ?
+            params->priorities[i] : App_PRI_DEFAULT);
+
+        if (status < 0) {
+            goto leave;
+        }
+    }
+
+    if (Module.numChannels == 1) {
+        status = App_run(&Module.channels[0]);
+        total = Module.channels[0].result;
+        goto leave;
+    }
+
+    if (pthread_barrier_init(&Module.barrier, NULL, Module.numChannels) != 0) {
+        printf("Error: failed to create the channel barrier\n");
+        status = -1;
+        goto leave;
+    }
+    barrier = TRUE;
+
+    Module.gate = 0;
+    for (i = 0; i < Module.numChannels; i++) {
+        ch = &Module.channels[i];
+        if (pthread_create(&ch->thread, NULL, App_channelThread, ch) != 0) {
+            printf("Error: failed to start the %s thread\n", ch->name);
+            status = -1;
+            break;
+        }
+        started++;
+    }
+
+    /* open the gate, or send the started threads home */
+    pthread_mutex_lock(&Module.lock);
+    Module.gate = (started == Module.numChannels) ? 1 : -1;
+    pthread_cond_broadcast(&Module.gateCond);
+    pthread_mutex_unlock(&Module.lock);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(Module.channels[i].thread, NULL);
+        if (Module.channels[i].status < 0) {
+            status = Module.channels[i].status;
+        }
+    }
+    if (status < 0) {
+        goto leave;
+    }
+
+    memset(&total, 0, sizeof(App_Result));
+    for (i = 0; i < Module.numChannels; i++) {
+        App_Result *r = &Module.channels[i].result;
+
+        total.numMsgs += r->numMsgs;
+        total.ms = (r->ms > total.ms) ? r->ms : total.ms;
+        total.msgPerSec += r->msgPerSec;
+        total.mbps += r->mbps;
+        total.rttP50Us = (r->rttP50Us > total.rttP50Us) ? r->rttP50Us :
+            total.rttP50Us;
+        total.rttP99Us = (r->rttP99Us > total.rttP99Us) ? r->rttP99Us :
+            total.rttP99Us;
+        total.rttP999Us = (r->rttP999Us > total.rttP999Us) ? r->rttP999Us :
+            total.rttP999Us;
+        total.rttMaxUs = (r->rttMaxUs > total.rttMaxUs) ? r->rttMaxUs :
+            total.rttMaxUs;
+        total.dspAllocUs = (r->dspAllocUs > total.dspAllocUs) ?
+            r->dspAllocUs : total.dspAllocUs;
+        total.dspPutUs = (r->dspPutUs > total.dspPutUs) ? r->dspPutUs :
+            total.dspPutUs;
+        total.replyAllocs += r->replyAllocs;
+        total.allocFails += r->allocFails;
+    }
+    App_printChannels(&total);
+
+leave:
+    if (barrier) {
+        pthread_barrier_destroy(&Module.barrier);
+    }
+    if (status >= 0 && result != NULL) {
+        *result = total;
+    }
     printf("<-- App_exec: %d\n", status);
     return(status);
 }
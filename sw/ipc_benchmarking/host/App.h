@@ -41,9 +41,51 @@
 extern "C" {
 #endif
 
-Int App_create(UInt16 remoteProcId);
+#include <stdio.h>
+
+/* ping-pong messages in flight, shared by all the channels; each one
+ * takes a block of the DSP's heap 0 while it is there, 160 of them, and
+ * the rest are left to the other channels' requests */
+#define App_MAX_OUTSTANDING 128
+
+/* BIOS priority of a DSP channel task not given one */
+#define App_PRI_DEFAULT 1
+
+typedef struct {
+    UInt32      msgSize;        /* bytes per reply, App_MSG_MIN..App_MSG_MAX */
+    UInt32      burst;          /* replies the DSP sends per request */
+    UInt32      numMsgs;        /* replies to receive, whole bursts */
+    UInt32      spinUs;         /* receive polling cap, 0 blocks */
+    UInt32      outstanding;    /* ping-pong messages in flight, 0 bursts */
+    Bool        pool;           /* DSP replies from a preallocated pool */
+    Bool        control;        /* channel 1 pings while the others burst */
+    Bool        urgent;         /* control messages at MessageQ_URGENTPRI */
+    UInt32      workUs;         /* DSP work before each burst reply, 0 none */
+    Int         priorities[App_MAX_CHANNELS];   /* DSP task, 0 default */
+    FILE *      dump;           /* raw round trips, may be NULL */
+} App_Params;
+
+/* what one run measured */
+typedef struct {
+    UInt32      numMsgs;
+    double      ms;
+    double      msgPerSec;
+    double      mbps;           /* whole messages, header included */
+    double      rttP50Us;       /* ping-pong only */
+    double      rttP99Us;
+    double      rttP999Us;
+    double      rttMaxUs;
+    double      dspAllocUs;     /* bursts only, DSP MessageQ_alloc per reply */
+    double      dspPutUs;       /* DSP MessageQ_put per reply */
+    UInt32      replyAllocs;    /* DSP allocs between the replies of a burst */
+    UInt32      allocFails;
+} App_Result;
+
+Void App_Params_init(App_Params *params);
+Int App_create(UInt16 remoteProcId, UInt32 numChannels);
 Int App_delete();
-Int App_exec();
+Int App_exec(const App_Params *params, App_Result *result);
+Int App_printHeaps(Void);
 
 
 #if defined (__cplusplus)
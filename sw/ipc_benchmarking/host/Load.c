@@ -0,0 +1,387 @@
+/*
+ *  ======== Load.c ========
+ *  Background CPU, memory bandwidth and cache load run alongside a
+ *  benchmark.
+ *
+ *  spin   : an arithmetic loop that never leaves the core, CPU time only
+ *  stream : memcpy from one half of a large buffer to the other, a chunk
+ *           at a time, which keeps the DDR controller busy
+ *  thrash : read-modify-write of cache lines picked in a scattered order
+ *           over a buffer a few times the L2, so every access misses and
+ *           the lines the benchmark had cached are evicted
+ *
+ *  Intensity is a duty cycle: every thread works for intensity % of each
+ *  Load_PERIOD_NS and sleeps for the rest, so 50 gives about half the
+ *  load of 100. The threads run SCHED_OTHER on any CPU whatever policy
+ *  and pinning the benchmark threads were given, they stand for the rest
+ *  of the system. Buffers are allocated and written before the threads
+ *  start, so their page faults stay out of the measurement.
+ */
+
+/* CPU_SET and pthread_attr_setaffinity_np are GNU extensions */
+#define _GNU_SOURCE
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* module header file */
+#include "Load.h"
+
+#define Load_PERIOD_NS      1000000         /* duty cycle period */
+#define Load_STREAM_CHUNK   (64 * 1024)     /* bytes per memcpy */
+#define Load_SPIN_CHUNK     1024            /* iterations between clocks */
+#define Load_THRASH_CHUNK   1024            /* lines between clocks */
+#define Load_LINE           64
+
+#define Load_KIND_SPIN      0
+#define Load_KIND_STREAM    1
+#define Load_KIND_THRASH    2
+
+typedef struct {
+    struct Load_Object *load;
+    pthread_t           thread;
+    UInt32              kind;           /* Load_KIND_xxx */
+    char *              buf;
+    size_t              size;
+    UInt64              work;           /* iterations, bytes or lines */
+} Load_Thread;
+
+typedef struct Load_Object {
+    Load_Params         params;
+    Load_Thread *       threads;
+    UInt32              numThreads;     /* allocated */
+    UInt32              started;
+    volatile Bool       stop;
+    UInt64              startNs;
+    UInt64              stopNs;
+} Load_Object;
+
+/* private functions */
+static void *Load_threadFxn(void *arg);
+
+
+/*
+ *  ======== Load_now ========
+ */
+static UInt64 Load_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Load_Params_init ========
+ */
+Void Load_Params_init(Load_Params *params)
+{
+    params->spinThreads = 0;
+    params->streamThreads = 0;
+    params->thrashThreads = 0;
+    params->streamKB = 32 * 1024;
+    params->thrashKB = 8 * 1024;
+    params->intensity = 100;
+}
+
+/*
+ *  ======== Load_parse ========
+ *  "spin:2,stream:1,thrash:1", a stream or thrash entry may add its
+ *  buffer size in KB, e.g. "stream:1:65536".
+ */
+Int Load_parse(Load_Params *params, String spec)
+{
+    char kind[16];
+    UInt32 threads, kb;
+    Int n, used;
+
+    while (*spec != '\0') {
+        kb = 0;
+        n = sscanf(spec, "%15[a-z]:%u%n:%u%n", kind, &threads, &used, &kb,
+            &used);
+        if (n < 2) {
+            printf("Error: bad load %s, expected e.g. spin:2,stream:1\n",
+                spec);
+            return -1;
+        }
+        if (strcmp(kind, "spin") == 0) {
+            params->spinThreads = threads;
+        }
+        else if (strcmp(kind, "stream") == 0) {
+            params->streamThreads = threads;
+            params->streamKB = (kb > 0) ? kb : params->streamKB;
+        }
+        else if (strcmp(kind, "thrash") == 0) {
+            params->thrashThreads = threads;
+            params->thrashKB = (kb > 0) ? kb : params->thrashKB;
+        }
+        else {
+            printf("Error: unknown load %s, spin, stream or thrash\n", kind);
+            return -1;
+        }
+        spec += used;
+        if (*spec == ',') {
+            spec++;
+        }
+        else if (*spec != '\0') {
+            printf("Error: bad load at %s\n", spec);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *  ======== Load_isIdle ========
+ */
+Bool Load_isIdle(const Load_Params *params)
+{
+    return (params->intensity == 0 || params->spinThreads +
+        params->streamThreads + params->thrashThreads == 0);
+}
+
+/*
+ *  ======== Load_create ========
+ *  Allocate the buffers and start the threads.
+ */
+Load_Handle Load_create(const Load_Params *params)
+{
+    Load_Object *obj;
+    Load_Thread *thread;
+    pthread_attr_t attr;
+    struct sched_param param;
+    cpu_set_t all;
+    UInt32 i, cpu;
+    size_t size;
+
+    obj = (Load_Object *)calloc(1, sizeof(Load_Object));
+    if (obj == NULL) {
+        printf("Load_create: failed to allocate object\n");
+        return NULL;
+    }
+    obj->params = *params;
+    if (obj->params.intensity > 100) {
+        obj->params.intensity = 100;
+    }
+
+    obj->numThreads = params->spinThreads + params->streamThreads +
+        params->thrashThreads;
+    obj->threads = (Load_Thread *)calloc(obj->numThreads,
+        sizeof(Load_Thread));
+    if (obj->threads == NULL && obj->numThreads > 0) {
+        printf("Load_create: failed to allocate %u threads\n",
+            obj->numThreads);
+        goto fail;
+    }
+
+    for (i = 0; i < obj->numThreads; i++) {
+        thread = &obj->threads[i];
+        thread->load = obj;
+        if (i < params->spinThreads) {
+            thread->kind = Load_KIND_SPIN;
+            continue;
+        }
+        if (i < params->spinThreads + params->streamThreads) {
+            thread->kind = Load_KIND_STREAM;
+            size = ((size_t)params->streamKB * 1024) & ~(size_t)
+                (2 * Load_STREAM_CHUNK - 1);
+            if (size == 0) {
+                size = 2 * Load_STREAM_CHUNK;
+            }
+        }
+        else {
+            thread->kind = Load_KIND_THRASH;
+            for (size = 2 * Load_LINE; size * 2 <= (size_t)params->thrashKB *
+                    1024; size *= 2) {
+            }
+        }
+        thread->buf = (char *)malloc(size);
+        if (thread->buf == NULL) {
+            printf("Load_create: failed to allocate %zu bytes\n", size);
+            goto fail;
+        }
+        memset(thread->buf, 0x5a, size);
+        thread->size = size;
+    }
+
+    /* the rest of the system: ordinary priority, any CPU */
+    CPU_ZERO(&all);
+    for (cpu = 0; cpu < (UInt32)sysconf(_SC_NPROCESSORS_CONF) &&
+            cpu < CPU_SETSIZE; cpu++) {
+        CPU_SET(cpu, &all);
+    }
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    param.sched_priority = 0;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setaffinity_np(&attr, sizeof(all), &all);
+
+    obj->startNs = Load_now();
+    for (i = 0; i < obj->numThreads; i++) {
+        if (pthread_create(&obj->threads[i].thread, &attr, Load_threadFxn,
+                &obj->threads[i]) != 0) {
+            printf("Load_create: failed to start load thread %u\n", i);
+            pthread_attr_destroy(&attr);
+            goto fail;
+        }
+        obj->started++;
+    }
+    pthread_attr_destroy(&attr);
+
+    return obj;
+
+fail:
+    Load_delete(&obj);
+    return NULL;
+}
+
+/*
+ *  ======== Load_stop ========
+ *  Stop and join the threads, their counters stay for the report.
+ */
+Void Load_stop(Load_Handle handle)
+{
+    UInt32 i;
+
+    if (handle->stopNs != 0) {
+        return;
+    }
+    handle->stop = TRUE;
+    for (i = 0; i < handle->started; i++) {
+        pthread_join(handle->threads[i].thread, NULL);
+    }
+    handle->started = 0;
+    handle->stopNs = Load_now();
+}
+
+/*
+ *  ======== Load_report ========
+ */
+Void Load_report(Load_Handle handle, Load_Summary *summary)
+{
+    const Load_Params *params = &handle->params;
+    UInt64 work[3] = { 0, 0, 0 };
+    UInt64 end;
+    UInt32 i;
+
+    for (i = 0; i < handle->numThreads; i++) {
+        work[handle->threads[i].kind] += handle->threads[i].work;
+    }
+    end = (handle->stopNs != 0) ? handle->stopNs : Load_now();
+    summary->seconds = (end - handle->startNs) / 1e9;
+    summary->spinMps = work[Load_KIND_SPIN] / 1e6 / summary->seconds;
+    summary->streamMBps = work[Load_KIND_STREAM] / 1e6 / summary->seconds;
+    summary->thrashMlps = work[Load_KIND_THRASH] / 1e6 / summary->seconds;
+
+    printf("Load: %u%% duty over %.3f s, SCHED_OTHER on any CPU\n",
+        params->intensity, summary->seconds);
+    if (params->spinThreads > 0) {
+        printf("    spin              : %u threads, %.3f M iterations/s\n",
+            params->spinThreads, summary->spinMps);
+    }
+    if (params->streamThreads > 0) {
+        printf("    stream            : %u threads over %u KB each, "
+            "%.3f MB/s copied\n", params->streamThreads, params->streamKB,
+            summary->streamMBps);
+    }
+    if (params->thrashThreads > 0) {
+        printf("    thrash            : %u threads over %u KB each, "
+            "%.3f M lines/s\n", params->thrashThreads,
+            (UInt32)(handle->threads[params->spinThreads +
+            params->streamThreads].size / 1024), summary->thrashMlps);
+    }
+}
+
+/*
+ *  ======== Load_delete ========
+ */
+Void Load_delete(Load_Handle *handle)
+{
+    Load_Object *obj = *handle;
+    UInt32 i;
+
+    if (obj == NULL) {
+        return;
+    }
+
+    Load_stop(obj);
+    for (i = 0; i < obj->numThreads; i++) {
+        free(obj->threads[i].buf);
+    }
+    free(obj->threads);
+    free(obj);
+    *handle = NULL;
+}
+
+/*
+ *  ======== Load_threadFxn ========
+ */
+static void *Load_threadFxn(void *arg)
+{
+    Load_Thread *thread = (Load_Thread *)arg;
+    Load_Object *obj = thread->load;
+    UInt64 busy = (UInt64)Load_PERIOD_NS * obj->params.intensity / 100;
+    volatile UInt32 sink = 0;
+    struct timespec rest;
+    UInt64 start, elapsed;
+    size_t half = thread->size / 2;
+    size_t off = 0;
+    UInt32 lines = thread->size / Load_LINE;
+    UInt32 x = (UInt32)(thread - obj->threads) + 1;
+    UInt32 i;
+
+    while (!obj->stop) {
+        start = Load_now();
+        do {
+            switch (thread->kind) {
+                case Load_KIND_SPIN:
+                    for (i = 0; i < Load_SPIN_CHUNK; i++) {
+                        x = x * 1103515245 + 12345;
+                    }
+                    sink = x;
+                    thread->work += Load_SPIN_CHUNK;
+                    break;
+
+                case Load_KIND_STREAM:
+                    memcpy(thread->buf + half + off, thread->buf + off,
+                        Load_STREAM_CHUNK);
+                    off += Load_STREAM_CHUNK;
+                    if (off >= half) {
+                        off = 0;
+                    }
+                    thread->work += Load_STREAM_CHUNK;
+                    break;
+
+                default:
+                    /* full period LCG over a power of two of lines */
+                    for (i = 0; i < Load_THRASH_CHUNK; i++) {
+                        x = (x * 1664525 + 1013904223) & (lines - 1);
+                        thread->buf[(size_t)x * Load_LINE]++;
+                    }
+                    thread->work += Load_THRASH_CHUNK;
+                    break;
+            }
+            elapsed = Load_now() - start;
+        } while (elapsed < busy && !obj->stop);
+
+        if (elapsed < Load_PERIOD_NS) {
+            rest.tv_sec = 0;
+            rest.tv_nsec = Load_PERIOD_NS - elapsed;
+            nanosleep(&rest, NULL);
+        }
+    }
+    (Void)sink;
+
+    return NULL;
+}
@@ -0,0 +1,43 @@
+/*
+ *  ======== Receive.h ========
+ *  MessageQ receive that polls the queue for a while before it blocks.
+ */
+
+#ifndef Receive__include
+#define Receive__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Receive_Object *Receive_Handle;
+
+typedef struct {
+    String              name;       /* printed with every line, may be NULL */
+    MessageQ_Handle     queue;
+    UInt32              maxSpinUs;  /* polling budget cap, 0 always blocks */
+} Receive_Params;
+
+/* counters since the last reset */
+typedef struct {
+    UInt64  messages;
+    UInt64  spinHits;       /* caught while polling, no wakeup needed */
+    UInt64  blocks;         /* fell back to a blocking MessageQ_get */
+    UInt64  spinNs;         /* all polling, hits and misses */
+    UInt64  missNs;         /* polling that ended in a block anyway */
+    double  budgetUs;       /* current polling budget */
+    double  gapUs;          /* average wait for a message */
+} Receive_Summary;
+
+Void Receive_Params_init(Receive_Params *params);
+Receive_Handle Receive_create(const Receive_Params *params);
+Void Receive_delete(Receive_Handle *handle);
+
+Int Receive_get(Receive_Handle handle, MessageQ_Msg *msg, UInt timeout);
+Void Receive_resetStats(Receive_Handle handle);
+Void Receive_report(Receive_Handle handle, Receive_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Receive__include */
@@ -0,0 +1,255 @@
+/*
+ *  ======== Rtt.c ========
+ *  Round trip times of ping-pong messages.
+ *
+ *  Every round trip is kept in nanoseconds, as measured, in the order it
+ *  completed; the report sorts a copy for the percentiles and buckets it
+ *  into a histogram, and the dump writes the raw times out so they can be
+ *  plotted against time or compared between runs.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* module header file */
+#include "Rtt.h"
+
+#define Rtt_BAR 40          /* histogram bar of the fullest bucket */
+
+/* histogram bucket upper bounds in us, the last bucket is open ended */
+static const double Rtt_buckets[] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+#define Rtt_NUM_BUCKETS (sizeof(Rtt_buckets) / sizeof(Rtt_buckets[0]) + 1)
+
+typedef struct Rtt_Object {
+    UInt64 *        samples;        /* ns */
+    UInt32          maxSamples;
+    UInt32          numSamples;
+    UInt64          dropped;
+} Rtt_Object;
+
+
+/*
+ *  ======== Rtt_Params_init ========
+ */
+Void Rtt_Params_init(Rtt_Params *params)
+{
+    params->maxSamples = 0x100000;
+}
+
+/*
+ *  ======== Rtt_create ========
+ */
+Rtt_Handle Rtt_create(const Rtt_Params *params)
+{
+    Rtt_Object *obj;
+
+    obj = (Rtt_Object *)calloc(1, sizeof(Rtt_Object));
+    if (obj == NULL) {
+        printf("Rtt_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    obj->maxSamples = params->maxSamples;
+    if (obj->maxSamples > 0) {
+        obj->samples = (UInt64 *)malloc(obj->maxSamples * sizeof(UInt64));
+        if (obj->samples == NULL) {
+            printf("Rtt_create: failed to allocate %u samples\n",
+                obj->maxSamples);
+            free(obj);
+            return NULL;
+        }
+    }
+
+    return obj;
+}
+
+/*
+ *  ======== Rtt_delete ========
+ */
+Void Rtt_delete(Rtt_Handle *handle)
+{
+    Rtt_Object *obj = *handle;
+
+    if (obj != NULL) {
+        free(obj->samples);
+        free(obj);
+        *handle = NULL;
+    }
+}
+
+/*
+ *  ======== Rtt_now ========
+ *  Time in nanoseconds, not slewed by NTP.
+ */
+UInt64 Rtt_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Rtt_record ========
+ */
+Void Rtt_record(Rtt_Handle handle, UInt64 ns)
+{
+    if (handle->numSamples < handle->maxSamples) {
+        handle->samples[handle->numSamples++] = ns;
+    }
+    else {
+        handle->dropped++;
+    }
+}
+
+/*
+ *  ======== Rtt_compare ========
+ */
+static int Rtt_compare(const void *a, const void *b)
+{
+    UInt64 x = *(const UInt64 *)a;
+    UInt64 y = *(const UInt64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ *  ======== Rtt_percentile ========
+ *  Nearest rank percentile of n sorted values, in us.
+ */
+static double Rtt_percentile(const UInt64 *sorted, UInt32 n, double pct)
+{
+    UInt32 rank;
+
+    if (n == 0) {
+        return 0.0;
+    }
+    rank = (UInt32)(pct / 100.0 * n + 0.999999);
+    rank = rank < 1 ? 1 : rank;
+    rank = rank > n ? n : rank;
+
+    return sorted[rank - 1] / 1e3;
+}
+
+/*
+ *  ======== Rtt_histogram ========
+ *  Bucket the sorted round trips, from the first bucket in use to the
+ *  last.
+ */
+static Void Rtt_histogram(const UInt64 *sorted, UInt32 n)
+{
+    static const char bar[] = "########################################";
+    UInt32 counts[Rtt_NUM_BUCKETS];
+    UInt32 first = Rtt_NUM_BUCKETS, last = 0, most = 0;
+    UInt32 i, b = 0;
+    char label[32];
+    int len;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < n; i++) {
+        while (b < Rtt_NUM_BUCKETS - 1 && sorted[i] / 1e3 >= Rtt_buckets[b]) {
+            b++;
+        }
+        counts[b]++;
+    }
+    for (b = 0; b < Rtt_NUM_BUCKETS; b++) {
+        if (counts[b] > 0) {
+            first = b < first ? b : first;
+            last = b;
+            most = counts[b] > most ? counts[b] : most;
+        }
+    }
+
+    printf("    histogram         :\n");
+    for (b = first; b <= last && b < Rtt_NUM_BUCKETS; b++) {
+        if (b == 0) {
+            snprintf(label, sizeof(label), "< %g us", Rtt_buckets[0]);
+        }
+        else if (b == Rtt_NUM_BUCKETS - 1) {
+            snprintf(label, sizeof(label), ">= %g us", Rtt_buckets[b - 1]);
+        }
+        else {
+            snprintf(label, sizeof(label), "%g - %g us",
+                Rtt_buckets[b - 1], Rtt_buckets[b]);
+        }
+        len = (int)((UInt64)counts[b] * Rtt_BAR / most);
+        printf("      %-16s: %8u %5.1f%%%s%.*s\n", label, counts[b],
+            counts[b] * 100.0 / n, len > 0 ? " " : "", len, bar);
+    }
+}
+
+/*
+ *  ======== Rtt_report ========
+ */
+Void Rtt_report(Rtt_Handle handle, Rtt_Summary *summary)
+{
+    UInt32 n = handle->numSamples;
+    UInt64 *sorted = NULL;
+    UInt64 total = 0;
+    UInt32 i;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->samples = n;
+    summary->dropped = handle->dropped;
+
+    if (n == 0) {
+        printf("Round trip: no samples\n");
+        return;
+    }
+
+    sorted = (UInt64 *)malloc(n * sizeof(UInt64));
+    if (sorted == NULL) {
+        printf("Round trip: failed to allocate the report\n");
+        return;
+    }
+    memcpy(sorted, handle->samples, n * sizeof(UInt64));
+    qsort(sorted, n, sizeof(UInt64), Rtt_compare);
+    for (i = 0; i < n; i++) {
+        total += sorted[i];
+    }
+
+    summary->minUs = sorted[0] / 1e3;
+    summary->meanUs = total / 1e3 / n;
+    summary->p50Us = Rtt_percentile(sorted, n, 50.0);
+    summary->p90Us = Rtt_percentile(sorted, n, 90.0);
+    summary->p99Us = Rtt_percentile(sorted, n, 99.0);
+    summary->p999Us = Rtt_percentile(sorted, n, 99.9);
+    summary->maxUs = sorted[n - 1] / 1e3;
+
+    printf("Round trip:\n");
+    printf("    samples           : %u", n);
+    if (handle->dropped > 0) {
+        printf(", %llu more not kept", (unsigned long long)handle->dropped);
+    }
+    printf("\n");
+    printf("    round trip (us)   : min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, "
+        "p99.9 %.3f, max %.3f, mean %.3f\n", summary->minUs, summary->p50Us,
+        summary->p90Us, summary->p99Us, summary->p999Us, summary->maxUs,
+        summary->meanUs);
+    Rtt_histogram(sorted, n);
+
+    free(sorted);
+}
+
+/*
+ *  ======== Rtt_dump ========
+ *  One csv line per round trip, in the order they completed.
+ */
+Void Rtt_dump(Rtt_Handle handle, FILE *file, UInt32 msgSize,
+        UInt32 outstanding)
+{
+    UInt32 i;
+
+    for (i = 0; i < handle->numSamples; i++) {
+        fprintf(file, "%u, %u, %u, %llu\n", msgSize, outstanding, i,
+            (unsigned long long)handle->samples[i]);
+    }
+}
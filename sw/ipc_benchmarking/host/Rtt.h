@@ -0,0 +1,48 @@
+/*
+ *  ======== Rtt.h ========
+ *  Round trip times of ping-pong messages, kept raw for percentiles, a
+ *  histogram and an optional dump.
+ */
+
+#ifndef Rtt__include
+#define Rtt__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+typedef struct Rtt_Object *Rtt_Handle;
+
+typedef struct {
+    UInt32  maxSamples;     /* round trips kept, later ones are counted */
+} Rtt_Params;
+
+/* result of all recorded round trips */
+typedef struct {
+    UInt64  samples;
+    UInt64  dropped;        /* past maxSamples */
+    double  minUs;
+    double  meanUs;
+    double  p50Us;
+    double  p90Us;
+    double  p99Us;
+    double  p999Us;
+    double  maxUs;
+} Rtt_Summary;
+
+Void Rtt_Params_init(Rtt_Params *params);
+Rtt_Handle Rtt_create(const Rtt_Params *params);
+Void Rtt_delete(Rtt_Handle *handle);
+
+UInt64 Rtt_now(Void);
+Void Rtt_record(Rtt_Handle handle, UInt64 ns);
+Void Rtt_report(Rtt_Handle handle, Rtt_Summary *summary);
+Void Rtt_dump(Rtt_Handle handle, FILE *file, UInt32 msgSize,
+        UInt32 outstanding);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Rtt__include */
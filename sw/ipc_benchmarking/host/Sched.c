@@ -0,0 +1,396 @@
+/*
+ *  ======== Sched.c ========
+ *  Real-time scheduling, CPU affinity and memory locking for the host
+ *  benchmark threads.
+ *
+ *  Sched_setup applies the policy to the calling thread, normally main
+ *  before Ipc_start, so threads created later, the IPC transport's
+ *  included, inherit the SCHED_FIFO priority and the CPU set. Each
+ *  benchmark thread then calls Sched_thread when it starts, which pins
+ *  it to the next CPU of the list, round robin, and records where it
+ *  ended up for the report.
+ *
+ *  Locking calls mlockall(MCL_CURRENT | MCL_FUTURE), so anonymous memory
+ *  is populated as it is mapped, and touches a stack's worth of pages in
+ *  every thread along with a first malloc, which sets up the thread's
+ *  heap arena while nothing is being timed yet. Sched_prefault locks a
+ *  buffer the same way, which maps ordinary memory writable, but device
+ *  mappings such as CMEM are left alone by mlock, so it also reads one
+ *  word per page to have their page tables filled before the timed
+ *  loops. It only reads, a write would leave dirty lines that could
+ *  later be evicted over the DSP's data.
+ */
+
+/* CPU_SET and pthread_setaffinity_np are GNU extensions */
+#define _GNU_SOURCE
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* module header file */
+#include "Sched.h"
+
+#define Sched_MAX_CPUS      32
+#define Sched_MAX_THREADS   32
+#define Sched_STACK         (64 * 1024)     /* pre-faulted per thread */
+
+/* where one thread ended up */
+typedef struct {
+    char        name[24];
+    Int         cpu;            /* -1 not pinned */
+    Int         priority;       /* 0 SCHED_OTHER */
+} Sched_Thread;
+
+/* module structure */
+typedef struct {
+    Int             priority;
+    Int             cpus[Sched_MAX_CPUS];
+    UInt32          numCpus;
+    UInt32          next;       /* next CPU to hand out */
+    Bool            locked;
+    UInt64          prefaulted; /* bytes */
+    Sched_Thread    threads[Sched_MAX_THREADS];
+    UInt32          numThreads;
+    pthread_t       main;       /* keeps the process's name */
+    pthread_mutex_t lock;
+} Sched_Module;
+
+/* private data */
+static Sched_Module Module = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+/*
+ *  ======== Sched_parseCpus ========
+ *  "1", "0,1" or "0-1" into the CPU list, in the order given.
+ */
+static Int Sched_parseCpus(String list)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_CONF);
+    char *end;
+    long first, last, cpu;
+
+    Module.numCpus = 0;
+    while (*list != '\0') {
+        first = strtol(list, &end, 10);
+        if (end == list) {
+            break;
+        }
+        last = first;
+        if (*end == '-') {
+            list = end + 1;
+            last = strtol(list, &end, 10);
+            if (end == list) {
+                break;
+            }
+        }
+        for (cpu = first; cpu <= last; cpu++) {
+            if (cpu < 0 || cpu >= ncpu || Module.numCpus == Sched_MAX_CPUS) {
+                printf("Error: CPU %ld is not one of the %ld CPUs\n", cpu,
+                    ncpu);
+                return -1;
+            }
+            Module.cpus[Module.numCpus++] = (Int)cpu;
+        }
+        list = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            break;
+        }
+    }
+
+    if (*list != '\0' || Module.numCpus == 0) {
+        printf("Error: bad CPU list, expected e.g. 1, 0,1 or 0-1\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ *  ======== Sched_touchStack ========
+ *  Fault in a stack's worth of pages below the caller.
+ */
+static void __attribute__((noinline)) Sched_touchStack(Void)
+{
+    volatile char stack[Sched_STACK];
+
+    memset((char *)stack, 0, sizeof(stack));
+}
+
+/*
+ *  ======== Sched_Params_init ========
+ */
+Void Sched_Params_init(Sched_Params *params)
+{
+    params->priority = 0;
+    params->cpus = NULL;
+    params->lockMemory = FALSE;
+}
+
+/*
+ *  ======== Sched_setup ========
+ *  Check and store the policy, lock memory and apply it to the caller.
+ */
+Int Sched_setup(const Sched_Params *params)
+{
+    Int min = sched_get_priority_min(SCHED_FIFO);
+    Int max = sched_get_priority_max(SCHED_FIFO);
+
+    if (params->priority < 0 || params->priority > max ||
+            (params->priority > 0 && params->priority < min)) {
+        printf("Error: SCHED_FIFO priority %d is not in %d..%d\n",
+            params->priority, min, max);
+        return -1;
+    }
+    Module.priority = params->priority;
+
+    Module.numCpus = 0;
+    if (params->cpus != NULL && Sched_parseCpus(params->cpus) < 0) {
+        return -1;
+    }
+
+    if (params->lockMemory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            printf("Error: mlockall failed: %s\n", strerror(errno));
+            return -1;
+        }
+        Module.locked = TRUE;
+    }
+
+    Module.main = pthread_self();
+    return Sched_thread("main");
+}
+
+/*
+ *  ======== Sched_thread ========
+ *  Apply the policy to the calling thread, named for the report and
+ *  for the system.
+ */
+Int Sched_thread(String name)
+{
+    Sched_Thread *thread = NULL;
+    struct sched_param param;
+    cpu_set_t set;
+    char comm[16];
+    Int cpu = -1;
+    Int status = 0;
+    UInt32 i;
+    Int err;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.numCpus > 0) {
+        cpu = Module.cpus[Module.next++ % Module.numCpus];
+    }
+
+    /* threads started again for every run keep their one line */
+    for (i = 0; i < Module.numThreads; i++) {
+        if (strncmp(Module.threads[i].name, name,
+                sizeof(Module.threads[i].name) - 1) == 0) {
+            thread = &Module.threads[i];
+            break;
+        }
+    }
+    if (thread == NULL && Module.numThreads < Sched_MAX_THREADS) {
+        thread = &Module.threads[Module.numThreads++];
+        snprintf(thread->name, sizeof(thread->name), "%s", name);
+    }
+    if (thread != NULL) {
+        thread->cpu = cpu;
+        thread->priority = Module.priority;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    /* the kernel keeps 15 characters, enough to tell them apart in a
+     * trace or in top; renaming main would rename the process */
+    if (!pthread_equal(pthread_self(), Module.main)) {
+        snprintf(comm, sizeof(comm), "%s", name);
+        (void)pthread_setname_np(pthread_self(), comm);
+    }
+
+    if (cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            printf("Error: %s: pinning to CPU %d failed: %s\n", name, cpu,
+                strerror(err));
+            status = -1;
+        }
+    }
+
+    if (Module.priority > 0) {
+        param.sched_priority = Module.priority;
+        err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            printf("Error: %s: SCHED_FIFO priority %d failed: %s\n", name,
+                Module.priority, strerror(err));
+            status = -1;
+        }
+    }
+
+    if (Module.locked) {
+        Sched_touchStack();
+        free(malloc(1));
+    }
+
+    return status;
+}
+
+/*
+ *  ======== Sched_prefault ========
+ *  Lock the buffer and read a word of every page so the mapping is in
+ *  place, only when memory locking was asked for.
+ */
+Void Sched_prefault(void *base, size_t size)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    volatile const char *p = (volatile const char *)base;
+    size_t off;
+
+    if (!Module.locked || base == NULL) {
+        return;
+    }
+
+    /* a device mapping refuses or ignores this, the reads still work */
+    (void)mlock(base, size);
+
+    for (off = 0; off < size; off += page) {
+        (void)p[off];
+    }
+
+    pthread_mutex_lock(&Module.lock);
+    Module.prefaulted += size;
+    pthread_mutex_unlock(&Module.lock);
+}
+
+/*
+ *  ======== Sched_usage ========
+ */
+Void Sched_usage(Sched_Usage *usage)
+{
+    struct rusage ru;
+
+    memset(usage, 0, sizeof(*usage));
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage->minorFaults = ru.ru_minflt;
+        usage->majorFaults = ru.ru_majflt;
+        usage->voluntary = ru.ru_nvcsw;
+        usage->involuntary = ru.ru_nivcsw;
+    }
+}
+
+/*
+ *  ======== Sched_usageSince ========
+ */
+Void Sched_usageSince(const Sched_Usage *start, Sched_Usage *delta)
+{
+    Sched_Usage now;
+
+    Sched_usage(&now);
+    delta->minorFaults = now.minorFaults - start->minorFaults;
+    delta->majorFaults = now.majorFaults - start->majorFaults;
+    delta->voluntary = now.voluntary - start->voluntary;
+    delta->involuntary = now.involuntary - start->involuntary;
+}
+
+/*
+ *  ======== Sched_cpuMask ========
+ *  The CPU list as a bit mask, 0 when not pinned.
+ */
+UInt32 Sched_cpuMask(Void)
+{
+    UInt32 mask = 0;
+    UInt32 i;
+
+    for (i = 0; i < Module.numCpus; i++) {
+        mask |= 1u << Module.cpus[i];
+    }
+    return mask;
+}
+
+/*
+ *  ======== Sched_priority ========
+ */
+Int Sched_priority(Void)
+{
+    return Module.priority;
+}
+
+/*
+ *  ======== Sched_locked ========
+ */
+Bool Sched_locked(Void)
+{
+    return Module.locked;
+}
+
+/*
+ *  ======== Sched_report ========
+ *  The policy, and where every thread that asked for it was placed.
+ *  The pre-faulted count starts again after each report.
+ */
+Void Sched_report(Void)
+{
+    Sched_Thread *thread;
+    UInt32 i;
+
+    pthread_mutex_lock(&Module.lock);
+    printf("Host scheduling: ");
+    if (Module.priority > 0) {
+        printf("SCHED_FIFO priority %d", Module.priority);
+    }
+    else {
+        printf("SCHED_OTHER");
+    }
+    if (Module.numCpus > 0) {
+        printf(", CPUs");
+        for (i = 0; i < Module.numCpus; i++) {
+            printf("%s%d", i == 0 ? " " : ",", Module.cpus[i]);
+        }
+    }
+    else {
+        printf(", any CPU");
+    }
+    if (Module.locked && Module.prefaulted > 0) {
+        printf(", memory locked, %llu KB pre-faulted\n",
+            (unsigned long long)(Module.prefaulted / 1024));
+        Module.prefaulted = 0;
+    }
+    else if (Module.locked) {
+        printf(", memory locked\n");
+    }
+    else {
+        printf(", memory not locked\n");
+    }
+
+    if (Module.priority > 0 || Module.numCpus > 0) {
+        for (i = 0; i < Module.numThreads; i++) {
+            thread = &Module.threads[i];
+            if (thread->cpu >= 0) {
+                printf("    %-18s: CPU %d", thread->name, thread->cpu);
+            }
+            else {
+                printf("    %-18s: any CPU", thread->name);
+            }
+            if (thread->priority > 0) {
+                printf(", SCHED_FIFO %d\n", thread->priority);
+            }
+            else {
+                printf(", SCHED_OTHER\n");
+            }
+        }
+    }
+    pthread_mutex_unlock(&Module.lock);
+}
@@ -38,6 +38,8 @@
 /* cstdlib header files */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
 /* package header files */
 #include <ti/ipc/Std.h>
@@ -45,13 +47,26 @@
 #include <ti/ipc/transports/TransportRpmsg.h>
 
 #include <ti/ipc/MultiProc.h>
+#include <ti/ipc/MessageQ.h>
 
 /* local header files */
+#include "../shared/AppCommon.h"
 #include "App.h"
+#include "Sched.h"
+#include "Load.h"
 
 /* private functions */
 static Int Main_main(Void);
 static Int Main_parseArgs(Int argc, Char *argv[]);
+static Int Main_parseList(String arg, UInt32 *list, UInt32 *num);
+static Void Main_printSweep(Void);
+static Void Main_printPingCurve(Void);
+static Int Main_execPoint(UInt32 level, App_Result *result,
+        Load_Summary *summary);
+static Void Main_printLoadCurve(Void);
+
+/* points of a sweep on each axis */
+#define Main_MAX_POINTS 8
 
 
 #define Main_USAGE "\
@@ -64,15 +79,90 @@ Arguments:\n\
 Options:\n\
     h   : print this help message\n\
     l   : list the available remote names\n\
+    p [bytes] : message size, header included, from the header and\n\
+              command words up to the whole App_Msg, default the whole\n\
+              App_Msg. A list, e.g. 64,128,256, runs each\n\
+    b [burst] : replies the DSP sends per request, default 64, or a list\n\
+    n [count] : replies received per run, rounded up to whole bursts,\n\
+              default 1280000, 128000 per point of a sweep\n\
+    w       : sweep message sizes and bursts not given with -p or -b and\n\
+              print the messages/s and MB/s matrix\n\
+    q [n]   : ping-pong instead of bursts, n messages in flight, each sent\n\
+              again as soon as it returns and every round trip timed. A\n\
+              list, e.g. 1,2,4,8, maps latency against throughput, at\n\
+              most 128 in flight\n\
+    d [file] : write every ping-pong round trip (ns) to file as csv\n\
+    c [n]   : n queue pairs to the core, 1 to 4, each served by its own\n\
+              DSP task and host thread, default 1\n\
+    r [pri] : BIOS priority of each channel's DSP task, 1 to 15, e.g.\n\
+              8,1 for channel 1 above channel 2, default 1\n\
+    x       : control and data: channel 1 ping-pongs one message while\n\
+              the other channels run the bursts, needs -c 2 or more.\n\
+              The control messages go at MessageQ_URGENTPRI, which puts\n\
+              channel 1's DSP task above every other\n\
+    N       : with -x, send the control messages at normal priority\n\
+    W [us]  : bursts become long jobs, us of DSP work before each reply\n\
+    z       : the DSP answers bursts from a pool allocated before the\n\
+              request, up to 128 messages, instead of allocating every\n\
+              reply, so allocation and transport can be told apart\n\
+    s [us]  : poll the host queue for up to us microseconds, adapted to\n\
+              the arrival rate, before blocking, default 0\n\
+    P [priority] : run SCHED_FIFO at priority, 1 to 99, needs root or\n\
+              CAP_SYS_NICE, default 0 (SCHED_OTHER). Polling (-s) at\n\
+              FIFO priority starves everything below it on its CPU\n\
+    C [cpus] : pin to the CPUs of the list, e.g. 1 or 0,1 or 0-1\n\
+    M       : lock the process memory (mlockall) and pre-fault the stack\n\
+    L [load] : run background load threads with every run, spin:N CPU\n\
+              loops, stream:N[:KB] memcpy through a large buffer (default\n\
+              32768 KB), thrash:N[:KB] scattered cache line updates\n\
+              (default 8192 KB), e.g. spin:1,stream:2\n\
+    I [levels] : load intensities to run, % of the time every load thread\n\
+              works, e.g. 0,25,50,100, default 100. Needs one -p size and\n\
+              one -b burst or -q depth, and prints how messages/s, MB/s\n\
+              and, for ping-pong, the round trip p99 degrade against the\n\
+              first level\n\
 \n\
 Examples:\n\
     app_host DSP\n\
+    app_host -p 128 -b 16 DSP1\n\
+    app_host -w DSP1\n\
+    app_host -w -b 64 -n 640000 DSP1\n\
+    app_host -w -z DSP1\n\
+    app_host -q 1 -n 100000 DSP1\n\
+    app_host -q 1,2,4,8,16 -p 64 -n 100000 -d rtt.csv DSP1\n\
+    app_host -c 4 -b 16 DSP1\n\
+    app_host -c 2 -x -r 8,1 DSP1\n\
+    app_host -c 3 -x -W 200 -b 16 -n 20000 DSP1\n\
+    app_host -s 50 DSP1\n\
+    app_host -P 80 -C 1 -M DSP1\n\
+    app_host -L stream:2,thrash:1 -I 0,50,100 -p 256 -b 16 DSP1\n\
+    app_host -L spin:1,stream:1 -I 0,100 -q 1 -n 100000 DSP1\n\
     app_host -l\n\
     app_host -h\n\
 \n"
 
 /* private data */
 static String   Main_remoteProcName = NULL;
+static App_Params Main_params;
+static Bool     Main_sweep = FALSE;
+static Bool     Main_countSet = FALSE;
+static UInt32   Main_sizes[Main_MAX_POINTS];
+static UInt32   Main_numSizes = 0;
+static UInt32   Main_bursts[Main_MAX_POINTS];
+static UInt32   Main_numBursts = 0;
+static UInt32   Main_outs[Main_MAX_POINTS];
+static UInt32   Main_numOuts = 0;
+static String   Main_dumpName = NULL;
+static UInt32   Main_numChannels = 1;
+static UInt32   Main_pris[Main_MAX_POINTS];
+static UInt32   Main_numPris = 0;
+static App_Result Main_results[Main_MAX_POINTS][Main_MAX_POINTS];
+static Sched_Params Main_sched;
+static Load_Params Main_load;
+static UInt32   Main_levels[Main_MAX_POINTS] = { 100 };
+static UInt32   Main_numLevels = 1;
+static App_Result Main_loadResults[Main_MAX_POINTS];
+static Load_Summary Main_loads[Main_MAX_POINTS];
 
 
 /*
@@ -94,6 +184,13 @@ Int main(Int argc, Char* argv[])
         goto leave;
     }
 
+    /* before Ipc_start so the transport's threads inherit the policy */
+    status = Sched_setup(&Main_sched);
+
+    if (status < 0) {
+        goto leave;
+    }
+
     /* Ipc initialization */
     status = Ipc_start();
 
@@ -124,20 +221,73 @@ Int Main_main(Void)
 {
     UInt16      remoteProcId;
     Int         status = 0;
+    UInt32      i, j;
 
     printf("--> Main_main:\n");
 
     remoteProcId = MultiProc_getId(Main_remoteProcName);
 
     /* application create phase */
-    status = App_create(remoteProcId);
+    status = App_create(remoteProcId, Main_numChannels);
 
     if (status < 0) {
         goto leave;
     }
 
-    /* application execute phase */
-    status = App_exec();
+    if (Main_dumpName != NULL) {
+        Main_params.dump = fopen(Main_dumpName, "w");
+        if (Main_params.dump == NULL) {
+            printf("Error: cannot write %s\n", Main_dumpName);
+            status = -1;
+            goto leave;
+        }
+        fprintf(Main_params.dump, "Message Size (B), Outstanding, Sample, "
+            "Round Trip (ns)\n");
+    }
+
+    /* application execute phase, every size with every burst or every
+     * number of messages in flight, or one point at every load level */
+    if (Main_numLevels > 1) {
+        Main_params.msgSize = Main_sizes[0];
+        Main_params.burst = Main_bursts[0];
+        Main_params.outstanding = (Main_numOuts > 0) ? Main_outs[0] : 0;
+        for (i = 0; i < Main_numLevels; i++) {
+            status = Main_execPoint(Main_levels[i], &Main_loadResults[i],
+                &Main_loads[i]);
+
+            if (status < 0) {
+                goto leave;
+            }
+        }
+    }
+    else {
+        for (i = 0; i < Main_numSizes; i++) {
+            for (j = 0; j < Main_numBursts; j++) {
+                Main_params.msgSize = Main_sizes[i];
+                Main_params.burst = Main_bursts[j];
+                Main_params.outstanding = (Main_numOuts > 0) ?
+                    Main_outs[j] : 0;
+                status = Main_execPoint(Main_levels[0], &Main_results[i][j],
+                    &Main_loads[0]);
+
+                if (status < 0) {
+                    goto leave;
+                }
+            }
+        }
+    }
+    if (Main_numLevels > 1) {
+        if (!Load_isIdle(&Main_load)) {
+            Main_printLoadCurve();
+        }
+    }
+    else if (Main_numOuts > 0) {
+        Main_printPingCurve();
+    }
+    else if (Main_numSizes * Main_numBursts > 1) {
+        Main_printSweep();
+    }
+    status = App_printHeaps();
 
     if (status < 0) {
         goto leave;
@@ -151,6 +301,10 @@ Int Main_main(Void)
     }
 
 leave:
+    if (Main_params.dump != NULL) {
+        fclose(Main_params.dump);
+        printf("Round trips written to %s\n", Main_dumpName);
+    }
     printf("<-- Main_main:\n");
 
     status = (status >= 0 ? 0 : status);
@@ -158,6 +312,172 @@ leave:
 }
 
 
+/*
+ *  ======== Main_printSweep ========
+ *  Messages/s and MB/s for every size and burst, as tables and csv.
+ */
+static Void Main_printSweep(Void)
+{
+    App_Result *r;
+    UInt32 i, j;
+
+    printf("Messages/s, message size (B) down, burst across:\n");
+    printf("    size  ");
+    for (j = 0; j < Main_numBursts; j++) {
+        printf(" %12u", Main_bursts[j]);
+    }
+    printf("\n");
+    for (i = 0; i < Main_numSizes; i++) {
+        printf("    %-5u ", Main_sizes[i]);
+        for (j = 0; j < Main_numBursts; j++) {
+            printf(" %12.1f", Main_results[i][j].msgPerSec);
+        }
+        printf("\n");
+    }
+
+    printf("MB/s, message size (B) down, burst across:\n");
+    printf("    size  ");
+    for (j = 0; j < Main_numBursts; j++) {
+        printf(" %12u", Main_bursts[j]);
+    }
+    printf("\n");
+    for (i = 0; i < Main_numSizes; i++) {
+        printf("    %-5u ", Main_sizes[i]);
+        for (j = 0; j < Main_numBursts; j++) {
+            printf(" %12.3f", Main_results[i][j].mbps);
+        }
+        printf("\n");
+    }
+
+    printf("csvheader, Message Size (B), Payload (B), Burst, Reply Pool, Messages, Time (ms), Messages/s, MB/s, Payload MB/s, DSP Alloc (us/msg), DSP Put (us/msg), DSP Reply Allocs, DSP Alloc Failures\n");
+    for (i = 0; i < Main_numSizes; i++) {
+        for (j = 0; j < Main_numBursts; j++) {
+            r = &Main_results[i][j];
+            printf("csv, %u, %u, %u, %s, %u, %f, %f, %f, %f, %f, %f, %u, %u\n", Main_sizes[i], Main_sizes[i] - App_MSG_MIN, Main_bursts[j], Main_params.pool ? "yes" : "no", r->numMsgs, r->ms, r->msgPerSec, r->mbps, r->mbps * (Main_sizes[i] - App_MSG_MIN) / Main_sizes[i], r->dspAllocUs, r->dspPutUs, r->replyAllocs, r->allocFails);
+        }
+    }
+}
+
+/*
+ *  ======== Main_printPingCurve ========
+ *  Round trips per second against latency for every number of messages
+ *  in flight.
+ */
+static Void Main_printPingCurve(Void)
+{
+    App_Result *r;
+    UInt32 i, j;
+
+    printf("Ping-pong, latency against messages in flight:\n");
+    printf("    size  in flight  round trips/s   p50 (us)     p99 (us)     "
+        "p99.9 (us)   max (us)\n");
+    for (i = 0; i < Main_numSizes; i++) {
+        for (j = 0; j < Main_numOuts; j++) {
+            r = &Main_results[i][j];
+            printf("    %-5u %-10u %-15.1f %-12.3f %-12.3f %-12.3f %.3f\n",
+                Main_sizes[i], Main_outs[j], r->msgPerSec, r->rttP50Us,
+                r->rttP99Us, r->rttP999Us, r->rttMaxUs);
+        }
+    }
+
+    printf("csvheader, Message Size (B), Outstanding, Round Trips, Time (ms), Round Trips/s, MB/s, RTT p50 (us), RTT p99 (us), RTT p99.9 (us), RTT max (us)\n");
+    for (i = 0; i < Main_numSizes; i++) {
+        for (j = 0; j < Main_numOuts; j++) {
+            r = &Main_results[i][j];
+            printf("csv, %u, %u, %u, %f, %f, %f, %f, %f, %f, %f\n", Main_sizes[i], Main_outs[j], r->numMsgs, r->ms, r->msgPerSec, r->mbps, r->rttP50Us, r->rttP99Us, r->rttP999Us, r->rttMaxUs);
+        }
+    }
+}
+
+/*
+ *  ======== Main_execPoint ========
+ *  One run at the load level, the load threads going for the whole run.
+ */
+static Int Main_execPoint(UInt32 level, App_Result *result,
+        Load_Summary *summary)
+{
+    Load_Handle load = NULL;
+    Int status;
+
+    memset(summary, 0, sizeof(Load_Summary));
+    Main_load.intensity = level;
+    if (!Load_isIdle(&Main_load)) {
+        load = Load_create(&Main_load);
+        if (load == NULL) {
+            return -1;
+        }
+    }
+
+    status = App_exec(&Main_params, result);
+
+    if (load != NULL) {
+        Load_stop(load);
+        Load_report(load, summary);
+        Load_delete(&load);
+    }
+
+    return status;
+}
+
+/*
+ *  ======== Main_printLoadCurve ========
+ *  Messages/s, MB/s and, for ping-pong, the round trip p99 at every load
+ *  level against the first one.
+ */
+static Void Main_printLoadCurve(Void)
+{
+    const App_Result *base = &Main_loadResults[0];
+    const App_Result *r;
+    UInt32 i;
+
+    printf("Load degradation (%s, %u B, against %u%% load):\n",
+        Main_numOuts > 0 ? "ping-pong" : "bursts", Main_sizes[0],
+        Main_levels[0]);
+    printf("    load %%   load MB/s   msg/s          MB/s         vs first  "
+        " p99 (us)     vs first\n");
+    for (i = 0; i < Main_numLevels; i++) {
+        r = &Main_loadResults[i];
+        printf("    %-8u %-11.1f %-14.1f %-12.3f %6.1f%%    ", Main_levels[i],
+            Main_loads[i].streamMBps, r->msgPerSec, r->mbps,
+            base->msgPerSec > 0 ? r->msgPerSec * 100.0 / base->msgPerSec :
+            0.0);
+        if (Main_numOuts > 0) {
+            printf("%-12.3f %5.2fx\n", r->rttP99Us, base->rttP99Us > 0 ?
+                r->rttP99Us / base->rttP99Us : 0.0);
+        }
+        else {
+            printf("-            -\n");
+        }
+    }
+
+    printf("csvloadheader, Load (%%), Spin Threads, Stream Threads, Thrash Threads, Load Stream (MB/s), Load Thrash (M lines/s), Message Size (B), Burst, Outstanding, Messages/s, MB/s, RTT p99 (us), Messages/s vs First (%%), RTT p99 vs First (x)\n");
+    for (i = 0; i < Main_numLevels; i++) {
+        r = &Main_loadResults[i];
+        printf("csvload, %u, %u, %u, %u, %f, %f, %u, %u, %u, %f, %f, %f, %f, %f\n", Main_levels[i], Main_load.spinThreads, Main_load.streamThreads, Main_load.thrashThreads, Main_loads[i].streamMBps, Main_loads[i].thrashMlps, Main_sizes[0], Main_bursts[0], Main_numOuts > 0 ? Main_outs[0] : 0, r->msgPerSec, r->mbps, r->rttP99Us, base->msgPerSec > 0 ? r->msgPerSec * 100.0 / base->msgPerSec : 0.0, base->rttP99Us > 0 ? r->rttP99Us / base->rttP99Us : 0.0);
+    }
+}
+
+/*
+ *  ======== Main_parseList ========
+ *  "64" or "64,128,256" into list, at most Main_MAX_POINTS.
+ */
+static Int Main_parseList(String arg, UInt32 *list, UInt32 *num)
+{
+    char *end;
+
+    *num = 0;
+    while (*arg != '\0' && *num < Main_MAX_POINTS) {
+        list[(*num)++] = strtoul(arg, &end, 0);
+        if (end == arg || (*end != ',' && *end != '\0')) {
+            break;
+        }
+        arg = (*end == ',') ? end + 1 : end;
+    }
+
+    return ((*num > 0 && *arg == '\0') ? 0 : -1);
+}
+
+
 /*
  *  ======== Main_parseArgs ========
  */
@@ -168,6 +488,9 @@ Int Main_parseArgs(Int argc, Char *argv[])
     String          name;
     Int             status = 0;
 
+    App_Params_init(&Main_params);
+    Sched_Params_init(&Main_sched);
+    Load_Params_init(&Main_load);
 
     /* parse the command line options */
     for (opt = 1; (opt < argc) && (argv[opt][0] == '-'); opt++) {
@@ -181,6 +504,163 @@ Int Main_parseArgs(Int argc, Char *argv[])
                 exit(0);
                 break;
 
+            case 's': /* -s */
+                if (opt + 1 >= argc) {
+                    printf("Error: -s needs a value in us\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_params.spinUs = strtoul(argv[++opt], NULL, 10);
+                break;
+
+            case 'p': /* -p */
+                if (opt + 1 >= argc ||
+                        Main_parseList(argv[++opt], Main_sizes, &Main_numSizes) < 0) {
+                    printf("Error: -p needs up to %d sizes, e.g. 64,128\n",
+                        Main_MAX_POINTS);
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'b': /* -b */
+                if (opt + 1 >= argc ||
+                        Main_parseList(argv[++opt], Main_bursts, &Main_numBursts) < 0) {
+                    printf("Error: -b needs up to %d bursts, e.g. 1,16,64\n",
+                        Main_MAX_POINTS);
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'n': /* -n */
+                if (opt + 1 >= argc) {
+                    printf("Error: -n needs a message count\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_params.numMsgs = strtoul(argv[++opt], NULL, 0);
+                Main_countSet = TRUE;
+                break;
+
+            case 'w': /* -w */
+                Main_sweep = TRUE;
+                break;
+
+            case 'q': /* -q */
+                if (opt + 1 >= argc ||
+                        Main_parseList(argv[++opt], Main_outs, &Main_numOuts) < 0) {
+                    printf("Error: -q needs up to %d counts, e.g. 1,2,4\n",
+                        Main_MAX_POINTS);
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'd': /* -d */
+                if (opt + 1 >= argc) {
+                    printf("Error: -d needs a file name\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_dumpName = argv[++opt];
+                break;
+
+            case 'P': /* -P */
+                if (opt + 1 >= argc) {
+                    printf("Error: -P needs a priority\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_sched.priority = strtol(argv[++opt], NULL, 10);
+                break;
+
+            case 'C': /* -C */
+                if (opt + 1 >= argc) {
+                    printf("Error: -C needs a CPU list\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_sched.cpus = argv[++opt];
+                break;
+
+            case 'M': /* -M */
+                Main_sched.lockMemory = TRUE;
+                break;
+
+            case 'c': /* -c */
+                if (opt + 1 >= argc) {
+                    printf("Error: -c needs a number of channels\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_numChannels = strtoul(argv[++opt], NULL, 10);
+                break;
+
+            case 'r': /* -r */
+                if (opt + 1 >= argc ||
+                        Main_parseList(argv[++opt], Main_pris, &Main_numPris) < 0) {
+                    printf("Error: -r needs a priority per channel, e.g. 8,1\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'L': /* -L */
+                if (opt + 1 >= argc) {
+                    printf("Error: -L needs a load, e.g. spin:1,stream:2\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                if (Load_parse(&Main_load, argv[++opt]) < 0) {
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'I': /* -I */
+                if (opt + 1 >= argc || Main_parseList(argv[++opt],
+                        Main_levels, &Main_numLevels) < 0) {
+                    printf("Error: -I needs load levels, e.g. 0,50,100\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'x': /* -x */
+                Main_params.control = TRUE;
+                break;
+
+            case 'z': /* -z */
+                Main_params.pool = TRUE;
+                break;
+
+            case 'N': /* -N */
+                Main_params.urgent = FALSE;
+                break;
+
+            case 'W': /* -W */
+                if (opt + 1 >= argc) {
+                    printf("Error: -W needs microseconds of work\n");
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
+                Main_params.workUs = strtoul(argv[++opt], NULL, 10);
+                break;
+
             case 'l': /* -l */
                 printf("Processor List\n");
                 status = Ipc_start();
@@ -237,6 +717,123 @@ Int Main_parseArgs(Int argc, Char *argv[])
         goto leave;
     }
 
+    /* the axes -w sweeps unless they were given */
+    if (Main_numSizes == 0 && Main_sweep) {
+        Main_sizes[Main_numSizes++] = App_MSG_MIN;
+        for (i = 64; i < App_MSG_MAX; i *= 2) {
+            if (i > App_MSG_MIN) {
+                Main_sizes[Main_numSizes++] = i;
+            }
+        }
+        Main_sizes[Main_numSizes++] = App_MSG_MAX;
+    }
+    else if (Main_numSizes == 0) {
+        Main_sizes[Main_numSizes++] = Main_params.msgSize;
+    }
+    if (Main_numOuts > 0) {
+        /* ping-pong steps through messages in flight instead of bursts */
+        for (i = 0; i < Main_numOuts; i++) {
+            if (Main_outs[i] == 0 || Main_outs[i] > App_MAX_OUTSTANDING) {
+                printf("Error: %u messages in flight is not in 1..%d\n",
+                    Main_outs[i], App_MAX_OUTSTANDING);
+                status = -1;
+                goto leave;
+            }
+            Main_bursts[i] = 1;
+        }
+        Main_numBursts = Main_numOuts;
+    }
+    else if (Main_numBursts == 0 && Main_sweep) {
+        for (i = 1; i <= App_BURST_DEFAULT; i *= 4) {
+            Main_bursts[Main_numBursts++] = i;
+        }
+    }
+    else if (Main_numBursts == 0) {
+        Main_bursts[Main_numBursts++] = Main_params.burst;
+    }
+    if (Main_numLevels > 1 && Main_numSizes * Main_numBursts > 1) {
+        printf("Error: -I needs one -p size and one -b burst or -q depth\n");
+        status = -1;
+        goto leave;
+    }
+    for (i = 0; i < Main_numLevels; i++) {
+        if (Main_levels[i] > 100) {
+            printf("Error: load level %u is not in 0..100\n",
+                Main_levels[i]);
+            status = -1;
+            goto leave;
+        }
+    }
+    if (Main_numSizes * Main_numBursts > 1 && !Main_countSet) {
+        Main_params.numMsgs /= 10;
+    }
+
+    for (i = 0; i < Main_numSizes; i++) {
+        if (Main_sizes[i] < App_MSG_MIN || Main_sizes[i] > App_MSG_MAX) {
+            printf("Error: message size %u is not in %u..%u\n",
+                Main_sizes[i], App_MSG_MIN, App_MSG_MAX);
+            status = -1;
+            goto leave;
+        }
+    }
+    for (i = 0; i < Main_numBursts; i++) {
+        if (Main_bursts[i] == 0) {
+            printf("Error: a burst needs at least one message\n");
+            status = -1;
+            goto leave;
+        }
+    }
+    if (Main_params.numMsgs == 0) {
+        printf("Error: no messages to receive\n");
+        status = -1;
+        goto leave;
+    }
+
+    /* channels share the DSP's HeapBuf */
+    if (Main_numChannels == 0 || Main_numChannels > App_MAX_CHANNELS) {
+        printf("Error: %u channels is not in 1..%d\n", Main_numChannels,
+            App_MAX_CHANNELS);
+        status = -1;
+        goto leave;
+    }
+    for (i = 0; i < Main_numOuts; i++) {
+        if (Main_outs[i] * Main_numChannels > App_MAX_OUTSTANDING) {
+            printf("Error: %u channels of %u messages in flight is more "
+                "than %d\n", Main_numChannels, Main_outs[i],
+                App_MAX_OUTSTANDING);
+            status = -1;
+            goto leave;
+        }
+    }
+    if (Main_numPris > Main_numChannels) {
+        printf("Error: %u priorities for %u channels\n", Main_numPris,
+            Main_numChannels);
+        status = -1;
+        goto leave;
+    }
+    for (i = 0; i < Main_numPris; i++) {
+        if (Main_pris[i] < 1 || Main_pris[i] > App_PRI_MAX) {
+            printf("Error: DSP priority %u is not in 1..%d\n", Main_pris[i],
+                App_PRI_MAX);
+            status = -1;
+            goto leave;
+        }
+        Main_params.priorities[i] = (Int)Main_pris[i];
+    }
+    if (Main_params.control && (Main_numChannels < 2 || Main_numOuts > 0)) {
+        printf("Error: -x needs -c 2 or more and no -q\n");
+        status = -1;
+        goto leave;
+    }
+    if (Main_params.workUs > App_WORK_MAX ||
+            (Main_params.workUs > 0 && (Main_params.pool || Main_sweep ||
+            Main_numOuts > 0))) {
+        printf("Error: -W takes at most %u us, with bursts and no -z or -w\n",
+            App_WORK_MAX);
+        status = -1;
+        goto leave;
+    }
+
 leave:
     return(status);
 }
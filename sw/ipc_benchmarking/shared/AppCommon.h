@@ -50,6 +50,41 @@ extern "C" {
 #define App_CMD_MASK            0xFF000000
 #define App_CMD_NOP             0x00000000  /* cc------ */
 #define App_CMD_SHUTDOWN        0x02000000  /* cc------ */
+#define App_CMD_BURST           0x03000000  /* ccssssss, r1 = count */
+#define App_CMD_ECHO            0x04000000  /* cc------, sent straight back */
+#define App_CMD_POOL            0x05000000  /* ccssssss, r1 = count */
+#define App_CMD_STATS           0x06000000  /* cc------, reply App_Stats */
+#define App_CMD_PRIORITY        0x07000000  /* cc------, r1 = task priority */
+#define App_CMD_WORK            0x08000000  /* ccuuuuuu, r1 = count */
+#define App_CMD_HEAPS           0x09000000  /* cc------, reply App_HeapStats */
+
+/* App_CMD_BURST asks for r1 replies of s bytes each, any other command
+ * gets the original 64 replies of sizeof(App_Msg) */
+#define App_BURST_DEFAULT       64
+
+/* App_CMD_POOL is App_CMD_BURST answered from messages the server
+ * allocated before the request came in: the request itself goes back as
+ * the first reply and the pool is refilled, up to App_POOL_MAX messages,
+ * once the burst is out, so no MessageQ_alloc sits between the replies
+ * of a burst that fits */
+#define App_POOL_MAX            128
+
+/* App_CMD_WORK is a long job: r1 replies the size of the request, with
+ * u microseconds of DSP work before each, all on the serving task */
+#define App_WORK_MAX            0x00FFFFFF
+
+/* queue pairs per remote core, each served by its own DSP task and host
+ * thread; App_CMD_PRIORITY sets the serving task's BIOS priority, 1 up to
+ * App_PRI_MAX with the default 16 priorities */
+#define App_MAX_CHANNELS        4
+#define App_PRI_MAX             15
+
+/* a message's MessageQ priority is its class, and the task serving it
+ * runs at the class's BIOS priority from then on: MessageQ_URGENTPRI at
+ * App_PRI_MAX, MessageQ_HIGHPRI at least App_PRI_HIGH, MessageQ_NORMALPRI
+ * at the channel's own from App_CMD_PRIORITY. Within a queue the higher
+ * classes are also taken first */
+#define App_PRI_HIGH            8
 
 
 typedef struct {
@@ -59,9 +94,64 @@ typedef struct {
     char payload[448];
 } App_Msg;
 
+/* message sizes a burst may ask for: the header and command words up to
+ * the whole App_Msg, which fills a 512 byte HeapBuf block as far as rpmsg
+ * allows */
+#define App_MSG_MIN             ((UInt32)offsetof(App_Msg, payload))
+#define App_MSG_MAX             ((UInt32)sizeof(App_Msg))
+
+/* server counters since the last App_CMD_STATS, in the reply payload;
+ * ticks are xdc.runtime.Timestamp ticks, split in hi and lo words */
+typedef struct {
+    UInt32              replies;
+    UInt32              allocs;         /* MessageQ_alloc that succeeded */
+    UInt32              allocFails;     /* MessageQ_alloc that returned NULL */
+    UInt32              replyAllocs;    /* allocs between replies of a burst */
+    UInt32              recycled;       /* requests sent back as a reply */
+    UInt32              allocTicksHi;
+    UInt32              allocTicksLo;
+    UInt32              putTicksHi;
+    UInt32              putTicksLo;
+    UInt32              tsFreq;         /* Timestamp ticks per second */
+} App_Stats;
+
+/* MessageQ heaps on the DSP. Heap 0 is the HeapBuf in Dsp1.cfg, which
+ * the transport allocates every inbound message from; heaps 1 up are size
+ * classes the server creates, smallest first, for its own messages. A
+ * message comes from the smallest class it fits, or the next one up while
+ * that one is empty, never from heap 0, which would leave the transport
+ * short of blocks. App_CMD_HEAPS reports how many blocks each class needed
+ * so far */
 #define App_MsgHeapId           0
-#define App_HostMsgQueName      "HOST:MsgQ:01"
-#define App_SlaveMsgQueName     "%s:MsgQ:01"  /* %s is each slave's Proc Name */
+#define App_NUM_HEAPS           5
+#define App_HEAP_SIZES          { 512, 64, 128, 256, 512 }
+#define App_HEAP_BLOCKS         { 160, 128, 64, 64, 128 }
+
+/* the class a size fits, also used by the host, for the record: the Linux
+ * MessageQ_alloc ignores the heap */
+#define App_heapId(size)        ((size) <= 64 ? 1 : (size) <= 128 ? 2 : \
+                                 (size) <= 256 ? 3 : 4)
+
+/* one heap in the App_CMD_HEAPS reply payload, App_NUM_HEAPS of them.
+ * The counters are the asking channel's since its last App_CMD_HEAPS,
+ * the blocks in use and the high-water mark the whole heap's since the
+ * server started */
+typedef struct {
+    UInt32              blockSize;
+    UInt32              numBlocks;
+    UInt32              inUse;          /* App_HEAP_UNKNOWN for heap 0 */
+    UInt32              highWater;      /* most blocks ever in use */
+    UInt32              allocs;         /* server allocs served here */
+    UInt32              fails;          /* the heap was empty */
+    UInt32              spills;         /* served here, a smaller class full */
+} App_HeapStats;
+
+/* heap 0 is created by the configuration and shared with the transport,
+ * the server cannot see how much of it is in use */
+#define App_HEAP_UNKNOWN        0xFFFFFFFF
+
+#define App_HostMsgQueName      "HOST:MsgQ:%02u"  /* %u is the channel, 1.. */
+#define App_SlaveMsgQueName     "%s:MsgQ:%02u"  /* %s is each slave's Proc Name */
 
 
 #if defined (__cplusplus)
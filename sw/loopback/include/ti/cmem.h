@@ -0,0 +1,50 @@
+/*
+ *  ======== cmem.h ========
+ *  Loopback stand-in for the CMEM user-space API.  The "physical"
+ *  window is mapped at the same address it has on the AM57x so the
+ *  remote-side code can dereference the physical addresses it is handed.
+ */
+
+#ifndef ti_CMEM__include
+#define ti_CMEM__include
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define CMEM_VERSION        0x04000000U
+
+#define CMEM_CACHED         0x00000000
+#define CMEM_NONCACHED      0x00000001
+#define CMEM_POOL           0x00000000
+#define CMEM_HEAP           0x00000001
+
+#define CMEM_CMABLOCKID     (-1)
+
+typedef struct CMEM_AllocParams {
+    int type;
+    int flags;
+    size_t alignment;
+} CMEM_AllocParams;
+
+extern CMEM_AllocParams CMEM_DEFAULTPARAMS;
+
+int CMEM_init(void);
+int CMEM_exit(void);
+int CMEM_getPool(unsigned long long size);
+void *CMEM_allocPool(int poolid, CMEM_AllocParams *params);
+void *CMEM_alloc(size_t size, CMEM_AllocParams *params);
+void *CMEM_alloc2(int blockid, size_t size, CMEM_AllocParams *params);
+int CMEM_free(void *ptr, CMEM_AllocParams *params);
+off_t CMEM_getPhys(void *ptr);
+int CMEM_cacheWb(void *ptr, size_t size);
+int CMEM_cacheInv(void *ptr, size_t size);
+int CMEM_cacheWbInv(void *ptr, size_t size);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_CMEM__include */
@@ -0,0 +1,31 @@
+/*
+ *  ======== Ipc.h ========
+ *  Loopback stand-in for the IPC module.
+ */
+
+#ifndef ti_ipc_Ipc__include
+#define ti_ipc_Ipc__include
+
+#include <ti/ipc/Std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Ipc_S_SUCCESS           (0)
+#define Ipc_S_ALREADYSETUP      (1)
+#define Ipc_E_FAIL              (-1)
+
+typedef struct Ipc_TransportFactoryFxns {
+    Int (*createFxn)(Void);
+    Void (*deleteFxn)(Void);
+} Ipc_TransportFactoryFxns;
+
+Int Ipc_transportConfig(Ipc_TransportFactoryFxns *factory);
+Int Ipc_start(Void);
+Int Ipc_stop(Void);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_ipc_Ipc__include */
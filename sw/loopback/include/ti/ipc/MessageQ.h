@@ -0,0 +1,115 @@
+/*
+ *  ======== MessageQ.h ========
+ *  Loopback stand-in for the IPC MessageQ module.
+ */
+
+#ifndef ti_ipc_MessageQ__include
+#define ti_ipc_MessageQ__include
+
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MultiProc.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define MessageQ_S_SUCCESS              (0)
+#define MessageQ_E_FAIL                 (-1)
+#define MessageQ_E_INVALIDARG           (-2)
+#define MessageQ_E_MEMORY               (-3)
+#define MessageQ_E_ALREADYEXISTS        (-4)
+#define MessageQ_E_NOTFOUND             (-5)
+#define MessageQ_E_TIMEOUT              (-6)
+#define MessageQ_E_INVALIDSTATE         (-7)
+#define MessageQ_E_OSFAILURE            (-8)
+#define MessageQ_E_RESOURCE             (-9)
+#define MessageQ_E_RESTART              (-10)
+#define MessageQ_E_INVALIDMSG           (-11)
+#define MessageQ_E_NOTOWNER             (-12)
+#define MessageQ_E_REMOTEACTIVE         (-13)
+#define MessageQ_E_INVALIDHEAPID        (-14)
+#define MessageQ_E_INVALIDPROCID        (-15)
+#define MessageQ_E_MAXREACHED           (-16)
+#define MessageQ_E_UNREGISTEREDHEAPID   (-17)
+#define MessageQ_E_CANNOTFREESTATICMSG  (-18)
+#define MessageQ_E_UNBLOCKED            (-19)
+#define MessageQ_E_SHUTDOWN             (-20)
+
+#define MessageQ_FOREVER                (~(0))
+#define MessageQ_INVALIDMSGID           (0xffff)
+#define MessageQ_INVALIDMESSAGEQ        (0xffff)
+#define MessageQ_PRIORITYMASK           (0x3)
+
+#define MessageQ_NORMALPRI              (0)
+#define MessageQ_HIGHPRI                (1)
+#define MessageQ_RESERVEDPRI            (2)
+#define MessageQ_URGENTPRI              (3)
+
+typedef UInt32 MessageQ_QueueId;
+typedef UInt16 MessageQ_QueueIndex;
+
+typedef struct MessageQ_MsgHeader {
+    Bits32      reserved0;
+    Bits32      reserved1;
+    Bits32      msgSize;
+    Bits16      flags;
+    Bits16      msgId;
+    Bits16      dstId;
+    Bits16      dstProc;
+    Bits16      replyId;
+    Bits16      replyProc;
+    Bits16      srcProc;
+    Bits16      heapId;
+    Bits16      seqNum;
+    Bits16      reserved;
+} MessageQ_MsgHeader;
+
+typedef MessageQ_MsgHeader *MessageQ_Msg;
+
+typedef struct MessageQ_Object *MessageQ_Handle;
+
+typedef struct {
+    Void       *synchronizer;
+    UInt16      queueIndex;
+} MessageQ_Params;
+
+#define MessageQ_getDstQueue(msg) \
+        (((MessageQ_Msg)(msg))->dstId == (MessageQ_QueueIndex)MessageQ_INVALIDMESSAGEQ) ? \
+        (MessageQ_QueueId)MessageQ_INVALIDMESSAGEQ : \
+        (MessageQ_QueueId)(((MessageQ_QueueId)((MessageQ_Msg)(msg))->dstProc << 16u) \
+        | (((MessageQ_Msg)(msg))->dstId))
+
+#define MessageQ_getMsgId(msg) (((MessageQ_Msg)(msg))->msgId)
+#define MessageQ_getMsgSize(msg) (((MessageQ_Msg)(msg))->msgSize)
+#define MessageQ_getMsgPri(msg) \
+        ((((MessageQ_Msg)(msg))->flags & MessageQ_PRIORITYMASK))
+#define MessageQ_getProcId(queueId) ((UInt16)((queueId) >> 16))
+#define MessageQ_getReplyQueue(msg) \
+        (((MessageQ_Msg)(msg))->replyId == (MessageQ_QueueIndex)MessageQ_INVALIDMESSAGEQ) ? \
+        (MessageQ_QueueId)MessageQ_INVALIDMESSAGEQ : \
+        (MessageQ_QueueId)((((MessageQ_Msg)(msg))->replyProc << 16u) \
+        | ((MessageQ_Msg)(msg))->replyId)
+#define MessageQ_setMsgId(msg, id) ((MessageQ_Msg)(msg))->msgId = (id)
+#define MessageQ_setMsgPri(msg, priority) \
+        (((MessageQ_Msg)(msg))->flags = ((priority) & MessageQ_PRIORITYMASK))
+
+Void MessageQ_Params_init(MessageQ_Params *params);
+MessageQ_Handle MessageQ_create(String name, const MessageQ_Params *params);
+Int MessageQ_delete(MessageQ_Handle *handlePtr);
+Int MessageQ_open(String name, MessageQ_QueueId *queueId);
+Int MessageQ_close(MessageQ_QueueId *queueId);
+MessageQ_Msg MessageQ_alloc(UInt16 heapId, UInt32 size);
+Int MessageQ_free(MessageQ_Msg msg);
+Int MessageQ_registerHeap(Ptr heap, UInt16 heapId);
+Int MessageQ_unregisterHeap(UInt16 heapId);
+Int MessageQ_put(MessageQ_QueueId queueId, MessageQ_Msg msg);
+Int MessageQ_get(MessageQ_Handle handle, MessageQ_Msg *msg, UInt timeout);
+Int MessageQ_count(MessageQ_Handle handle);
+MessageQ_QueueId MessageQ_getQueueId(MessageQ_Handle handle);
+Void MessageQ_setReplyQueue(MessageQ_Handle handle, MessageQ_Msg msg);
+Void MessageQ_unblock(MessageQ_Handle handle);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_ipc_MessageQ__include */
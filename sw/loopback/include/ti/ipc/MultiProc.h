@@ -0,0 +1,27 @@
+/*
+ *  ======== MultiProc.h ========
+ *  Loopback stand-in for the IPC MultiProc module.
+ */
+
+#ifndef ti_ipc_MultiProc__include
+#define ti_ipc_MultiProc__include
+
+#include <ti/ipc/Std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define MultiProc_INVALIDID     (0xFFFF)
+#define MultiProc_S_SUCCESS     (0)
+#define MultiProc_E_FAIL        (-1)
+
+UInt16 MultiProc_getId(String name);
+String MultiProc_getName(UInt16 id);
+UInt16 MultiProc_getNumProcessors(Void);
+UInt16 MultiProc_self(Void);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_ipc_MultiProc__include */
@@ -0,0 +1,63 @@
+/*
+ *  ======== Std.h ========
+ *  Loopback stand-in for the IPC standard types header.
+ */
+
+#ifndef ti_ipc_Std__include
+#define ti_ipc_Std__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef char                Char;
+typedef unsigned char       UChar;
+typedef short               Short;
+typedef unsigned short      UShort;
+typedef int                 Int;
+typedef unsigned int        UInt;
+typedef long                Long;
+typedef unsigned long       ULong;
+typedef float               Float;
+typedef double              Double;
+typedef long double         LDouble;
+typedef void                Void;
+
+typedef unsigned short      Bool;
+typedef void *              Ptr;
+typedef char *              String;
+typedef const char *        CString;
+
+typedef int8_t              Int8;
+typedef int16_t             Int16;
+typedef int32_t             Int32;
+typedef int64_t             Int64;
+typedef uint8_t             UInt8;
+typedef uint16_t            UInt16;
+typedef uint32_t            UInt32;
+typedef uint64_t            UInt64;
+
+typedef uint8_t             Bits8;
+typedef uint16_t            Bits16;
+typedef uint32_t            Bits32;
+typedef uint64_t            Bits64;
+
+typedef intptr_t            IArg;
+typedef uintptr_t           UArg;
+typedef size_t              SizeT;
+typedef void                (*Fxn)(void);
+
+#ifndef TRUE
+#define TRUE                1
+#endif
+#ifndef FALSE
+#define FALSE               0
+#endif
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_ipc_Std__include */
@@ -0,0 +1,20 @@
+/*
+ *  ======== TransportRpmsg.h ========
+ *  Loopback stand-in for the rpmsg transport factory.
+ */
+
+#ifndef ti_ipc_transports_TransportRpmsg__include
+#define ti_ipc_transports_TransportRpmsg__include
+
+#include <ti/ipc/Ipc.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+extern Ipc_TransportFactoryFxns TransportRpmsg_Factory;
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_ipc_transports_TransportRpmsg__include */
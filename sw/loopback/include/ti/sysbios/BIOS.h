@@ -0,0 +1,24 @@
+/*
+ *  ======== BIOS.h ========
+ *  Loopback stand-in for ti.sysbios.BIOS.  BIOS_start() ends the emulated
+ *  core's startup thread; the tasks it created keep running.
+ */
+
+#ifndef ti_sysbios_BIOS__include
+#define ti_sysbios_BIOS__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define BIOS_WAIT_FOREVER   (~(0))
+#define BIOS_NO_WAIT        (0)
+
+Void BIOS_start(Void);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_sysbios_BIOS__include */
@@ -0,0 +1,24 @@
+/*
+ *  ======== Cache.h ========
+ *  Loopback stand-in for ti.sysbios.family.c66.Cache.  Only the long
+ *  names are provided; include it with __nolocalnames as the DSP code does.
+ */
+
+#ifndef ti_sysbios_family_c66_Cache__include
+#define ti_sysbios_family_c66_Cache__include
+
+#include <xdc/std.h>
+
+typedef enum ti_sysbios_family_c66_Cache_Mar {
+    ti_sysbios_family_c66_Cache_Mar_DISABLE = 0,
+    ti_sysbios_family_c66_Cache_Mar_ENABLE = 1
+} ti_sysbios_family_c66_Cache_Mar;
+
+#define ti_sysbios_family_c66_Cache_setMar(base, size, value) \
+        ((Void)(base), (Void)(size), (Void)(value))
+#define ti_sysbios_family_c66_Cache_getMar(base) \
+        ((Void)(base), ti_sysbios_family_c66_Cache_Mar_ENABLE)
+#define ti_sysbios_family_c66_Cache_wbInv(ptr, cnt, type, wait) \
+        ((Void)(ptr), (Void)(cnt))
+
+#endif /* ti_sysbios_family_c66_Cache__include */
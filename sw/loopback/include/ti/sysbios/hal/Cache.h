@@ -0,0 +1,31 @@
+/*
+ *  ======== Cache.h ========
+ *  Loopback stand-in for ti.sysbios.hal.Cache.  Host memory is coherent,
+ *  so every operation is a no-op.
+ */
+
+#ifndef ti_sysbios_hal_Cache__include
+#define ti_sysbios_hal_Cache__include
+
+#include <xdc/std.h>
+
+typedef enum Cache_Type {
+    Cache_Type_L1P = 0x1,
+    Cache_Type_L1D = 0x2,
+    Cache_Type_L1 = 0x3,
+    Cache_Type_L2P = 0x4,
+    Cache_Type_L2D = 0x8,
+    Cache_Type_L2 = 0xC,
+    Cache_Type_ALLP = 0x5,
+    Cache_Type_ALLD = 0xA,
+    Cache_Type_ALL = 0x7fff
+} Cache_Type;
+
+#define Cache_wb(ptr, cnt, type, wait)      ((Void)(ptr), (Void)(cnt))
+#define Cache_inv(ptr, cnt, type, wait)     ((Void)(ptr), (Void)(cnt))
+#define Cache_wbInv(ptr, cnt, type, wait)   ((Void)(ptr), (Void)(cnt))
+#define Cache_wbAll()                       ((Void)0)
+#define Cache_wbInvAll()                    ((Void)0)
+#define Cache_wait()                        ((Void)0)
+
+#endif /* ti_sysbios_hal_Cache__include */
@@ -0,0 +1,45 @@
+/*
+ *  ======== HeapBuf.h ========
+ *  Loopback stand-in for ti.sysbios.heaps.HeapBuf.  Only the block
+ *  accounting is kept: a MessageQ heap registered with
+ *  MessageQ_registerHeap refuses messages larger than a block and runs
+ *  out after numBlocks, but the messages themselves come from malloc.
+ */
+
+#ifndef ti_sysbios_heaps_HeapBuf__include
+#define ti_sysbios_heaps_HeapBuf__include
+
+#include <xdc/std.h>
+#include <xdc/runtime/Error.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct HeapBuf_Object *HeapBuf_Handle;
+
+typedef struct HeapBuf_Params {
+    SizeT align;
+    UInt numBlocks;
+    SizeT blockSize;
+    UArg bufSize;
+    Ptr buf;
+} HeapBuf_Params;
+
+typedef struct HeapBuf_ExtendedStats {
+    UInt maxAllocatedBlocks;
+    UInt numAllocatedBlocks;
+} HeapBuf_ExtendedStats;
+
+#define HeapBuf_Handle_upCast(handle)   ((Ptr)(handle))
+
+Void HeapBuf_Params_init(HeapBuf_Params *params);
+HeapBuf_Handle HeapBuf_create(const HeapBuf_Params *params, Error_Block *eb);
+Void HeapBuf_delete(HeapBuf_Handle *handle);
+Void HeapBuf_getExtendedStats(HeapBuf_Handle handle,
+    HeapBuf_ExtendedStats *stats);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_sysbios_heaps_HeapBuf__include */
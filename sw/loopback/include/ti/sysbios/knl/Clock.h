@@ -0,0 +1,22 @@
+/*
+ *  ======== Clock.h ========
+ *  Loopback stand-in for ti.sysbios.knl.Clock (1 ms tick).
+ */
+
+#ifndef ti_sysbios_knl_Clock__include
+#define ti_sysbios_knl_Clock__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Clock_tickPeriod    (1000)
+
+UInt32 Clock_getTicks(Void);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_sysbios_knl_Clock__include */
@@ -0,0 +1,33 @@
+/*
+ *  ======== Semaphore.h ========
+ *  Loopback stand-in for ti.sysbios.knl.Semaphore.
+ */
+
+#ifndef ti_sysbios_knl_Semaphore__include
+#define ti_sysbios_knl_Semaphore__include
+
+#include <xdc/std.h>
+#include <xdc/runtime/Error.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Semaphore_Object *Semaphore_Handle;
+
+typedef struct Semaphore_Params {
+    Int mode;
+} Semaphore_Params;
+
+Void Semaphore_Params_init(Semaphore_Params *params);
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params,
+    Error_Block *eb);
+Void Semaphore_delete(Semaphore_Handle *handle);
+Bool Semaphore_pend(Semaphore_Handle handle, UInt32 timeout);
+Void Semaphore_post(Semaphore_Handle handle);
+Int Semaphore_getCount(Semaphore_Handle handle);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_sysbios_knl_Semaphore__include */
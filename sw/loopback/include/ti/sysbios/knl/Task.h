@@ -0,0 +1,49 @@
+/*
+ *  ======== Task.h ========
+ *  Loopback stand-in for ti.sysbios.knl.Task; tasks run as POSIX threads
+ *  of the emulated core.  Priorities are recorded but not enforced.
+ */
+
+#ifndef ti_sysbios_knl_Task__include
+#define ti_sysbios_knl_Task__include
+
+#include <xdc/std.h>
+#include <xdc/runtime/Error.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef Void (*Task_FuncPtr)(UArg arg0, UArg arg1);
+typedef struct Task_Object *Task_Handle;
+
+typedef struct Task_InstanceParams {
+    CString name;
+} Task_InstanceParams;
+
+typedef struct Task_Params {
+    Task_InstanceParams *instance;
+    UArg arg0;
+    UArg arg1;
+    Int priority;
+    Ptr stack;
+    size_t stackSize;
+    Ptr env;
+    Bool vitalTaskFlag;
+    Task_InstanceParams __iprms;
+} Task_Params;
+
+Void Task_Params_init(Task_Params *params);
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params,
+    Error_Block *eb);
+Void Task_delete(Task_Handle *handle);
+Task_Handle Task_self(Void);
+Int Task_getPri(Task_Handle handle);
+Int Task_setPri(Task_Handle handle, Int newpri);
+Void Task_sleep(UInt32 nticks);
+Void Task_yield(Void);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* ti_sysbios_knl_Task__include */
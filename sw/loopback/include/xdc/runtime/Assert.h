@@ -0,0 +1,16 @@
+/*
+ *  ======== Assert.h ========
+ *  Loopback stand-in for xdc.runtime.Assert.
+ */
+
+#ifndef xdc_runtime_Assert__include
+#define xdc_runtime_Assert__include
+
+#include <assert.h>
+#include <xdc/std.h>
+
+typedef Bits32 Assert_Id;
+
+#define Assert_isTrue(expr, id) assert(expr)
+
+#endif /* xdc_runtime_Assert__include */
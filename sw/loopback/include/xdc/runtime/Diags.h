@@ -0,0 +1,32 @@
+/*
+ *  ======== Diags.h ========
+ *  Loopback stand-in for xdc.runtime.Diags; masks are accepted and ignored.
+ */
+
+#ifndef xdc_runtime_Diags__include
+#define xdc_runtime_Diags__include
+
+#include <xdc/std.h>
+
+typedef Bits16 Diags_Mask;
+
+#define Diags_ENTRY         0x0001
+#define Diags_EXIT          0x0002
+#define Diags_LIFECYCLE     0x0004
+#define Diags_INTERNAL      0x0008
+#define Diags_ASSERT        0x0010
+#define Diags_STATUS        0x0080
+#define Diags_USER1         0x0100
+#define Diags_USER2         0x0200
+#define Diags_USER3         0x0400
+#define Diags_USER4         0x0800
+#define Diags_USER5         0x1000
+#define Diags_USER6         0x2000
+#define Diags_USER7         0x4000
+#define Diags_INFO          Diags_USER1
+#define Diags_USER8         0x8000
+#define Diags_ANALYSIS      0x0400
+
+#define Diags_setMask(control) ((Void)(control))
+
+#endif /* xdc_runtime_Diags__include */
@@ -0,0 +1,20 @@
+/*
+ *  ======== Error.h ========
+ *  Loopback stand-in for xdc.runtime.Error.
+ */
+
+#ifndef xdc_runtime_Error__include
+#define xdc_runtime_Error__include
+
+#include <xdc/std.h>
+
+typedef struct Error_Block {
+    Bool raised;
+} Error_Block;
+
+#define Error_IGNORE        ((Error_Block *)NULL)
+
+#define Error_init(eb)      ((eb)->raised = FALSE)
+#define Error_check(eb)     ((eb) != NULL && (eb)->raised)
+
+#endif /* xdc_runtime_Error__include */
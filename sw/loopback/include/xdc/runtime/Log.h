@@ -0,0 +1,43 @@
+/*
+ *  ======== Log.h ========
+ *  Loopback stand-in for xdc.runtime.Log.  Events are printed to stderr,
+ *  tagged with the emulated core, when LOOPBACK_TRACE is set.
+ */
+
+#ifndef xdc_runtime_Log__include
+#define xdc_runtime_Log__include
+
+#include <xdc/std.h>
+#include <xdc/runtime/Diags.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+Void Loopback_log(CString kind, Bits16 mask, CString fmt, IArg a0, IArg a1,
+    IArg a2, IArg a3, IArg a4, IArg a5);
+
+#define Log_print0(m, f)                    Loopback_log("", m, f, 0, 0, 0, 0, 0, 0)
+#define Log_print1(m, f, a)                 Loopback_log("", m, f, (IArg)(a), 0, 0, 0, 0, 0)
+#define Log_print2(m, f, a, b)              Loopback_log("", m, f, (IArg)(a), (IArg)(b), 0, 0, 0, 0)
+#define Log_print3(m, f, a, b, c)           Loopback_log("", m, f, (IArg)(a), (IArg)(b), (IArg)(c), 0, 0, 0)
+#define Log_print4(m, f, a, b, c, d)        Loopback_log("", m, f, (IArg)(a), (IArg)(b), (IArg)(c), (IArg)(d), 0, 0)
+#define Log_print5(m, f, a, b, c, d, e)     Loopback_log("", m, f, (IArg)(a), (IArg)(b), (IArg)(c), (IArg)(d), (IArg)(e), 0)
+#define Log_print6(m, f, a, b, c, d, e, g)  Loopback_log("", m, f, (IArg)(a), (IArg)(b), (IArg)(c), (IArg)(d), (IArg)(e), (IArg)(g))
+
+#define Log_error0(f)                       Loopback_log("ERROR: ", 0, f, 0, 0, 0, 0, 0, 0)
+#define Log_error1(f, a)                    Loopback_log("ERROR: ", 0, f, (IArg)(a), 0, 0, 0, 0, 0)
+#define Log_error2(f, a, b)                 Loopback_log("ERROR: ", 0, f, (IArg)(a), (IArg)(b), 0, 0, 0, 0)
+#define Log_error3(f, a, b, c)              Loopback_log("ERROR: ", 0, f, (IArg)(a), (IArg)(b), (IArg)(c), 0, 0, 0)
+#define Log_error4(f, a, b, c, d)           Loopback_log("ERROR: ", 0, f, (IArg)(a), (IArg)(b), (IArg)(c), (IArg)(d), 0, 0)
+
+#define Log_info0(f)                        Log_print0(Diags_INFO, f)
+#define Log_info1(f, a)                     Log_print1(Diags_INFO, f, a)
+#define Log_info2(f, a, b)                  Log_print2(Diags_INFO, f, a, b)
+#define Log_info3(f, a, b, c)               Log_print3(Diags_INFO, f, a, b, c)
+#define Log_info4(f, a, b, c, d)            Log_print4(Diags_INFO, f, a, b, c, d)
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* xdc_runtime_Log__include */
@@ -0,0 +1,17 @@
+/*
+ *  ======== Memory.h ========
+ *  Loopback stand-in for xdc.runtime.Memory.
+ */
+
+#ifndef xdc_runtime_Memory__include
+#define xdc_runtime_Memory__include
+
+#include <stdlib.h>
+#include <xdc/std.h>
+#include <xdc/runtime/Error.h>
+
+#define Memory_alloc(heap, size, align, eb)     malloc(size)
+#define Memory_calloc(heap, size, align, eb)    calloc(1, size)
+#define Memory_free(heap, block, size)          free(block)
+
+#endif /* xdc_runtime_Memory__include */
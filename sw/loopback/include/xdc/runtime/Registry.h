@@ -0,0 +1,25 @@
+/*
+ *  ======== Registry.h ========
+ *  Loopback stand-in for xdc.runtime.Registry.
+ */
+
+#ifndef xdc_runtime_Registry__include
+#define xdc_runtime_Registry__include
+
+#include <xdc/std.h>
+
+typedef struct Registry_Desc {
+    CString modName;
+} Registry_Desc;
+
+typedef enum Registry_Result {
+    Registry_SUCCESS,
+    Registry_ALLOC_FAILED,
+    Registry_ALREADY_ADDED,
+    Registry_NOT_FOUND
+} Registry_Result;
+
+#define Registry_addModule(desc, name) \
+        ((desc)->modName = (name), Registry_SUCCESS)
+
+#endif /* xdc_runtime_Registry__include */
@@ -0,0 +1,17 @@
+/*
+ *  ======== System.h ========
+ *  Loopback stand-in for xdc.runtime.System.
+ */
+
+#ifndef xdc_runtime_System__include
+#define xdc_runtime_System__include
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <xdc/std.h>
+
+#define System_printf       printf
+#define System_abort(str)   (fprintf(stderr, "%s\n", (str)), abort())
+#define System_exit(stat)   exit(stat)
+
+#endif /* xdc_runtime_System__include */
@@ -0,0 +1,24 @@
+/*
+ *  ======== Timestamp.h ========
+ *  Loopback stand-in for xdc.runtime.Timestamp; counts nanoseconds of
+ *  CLOCK_MONOTONIC_RAW, so the frequency is reported as 1 GHz.
+ */
+
+#ifndef xdc_runtime_Timestamp__include
+#define xdc_runtime_Timestamp__include
+
+#include <xdc/std.h>
+#include <xdc/runtime/Types.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+Bits32 Timestamp_get32(Void);
+Void Timestamp_get64(Types_Timestamp64 *result);
+Void Timestamp_getFreq(Types_FreqHz *freq);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* xdc_runtime_Timestamp__include */
@@ -0,0 +1,21 @@
+/*
+ *  ======== Types.h ========
+ *  Loopback stand-in for xdc.runtime.Types.
+ */
+
+#ifndef xdc_runtime_Types__include
+#define xdc_runtime_Types__include
+
+#include <xdc/std.h>
+
+typedef struct Types_FreqHz {
+    Bits32 hi;
+    Bits32 lo;
+} Types_FreqHz;
+
+typedef struct Types_Timestamp64 {
+    Bits32 hi;
+    Bits32 lo;
+} Types_Timestamp64;
+
+#endif /* xdc_runtime_Types__include */
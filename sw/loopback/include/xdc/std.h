@@ -0,0 +1,11 @@
+/*
+ *  ======== std.h ========
+ *  Loopback stand-in for the XDC standard types header.
+ */
+
+#ifndef xdc_std__include
+#define xdc_std__include
+
+#include <ti/ipc/Std.h>
+
+#endif /* xdc_std__include */
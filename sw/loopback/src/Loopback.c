@@ -0,0 +1,1203 @@
+/*
+ *  ======== Loopback.c ========
+ *  In-process stand-in for the subset of IPC, SYS/BIOS, xdc.runtime and
+ *  CMEM used by the examples.  The host application runs on the calling
+ *  thread(s); every remote core linked into the binary runs its own main()
+ *  on a thread of its own, so the unmodified Server code answers the host.
+ *
+ *  Transport behaviour is controlled from the environment:
+ *      LOOPBACK_LATENCY_US     one-way latency added to every remote put
+ *      LOOPBACK_BANDWIDTH_MBPS per-direction link bandwidth (0 = unlimited)
+ *      LOOPBACK_CORES          comma separated list of cores to start
+ *      LOOPBACK_TRACE          print remote Log_print output to stderr
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <ti/ipc/Std.h>
+#include <ti/ipc/Ipc.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/transports/TransportRpmsg.h>
+#include <ti/cmem.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/heaps/HeapBuf.h>
+
+#define Loopback_NUMPROCS       5
+#define Loopback_HOSTID         0
+#define Loopback_MAXQUEUES      64
+#define Loopback_MAXHEAPS       8
+#define Loopback_MAXMSGSIZE     496         /* rpmsg buffer less its header */
+
+#define Loopback_CMEM_BASE      0xA0000000UL
+#define Loopback_CMEM_SIZE      0x0C000000UL
+#define Loopback_CMEM_POOLSIZE  0x08000000UL
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+typedef Int (*Loopback_MainFxn)(Int argc, Char *argv[]);
+
+/* remote core images, present only when linked into the binary */
+extern Int Loopback_IPU2_main(Int argc, Char *argv[]) __attribute__((weak));
+extern Int Loopback_IPU1_main(Int argc, Char *argv[]) __attribute__((weak));
+extern Int Loopback_DSP2_main(Int argc, Char *argv[]) __attribute__((weak));
+extern Int Loopback_DSP1_main(Int argc, Char *argv[]) __attribute__((weak));
+
+/* every message carries a hidden link node ahead of its header */
+typedef struct Loopback_Node {
+    struct Loopback_Node   *next;
+    UInt64                  deliverAt;
+    struct HeapBuf_Object  *heap;       /* NULL when unaccounted */
+} Loopback_Node;
+
+typedef struct {
+    Loopback_Node          *head;
+    Loopback_Node          *tail;
+} Loopback_List;
+
+struct MessageQ_Object {
+    char                    name[32];
+    UInt16                  procId;
+    UInt16                  index;
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+    Loopback_List           normal;
+    Loopback_List           high;
+    Int                     count;
+    Bool                    unblocked;
+};
+
+typedef struct {
+    UInt64                  busyUntil;
+} Loopback_Link;
+
+struct Task_Object {
+    Task_FuncPtr            fxn;
+    UArg                    arg0;
+    UArg                    arg1;
+    Int                     priority;
+    UInt16                  procId;
+    char                    name[32];
+    pthread_t               thread;
+};
+
+struct HeapBuf_Object {
+    SizeT                   blockSize;
+    UInt                    numBlocks;
+    UInt                    numAllocated;
+    UInt                    maxAllocated;
+};
+
+struct Semaphore_Object {
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+    Int                     count;
+};
+
+typedef struct {
+    pthread_mutex_t         lock;
+    Int                     refCount;
+    Bool                    shutdown;
+    UInt64                  latencyNs;
+    double                  nsPerByte;
+    Bool                    trace;
+    UInt64                  epoch;
+    MessageQ_Handle         queues[Loopback_NUMPROCS][Loopback_MAXQUEUES];
+    HeapBuf_Handle          heaps[Loopback_NUMPROCS][Loopback_MAXHEAPS];
+    Loopback_Link           links[Loopback_NUMPROCS][Loopback_NUMPROCS];
+    char                   *cmemBase;
+    Bool                    cmemPoolBusy;
+    size_t                  cmemCmaNext;
+} Loopback_Module;
+
+static Loopback_Module Module = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static __thread UInt16 Loopback_procId = Loopback_HOSTID;
+static __thread struct Task_Object *Loopback_task = NULL;
+
+static String Loopback_names[Loopback_NUMPROCS] = {
+    "HOST", "IPU2", "IPU1", "DSP2", "DSP1"
+};
+
+Ipc_TransportFactoryFxns TransportRpmsg_Factory = { NULL, NULL };
+
+CMEM_AllocParams CMEM_DEFAULTPARAMS = { CMEM_POOL, CMEM_CACHED, 1 };
+
+/* referenced by the resource tables of the remote images */
+char ti_trace_SysMin_Module_State_0_outbuf__A;
+
+
+/*
+ *  ======== Loopback_now ========
+ */
+static UInt64 Loopback_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Loopback_condInit ========
+ */
+static Void Loopback_condInit(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/*
+ *  ======== Loopback_condWait ========
+ *  Wait until signalled or the absolute monotonic deadline (0 = forever).
+ */
+static Void Loopback_condWait(pthread_cond_t *cond, pthread_mutex_t *lock,
+    UInt64 deadline)
+{
+    struct timespec ts;
+
+    if (deadline == 0) {
+        pthread_cond_wait(cond, lock);
+        return;
+    }
+    ts.tv_sec = deadline / 1000000000ULL;
+    ts.tv_nsec = deadline % 1000000000ULL;
+    pthread_cond_timedwait(cond, lock, &ts);
+}
+
+/*
+ *  ======== Loopback_timeoutNs ========
+ *  Host MessageQ timeouts are in microseconds, remote ones in Clock ticks.
+ */
+static UInt64 Loopback_timeoutNs(UInt timeout)
+{
+    if (Loopback_procId == Loopback_HOSTID) {
+        return ((UInt64)timeout * 1000ULL);
+    }
+    return ((UInt64)timeout * Clock_tickPeriod * 1000ULL);
+}
+
+/*
+ *  ======== Loopback_log ========
+ */
+Void Loopback_log(CString kind, Bits16 mask, CString fmt, IArg a0, IArg a1,
+    IArg a2, IArg a3, IArg a4, IArg a5)
+{
+    char buf[256];
+    size_t len;
+
+    (Void)mask;
+
+    if (!Module.trace && kind[0] == '\0') {
+        return;
+    }
+
+    snprintf(buf, sizeof(buf), fmt, a0, a1, a2, a3, a4, a5);
+    len = strlen(buf);
+    while (len > 0 && buf[len - 1] == '\n') {
+        buf[--len] = '\0';
+    }
+    fprintf(stderr, "[%s] %s%s\n", Loopback_names[Loopback_procId], kind, buf);
+}
+
+
+/*
+ *  ======== MultiProc ========
+ */
+UInt16 MultiProc_getId(String name)
+{
+    UInt16 i;
+
+    for (i = 0; name != NULL && i < Loopback_NUMPROCS; i++) {
+        if (strcmp(name, Loopback_names[i]) == 0) {
+            return (i);
+        }
+    }
+    return (MultiProc_INVALIDID);
+}
+
+String MultiProc_getName(UInt16 id)
+{
+    return (id < Loopback_NUMPROCS ? Loopback_names[id] : NULL);
+}
+
+UInt16 MultiProc_getNumProcessors(Void)
+{
+    return (Loopback_NUMPROCS);
+}
+
+UInt16 MultiProc_self(Void)
+{
+    return (Loopback_procId);
+}
+
+
+/*
+ *  ======== Loopback_image ========
+ *  The main() of a remote core, NULL when it was not linked in.
+ */
+static Loopback_MainFxn Loopback_image(UInt16 procId)
+{
+    switch (procId) {
+        case 1: return (Loopback_IPU2_main);
+        case 2: return (Loopback_IPU1_main);
+        case 3: return (Loopback_DSP2_main);
+        case 4: return (Loopback_DSP1_main);
+    }
+    return (NULL);
+}
+
+/*
+ *  ======== Loopback_coreMain ========
+ *  Startup thread of one emulated remote core.
+ */
+static Void *Loopback_coreMain(Void *arg)
+{
+    UInt16 procId = (UInt16)(UArg)arg;
+    Loopback_MainFxn fxn = Loopback_image(procId);
+    static Char *argv[] = { NULL };
+
+    Loopback_procId = procId;
+
+    if (fxn != NULL) {
+        fxn(0, argv);
+    }
+    return (NULL);
+}
+
+/*
+ *  ======== Loopback_coreEnabled ========
+ */
+static Bool Loopback_coreEnabled(UInt16 procId)
+{
+    const char *list = getenv("LOOPBACK_CORES");
+    const char *name = Loopback_names[procId];
+    size_t len = strlen(name);
+    const char *p;
+
+    if (list == NULL || list[0] == '\0') {
+        return (TRUE);
+    }
+    for (p = list; (p = strcasestr(p, name)) != NULL; p += len) {
+        if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) {
+            return (TRUE);
+        }
+    }
+    return (FALSE);
+}
+
+
+/*
+ *  ======== Ipc ========
+ */
+Int Ipc_transportConfig(Ipc_TransportFactoryFxns *factory)
+{
+    (Void)factory;
+    return (Ipc_S_SUCCESS);
+}
+
+Int Ipc_start(Void)
+{
+    const char *env;
+    pthread_t thread;
+    double mbps;
+    UInt16 i;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.refCount++ > 0) {
+        pthread_mutex_unlock(&Module.lock);
+        return (Ipc_S_ALREADYSETUP);
+    }
+
+    Module.shutdown = FALSE;
+    Module.epoch = Loopback_now();
+    env = getenv("LOOPBACK_LATENCY_US");
+    Module.latencyNs = (env != NULL) ? strtoull(env, NULL, 0) * 1000ULL : 0;
+    env = getenv("LOOPBACK_BANDWIDTH_MBPS");
+    mbps = (env != NULL) ? strtod(env, NULL) : 0.0;
+    Module.nsPerByte = (mbps > 0.0) ? 1000.0 / mbps : 0.0;
+    Module.trace = (getenv("LOOPBACK_TRACE") != NULL);
+    pthread_mutex_unlock(&Module.lock);
+
+    for (i = 1; i < Loopback_NUMPROCS; i++) {
+        if (Loopback_image(i) != NULL && Loopback_coreEnabled(i)) {
+            pthread_create(&thread, NULL, Loopback_coreMain, (Void *)(UArg)i);
+            pthread_detach(thread);
+        }
+    }
+
+    return (Ipc_S_SUCCESS);
+}
+
+Int Ipc_stop(Void)
+{
+    UInt16 p, q;
+    MessageQ_Handle obj;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.refCount == 0 || --Module.refCount > 0) {
+        pthread_mutex_unlock(&Module.lock);
+        return (Ipc_S_SUCCESS);
+    }
+
+    /* release every remote task blocked in MessageQ_get */
+    Module.shutdown = TRUE;
+    for (p = 1; p < Loopback_NUMPROCS; p++) {
+        for (q = 0; q < Loopback_MAXQUEUES; q++) {
+            if ((obj = Module.queues[p][q]) != NULL) {
+                pthread_mutex_lock(&obj->lock);
+                pthread_cond_broadcast(&obj->cond);
+                pthread_mutex_unlock(&obj->lock);
+            }
+        }
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (Ipc_S_SUCCESS);
+}
+
+
+/*
+ *  ======== MessageQ ========
+ */
+Void MessageQ_Params_init(MessageQ_Params *params)
+{
+    params->synchronizer = NULL;
+    params->queueIndex = MessageQ_INVALIDMESSAGEQ;
+}
+
+MessageQ_Handle MessageQ_create(String name, const MessageQ_Params *params)
+{
+    MessageQ_Handle obj = NULL;
+    UInt16 proc = Loopback_procId;
+    UInt16 i;
+
+    (Void)params;
+
+    pthread_mutex_lock(&Module.lock);
+
+    if (name != NULL) {
+        for (i = 0; i < Loopback_MAXQUEUES; i++) {
+            MessageQ_Handle q = Module.queues[proc][i];
+            if (q != NULL && strcmp(q->name, name) == 0) {
+                goto leave;
+            }
+        }
+    }
+
+    /* index 0 is kept free so no queue id collides with INVALIDMESSAGEQ */
+    for (i = 1; i < Loopback_MAXQUEUES; i++) {
+        if (Module.queues[proc][i] == NULL) {
+            break;
+        }
+    }
+    if (i == Loopback_MAXQUEUES) {
+        goto leave;
+    }
+
+    obj = calloc(1, sizeof(*obj));
+    if (obj == NULL) {
+        goto leave;
+    }
+    if (name != NULL) {
+        snprintf(obj->name, sizeof(obj->name), "%s", name);
+    }
+    obj->procId = proc;
+    obj->index = i;
+    pthread_mutex_init(&obj->lock, NULL);
+    Loopback_condInit(&obj->cond);
+    Module.queues[proc][i] = obj;
+
+leave:
+    pthread_mutex_unlock(&Module.lock);
+    return (obj);
+}
+
+/*
+ *  ======== Loopback_release ========
+ *  Free a message, giving its block back to the heap it came from.
+ */
+static Void Loopback_release(Loopback_Node *node)
+{
+    if (node->heap != NULL) {
+        pthread_mutex_lock(&Module.lock);
+        node->heap->numAllocated--;
+        pthread_mutex_unlock(&Module.lock);
+    }
+    free(node);
+}
+
+static Void Loopback_drain(Loopback_List *list)
+{
+    Loopback_Node *node;
+
+    while ((node = list->head) != NULL) {
+        list->head = node->next;
+        Loopback_release(node);
+    }
+    list->tail = NULL;
+}
+
+Int MessageQ_delete(MessageQ_Handle *handlePtr)
+{
+    MessageQ_Handle obj = *handlePtr;
+
+    if (obj == NULL) {
+        return (MessageQ_E_INVALIDARG);
+    }
+
+    pthread_mutex_lock(&Module.lock);
+    Module.queues[obj->procId][obj->index] = NULL;
+    pthread_mutex_unlock(&Module.lock);
+
+    Loopback_drain(&obj->normal);
+    Loopback_drain(&obj->high);
+    pthread_cond_destroy(&obj->cond);
+    pthread_mutex_destroy(&obj->lock);
+    free(obj);
+    *handlePtr = NULL;
+
+    return (MessageQ_S_SUCCESS);
+}
+
+Int MessageQ_open(String name, MessageQ_QueueId *queueId)
+{
+    Int status = MessageQ_E_NOTFOUND;
+    UInt16 p, i;
+
+    pthread_mutex_lock(&Module.lock);
+    for (p = 0; p < Loopback_NUMPROCS; p++) {
+        for (i = 0; i < Loopback_MAXQUEUES; i++) {
+            MessageQ_Handle q = Module.queues[p][i];
+            if (q != NULL && strcmp(q->name, name) == 0) {
+                *queueId = ((MessageQ_QueueId)p << 16) | i;
+                status = MessageQ_S_SUCCESS;
+                goto leave;
+            }
+        }
+    }
+    *queueId = MessageQ_INVALIDMESSAGEQ;
+
+leave:
+    pthread_mutex_unlock(&Module.lock);
+    return (status);
+}
+
+Int MessageQ_close(MessageQ_QueueId *queueId)
+{
+    *queueId = MessageQ_INVALIDMESSAGEQ;
+    return (MessageQ_S_SUCCESS);
+}
+
+Int MessageQ_registerHeap(Ptr heap, UInt16 heapId)
+{
+    Int status = MessageQ_S_SUCCESS;
+
+    if (heapId >= Loopback_MAXHEAPS) {
+        return (MessageQ_E_INVALIDHEAPID);
+    }
+    pthread_mutex_lock(&Module.lock);
+    if (Module.heaps[Loopback_procId][heapId] != NULL) {
+        status = MessageQ_E_ALREADYEXISTS;
+    }
+    else {
+        Module.heaps[Loopback_procId][heapId] = (HeapBuf_Handle)heap;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (status);
+}
+
+Int MessageQ_unregisterHeap(UInt16 heapId)
+{
+    if (heapId >= Loopback_MAXHEAPS) {
+        return (MessageQ_E_INVALIDHEAPID);
+    }
+    pthread_mutex_lock(&Module.lock);
+    Module.heaps[Loopback_procId][heapId] = NULL;
+    pthread_mutex_unlock(&Module.lock);
+
+    return (MessageQ_S_SUCCESS);
+}
+
+MessageQ_Msg MessageQ_alloc(UInt16 heapId, UInt32 size)
+{
+    Loopback_Node *node;
+    MessageQ_Msg msg;
+    HeapBuf_Handle heap = NULL;
+
+    if (size < sizeof(MessageQ_MsgHeader)) {
+        return (NULL);
+    }
+
+    /* a registered heap holds numBlocks of blockSize, the rest is free */
+    if (heapId < Loopback_MAXHEAPS) {
+        pthread_mutex_lock(&Module.lock);
+        heap = Module.heaps[Loopback_procId][heapId];
+        if (heap != NULL && (size > heap->blockSize ||
+                heap->numAllocated >= heap->numBlocks)) {
+            pthread_mutex_unlock(&Module.lock);
+            return (NULL);
+        }
+        if (heap != NULL && ++heap->numAllocated > heap->maxAllocated) {
+            heap->maxAllocated = heap->numAllocated;
+        }
+        pthread_mutex_unlock(&Module.lock);
+    }
+
+    node = malloc(sizeof(Loopback_Node) + size);
+    if (node == NULL) {
+        if (heap != NULL) {
+            pthread_mutex_lock(&Module.lock);
+            heap->numAllocated--;
+            pthread_mutex_unlock(&Module.lock);
+        }
+        return (NULL);
+    }
+    node->heap = heap;
+    msg = (MessageQ_Msg)(node + 1);
+    memset(msg, 0, sizeof(MessageQ_MsgHeader));
+    msg->msgSize = size;
+    msg->heapId = heapId;
+    msg->msgId = MessageQ_INVALIDMSGID;
+    msg->dstId = MessageQ_INVALIDMESSAGEQ;
+    msg->replyId = MessageQ_INVALIDMESSAGEQ;
+    msg->replyProc = MessageQ_INVALIDMESSAGEQ;
+    msg->srcProc = Loopback_procId;
+
+    return (msg);
+}
+
+Int MessageQ_free(MessageQ_Msg msg)
+{
+    if (msg == NULL) {
+        return (MessageQ_E_INVALIDMSG);
+    }
+    Loopback_release((Loopback_Node *)msg - 1);
+    return (MessageQ_S_SUCCESS);
+}
+
+/*
+ *  ======== Loopback_insert ========
+ *  Keep each list ordered by delivery time; equal times stay FIFO.
+ */
+static Void Loopback_insert(Loopback_List *list, Loopback_Node *node,
+    Bool atHead)
+{
+    Loopback_Node *prev, *cur;
+
+    node->next = NULL;
+
+    if (atHead) {
+        node->next = list->head;
+        list->head = node;
+        if (list->tail == NULL) {
+            list->tail = node;
+        }
+        return;
+    }
+
+    if (list->tail == NULL) {
+        list->head = list->tail = node;
+        return;
+    }
+    if (list->tail->deliverAt <= node->deliverAt) {
+        list->tail->next = node;
+        list->tail = node;
+        return;
+    }
+
+    prev = NULL;
+    for (cur = list->head; cur != NULL && cur->deliverAt <= node->deliverAt;
+         cur = cur->next) {
+        prev = cur;
+    }
+    node->next = cur;
+    if (prev == NULL) {
+        list->head = node;
+    }
+    else {
+        prev->next = node;
+    }
+}
+
+Int MessageQ_put(MessageQ_QueueId queueId, MessageQ_Msg msg)
+{
+    UInt16 dstProc = (UInt16)(queueId >> 16);
+    UInt16 dstIndex = (UInt16)(queueId & 0xFFFF);
+    UInt16 srcProc = Loopback_procId;
+    MessageQ_Handle obj;
+    Loopback_Node *node = (Loopback_Node *)msg - 1;
+    Loopback_Link *link;
+    UInt64 now, start;
+    UInt32 pri;
+
+    if (dstProc >= Loopback_NUMPROCS || dstIndex >= Loopback_MAXQUEUES) {
+        return (MessageQ_E_INVALIDPROCID);
+    }
+
+    msg->dstProc = dstProc;
+    msg->dstId = dstIndex;
+    msg->srcProc = srcProc;
+    now = Loopback_now();
+    node->deliverAt = now;
+
+    /* crossing cores copies the message like the rpmsg transport does */
+    if (dstProc != srcProc) {
+        Loopback_Node *copy;
+
+        if (msg->msgSize > Loopback_MAXMSGSIZE) {
+            fprintf(stderr, "MessageQ_put: %u byte message exceeds the "
+                "%d byte transport limit\n", msg->msgSize,
+                Loopback_MAXMSGSIZE);
+            return (MessageQ_E_FAIL);
+        }
+
+        copy = malloc(sizeof(Loopback_Node) + msg->msgSize);
+        if (copy == NULL) {
+            return (MessageQ_E_MEMORY);
+        }
+        memcpy(copy + 1, msg, msg->msgSize);
+        copy->heap = NULL;
+        ((MessageQ_Msg)(copy + 1))->heapId = 0;
+
+        pthread_mutex_lock(&Module.lock);
+        link = &Module.links[srcProc][dstProc];
+        start = (link->busyUntil > now) ? link->busyUntil : now;
+        link->busyUntil = start + (UInt64)(Module.nsPerByte * msg->msgSize);
+        copy->deliverAt = link->busyUntil + Module.latencyNs;
+        pthread_mutex_unlock(&Module.lock);
+
+        Loopback_release(node);
+        node = copy;
+        msg = (MessageQ_Msg)(node + 1);
+    }
+
+    pthread_mutex_lock(&Module.lock);
+    obj = Module.queues[dstProc][dstIndex];
+    if (obj == NULL) {
+        pthread_mutex_unlock(&Module.lock);
+        Loopback_release(node);
+        return (MessageQ_E_FAIL);
+    }
+    pthread_mutex_lock(&obj->lock);
+    pthread_mutex_unlock(&Module.lock);
+
+    pri = MessageQ_getMsgPri(msg);
+    if (pri == MessageQ_NORMALPRI) {
+        Loopback_insert(&obj->normal, node, FALSE);
+    }
+    else {
+        Loopback_insert(&obj->high, node, pri == MessageQ_URGENTPRI);
+    }
+    obj->count++;
+    pthread_cond_broadcast(&obj->cond);
+    pthread_mutex_unlock(&obj->lock);
+
+    return (MessageQ_S_SUCCESS);
+}
+
+Int MessageQ_get(MessageQ_Handle obj, MessageQ_Msg *msg, UInt timeout)
+{
+    Loopback_List *list;
+    Loopback_Node *node;
+    UInt64 now, deadline = 0, wake;
+    Int status;
+
+    if (obj == NULL) {
+        return (MessageQ_E_INVALIDARG);
+    }
+    if (timeout != (UInt)MessageQ_FOREVER) {
+        deadline = Loopback_now() + Loopback_timeoutNs(timeout);
+    }
+
+    pthread_mutex_lock(&obj->lock);
+    for (;;) {
+        if (Module.shutdown && obj->procId != Loopback_HOSTID) {
+            status = MessageQ_E_SHUTDOWN;
+            break;
+        }
+        if (obj->unblocked) {
+            obj->unblocked = FALSE;
+            status = MessageQ_E_UNBLOCKED;
+            break;
+        }
+
+        now = Loopback_now();
+        if (obj->high.head != NULL && obj->high.head->deliverAt <= now) {
+            list = &obj->high;
+        }
+        else if (obj->normal.head != NULL &&
+                 obj->normal.head->deliverAt <= now) {
+            list = &obj->normal;
+        }
+        else {
+            list = NULL;
+        }
+
+        if (list != NULL) {
+            node = list->head;
+            list->head = node->next;
+            if (list->head == NULL) {
+                list->tail = NULL;
+            }
+            obj->count--;
+            *msg = (MessageQ_Msg)(node + 1);
+            status = MessageQ_S_SUCCESS;
+            break;
+        }
+
+        if (deadline != 0 && now >= deadline) {
+            status = MessageQ_E_TIMEOUT;
+            break;
+        }
+
+        /* sleep until the earliest pending delivery or the timeout */
+        wake = deadline;
+        if (obj->high.head != NULL &&
+            (wake == 0 || obj->high.head->deliverAt < wake)) {
+            wake = obj->high.head->deliverAt;
+        }
+        if (obj->normal.head != NULL &&
+            (wake == 0 || obj->normal.head->deliverAt < wake)) {
+            wake = obj->normal.head->deliverAt;
+        }
+        Loopback_condWait(&obj->cond, &obj->lock, wake);
+    }
+    pthread_mutex_unlock(&obj->lock);
+
+    if (status < 0) {
+        *msg = NULL;
+    }
+    return (status);
+}
+
+Int MessageQ_count(MessageQ_Handle obj)
+{
+    Int count;
+
+    pthread_mutex_lock(&obj->lock);
+    count = obj->count;
+    pthread_mutex_unlock(&obj->lock);
+
+    return (count);
+}
+
+MessageQ_QueueId MessageQ_getQueueId(MessageQ_Handle obj)
+{
+    return (((MessageQ_QueueId)obj->procId << 16) | obj->index);
+}
+
+Void MessageQ_setReplyQueue(MessageQ_Handle obj, MessageQ_Msg msg)
+{
+    msg->replyId = obj->index;
+    msg->replyProc = obj->procId;
+}
+
+Void MessageQ_unblock(MessageQ_Handle obj)
+{
+    pthread_mutex_lock(&obj->lock);
+    obj->unblocked = TRUE;
+    pthread_cond_broadcast(&obj->cond);
+    pthread_mutex_unlock(&obj->lock);
+}
+
+
+/*
+ *  ======== Timestamp / Clock ========
+ */
+Bits32 Timestamp_get32(Void)
+{
+    return ((Bits32)Loopback_now());
+}
+
+Void Timestamp_get64(Types_Timestamp64 *result)
+{
+    UInt64 now = Loopback_now();
+
+    result->hi = (Bits32)(now >> 32);
+    result->lo = (Bits32)now;
+}
+
+Void Timestamp_getFreq(Types_FreqHz *freq)
+{
+    freq->hi = 0;
+    freq->lo = 1000000000U;
+}
+
+UInt32 Clock_getTicks(Void)
+{
+    return ((UInt32)((Loopback_now() - Module.epoch) /
+        (Clock_tickPeriod * 1000ULL)));
+}
+
+
+/*
+ *  ======== BIOS / Task ========
+ */
+Void BIOS_start(Void)
+{
+    pthread_exit(NULL);
+}
+
+static Void *Loopback_taskMain(Void *arg)
+{
+    struct Task_Object *task = arg;
+
+    Loopback_procId = task->procId;
+    Loopback_task = task;
+    task->fxn(task->arg0, task->arg1);
+
+    return (NULL);
+}
+
+Void Task_Params_init(Task_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->instance = &params->__iprms;
+    params->priority = 1;
+    params->stackSize = 0x1000;
+}
+
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params,
+    Error_Block *eb)
+{
+    struct Task_Object *task;
+    Task_Params defaults;
+
+    if (params == NULL) {
+        Task_Params_init(&defaults);
+        params = &defaults;
+    }
+
+    task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        goto fail;
+    }
+    task->fxn = fxn;
+    task->arg0 = params->arg0;
+    task->arg1 = params->arg1;
+    task->priority = params->priority;
+    task->procId = Loopback_procId;
+    if (params->instance != NULL && params->instance->name != NULL) {
+        snprintf(task->name, sizeof(task->name), "%s", params->instance->name);
+    }
+
+    if (pthread_create(&task->thread, NULL, Loopback_taskMain, task) != 0) {
+        free(task);
+        goto fail;
+    }
+    pthread_detach(task->thread);
+    return (task);
+
+fail:
+    if (eb != NULL) {
+        eb->raised = TRUE;
+    }
+    return (NULL);
+}
+
+Void Task_delete(Task_Handle *handle)
+{
+    *handle = NULL;
+}
+
+Task_Handle Task_self(Void)
+{
+    return (Loopback_task);
+}
+
+Int Task_getPri(Task_Handle handle)
+{
+    return (handle != NULL ? handle->priority : -1);
+}
+
+Int Task_setPri(Task_Handle handle, Int newpri)
+{
+    Int old = handle->priority;
+
+    handle->priority = newpri;
+    return (old);
+}
+
+Void Task_sleep(UInt32 nticks)
+{
+    usleep((useconds_t)nticks * Clock_tickPeriod);
+}
+
+Void Task_yield(Void)
+{
+    sched_yield();
+}
+
+
+/*
+ *  ======== HeapBuf ========
+ */
+Void HeapBuf_Params_init(HeapBuf_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+HeapBuf_Handle HeapBuf_create(const HeapBuf_Params *params, Error_Block *eb)
+{
+    HeapBuf_Handle heap;
+
+    heap = calloc(1, sizeof(*heap));
+    if (heap == NULL || params->blockSize == 0 || params->numBlocks == 0) {
+        free(heap);
+        if (eb != NULL) {
+            eb->raised = TRUE;
+        }
+        return (NULL);
+    }
+    heap->blockSize = params->blockSize;
+    heap->numBlocks = params->numBlocks;
+
+    return (heap);
+}
+
+Void HeapBuf_delete(HeapBuf_Handle *handle)
+{
+    free(*handle);
+    *handle = NULL;
+}
+
+Void HeapBuf_getExtendedStats(HeapBuf_Handle handle,
+    HeapBuf_ExtendedStats *stats)
+{
+    pthread_mutex_lock(&Module.lock);
+    stats->maxAllocatedBlocks = handle->maxAllocated;
+    stats->numAllocatedBlocks = handle->numAllocated;
+    pthread_mutex_unlock(&Module.lock);
+}
+
+
+/*
+ *  ======== Semaphore ========
+ */
+Void Semaphore_Params_init(Semaphore_Params *params)
+{
+    params->mode = 0;
+}
+
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params,
+    Error_Block *eb)
+{
+    struct Semaphore_Object *sem = calloc(1, sizeof(*sem));
+
+    (Void)params;
+
+    if (sem == NULL) {
+        if (eb != NULL) {
+            eb->raised = TRUE;
+        }
+        return (NULL);
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    Loopback_condInit(&sem->cond);
+    sem->count = count;
+
+    return (sem);
+}
+
+Void Semaphore_delete(Semaphore_Handle *handle)
+{
+    pthread_cond_destroy(&(*handle)->cond);
+    pthread_mutex_destroy(&(*handle)->lock);
+    free(*handle);
+    *handle = NULL;
+}
+
+Bool Semaphore_pend(Semaphore_Handle sem, UInt32 timeout)
+{
+    UInt64 deadline = 0;
+    Bool taken = FALSE;
+
+    if (timeout != (UInt32)BIOS_WAIT_FOREVER) {
+        deadline = Loopback_now() +
+            (UInt64)timeout * Clock_tickPeriod * 1000ULL;
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    for (;;) {
+        if (sem->count > 0) {
+            sem->count--;
+            taken = TRUE;
+            break;
+        }
+        if (timeout == 0 || (deadline != 0 && Loopback_now() >= deadline)) {
+            break;
+        }
+        Loopback_condWait(&sem->cond, &sem->lock, deadline);
+    }
+    pthread_mutex_unlock(&sem->lock);
+
+    return (taken);
+}
+
+Void Semaphore_post(Semaphore_Handle sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+}
+
+Int Semaphore_getCount(Semaphore_Handle sem)
+{
+    return (sem->count);
+}
+
+
+/*
+ *  ======== CMEM ========
+ *  One pool of Loopback_CMEM_POOLSIZE at the start of the window, with
+ *  the remainder handed out as the CMA block.
+ */
+int CMEM_init(void)
+{
+    void *addr;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.cmemBase == NULL) {
+        addr = mmap((void *)Loopback_CMEM_BASE, Loopback_CMEM_SIZE,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE,
+            -1, 0);
+        if (addr != (void *)Loopback_CMEM_BASE) {
+            if (addr != MAP_FAILED) {
+                munmap(addr, Loopback_CMEM_SIZE);
+            }
+            pthread_mutex_unlock(&Module.lock);
+            fprintf(stderr, "CMEM_init: cannot map window at 0x%lx\n",
+                Loopback_CMEM_BASE);
+            return (-1);
+        }
+        Module.cmemBase = addr;
+        Module.cmemCmaNext = Loopback_CMEM_POOLSIZE;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (0);
+}
+
+int CMEM_exit(void)
+{
+    return (0);
+}
+
+int CMEM_getPool(unsigned long long size)
+{
+    return (size <= Loopback_CMEM_POOLSIZE ? 0 : -1);
+}
+
+void *CMEM_allocPool(int poolid, CMEM_AllocParams *params)
+{
+    void *ptr = NULL;
+
+    (Void)params;
+
+    pthread_mutex_lock(&Module.lock);
+    if (poolid == 0 && Module.cmemBase != NULL && !Module.cmemPoolBusy) {
+        Module.cmemPoolBusy = TRUE;
+        ptr = Module.cmemBase;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (ptr);
+}
+
+void *CMEM_alloc2(int blockid, size_t size, CMEM_AllocParams *params)
+{
+    size_t align = (params != NULL && params->alignment > 1) ?
+        params->alignment : 1;
+    size_t offset;
+    void *ptr = NULL;
+
+    (Void)blockid;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.cmemBase != NULL) {
+        offset = (Module.cmemCmaNext + align - 1) / align * align;
+        if (offset + size <= Loopback_CMEM_SIZE) {
+            ptr = Module.cmemBase + offset;
+            Module.cmemCmaNext = offset + size;
+        }
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (ptr);
+}
+
+void *CMEM_alloc(size_t size, CMEM_AllocParams *params)
+{
+    return (CMEM_alloc2(CMEM_CMABLOCKID, size, params));
+}
+
+int CMEM_free(void *ptr, CMEM_AllocParams *params)
+{
+    (Void)params;
+
+    pthread_mutex_lock(&Module.lock);
+    if (ptr == Module.cmemBase) {
+        Module.cmemPoolBusy = FALSE;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (0);
+}
+
+off_t CMEM_getPhys(void *ptr)
+{
+    return ((off_t)(UArg)ptr);
+}
+
+int CMEM_cacheWb(void *ptr, size_t size)
+{
+    (Void)ptr;
+    (Void)size;
+    return (0);
+}
+
+int CMEM_cacheInv(void *ptr, size_t size)
+{
+    (Void)ptr;
+    (Void)size;
+    return (0);
+}
+
+int CMEM_cacheWbInv(void *ptr, size_t size)
+{
+    (Void)ptr;
+    (Void)size;
+    return (0);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file RtSched.cpp
+ * @brief Implementation of the real-time scheduling and memory locking helper.
+ * @version 0.1
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "RtSched.h"
+
+tcRtSched::tcRtSched()
+: priority(0), pinned(false), isLocked(false), prefaulted(0)
+{
+	CPU_ZERO(&cpus);
+	memset(&start, 0, sizeof(start));
+}
+
+tcRtSched::~tcRtSched() {
+	if (isLocked) {
+		munlockall();
+	}
+}
+
+int tcRtSched::setPriority(int prio) {
+	int min = sched_get_priority_min(SCHED_FIFO);
+	int max = sched_get_priority_max(SCHED_FIFO);
+	if (prio < min || prio > max) {
+		printf("%s: priority %d is not in %d..%d\n", __func__, prio, min, max);
+		return -1;
+	}
+
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = prio;
+	int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (err) {
+		printf("%s: SCHED_FIFO %d failed. %s\n", __func__, prio, strerror(err));
+		return -1;
+	}
+
+	priority = prio;
+	return 0;
+}
+
+int tcRtSched::setCpus(const char* list) {
+	long ncpu = sysconf(_SC_NPROCESSORS_CONF);
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	// "1", "0,1" or "0-1"
+	const char* p = list;
+	while (*p) {
+		char* end;
+		long first = strtol(p, &end, 10);
+		long last = first;
+		if (end == p)
+			break;
+		if (*end == '-') {
+			p = end + 1;
+			last = strtol(p, &end, 10);
+			if (end == p)
+				break;
+		}
+		for (long cpu = first; cpu <= last; cpu++) {
+			if (cpu < 0 || cpu >= ncpu || cpu >= CPU_SETSIZE) {
+				printf("%s: CPU %ld is not one of the %ld CPUs\n", __func__,
+					cpu, ncpu);
+				return -1;
+			}
+			CPU_SET(cpu, &set);
+		}
+		if (*end != ',') {
+			p = end;
+			break;
+		}
+		p = end + 1;
+	}
+	if (*p || !CPU_COUNT(&set)) {
+		printf("%s: bad CPU list '%s', expected e.g. 1, 0,1 or 0-1\n",
+			__func__, list);
+		return -1;
+	}
+
+	int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (err) {
+		printf("%s: pinning to %s failed. %s\n", __func__, list, strerror(err));
+		return -1;
+	}
+
+	cpus = set;
+	pinned = true;
+	return 0;
+}
+
+int tcRtSched::lockMemory() {
+	if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+		printf("%s: mlockall failed. %s\n", __func__, strerror(errno));
+		return -1;
+	}
+	isLocked = true;
+	return 0;
+}
+
+void tcRtSched::prefault(void* base, size_t size) {
+	long page = sysconf(_SC_PAGESIZE);
+	volatile const uint8_t* p = (volatile const uint8_t*)base;
+	for (size_t off = 0; off < size; off += page) {
+		(void)p[off];
+	}
+	prefaulted += size;
+}
+
+void tcRtSched::usageStart() {
+	getrusage(RUSAGE_SELF, &start);
+}
+
+void tcRtSched::usageReport(const char* what) {
+	struct rusage now;
+	getrusage(RUSAGE_SELF, &now);
+	printf("Faults during %s: %ld minor, %ld major\n", what,
+		now.ru_minflt - start.ru_minflt, now.ru_majflt - start.ru_majflt);
+	printf("Context switches during %s: %ld voluntary, %ld involuntary\n",
+		what, now.ru_nvcsw - start.ru_nvcsw, now.ru_nivcsw - start.ru_nivcsw);
+}
+
+void tcRtSched::report() {
+	if (priority) {
+		printf("Scheduling: SCHED_FIFO priority %d", priority);
+	} else {
+		printf("Scheduling: SCHED_OTHER");
+	}
+	if (pinned) {
+		printf(", CPUs");
+		const char* sep = " ";
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &cpus)) {
+				printf("%s%d", sep, cpu);
+				sep = ",";
+			}
+		}
+	} else {
+		printf(", any CPU");
+	}
+	if (isLocked) {
+		printf(", memory locked, %u KB pre-faulted\n",
+			(unsigned)(prefaulted / 1024));
+	} else {
+		printf(", memory not locked\n");
+	}
+}
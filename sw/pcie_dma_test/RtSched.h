@@ -0,0 +1,91 @@
+/**
+ * @file RtSched.h
+ * @brief definition of the real-time scheduling and memory locking helper.
+ * @version 0.1
+ *
+ */
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+/**
+ * @brief SCHED_FIFO priority, CPU pinning and memory locking for the test
+ * thread, with the page faults and context switches over a measurement.
+ *
+ */
+class tcRtSched {
+public:
+	tcRtSched();
+
+	~tcRtSched();
+
+	/**
+	 * Run the calling thread SCHED_FIFO.
+	 *
+	 * \param prio 1 to 99, needs root or CAP_SYS_NICE
+	 * \return 0 on success
+	 */
+	int setPriority(int prio);
+
+	/**
+	 * Pin the calling thread.
+	 *
+	 * \param cpus CPU list, e.g. "1", "0,1" or "0-1"
+	 * \return 0 on success
+	 */
+	int setCpus(const char* cpus);
+
+	/**
+	 * mlockall the process, current and future mappings.
+	 *
+	 * \return 0 on success
+	 */
+	int lockMemory();
+
+	/**
+	 * Read a word of every page of a buffer so its page tables are filled
+	 * in before it is timed. Only reads, a CMEM buffer is left clean.
+	 *
+	 * \param base start of the buffer
+	 * \param size bytes
+	 */
+	void prefault(void* base, size_t size);
+
+	/**
+	 * Start counting page faults and context switches.
+	 */
+	void usageStart();
+
+	/**
+	 * Print the page faults and context switches since usageStart().
+	 *
+	 * \param what the measurement, e.g. "DMA"
+	 */
+	void usageReport(const char* what);
+
+	/**
+	 * Print the policy the thread runs with.
+	 */
+	void report();
+
+	bool locked() const { return isLocked; }
+
+private:
+	int priority;
+
+	cpu_set_t cpus;
+
+	bool pinned;
+
+	bool isLocked;
+
+	size_t prefaulted;
+
+	struct rusage start;
+};
+
+#endif
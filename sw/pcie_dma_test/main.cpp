@@ -24,6 +24,7 @@
 
 #include "FpgaPcieDma.h"
 #include "TestPatternStream.h"
+#include "RtSched.h"
 
 /**
  * @brief Check memory region used by DMA test pattern for correct results.
@@ -60,13 +61,39 @@ void checkDmaMem(uint16_t* dma_mem, uint32_t num16bWords, uint32_t startVal) {
  */
 int main(int argc, char*argv[]) {
 
-	if (argc < 2) {
-		printf("usage pcie_dma_test num_bytes\n");
+	tcRtSched sched;
+	int opt;
+	while ((opt = getopt(argc, argv, "P:C:M")) != -1) {
+		switch (opt) {
+		case 'P':
+			if (sched.setPriority(strtol(optarg, NULL, 0)))
+				return -1;
+			break;
+		case 'C':
+			if (sched.setCpus(optarg))
+				return -1;
+			break;
+		case 'M':
+			if (sched.lockMemory())
+				return -1;
+			break;
+		default:
+			optind = argc;
+			break;
+		}
+	}
+
+	if (optind >= argc) {
+		printf("usage pcie_dma_test [-P priority] [-C cpus] [-M] num_bytes\n");
+		printf("  -P  run SCHED_FIFO at priority 1..99 while waiting on the DMA\n");
+		printf("  -C  pin to a CPU list, e.g. 1 or 0,1 or 0-1\n");
+		printf("  -M  lock memory (mlockall) and pre-fault the CMEM buffer\n");
 		printf("ex: ./pcie_dma_test 0x100000\n");
+		printf("ex: ./pcie_dma_test -P 80 -C 1 -M 0x100000\n");
 		return -1;
 	}
 
-	uint32_t num_bytes = strtoul(argv[1], NULL, 0);
+	uint32_t num_bytes = strtoul(argv[optind], NULL, 0);
 	uint32_t tp_offset = 0x200;
 	uint32_t dma_offset = 0x180;
 
@@ -91,6 +118,11 @@ int main(int argc, char*argv[]) {
 	}
 	uint32_t start_addr = CMEM_getPhys(cmem_memory);
 	printf("CMEM allocated 0x%08X bytes at physical address 0x%08X for %p\n", num_bytes, start_addr, cmem_memory);
+
+	// fill in the page tables now rather than while checking the results
+	if (sched.locked())
+		sched.prefault(cmem_memory, num_bytes);
+	sched.report();
 	
 	printf("Constructing DMA class.\n");
 	tcFpgaPcieDma dma(0x01000000, dma_offset);
@@ -126,6 +158,7 @@ int main(int argc, char*argv[]) {
 	printf("Starting DMAs.\n");
 	printf("\n");
 	
+	sched.usageStart();
 	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
 	tp_stream.reset(false);
@@ -134,6 +167,7 @@ int main(int argc, char*argv[]) {
 	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 
 	float dur_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+	sched.usageReport("DMA");
 
 	float num_mbytes_total = num_bytes;
 	num_mbytes_total /= 1000000.0f;
@@ -0,0 +1,237 @@
+/*
+ *  ======== Jobs.c ========
+ *  DSP side of the job queue in CMEM.
+ *
+ *  The region is uncached on the DSP (its MAR bits are cleared before a
+ *  run), so every access goes to DDR and the only ordering needed is a
+ *  fence between a write and a read that depends on it being seen. The
+ *  bakery lock is Lamport's: take a ticket one above every ticket in
+ *  use, then wait for each core that is choosing or holds a lower
+ *  ticket. Two locks are always taken in core order.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+
+#if defined(_TMS320C6X)
+#include <c6x.h>
+#define Jobs_fence() _mfence()
+#else
+#define Jobs_fence() __sync_synchronize()
+#endif
+
+/* package header files */
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "Trace.h"
+
+/* module header file */
+#include "Jobs.h"
+
+#define Jobs_NONE 0xFFFFFFFF
+
+
+/*
+ *  ======== Jobs_kernel ========
+ *  work LCG steps from seed, the host checks the result the same way.
+ */
+UInt32 Jobs_kernel(UInt32 work, UInt32 seed)
+{
+    UInt32 x = seed;
+    UInt32 i;
+
+    for (i = 0; i < work; i++) {
+        x = x * 1664525 + 1013904223;
+    }
+
+    return (x);
+}
+
+/*
+ *  ======== Jobs_lock ========
+ */
+static Void Jobs_lock(App_JobLock *lock, UInt32 me, UInt32 numCores)
+{
+    UInt32 ticket = 0;
+    UInt32 i, n;
+
+    lock->choosing[me] = 1;
+    Jobs_fence();
+    for (i = 0; i < numCores; i++) {
+        n = lock->number[i];
+        ticket = (n > ticket) ? n : ticket;
+    }
+    lock->number[me] = ticket + 1;
+    Jobs_fence();
+    lock->choosing[me] = 0;
+    Jobs_fence();
+
+    for (i = 0; i < numCores; i++) {
+        if (i == me) {
+            continue;
+        }
+        while (lock->choosing[i] != 0) {
+        }
+        for (;;) {
+            n = lock->number[i];
+            if (n == 0 || n > ticket + 1 || (n == ticket + 1 && i > me)) {
+                break;
+            }
+        }
+    }
+}
+
+/*
+ *  ======== Jobs_unlock ========
+ */
+static Void Jobs_unlock(App_JobLock *lock, UInt32 me)
+{
+    Jobs_fence();
+    lock->number[me] = 0;
+    Jobs_fence();
+}
+
+/*
+ *  ======== Jobs_take ========
+ *  The next job of the core's own deque, Jobs_NONE when it is empty.
+ */
+static UInt32 Jobs_take(App_JobQueue *queue, UInt32 me, Jobs_Stats *stats)
+{
+    App_JobDeque *deque = &queue->deques[me];
+    UInt32 start = Timestamp_get32();
+    UInt32 job = Jobs_NONE;
+
+    Jobs_lock(&deque->lock, me, queue->numCores);
+    if (deque->head < deque->tail) {
+        job = deque->head;
+        deque->head = job + 1;
+    }
+    Jobs_unlock(&deque->lock, me);
+    stats->lockTicks += Timestamp_get32() - start;
+
+    return (job);
+}
+
+/*
+ *  ======== Jobs_steal ========
+ *  Move the top half of the fullest other deque into the core's own,
+ *  which is empty. FALSE once a look round finds every deque empty;
+ *  a range stolen meanwhile by a third core is that core's to run.
+ */
+static Bool Jobs_steal(App_JobQueue *queue, UInt32 me, Jobs_Stats *stats)
+{
+    App_JobDeque *mine = &queue->deques[me];
+    App_JobDeque *victim;
+    App_JobDeque *first;
+    App_JobDeque *second;
+    UInt32 start, best, most, left, take, i;
+
+    for (;;) {
+        /* a glance without the locks picks the victim */
+        best = me;
+        most = 0;
+        for (i = 0; i < queue->numCores; i++) {
+            victim = &queue->deques[i];
+            left = victim->tail - victim->head;
+            if (i != me && victim->head < victim->tail && left > most) {
+                best = i;
+                most = left;
+            }
+        }
+        if (best == me) {
+            return (FALSE);
+        }
+
+        start = Timestamp_get32();
+        victim = &queue->deques[best];
+        first = (best < me) ? victim : mine;
+        second = (best < me) ? mine : victim;
+        Jobs_lock(&first->lock, me, queue->numCores);
+        Jobs_lock(&second->lock, me, queue->numCores);
+
+        take = 0;
+        if (victim->head < victim->tail) {
+            take = (victim->tail - victim->head + 1) / 2;
+            mine->tail = victim->tail;
+            victim->tail -= take;
+            mine->head = victim->tail;
+        }
+
+        Jobs_unlock(&second->lock, me);
+        Jobs_unlock(&first->lock, me);
+        stats->lockTicks += Timestamp_get32() - start;
+
+        /* the owner or another thief got there first, look again */
+        if (take > 0) {
+            stats->steals++;
+            stats->stolen += take;
+            return (TRUE);
+        }
+    }
+}
+
+/*
+ *  ======== Jobs_complete ========
+ *  Put a result in the core's ring, once the host has made room.
+ */
+static Void Jobs_complete(App_JobRing *ring, UInt32 job, UInt32 result,
+        Jobs_Stats *stats)
+{
+    UInt32 write = ring->write;
+    UInt32 start;
+
+    if (write - ring->read >= App_JOBS_RING_SIZE) {
+        start = Timestamp_get32();
+        while (write - ring->read >= App_JOBS_RING_SIZE) {
+        }
+        stats->ringTicks += Timestamp_get32() - start;
+    }
+
+    ring->done[write & (App_JOBS_RING_SIZE - 1)].job = job;
+    ring->done[write & (App_JOBS_RING_SIZE - 1)].result = result;
+    Jobs_fence();
+    ring->write = write + 1;
+}
+
+/*
+ *  ======== Jobs_run ========
+ *  Run jobs from the core's own deque, stealing when it runs dry, until
+ *  every deque is empty.
+ */
+Void Jobs_run(App_JobQueue *queue, UInt32 core, Jobs_Stats *stats)
+{
+    App_Job *table = (App_Job *)(queue + 1);
+    App_JobRing *ring = &queue->rings[core];
+    UInt32 job, work, seed, result, start;
+
+    stats->jobs = 0;
+    stats->stolen = 0;
+    stats->steals = 0;
+    stats->busyTicks = 0;
+    stats->lockTicks = 0;
+    stats->ringTicks = 0;
+
+    for (;;) {
+        job = Jobs_take(queue, core, stats);
+
+        if (job == Jobs_NONE) {
+            if (!Jobs_steal(queue, core, stats)) {
+                break;
+            }
+            continue;
+        }
+
+        work = table[job].work;
+        seed = table[job].seed;
+        Trace_event(App_TRACE_JOB_BEGIN, job, work);
+        start = Timestamp_get32();
+        result = Jobs_kernel(work, seed);
+        stats->busyTicks += Timestamp_get32() - start;
+        stats->jobs++;
+        Trace_event(App_TRACE_JOB_END, job, work);
+
+        Jobs_complete(ring, job, result, stats);
+    }
+}
@@ -1,3 +1,5 @@
+#include <stdlib.h>
+
 #include "RingBuffer.h"
 
 RingBuffer* RingBuffer_initialize(UInt32 phyStart, UInt32 ringBufferSize)
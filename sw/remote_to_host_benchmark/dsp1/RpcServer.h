@@ -0,0 +1,21 @@
+/*
+ *  ======== RpcServer.h ========
+ *  DSP side of the typed calls in Rpc.h.
+ */
+
+#ifndef RpcServer__include
+#define RpcServer__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+Void RpcServer_dispatch(Rpc_Msg *msg);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* RpcServer__include */
@@ -0,0 +1,96 @@
+/*
+ *  ======== Trace.c ========
+ *  DSP side of the trace ring in CMEM.
+ *
+ *  The ring is uncached on the DSP (the server clears its MAR bits before
+ *  Trace_start), so an event is written straight to DDR and the only
+ *  ordering needed is a fence between the event and the write count that
+ *  publishes it. The server task is the only writer. The host's read
+ *  count is an uncached load, so it is only fetched again when the ring
+ *  looks full from the last one seen.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+
+#if defined(_TMS320C6X)
+#include <c6x.h>
+#define Trace_fence() _mfence()
+#else
+#define Trace_fence() __sync_synchronize()
+#endif
+
+/* package header files */
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+
+/* module header file */
+#include "Trace.h"
+
+/* module structure */
+typedef struct {
+    App_TraceRing *     ring;       // NULL while the trace is off
+    UInt32              write;      // events written
+    UInt32              read;       // host's read count, last seen
+    UInt32              dropped;
+} Trace_Module;
+
+/* private data */
+static Trace_Module Module;
+
+
+/*
+ *  ======== Trace_start ========
+ *  Write events to ring from now on, the host has cleared it.
+ */
+Void Trace_start(App_TraceRing *ring)
+{
+    Module.write = ring->write;
+    Module.read = ring->read;
+    Module.dropped = ring->dropped;
+    Module.ring = ring;
+}
+
+/*
+ *  ======== Trace_stop ========
+ *  Stop writing events, the ring keeps its counts for the host.
+ */
+Void Trace_stop(Void)
+{
+    Module.ring = NULL;
+}
+
+/*
+ *  ======== Trace_event ========
+ */
+Void Trace_event(UInt32 id, UInt32 arg0, UInt32 arg1)
+{
+    App_TraceRing *ring = Module.ring;
+    App_TraceEvent *ev;
+    Types_Timestamp64 stamp;
+
+    if (ring == NULL) {
+        return;
+    }
+    Timestamp_get64(&stamp);
+
+    if (Module.write - Module.read >= App_TRACE_RING_SIZE) {
+        Module.read = ring->read;
+        if (Module.write - Module.read >= App_TRACE_RING_SIZE) {
+            ring->dropped = ++Module.dropped;
+            return;
+        }
+    }
+
+    ev = &ring->events[Module.write & (App_TRACE_RING_SIZE - 1)];
+    ev->stampHi = stamp.hi;
+    ev->stampLo = stamp.lo;
+    ev->id = id;
+    ev->arg0 = arg0;
+    ev->arg1 = arg1;
+    Trace_fence();
+    ring->write = ++Module.write;
+}
@@ -0,0 +1,24 @@
+/*
+ *  ======== Trace.h ========
+ *  DSP side of the trace ring in CMEM: binary events for the host to
+ *  drain, App_CMD_TRACE.
+ */
+
+#ifndef Trace__include
+#define Trace__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+Void Trace_start(App_TraceRing *ring);
+Void Trace_stop(Void);
+Void Trace_event(UInt32 id, UInt32 arg0, UInt32 arg1);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Trace__include */
@@ -0,0 +1,33 @@
+/*
+ *  ======== Jobs.h ========
+ *  DSP side of the job queue in CMEM: pull, steal and complete jobs, and
+ *  the kernel a job runs.
+ */
+
+#ifndef Jobs__include
+#define Jobs__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* one core's run of the queue, in Timestamp ticks */
+typedef struct {
+    UInt32  jobs;
+    UInt32  stolen;         /* jobs taken from other deques */
+    UInt32  steals;
+    UInt64  busyTicks;      /* in the kernel */
+    UInt64  lockTicks;      /* taking and holding locks */
+    UInt64  ringTicks;      /* waiting for room in the ring */
+} Jobs_Stats;
+
+UInt32 Jobs_kernel(UInt32 work, UInt32 seed);
+Void Jobs_run(App_JobQueue *queue, UInt32 core, Jobs_Stats *stats);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Jobs__include */
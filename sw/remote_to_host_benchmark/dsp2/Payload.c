@@ -0,0 +1,240 @@
+/*
+ *  ======== Payload.c ========
+ *  DSP fill and check of the ramp payload, for every element width.
+ *
+ *  Element i of buffer seq holds the low bits of i + seq, in elements of
+ *  App_ELEM_8 to App_ELEM_64 bytes. The plain C kernels are instantiated
+ *  once per width by Payload_KERNELS. Built for the C66x, the 8, 16 and
+ *  32 bit widths also get a packed kernel that handles a double word per
+ *  iteration: the next eight bytes of the ramp are kept as two words and
+ *  advanced with _add4/_add2, so one aligned _amem8 access covers up to
+ *  eight elements. The packed check XORs every double word against the
+ *  ramp and only counts the bad elements with the plain kernel when the
+ *  OR of all differences is non-zero.
+ */
+
+#include <xdc/std.h>
+
+#if defined(_TMS320C6X)
+#include <c6x.h>
+#endif
+
+/* package header files */
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+
+/* module header file */
+#include "Payload.h"
+
+/*
+ *  ======== Payload_KERNELS ========
+ *  Plain kernels for elements of type T, over elements [from, n).
+ */
+#define Payload_KERNELS(T, bits)                                            \
+static Void Payload_fill##bits(T *p, UInt32 from, UInt32 n, UInt32 seq)     \
+{                                                                           \
+    UInt32 i;                                                               \
+                                                                            \
+    for (i = from; i < n; i++) {                                            \
+        p[i] = (T)(i + seq);                                                \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static UInt32 Payload_count##bits(const T *p, UInt32 from, UInt32 n,        \
+        UInt32 seq)                                                         \
+{                                                                           \
+    UInt32 i, errors = 0;                                                   \
+                                                                            \
+    for (i = from; i < n; i++) {                                            \
+        if (p[i] != (T)(i + seq)) {                                         \
+            errors++;                                                       \
+        }                                                                   \
+    }                                                                       \
+    return errors;                                                          \
+}
+
+Payload_KERNELS(UInt8, 8)
+Payload_KERNELS(UInt16, 16)
+Payload_KERNELS(UInt32, 32)
+Payload_KERNELS(UInt64, 64)
+
+#if defined(_TMS320C6X)
+
+#define Payload_ADD32(a, b) ((a) + (b))
+
+/*
+ *  ======== Payload_PACKED ========
+ *  Packed kernels over whole double words; lo and hi hold the first
+ *  double word of the ramp and ADD advances each by step.
+ */
+#define Payload_PACKED(bits, ADD)                                           \
+static Void Payload_fillPacked##bits(Ptr data, UInt32 words, UInt32 lo,     \
+        UInt32 hi, UInt32 step)                                             \
+{                                                                           \
+    long long *p = (long long *)data;                                       \
+    UInt32 i;                                                               \
+                                                                            \
+    for (i = 0; i < words; i++) {                                           \
+        _amem8(&p[i]) = _itoll(hi, lo);                                     \
+        lo = ADD(lo, step);                                                 \
+        hi = ADD(hi, step);                                                 \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static Bool Payload_checkPacked##bits(Ptr data, UInt32 words, UInt32 lo,    \
+        UInt32 hi, UInt32 step)                                             \
+{                                                                           \
+    const long long *p = (const long long *)data;                           \
+    long long acc = 0;                                                      \
+    UInt32 i;                                                               \
+                                                                            \
+    for (i = 0; i < words; i++) {                                           \
+        acc |= _amem8_const(&p[i]) ^ _itoll(hi, lo);                        \
+        lo = ADD(lo, step);                                                 \
+        hi = ADD(hi, step);                                                 \
+    }                                                                       \
+    return acc == 0;                                                        \
+}
+
+Payload_PACKED(8, _add4)
+Payload_PACKED(16, _add2)
+Payload_PACKED(32, Payload_ADD32)
+
+/*
+ *  ======== Payload_packedStart ========
+ *  The first double word of the ramp as two words, and the step that
+ *  moves them on to the next. FALSE when the width has no packed kernel.
+ */
+static Bool Payload_packedStart(UInt32 elemSize, UInt32 seq, UInt32 *lo,
+        UInt32 *hi, UInt32 *step)
+{
+    UInt32 base;
+
+    switch (elemSize) {
+        case App_ELEM_8:
+            base = (seq & 0xFF) * 0x01010101;
+            *lo = _add4(base, 0x03020100);
+            *hi = _add4(base, 0x07060504);
+            *step = 0x08080808;
+            return TRUE;
+
+        case App_ELEM_16:
+            base = (seq & 0xFFFF) * 0x00010001;
+            *lo = _add2(base, 0x00010000);
+            *hi = _add2(base, 0x00030002);
+            *step = 0x00040004;
+            return TRUE;
+
+        case App_ELEM_32:
+            *lo = seq;
+            *hi = seq + 1;
+            *step = 2;
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+#endif /* _TMS320C6X */
+
+
+/*
+ *  ======== Payload_isValidElemSize ========
+ */
+Bool Payload_isValidElemSize(UInt32 elemSize)
+{
+    return (elemSize == App_ELEM_8 || elemSize == App_ELEM_16 ||
+        elemSize == App_ELEM_32 || elemSize == App_ELEM_64);
+}
+
+/*
+ *  ======== Payload_fill ========
+ *  Write the ramp for buffer seq over len bytes.
+ */
+Void Payload_fill(Ptr data, UInt32 len, UInt32 elemSize, UInt32 seq)
+{
+    UInt32 n = len / elemSize;
+    UInt32 done = 0;
+#if defined(_TMS320C6X)
+    UInt32 lo, hi, step, words;
+
+    if (((UInt32)data & 7) == 0 &&
+            Payload_packedStart(elemSize, seq, &lo, &hi, &step)) {
+        words = len / 8;
+        switch (elemSize) {
+            case App_ELEM_8:
+                Payload_fillPacked8(data, words, lo, hi, step);
+                break;
+            case App_ELEM_16:
+                Payload_fillPacked16(data, words, lo, hi, step);
+                break;
+            case App_ELEM_32:
+                Payload_fillPacked32(data, words, lo, hi, step);
+                break;
+        }
+        done = words * 8 / elemSize;
+    }
+#endif
+
+    /* whatever the packed kernel did not cover */
+    switch (elemSize) {
+        case App_ELEM_8:
+            Payload_fill8((UInt8 *)data, done, n, seq);
+            break;
+        case App_ELEM_16:
+            Payload_fill16((UInt16 *)data, done, n, seq);
+            break;
+        case App_ELEM_32:
+            Payload_fill32((UInt32 *)data, done, n, seq);
+            break;
+        default:
+            Payload_fill64((UInt64 *)data, done, n, seq);
+            break;
+    }
+}
+
+/*
+ *  ======== Payload_verify ========
+ *  Check the ramp for buffer seq over len bytes, returns the bad elements.
+ */
+UInt32 Payload_verify(Ptr data, UInt32 len, UInt32 elemSize, UInt32 seq)
+{
+    UInt32 n = len / elemSize;
+    UInt32 done = 0;
+#if defined(_TMS320C6X)
+    UInt32 lo, hi, step, words;
+    Bool ok = FALSE;
+
+    if (((UInt32)data & 7) == 0 &&
+            Payload_packedStart(elemSize, seq, &lo, &hi, &step)) {
+        words = len / 8;
+        switch (elemSize) {
+            case App_ELEM_8:
+                ok = Payload_checkPacked8(data, words, lo, hi, step);
+                break;
+            case App_ELEM_16:
+                ok = Payload_checkPacked16(data, words, lo, hi, step);
+                break;
+            case App_ELEM_32:
+                ok = Payload_checkPacked32(data, words, lo, hi, step);
+                break;
+        }
+        /* on a mismatch everything is counted again below */
+        done = ok ? words * 8 / elemSize : 0;
+    }
+#endif
+
+    switch (elemSize) {
+        case App_ELEM_8:
+            return Payload_count8((UInt8 *)data, done, n, seq);
+        case App_ELEM_16:
+            return Payload_count16((UInt16 *)data, done, n, seq);
+        case App_ELEM_32:
+            return Payload_count32((UInt32 *)data, done, n, seq);
+        default:
+            return Payload_count64((UInt64 *)data, done, n, seq);
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ *  ======== Payload.h ========
+ *  DSP fill and check of the ramp payload, for every element width.
+ */
+
+#ifndef Payload__include
+#define Payload__include
+
+#include <xdc/std.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+Bool Payload_isValidElemSize(UInt32 elemSize);
+Void Payload_fill(Ptr data, UInt32 len, UInt32 elemSize, UInt32 seq);
+UInt32 Payload_verify(Ptr data, UInt32 len, UInt32 elemSize, UInt32 seq);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Payload__include */
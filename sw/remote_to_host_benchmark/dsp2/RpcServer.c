@@ -0,0 +1,149 @@
+/*
+ *  ======== RpcServer.c ========
+ *  DSP side of the typed calls in Rpc.h.
+ *
+ *  Every call in Rpc_CALLS is a static RpcServer_<name> here; a call
+ *  added to the schema without one does not build. The dispatch copies
+ *  the arguments out of the message first, so a call may write its
+ *  results over them, and the message goes back as the reply.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+
+#include <string.h>
+
+/* package header files */
+#include <ti/ipc/MessageQ.h>
+#include <ti/sysbios/hal/Cache.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "../shared/Rpc.h"
+
+/* module header file */
+#include "RpcServer.h"
+
+/* one handler per call */
+#define RpcServer_DECLARE(name, id) \
+    static Int RpcServer_##name(const Rpc_##name##_In *in, \
+            Rpc_##name##_Out *out);
+Rpc_CALLS(RpcServer_DECLARE)
+#undef RpcServer_DECLARE
+
+
+/*
+ *  ======== RpcServer_dispatch ========
+ */
+Void RpcServer_dispatch(Rpc_Msg *msg)
+{
+    UInt32 size = MessageQ_getMsgSize(msg);
+    UInt32 start = Timestamp_get32();
+    Int status;
+
+    switch (msg->cmd & ~App_CMD_MASK) {
+
+#define RpcServer_CASE(name, id) \
+        case id: \
+            if (size < Rpc_MSG_SIZE(Rpc_ARGS_SIZE(name))) { \
+                status = Rpc_E_SIZE; \
+            } \
+            else { \
+                Rpc_##name##_In in; \
+                memcpy(&in, msg->args, sizeof(in)); \
+                status = RpcServer_##name(&in, \
+                    (Rpc_##name##_Out *)msg->args); \
+            } \
+            break;
+        Rpc_CALLS(RpcServer_CASE)
+#undef RpcServer_CASE
+
+        default:
+            status = Rpc_E_CALL;
+            break;
+    }
+
+    msg->status = status;
+    msg->ticks = Timestamp_get32() - start;
+}
+
+/*
+ *  ======== RpcServer_bytes ========
+ *  Sum of size bytes.
+ */
+static UInt32 RpcServer_bytes(const UInt8 *data, UInt32 size)
+{
+    UInt32 sum = 0;
+    UInt32 i;
+
+    for (i = 0; i < size; i++) {
+        sum += data[i];
+    }
+
+    return (sum);
+}
+
+/*
+ *  ======== RpcServer_info ========
+ */
+static Int RpcServer_info(const Rpc_info_In *in, Rpc_info_Out *out)
+{
+    Types_FreqHz freq;
+
+    Timestamp_getFreq(&freq);
+    out->version = Rpc_VERSION;
+    out->tsFreq = freq.lo;
+
+    return (in->version == Rpc_VERSION ? Rpc_S_SUCCESS : Rpc_E_VERSION);
+}
+
+/*
+ *  ======== RpcServer_echo ========
+ */
+static Int RpcServer_echo(const Rpc_echo_In *in, Rpc_echo_Out *out)
+{
+    out->value = in->value;
+
+    return (Rpc_S_SUCCESS);
+}
+
+/*
+ *  ======== RpcServer_add ========
+ */
+static Int RpcServer_add(const Rpc_add_In *in, Rpc_add_Out *out)
+{
+    out->sum = in->a + in->b;
+
+    return (Rpc_S_SUCCESS);
+}
+
+/*
+ *  ======== RpcServer_sum ========
+ */
+static Int RpcServer_sum(const Rpc_sum_In *in, Rpc_sum_Out *out)
+{
+    if (in->size > Rpc_SUM_MAX) {
+        return (Rpc_E_ARGS);
+    }
+    out->sum = RpcServer_bytes(in->data, in->size);
+
+    return (Rpc_S_SUCCESS);
+}
+
+/*
+ *  ======== RpcServer_sumBulk ========
+ *  The host wrote the buffer back, drop any stale lines before reading.
+ */
+static Int RpcServer_sumBulk(const Rpc_sumBulk_In *in, Rpc_sumBulk_Out *out)
+{
+    UInt8 *data = (UInt8 *)in->data.phys;
+
+    if (data == NULL) {
+        return (Rpc_E_ARGS);
+    }
+    Cache_inv(data, in->data.size, Cache_Type_ALL, TRUE);
+    out->sum = RpcServer_bytes(data, in->data.size);
+
+    return (Rpc_S_SUCCESS);
+}
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2013-2014, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *  ======== Server.c ========
+ *
+ */
+
+/* this define must precede inclusion of any xdc header file */
+#define Registry_CURDESC Test__Desc
+#define MODULE_NAME "Server"
+
+/* xdctools header files */
+#include <xdc/std.h>
+#include <xdc/runtime/Assert.h>
+#include <xdc/runtime/Diags.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/Registry.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* package header files */
+#include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
+
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Cache.h>
+
+/* only the MAR control is needed from the family cache module */
+#define ti_sysbios_family_c66_Cache__nolocalnames
+#include <ti/sysbios/family/c66/Cache.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "RingBuffer.h"
+#include "Payload.h"
+#include "Jobs.h"
+#include "../shared/Rpc.h"
+#include "RpcServer.h"
+#include "Trace.h"
+
+/* module header file */
+#include "Server.h"
+
+/* module structure */
+typedef struct {
+    UInt16              hostProcId;         // host processor id
+    MessageQ_Handle     slaveQue;           // created locally
+    UInt32              tsFreq;             // Timestamp ticks per second
+    UInt32              jobsPhys;           // job queue region made uncached
+    UInt32              jobsSize;
+} Server_Module;
+
+/* credits the host has granted for the current loop */
+typedef struct {
+    Bool                limited;            // FALSE: host sent no credits
+    UInt32              credits;            // buffers the DSP may still send
+    UInt32              stalls;             // times the DSP ran out
+    UInt64              stallTicks;         // time spent out of credits
+    Bool                stalled;
+    Bits32              stallStart;
+} Server_Credits;
+
+/* private data */
+Registry_Desc               Registry_CURDESC;
+static Server_Module        Module;
+
+
+/*
+ *  ======== Server_init ========
+ */
+Void Server_init(Void)
+{
+    Registry_Result result;
+
+    /* register with xdc.runtime to get a diags mask */
+    result = Registry_addModule(&Registry_CURDESC, MODULE_NAME);
+    Assert_isTrue(result == Registry_SUCCESS, (Assert_Id)NULL);
+
+    /* initialize module object state */
+    Module.hostProcId = MultiProc_getId("HOST");
+}
+
+
+/*
+ *  ======== Server_ticksToUs ========
+ */
+static UInt32 Server_ticksToUs(UInt64 ticks)
+{
+    if (Module.tsFreq == 0) {
+        return 0;
+    }
+    return (UInt32)(ticks * 1000000 / Module.tsFreq);
+}
+
+
+/*
+ *  ======== Server_create ========
+ */
+Int Server_create()
+{
+    Int                 status = 0;
+    MessageQ_Params     msgqParams;
+    char                msgqName[32];
+    Types_FreqHz        freq;
+
+    /* enable some log events */
+    Diags_setMask(MODULE_NAME"+EXF");
+
+    /* create local message queue (inbound messages) */
+    MessageQ_Params_init(&msgqParams);
+    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(MultiProc_self()));
+    Module.slaveQue = MessageQ_create(msgqName, &msgqParams);
+
+    if (Module.slaveQue == NULL) {
+        status = -1;
+        goto leave;
+    }
+
+    Timestamp_getFreq(&freq);
+    Module.tsFreq = freq.lo;
+    Module.jobsPhys = 0;
+    Module.jobsSize = 0;
+
+    Log_print0(Diags_INFO,"Server_create: server is ready");
+
+leave:
+    Log_print1(Diags_EXIT, "<-- Server_create: %d", (IArg)status);
+    return (status);
+}
+
+
+/*
+ *  ======== Server_setRegionCached ========
+ *  Set the MAR bits covering the shared region.  Any lines the DSP holds
+ *  are written back and invalidated first so nothing stale survives the
+ *  change.  MAR granularity is 16 MB, so the whole CMEM pool is affected.
+ */
+static Void Server_setRegionCached(UInt32 base, UInt32 size, Bool cached)
+{
+    Cache_wbInvAll();
+    ti_sysbios_family_c66_Cache_setMar((Ptr)base, size, cached ?
+        ti_sysbios_family_c66_Cache_Mar_ENABLE :
+        ti_sysbios_family_c66_Cache_Mar_DISABLE);
+}
+
+/*
+ *  ======== Server_consume ========
+ *  Read and verify a buffer the host filled, returns the bad elements.
+ */
+static UInt32 Server_consume(Buffer_Data *buf, UInt32 cacheMode,
+        UInt32 elemSize)
+{
+    Ptr data = (Ptr)buf->phyAddress;
+
+    if (cacheMode == App_DSP_CACHE_WB) {
+        /* drop any lines left from the slot's last use before reading */
+        Cache_inv(data, buf->dataLen, Cache_Type_ALL, TRUE);
+    }
+
+    return Payload_verify(data, buf->dataLen, elemSize, buf->seq);
+}
+
+
+/*
+ *  ======== Server_jobs ========
+ *  Run the shared job queue dry and answer with what this core did.
+ *  The region is made uncached once, the lock and ring protocols rely
+ *  on every access reaching DDR.
+ */
+static Void Server_jobs(Jobs_Data *data)
+{
+    Jobs_Stats stats;
+    UInt32 start;
+
+    if (data->phyAddress != Module.jobsPhys || data->size != Module.jobsSize) {
+        Server_setRegionCached(data->phyAddress, data->size, FALSE);
+        Module.jobsPhys = data->phyAddress;
+        Module.jobsSize = data->size;
+    }
+
+    start = Timestamp_get32();
+    Jobs_run((App_JobQueue *)data->phyAddress, data->core, &stats);
+    data->totalUs = Server_ticksToUs(Timestamp_get32() - start);
+    data->jobs = stats.jobs;
+    data->stolen = stats.stolen;
+    data->steals = stats.steals;
+    data->busyUs = Server_ticksToUs(stats.busyTicks);
+    data->lockUs = Server_ticksToUs(stats.lockTicks);
+    data->ringUs = Server_ticksToUs(stats.ringTicks);
+}
+
+
+/*
+ *  ======== Server_trace ========
+ *  Start writing trace events to the ring in the message, with its window
+ *  uncached, or stop writing them.
+ */
+static Void Server_trace(Trace_Data *data)
+{
+    Trace_stop();
+    if (data->phyAddress != 0) {
+        Server_setRegionCached(data->phyAddress, data->size, FALSE);
+        Trace_start((App_TraceRing *)data->phyAddress);
+    }
+}
+
+
+App_Msg* createAppMsg(UInt32 cmd)
+{
+    App_Msg *   msg;
+    msg = (App_Msg *)MessageQ_alloc(0, sizeof(App_Msg));
+    if (msg == NULL) {
+        Log_print0(Diags_INFO, "Error: failed to allocate message\n");
+        return NULL;
+    }
+
+    msg->cmd = cmd;
+    return msg;
+}
+
+
+/*
+ *  ======== Server_exec ========
+ */
+Int Server_exec()
+{
+    Int32                 status;
+    Bool                running = TRUE;
+    App_Msg *           msg;
+    App_Msg *           txMsg;
+    MessageQ_QueueId    queId = MessageQ_INVALIDMESSAGEQ;
+    void *            bufStart;
+    RingBuffer* ringBuffer = NULL;
+    UInt32              buffersLeftToSend = 0;
+    UInt32              payloadSize = 0;
+    Buffer              buffer;
+    UInt32              buffersSent = 0;
+    UInt32              cacheMode = App_DSP_CACHE_WB;
+    Bool                cacheWait = TRUE;
+    UInt32              elemSize = App_ELEM_64;
+    Server_Credits      credit;
+    Types_Timestamp64   stamp;
+    Types_FreqHz        freq;
+    Bits32              start;
+
+    Log_print0(Diags_ENTRY | Diags_INFO, "--> Server_exec:");
+
+    credit.limited = FALSE;
+    credit.credits = 0;
+    credit.stalls = 0;
+    credit.stallTicks = 0;
+    credit.stalled = FALSE;
+    credit.stallStart = 0;
+
+    while (running) {
+
+        /* wait for inbound message */
+        status = MessageQ_get(Module.slaveQue, (MessageQ_Msg *)&msg, MessageQ_FOREVER);
+
+        if (status < 0) {
+            goto leave;
+        }
+        Trace_event(App_TRACE_GET, msg->cmd, 0);
+
+        if (msg->cmd == App_CMD_SHUTDOWN) {
+            running = FALSE;
+        }
+        else if (msg->cmd == App_CMD_INIT) {
+            if(ringBuffer != NULL)
+                free(ringBuffer);
+
+            Log_print0(Diags_INFO, "Init Received");
+            ringBuffer = RingBuffer_initialize(msg->data.initData.phyStartAddress, msg->data.initData.ringBufferSize);
+            cacheMode = msg->data.initData.dspCacheMode;
+            cacheWait = (msg->data.initData.dspCacheWait != 0);
+            elemSize = msg->data.initData.elemSize;
+            if (!Payload_isValidElemSize(elemSize)) {
+                Log_error1("Element size %d not supported, using 8", elemSize);
+                elemSize = App_ELEM_64;
+            }
+            Server_setRegionCached(msg->data.initData.phyStartAddress,
+                msg->data.initData.regionSize,
+                cacheMode != App_DSP_CACHE_NONE);
+            Module.jobsPhys = 0;
+            Log_print3(Diags_INFO, "Cache mode %d, wait %d, element size %d",
+                cacheMode, cacheWait, elemSize);
+            buffersLeftToSend = 0;
+            buffersSent = 0;
+        }
+        else if (msg->cmd == App_CMD_SEND) {
+            Log_print0(Diags_INFO, "Send Received");
+            queId = MessageQ_getReplyQueue(msg); /* type-cast not needed */
+
+            if(msg->data.startData.payloadSize > ringBuffer->maxBufferSize)
+            {
+                Log_error0("Payload requested is greater than max buffer size");
+                buffersLeftToSend = 0;
+            }
+            else
+            {
+                buffersLeftToSend = msg->data.startData.numBuffers;
+                payloadSize = msg->data.startData.payloadSize;
+                buffersSent = msg->data.startData.firstSeq;
+            }
+
+            /* every loop starts from the host's initial grant */
+            credit.credits = msg->data.startData.credits;
+            credit.limited = (credit.credits > 0);
+            credit.stalls = 0;
+            credit.stallTicks = 0;
+            credit.stalled = FALSE;
+        }
+        else if (msg->cmd == App_CMD_H2D_BUFFER) {
+            /* consume the host's slot and hand it straight back */
+            Trace_event(App_TRACE_CONSUME_BEGIN, msg->data.bufferData.seq,
+                msg->data.bufferData.dataLen);
+            msg->data.bufferData.errors =
+                Server_consume(&msg->data.bufferData, cacheMode, elemSize);
+            Trace_event(App_TRACE_CONSUME_END, msg->data.bufferData.seq,
+                msg->data.bufferData.dataLen);
+            msg->cmd = App_CMD_H2D_RETURN;
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if (msg->cmd == App_CMD_SYNC) {
+            /* answer straight away, the host takes the midpoint of the
+             * round trip as the time of the stamp */
+            Timestamp_getFreq(&freq);
+            Timestamp_get64(&stamp);
+            msg->data.syncData.stampHi = stamp.hi;
+            msg->data.syncData.stampLo = stamp.lo;
+            msg->data.syncData.freqHi = freq.hi;
+            msg->data.syncData.freqLo = freq.lo;
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if (msg->cmd == App_CMD_JOBS) {
+            Server_jobs(&msg->data.jobsData);
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if (msg->cmd == App_CMD_JOB) {
+            Trace_event(App_TRACE_JOB_BEGIN, msg->data.jobData.job,
+                msg->data.jobData.work);
+            start = Timestamp_get32();
+            msg->data.jobData.result = Jobs_kernel(msg->data.jobData.work,
+                msg->data.jobData.seed);
+            msg->data.jobData.ticks = Timestamp_get32() - start;
+            Trace_event(App_TRACE_JOB_END, msg->data.jobData.job,
+                msg->data.jobData.work);
+            msg->data.jobData.freq = Module.tsFreq;
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if (msg->cmd == App_CMD_TRACE) {
+            Server_trace(&msg->data.traceData);
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if ((msg->cmd & App_CMD_MASK) == App_CMD_RPC) {
+            Trace_event(App_TRACE_RPC_BEGIN, msg->cmd & ~App_CMD_MASK, 0);
+            RpcServer_dispatch((Rpc_Msg *)msg);
+            Trace_event(App_TRACE_RPC_END, msg->cmd & ~App_CMD_MASK, 0);
+            MessageQ_put(MessageQ_getReplyQueue(msg), (MessageQ_Msg)msg);
+            msg = NULL;
+        }
+        else if (msg->cmd == App_CMD_BUFFER) {
+            if(ringBuffer != NULL)
+            {
+                buffer.phyAddress = msg->data.bufferData.phyAddress;
+                buffer.offset = msg->data.bufferData.offset;
+                buffer.size = 0;
+                RingBuffer_returnBuffer(ringBuffer, buffer);
+            }
+
+            credit.credits += msg->data.bufferData.credits;
+            if (credit.stalled && credit.credits > 0) {
+                credit.stallTicks += Timestamp_get32() - credit.stallStart;
+                credit.stalled = FALSE;
+            }
+        }
+
+        if(msg != NULL)
+            MessageQ_free((MessageQ_Msg)msg);
+
+        while(buffersLeftToSend > 0 && RingBufffer_isEmpty(ringBuffer) == 0
+            && (!credit.limited || credit.credits > 0))
+        {
+            status = RingBuffer_getBuffer(ringBuffer, &buffer);
+            if(status == 0)
+            {
+                Trace_event(App_TRACE_FILL_BEGIN, buffersSent, payloadSize);
+                Payload_fill((Ptr)buffer.phyAddress, payloadSize, elemSize,
+                    buffersSent);
+
+                if (cacheMode == App_DSP_CACHE_WB) {
+                    /* without the wait the host may read ahead of the
+                     * write back, the verifier reports it if it does */
+                    Cache_wb((char*)buffer.phyAddress, payloadSize, Cache_Type_ALL, cacheWait);
+                }
+                Trace_event(App_TRACE_FILL_END, buffersSent, payloadSize);
+                Timestamp_get64(&stamp);
+                msg = createAppMsg(App_CMD_BUFFER);
+                msg->data.bufferData.phyAddress = buffer.phyAddress;
+                msg->data.bufferData.offset = buffer.offset;
+                msg->data.bufferData.dataLen = payloadSize;
+                msg->data.bufferData.seq = buffersSent;
+                msg->data.bufferData.creditStalls = credit.stalls;
+                msg->data.bufferData.creditStallUs =
+                    Server_ticksToUs(credit.stallTicks);
+                msg->data.bufferData.stampHi = stamp.hi;
+                msg->data.bufferData.stampLo = stamp.lo;
+
+                MessageQ_put(queId, (MessageQ_Msg)msg);
+                buffersLeftToSend--;
+                buffersSent++;
+                if (credit.limited) {
+                    credit.credits--;
+                }
+                Trace_event(App_TRACE_PUT, buffersSent - 1, credit.credits);
+            }
+        }
+
+        /* a free buffer is waiting on the host's next grant */
+        if (buffersLeftToSend > 0 && RingBufffer_isEmpty(ringBuffer) == 0
+                && credit.limited && credit.credits == 0 && !credit.stalled) {
+            credit.stalled = TRUE;
+            credit.stallStart = Timestamp_get32();
+            credit.stalls++;
+            Trace_event(App_TRACE_STALL, buffersSent, 0);
+        }
+    } /* while (running) */
+
+leave:
+    Log_print1(Diags_EXIT, "<-- Server_exec: %d", (IArg)status);
+    return(status);
+}
+
+/*
+ *  ======== Server_delete ========
+ */
+
+Int Server_delete()
+{
+    Int         status;
+
+    Log_print0(Diags_ENTRY, "--> Server_delete:");
+
+    /* delete the video message queue */
+    status = MessageQ_delete(&Module.slaveQue);
+
+    if (status < 0) {
+        goto leave;
+    }
+
+leave:
+    if (status < 0) {
+        Log_error1("Server_finish: error=0x%x", (IArg)status);
+    }
+
+    /* disable log events */
+    Log_print1(Diags_EXIT, "<-- Server_delete: %d", (IArg)status);
+    Diags_setMask(MODULE_NAME"-EXF");
+
+    return(status);
+}
+
+/*
+ *  ======== Server_exit ========
+ */
+
+Void Server_exit(Void)
+{
+    /*
+     * Note that there isn't a Registry_removeModule() yet:
+     *     https://bugs.eclipse.org/bugs/show_bug.cgi?id=315448
+     *
+     * ... but this is where we'd call it.
+     */
+}
@@ -37,77 +37,192 @@
 
 /* host header files */
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
-#include <float.h>
-#include <sys/time.h>
+#include <pthread.h>
 
 
 /* package header files */
 #include <ti/ipc/Std.h>
 #include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
 #include <ti/cmem.h>
 
 /* local header files */
 #include "../shared/AppCommon.h"
 #include "App.h"
+#include "Stats.h"
+#include "Credit.h"
+#include "Verify.h"
+#include "Latency.h"
+#include "Receive.h"
+#include "Sched.h"
+#include "Pipeline.h"
+#include "Jobs.h"
+#include "Calls.h"
+#include "Async.h"
+#include "Trace.h"
 
-/* module structure */
+/* Application specific defines */
+//#define BIG_DATA_POOL_SIZE 0x1000000
+#define BIG_DATA_POOL_SIZE 0x8000000
+//#define BIG_DATA_POOL_SIZE 0x100000
+
+/* core partitions start on a DSP MAR boundary */
+#define App_PARTITION_ALIGN 0x1000000
+
+/* host to DSP slots, owned by the host from App_CMD_H2D_RETURN until
+ * they are filled again */
+#define App_H2D_SLOTS 4
+
+/* App_CMD_SYNC round trips per clock sync, the fastest one is kept */
+#define App_SYNC_ROUNDS 32
+
+/* a trace takes the pool's last MAR window for the rings, see Trace.h */
+#define App_TRACE_WINDOW App_PARTITION_ALIGN
+
+typedef struct {
+    void *      base;       /* host mapping of the core's partition */
+    UInt32      phys;       /* physical address of the core's partition */
+    UInt32      offset;     /* first slot, from the start of the partition */
+    UInt32      slotSize;
+    UInt32      free[App_H2D_SLOTS];
+    UInt32      numFree;
+    UInt32      sent;       /* this loop */
+    UInt32      done;       /* this loop */
+    UInt32      errors;     /* reported by the DSP */
+} App_H2d;
+
+/* one remote core, and its share of the current run */
 typedef struct {
+    UInt16                  procId;
+    String                  name;
     MessageQ_Handle         hostQue;    // created locally
     MessageQ_QueueId        slaveQue;   // opened remotely
+
+    UInt32                  offset;     // partition, from the pool start
+    UInt32                  size;
+    Stats_Handle            d2hStats;
+    Stats_Handle            h2dStats;
+    Credit_Handle           credit;     // d2h flow control
+    Latency_Handle          latency;    // ping flow only
+    Latency_Handle          clock;      // trace only, DSP events to host
+    Receive_Handle          receive;    // every read of hostQue
+    Pipeline_Handle         pipeline;
+    App_H2d                 h2d;
+    UInt32                  errors;     // d2h verify errors on the host
+    Verify_Cost             verify;     // without a pipeline
+    Int                     status;
+    pthread_t               thread;
+} App_Core;
+
+/* module structure */
+typedef struct {
+    App_Core                cores[App_MAX_CORES];
+    UInt32                  numCores;
     UInt16                  heapId;     // MessageQ heapId
     UInt32                  msgSize;
+    Bool                    csvHeader;  // csv header already printed
+    Sched_Usage             usage;      // faults and switches, last run
+
+    const App_Params *      params;     // current run
+    void *                  base;       // host mapping of the pool
+    UInt32                  phys;
+    UInt32                  poolSize;   // left to the flows
+    Trace_Handle            trace;
+    UInt32                  traceRuns;  // trace files written
+    pthread_barrier_t       barrier;    // loop start and end, cores + main
+    pthread_mutex_t         gateLock;   // holds the core threads until
+    pthread_cond_t          gateCond;   // all of them have started
+    Int                     gate;       // 0 wait, 1 run, -1 give up
 } App_Module;
 
 /* private data */
-static App_Module Module;
+static App_Module Module = {
+    .gateLock = PTHREAD_MUTEX_INITIALIZER,
+    .gateCond = PTHREAD_COND_INITIALIZER,
+};
 
-/* Application specific defines */
-//#define BIG_DATA_POOL_SIZE 0x1000000
-#define BIG_DATA_POOL_SIZE 0x8000000
-//#define BIG_DATA_POOL_SIZE 0x100000
+/* the core's index, as trace events name it */
+#define App_coreIndex(core) ((UInt32)((core) - Module.cores))
 
 
+/*
+ *  ======== App_flowName ========
+ */
+String App_flowName(UInt32 flow)
+{
+    switch (flow) {
+        case App_FLOW_D2H:      return "d2h";
+        case App_FLOW_H2D:      return "h2d";
+        case App_FLOW_DUPLEX:   return "duplex";
+        case App_FLOW_PING:     return "ping";
+        case App_FLOW_STEAL:    return "steal";
+        case App_FLOW_PUSH:     return "push";
+        case App_FLOW_RPC:      return "rpc";
+        case App_FLOW_ASYNC:    return "async";
+        default:                return "none";
+    }
+}
+
 /*
  *  ======== App_create ========
  */
 
-Int App_create(UInt16 remoteProcId)
+Int App_create(const UInt16 *procIds, UInt32 numProcs)
 {
     Int                 status = 0;
     MessageQ_Params     msgqParams;
     char                msgqName[32];
+    App_Core *          core;
+    UInt32              i;
 
     printf("--> App_create:\n");
 
     /* setting default values */
-    Module.hostQue = NULL;
-    Module.slaveQue = MessageQ_INVALIDMESSAGEQ;
+    Module.numCores = 0;
     Module.heapId = App_MsgHeapId;
     Module.msgSize = sizeof(App_Msg);
+    Module.csvHeader = FALSE;
 
-    /* create local message queue (inbound messages) */
-    MessageQ_Params_init(&msgqParams);
-
-    Module.hostQue = MessageQ_create(App_HostMsgQueName, &msgqParams);
-
-    if (Module.hostQue == NULL) {
-        printf("App_create: Failed creating MessageQ\n");
+    if (numProcs > App_MAX_CORES) {
+        printf("App_create: at most %d remote cores\n", App_MAX_CORES);
         status = -1;
         goto leave;
     }
 
-    /* open the remote message queue */
-    sprintf(msgqName, App_SlaveMsgQueName, MultiProc_getName(remoteProcId));
+    for (i = 0; i < numProcs; i++) {
+        core = &Module.cores[i];
+        core->procId = procIds[i];
+        core->name = MultiProc_getName(procIds[i]);
+        core->hostQue = NULL;
+        core->slaveQue = MessageQ_INVALIDMESSAGEQ;
+        Module.numCores++;
 
-    do {
-        status = MessageQ_open(msgqName, &Module.slaveQue);
-        sleep(1);
-    } while (status == MessageQ_E_NOTFOUND);
+        /* create local message queue (inbound messages), one per core */
+        MessageQ_Params_init(&msgqParams);
+        sprintf(msgqName, App_HostMsgQueName, core->name);
+        core->hostQue = MessageQ_create(msgqName, &msgqParams);
 
-    if (status < 0) {
-        printf("App_create: Failed opening MessageQ\n");
-        goto leave;
+        if (core->hostQue == NULL) {
+            printf("App_create: Failed creating MessageQ\n");
+            status = -1;
+            goto leave;
+        }
+
+        /* open the remote message queue */
+        sprintf(msgqName, App_SlaveMsgQueName, core->name);
+
+        do {
+            status = MessageQ_open(msgqName, &core->slaveQue);
+            sleep(1);
+        } while (status == MessageQ_E_NOTFOUND);
+
+        if (status < 0) {
+            printf("App_create: Failed opening MessageQ\n");
+            goto leave;
+        }
+        printf("App_create: %s is ready\n", core->name);
     }
 
     printf("App_create: Host is ready\n");
@@ -124,21 +239,31 @@ leave:
 Int App_delete(Void)
 {
     Int         status = 0;
+    App_Core *  core;
+    UInt32      i;
 
     printf("--> App_delete:\n");
 
-    /* close remote resources */
-    status = MessageQ_close(&Module.slaveQue);
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
 
-    if (status < 0) {
-        goto leave;
-    }
+        /* close remote resources */
+        if (core->slaveQue != MessageQ_INVALIDMESSAGEQ) {
+            status = MessageQ_close(&core->slaveQue);
 
-    /* delete the host message queue */
-    status = MessageQ_delete(&Module.hostQue);
+            if (status < 0) {
+                goto leave;
+            }
+        }
 
-    if (status < 0) {
-        goto leave;
+        /* delete the host message queue */
+        if (core->hostQue != NULL) {
+            status = MessageQ_delete(&core->hostQue);
+
+            if (status < 0) {
+                goto leave;
+            }
+        }
     }
 
 leave:
@@ -146,7 +271,7 @@ leave:
     return(status);
 }
 
-App_Msg* createAppMsg(UInt32 cmd)
+App_Msg* createAppMsg(App_Core *core, UInt32 cmd)
 {
     App_Msg *   msg;
     msg = (App_Msg *)MessageQ_alloc(Module.heapId, Module.msgSize);
@@ -154,39 +279,977 @@ App_Msg* createAppMsg(UInt32 cmd)
         printf("Error: failed to allocate message\n");
         return NULL;
     }
-    MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
+    MessageQ_setReplyQueue(core->hostQue, (MessageQ_Msg)msg);
     msg->cmd = cmd;
 
     return msg;
 }
 
+/*
+ *  ======== App_Params_init ========
+ */
+Void App_Params_init(App_Params *params)
+{
+    params->numLoops = 1;
+    params->numBuffers = 10;
+    params->payloadSize = 100;
+    params->warmupLoops = 0;
+    params->flow = App_FLOW_D2H;
+    params->numWorkers = 2;
+    params->inOrder = TRUE;
+    params->creditWindow = 4;
+    params->creditBatch = 1;
+    params->verifyStride = 1;
+    params->elemSize = App_ELEM_64;
+    params->spinUs = 0;
+    params->loadPct = 0;
+    params->numJobs = 1000;
+    params->jobWork = 1000;
+    params->jobSpread = 1;
+    params->jobWindow = 4;
+    params->numCalls = 10000;
+    params->callWindow = 16;
+    params->depths[0] = 1;
+    params->depths[1] = 4;
+    params->depths[2] = 16;
+    params->depths[3] = 64;
+    params->depths[4] = 256;
+    params->depths[5] = 1024;
+    params->depths[6] = 4096;
+    params->numDepths = 7;
+    params->policy.armCached = TRUE;
+    params->policy.dspCached = TRUE;
+    params->policy.dspWbWait = TRUE;
+    params->traceFile = NULL;
+}
+
+/*
+ *  ======== App_h2dSend ========
+ *  Fill a free host to DSP slot and pass it to the DSP.
+ */
+static Int App_h2dSend(App_Core *core, UInt32 payloadSize, Bool armCached)
+{
+    App_H2d *h2d = &core->h2d;
+    App_Msg *msg;
+    void *data;
+    UInt32 offset;
+
+    msg = createAppMsg(core, App_CMD_H2D_BUFFER);
+    if (msg == NULL) {
+        return -1;
+    }
+
+    offset = h2d->offset + h2d->free[--h2d->numFree] * h2d->slotSize;
+    data = (char *)h2d->base + offset;
+    Verify_fill(data, payloadSize, Module.params->elemSize, h2d->sent);
+    if (armCached) {
+        CMEM_cacheWb(data, payloadSize);
+    }
+
+    msg->data.bufferData.phyAddress = h2d->phys + offset;
+    msg->data.bufferData.offset = offset;
+    msg->data.bufferData.dataLen = payloadSize;
+    msg->data.bufferData.seq = h2d->sent;
+    msg->data.bufferData.errors = 0;
+    Trace_event(App_TRACE_SEND, msg->cmd, App_coreIndex(core));
+    MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+    h2d->sent++;
+
+    return 0;
+}
+
+/*
+ *  ======== App_h2dReturned ========
+ *  The DSP has consumed a slot, take it back.
+ */
+static Void App_h2dReturned(App_Core *core, App_Msg *msg)
+{
+    App_H2d *h2d = &core->h2d;
+
+    Trace_event(App_TRACE_RECV, msg->cmd, App_coreIndex(core));
+    Stats_message(core->h2dStats, msg->data.bufferData.dataLen);
+    if (msg->data.bufferData.errors > 0) {
+        printf("error: %s read %u bad elements in buffer %u\n", core->name,
+            msg->data.bufferData.errors, msg->data.bufferData.seq);
+    }
+    h2d->errors += msg->data.bufferData.errors;
+    h2d->free[h2d->numFree++] =
+        (msg->data.bufferData.offset - h2d->offset) / h2d->slotSize;
+    h2d->done++;
+    MessageQ_free((MessageQ_Msg)msg);
+}
+
+/*
+ *  ======== App_printCsv ========
+ *  One row per core and direction of each run.
+ */
+static Void App_printCsv(const App_Params *params, String core, UInt32 flow,
+        const Stats_Summary *summary, const Credit_Summary *credit,
+        const Verify_Cost *verify, const Latency_Summary *latency,
+        const Receive_Summary *receive, UInt32 errors)
+{
+    const App_CachePolicy *policy = &params->policy;
+    UInt32 workers = (flow & App_FLOW_D2H) ? params->numWorkers : 0;
+    UInt32 stride = (flow & App_FLOW_D2H) ? params->verifyStride : 0;
+    double verifyUs = 0.0;
+    double spinHitPct = 0.0;
+    Credit_Summary none;
+    Latency_Summary noLatency;
+
+    if (credit == NULL) {
+        memset(&none, 0, sizeof(none));
+        credit = &none;
+    }
+    if (latency == NULL) {
+        memset(&noLatency, 0, sizeof(noLatency));
+        latency = &noLatency;
+    }
+    if (receive != NULL && receive->messages > 0) {
+        spinHitPct = receive->spinHits * 100.0 / receive->messages;
+    }
+    if (verify != NULL && verify->buffers > 0) {
+        verifyUs = (verify->invNs + verify->checkNs) / 1e3 / verify->buffers;
+    }
+
+    if (!Module.csvHeader) {
+        /* one header for every policy run by this process */
+        printf("csvheader, Payload Size, Core, Direction, Bandwidth (MB/s), Messages/s, Buffers per Loop, Loops Measured, Payload Data Type Size (B), ARM Cached, DSP Cached, DSP WB Wait, Host Workers, In Order Returns, Credit Window, Credit Batch, DSP Credit Stalls, DSP Credit Stall Time (us), Host Credit Stalls, Verify Line Stride, Verify per Buffer (us), Avg Loop Time (ms), Interval p50 (us), Interval p99 (us), One-way p50 (us), One-way p99 (us), Clock Sync Error (us), Receive Spin Cap (us), Receive Spin Hits (%%), Background Load (%%), RT Priority, CPU Mask, Memory Locked, Minor Faults, Involuntary Switches, Bytes Transferred, Verify Errors\n");
+        Module.csvHeader = TRUE;
+    }
+    printf("csv, %d, %s, %s, %f, %f, %d, %d, %d, %d, %d, %d, %d, %d, %u, %u, %llu, %f, %llu, %u, %f, %f, %f, %f, %f, %f, %f, %u, %f, %u, %d, 0x%x, %d, %llu, %llu, %llu, %u\n", params->payloadSize, core, App_flowName(flow), summary->mbps, summary->msgPerSec, params->numBuffers, summary->loops, params->elemSize, policy->armCached, policy->dspCached, policy->dspCached && policy->dspWbWait, workers, workers > 0 && params->inOrder, credit->window, credit->batch, (unsigned long long)credit->dspStalls, credit->dspStallUs, (unsigned long long)credit->hostStalls, stride, verifyUs, summary->avgLoopMs, summary->p50Us, summary->p99Us, latency->p50Us, latency->p99Us, latency->syncErrUs, receive != NULL ? params->spinUs : 0, spinHitPct, params->loadPct, Sched_priority(), Sched_cpuMask(), Sched_locked(), (unsigned long long)Module.usage.minorFaults, (unsigned long long)Module.usage.involuntary, (unsigned long long)summary->bytes, errors);
+}
+
+/*
+ *  ======== App_resultAdd ========
+ *  Fold one core and direction into the run's result, worst case wins.
+ */
+static Void App_resultAdd(App_Result *result, const Stats_Summary *summary,
+        const Latency_Summary *latency)
+{
+    if (summary->p50Us > result->p50Us) {
+        result->p50Us = summary->p50Us;
+    }
+    if (summary->p99Us > result->p99Us) {
+        result->p99Us = summary->p99Us;
+    }
+    if (latency != NULL && latency->p99Us > result->oneWayP99Us) {
+        result->oneWayP99Us = latency->p99Us;
+    }
+}
+
+/*
+ *  ======== App_coreSync ========
+ *  Sample the DSP's clock against the host's with App_CMD_SYNC round
+ *  trips, fitted by clock. Nothing else may be in flight to or from the
+ *  core.
+ */
+static Int App_coreSync(App_Core *core, Latency_Handle clock)
+{
+    App_Msg *msg;
+    UInt64 send, recv;
+    Int status;
+    UInt32 i;
+
+    for (i = 0; i < App_SYNC_ROUNDS; i++) {
+        msg = createAppMsg(core, App_CMD_SYNC);
+        if (msg == NULL) {
+            return -1;
+        }
+        send = Latency_now();
+        MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+        status = MessageQ_get(core->hostQue, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+        recv = Latency_now();
+        if (status < 0) {
+            return status;
+        }
+        if (msg->cmd != App_CMD_SYNC) {
+            printf("Error: %s answered a clock sync with 0x%x\n", core->name,
+                msg->cmd);
+            MessageQ_free((MessageQ_Msg)msg);
+            return -1;
+        }
+
+        Latency_syncSample(clock, send,
+            ((UInt64)msg->data.syncData.stampHi << 32) |
+            msg->data.syncData.stampLo,
+            ((UInt64)msg->data.syncData.freqHi << 32) |
+            msg->data.syncData.freqLo, recv);
+        MessageQ_free((MessageQ_Msg)msg);
+    }
+
+    return Latency_syncEnd(clock);
+}
+
+/*
+ *  ======== App_coreSetup ========
+ *  Give the core its partition, statistics and pipeline, and tell the
+ *  DSP where its ring buffer lives.
+ */
+static Int App_coreSetup(App_Core *core, UInt32 offset, UInt32 size)
+{
+    const App_Params *params = Module.params;
+    const App_CachePolicy *policy = &params->policy;
+    Bool d2h = (params->flow & App_FLOW_D2H) != 0;
+    Bool h2d = (params->flow & App_FLOW_H2D) != 0;
+    Stats_Params statsParams;
+    Credit_Params creditParams;
+    Latency_Params latencyParams;
+    Receive_Params receiveParams;
+    Pipeline_Params pipeParams;
+    char name[24];
+    App_Msg *msg;
+    UInt32 ringSize;
+    UInt32 i;
+
+    core->offset = offset;
+    core->size = size;
+    core->errors = 0;
+    core->status = 0;
+    memset(&core->verify, 0, sizeof(Verify_Cost));
+
+    Receive_Params_init(&receiveParams);
+    receiveParams.name = core->name;
+    receiveParams.queue = core->hostQue;
+    receiveParams.maxSpinUs = params->spinUs;
+    core->receive = Receive_create(&receiveParams);
+    if (core->receive == NULL) {
+        return -1;
+    }
+
+    Stats_Params_init(&statsParams);
+    statsParams.name = name;
+    statsParams.warmupLoops = params->warmupLoops;
+    if (params->numLoops > params->warmupLoops) {
+        statsParams.maxSamples =
+            (params->numLoops - params->warmupLoops) * params->numBuffers;
+    }
+    if (d2h) {
+        snprintf(name, sizeof(name), "%s %s", core->name,
+            App_flowName(params->flow & ~App_FLOW_H2D));
+        core->d2hStats = Stats_create(&statsParams);
+        if (core->d2hStats == NULL) {
+            return -1;
+        }
+
+        Credit_Params_init(&creditParams);
+        creditParams.name = name;
+        creditParams.window = params->creditWindow;
+        creditParams.batch = params->creditBatch;
+        creditParams.warmupLoops = params->warmupLoops;
+        core->credit = Credit_create(&creditParams);
+        if (core->credit == NULL) {
+            return -1;
+        }
+    }
+    if (params->flow & App_FLOW_SINGLE) {
+        Latency_Params_init(&latencyParams);
+        latencyParams.name = name;
+        latencyParams.maxSamples = statsParams.maxSamples;
+        core->latency = Latency_create(&latencyParams);
+        if (core->latency == NULL) {
+            return -1;
+        }
+    }
+    if (h2d) {
+        snprintf(name, sizeof(name), "%s h2d", core->name);
+        core->h2dStats = Stats_create(&statsParams);
+        if (core->h2dStats == NULL) {
+            return -1;
+        }
+    }
+
+    /* full duplex splits the partition, the DSP ring gets the lower half */
+    ringSize = (d2h && h2d) ? size / 2 : size;
+    core->h2d.base = (char *)Module.base + offset;
+    core->h2d.phys = Module.phys + offset;
+    core->h2d.offset = d2h ? ringSize : 0;
+    core->h2d.slotSize = (size - core->h2d.offset) / App_H2D_SLOTS;
+    core->h2d.errors = 0;
+    core->h2d.numFree = App_H2D_SLOTS;
+    for (i = 0; i < App_H2D_SLOTS; i++) {
+        core->h2d.free[i] = App_H2D_SLOTS - 1 - i;
+    }
+    if (h2d && params->payloadSize > core->h2d.slotSize) {
+        printf("Error: payload %u is larger than the %u byte host slots\n",
+            params->payloadSize, core->h2d.slotSize);
+        return -1;
+    }
+
+    printf("Tell %s to initialize Ring Buffer: phys %x, %u bytes\n",
+        core->name, Module.phys + offset, size);
+    msg = createAppMsg(core, App_CMD_INIT);
+    if (msg == NULL) {
+        return -1;
+    }
+    msg->data.initData.phyStartAddress = Module.phys + offset;
+    msg->data.initData.ringBufferSize = ringSize;
+    msg->data.initData.regionSize = size;
+    msg->data.initData.dspCacheMode = policy->dspCached ?
+        App_DSP_CACHE_WB : App_DSP_CACHE_NONE;
+    msg->data.initData.dspCacheWait = policy->dspWbWait;
+    msg->data.initData.elemSize = params->elemSize;
+    MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+
+    /* the first clock sync, before the pipeline can take the replies */
+    if (core->latency != NULL && App_coreSync(core, core->latency) < 0) {
+        return -1;
+    }
+
+    if (d2h && params->numWorkers > 0 && !(params->flow & App_FLOW_SINGLE)) {
+        pipeParams.name = core->name;
+        pipeParams.core = App_coreIndex(core);
+        pipeParams.numWorkers = params->numWorkers;
+        pipeParams.inOrder = params->inOrder;
+        pipeParams.armCached = policy->armCached;
+        pipeParams.verifyStride = params->verifyStride;
+        pipeParams.elemSize = params->elemSize;
+        pipeParams.base = (char *)Module.base + offset;
+        pipeParams.hostQue = core->hostQue;
+        pipeParams.slaveQue = core->slaveQue;
+        pipeParams.stats = core->d2hStats;
+        pipeParams.credit = core->credit;
+        pipeParams.receive = core->receive;
+        core->pipeline = Pipeline_create(&pipeParams);
+        if (core->pipeline == NULL) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *  ======== App_corePing ========
+ *  One loop of the ping flow: ask for a single buffer, take it back as
+ *  soon as it arrives and only then ask for the next, so every buffer
+ *  finds both ends idle.
+ */
+static Int App_corePing(App_Core *core, UInt32 loop)
+{
+    const App_Params *params = Module.params;
+    Bool measured = (loop >= params->warmupLoops);
+    Buffer_Data *buf;
+    App_Msg *msg;
+    UInt64 send, recv;
+    Int status;
+    UInt32 i;
+
+    Stats_loopBegin(core->d2hStats);
+    for (i = 0; i < params->numBuffers; i++) {
+        msg = createAppMsg(core, App_CMD_SEND);
+        if (msg == NULL) {
+            return -1;
+        }
+        msg->data.startData.numBuffers = 1;
+        msg->data.startData.payloadSize = params->payloadSize;
+        msg->data.startData.credits = 0;
+        msg->data.startData.firstSeq = i;
+        Trace_event(App_TRACE_SEND, msg->cmd, App_coreIndex(core));
+        send = Latency_now();
+        MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+
+        status = Receive_get(core->receive, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+        recv = Latency_now();
+        if (status < 0) {
+            return status;
+        }
+        Trace_event(App_TRACE_RECV, msg->cmd, App_coreIndex(core));
+        if (msg->cmd != App_CMD_BUFFER) {
+            printf("Error: %s sent 0x%x instead of a buffer\n", core->name,
+                msg->cmd);
+            MessageQ_free((MessageQ_Msg)msg);
+            return -1;
+        }
+
+        buf = &msg->data.bufferData;
+        Stats_message(core->d2hStats, buf->dataLen);
+        if (measured) {
+            Latency_record(core->latency, send,
+                ((UInt64)buf->stampHi << 32) | buf->stampLo, recv);
+        }
+        Trace_event(App_TRACE_VERIFY_BEGIN, buf->seq, App_coreIndex(core));
+        core->errors += Verify_buffer((char *)Module.base + core->offset +
+            buf->offset, buf->dataLen, params->elemSize, buf->seq,
+            params->policy.armCached, params->verifyStride, &core->verify);
+        Trace_event(App_TRACE_VERIFY_END, buf->seq, App_coreIndex(core));
+        buf->credits = 0;
+        Trace_event(App_TRACE_RETURN, buf->seq, App_coreIndex(core));
+        MessageQ_setReplyQueue(core->hostQue, (MessageQ_Msg)msg);
+        MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+    }
+    Stats_loopEnd(core->d2hStats);
+
+    if (loop + 1 == params->warmupLoops) {
+        memset(&core->verify, 0, sizeof(Verify_Cost));
+    }
+
+    return 0;
+}
+
+/*
+ *  ======== App_coreLoop ========
+ *  One loop of one core: start both directions and wait for both.
+ */
+static Int App_coreLoop(App_Core *core, UInt32 loop)
+{
+    const App_Params *params = Module.params;
+    Bool armCached = params->policy.armCached;
+    Bool d2h = (params->flow & App_FLOW_D2H) != 0;
+    Bool h2d = (params->flow & App_FLOW_H2D) != 0;
+    UInt32 numBuffers = params->numBuffers;
+    UInt32 h2dTarget = h2d ? numBuffers : 0;
+    UInt32 msgCount = 0;
+    Bool d2hDone = !d2h;
+    UInt64 doneTime;
+    App_Msg *msg;
+    Int status = 0;
+
+    if (params->flow & App_FLOW_SINGLE) {
+        return App_corePing(core, loop);
+    }
+
+    core->h2d.sent = 0;
+    core->h2d.done = 0;
+
+    /* start both directions together */
+    if (d2h) {
+        msg = createAppMsg(core, App_CMD_SEND);
+        if (msg == NULL) {
+            return -1;
+        }
+        msg->data.startData.numBuffers = numBuffers;
+        msg->data.startData.payloadSize = params->payloadSize;
+        msg->data.startData.credits = Credit_loopBegin(core->credit,
+            numBuffers);
+        msg->data.startData.firstSeq = 0;
+        Stats_loopBegin(core->d2hStats);
+        if (core->pipeline != NULL) {
+            /* the pipeline threads receive and return the buffers */
+            Pipeline_loopBegin(core->pipeline, numBuffers);
+        }
+        Trace_event(App_TRACE_SEND, msg->cmd, App_coreIndex(core));
+        MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+    }
+    if (h2d) {
+        Stats_loopBegin(core->h2dStats);
+        while (core->h2d.sent < numBuffers && core->h2d.numFree > 0) {
+            if (App_h2dSend(core, params->payloadSize, armCached) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    while (core->h2d.done < h2dTarget ||
+            (core->pipeline == NULL && !d2hDone))
+    {
+        if (core->pipeline != NULL) {
+            msg = Pipeline_getH2dReturn(core->pipeline);
+            if (msg == NULL) {
+                return -1;
+            }
+        }
+        else {
+            status = Receive_get(core->receive, (MessageQ_Msg *)&msg,
+                MessageQ_FOREVER);
+            if (status < 0) {
+                return status;
+            }
+        }
+
+        if(msg->cmd == App_CMD_H2D_RETURN)
+        {
+            App_h2dReturned(core, msg);
+            if (core->h2d.sent < numBuffers &&
+                App_h2dSend(core, params->payloadSize, armCached) < 0) {
+                return -1;
+            }
+            if (core->h2d.done == numBuffers) {
+                Stats_loopEnd(core->h2dStats);
+            }
+            continue;
+        }
+        if(msg->cmd == App_CMD_BUFFER)
+        {
+            Trace_event(App_TRACE_RECV, msg->cmd, App_coreIndex(core));
+            Stats_message(core->d2hStats, msg->data.bufferData.dataLen);
+            Credit_received(core->credit, msg->data.bufferData.creditStalls,
+                msg->data.bufferData.creditStallUs);
+            Trace_event(App_TRACE_VERIFY_BEGIN, msg->data.bufferData.seq,
+                App_coreIndex(core));
+            core->errors += Verify_buffer((char *)Module.base +
+                core->offset + msg->data.bufferData.offset,
+                msg->data.bufferData.dataLen, params->elemSize,
+                msg->data.bufferData.seq, armCached, params->verifyStride,
+                &core->verify);
+            Trace_event(App_TRACE_VERIFY_END, msg->data.bufferData.seq,
+                App_coreIndex(core));
+            msg->data.bufferData.credits = Credit_release(core->credit);
+            Trace_event(App_TRACE_RETURN, msg->data.bufferData.seq,
+                App_coreIndex(core));
+            msgCount++;
+        }
+        MessageQ_setReplyQueue(core->hostQue, (MessageQ_Msg)msg);
+        MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+        if (d2h && msgCount == numBuffers) {
+            Stats_loopEnd(core->d2hStats);
+            Credit_loopEnd(core->credit);
+            d2hDone = TRUE;
+        }
+    }
+
+    if (core->pipeline != NULL) {
+        core->errors += Pipeline_waitLoop(core->pipeline, &doneTime);
+        Stats_loopEndAt(core->d2hStats, doneTime);
+        Credit_loopEnd(core->credit);
+        if (loop + 1 == params->warmupLoops) {
+            Pipeline_resetStats(core->pipeline);
+        }
+    }
+    else if (loop + 1 == params->warmupLoops) {
+        memset(&core->verify, 0, sizeof(Verify_Cost));
+    }
+
+    return status;
+}
+
+/*
+ *  ======== App_coreThread ========
+ *  Runs every loop of one core in step with the other cores. A core that
+ *  failed keeps meeting the barriers so the others are not stranded.
+ */
+static void *App_coreThread(void *arg)
+{
+    App_Core *core = (App_Core *)arg;
+    UInt32 loop;
+    Int gate;
+
+    Sched_thread(core->name);
+
+    /* the barriers need every core, wait until they are all running */
+    pthread_mutex_lock(&Module.gateLock);
+    while ((gate = Module.gate) == 0) {
+        pthread_cond_wait(&Module.gateCond, &Module.gateLock);
+    }
+    pthread_mutex_unlock(&Module.gateLock);
+    if (gate < 0) {
+        return NULL;
+    }
+
+    for (loop = 0; loop < Module.params->numLoops; loop++) {
+        pthread_barrier_wait(&Module.barrier);
+        if (core->status >= 0) {
+            core->status = App_coreLoop(core, loop);
+            if (core->status < 0) {
+                printf("Error: %s loop %u failed: %d\n", core->name, loop,
+                    core->status);
+            }
+            if (loop + 1 == Module.params->warmupLoops) {
+                Receive_resetStats(core->receive);
+            }
+        }
+        pthread_barrier_wait(&Module.barrier);
+    }
+
+    return NULL;
+}
+
+/*
+ *  ======== App_coreReport ========
+ */
+static Void App_coreReport(App_Core *core, App_Result *result)
+{
+    const App_Params *params = Module.params;
+    Stats_Summary summary;
+    UInt32 flow = params->flow & ~App_FLOW_H2D;
+    Credit_Summary credit;
+    Latency_Summary latency;
+    Receive_Summary receive;
+    Verify_Cost verify = core->verify;
+    char name[24];
+
+    /* one receive path serves both directions */
+    Receive_report(core->receive, &receive);
+
+    if (core->d2hStats != NULL) {
+        Stats_report(core->d2hStats, &summary);
+        Credit_report(core->credit, summary.totalMs, &credit);
+        if (core->pipeline != NULL) {
+            Pipeline_getVerifyCost(core->pipeline, &verify);
+        }
+        snprintf(name, sizeof(name), "%s %s", core->name, App_flowName(flow));
+        Verify_report(name, params->verifyStride, &verify, summary.totalMs,
+            core->pipeline == NULL);
+        if (core->pipeline != NULL) {
+            Pipeline_report(core->pipeline);
+        }
+        if (core->latency != NULL) {
+            Latency_report(core->latency, &latency);
+        }
+        printf("%s verify errors (host): %u\n", name, core->errors);
+        App_printCsv(params, core->name, flow, &summary, &credit, &verify,
+            core->latency != NULL ? &latency : NULL, &receive, core->errors);
+        App_resultAdd(result, &summary,
+            core->latency != NULL ? &latency : NULL);
+    }
+    if (core->h2dStats != NULL) {
+        Stats_report(core->h2dStats, &summary);
+        printf("%s h2d verify errors (DSP): %u\n", core->name,
+            core->h2d.errors);
+        App_printCsv(params, core->name, App_FLOW_H2D, &summary, NULL,
+            NULL, NULL, &receive, core->h2d.errors);
+        App_resultAdd(result, &summary, NULL);
+    }
+}
+
+/*
+ *  ======== App_execJobs ========
+ *  Run the steal or push flow on the pool mapped by App_exec.
+ */
+static Int App_execJobs(const App_Params *params, App_Result *result)
+{
+    Jobs_Params jobsParams;
+    Jobs_Summary summary;
+    App_Core *core;
+    Int status;
+    UInt32 i;
+
+    memset(&jobsParams, 0, sizeof(Jobs_Params));
+    jobsParams.numCores = Module.numCores;
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        jobsParams.names[i] = core->name;
+        jobsParams.hostQues[i] = core->hostQue;
+        jobsParams.slaveQues[i] = core->slaveQue;
+    }
+    jobsParams.base = Module.base;
+    jobsParams.phys = Module.phys;
+    jobsParams.size = Jobs_regionSize(params->numJobs);
+    jobsParams.armCached = params->policy.armCached;
+    jobsParams.steal = (params->flow == App_FLOW_STEAL);
+    jobsParams.numJobs = params->numJobs;
+    jobsParams.work = params->jobWork;
+    jobsParams.spread = params->jobSpread;
+    jobsParams.window = params->jobWindow;
+    jobsParams.numLoops = params->numLoops;
+    jobsParams.warmupLoops = params->warmupLoops;
+
+    if (params->numJobs > App_JOBS_MAX ||
+            jobsParams.size > Module.poolSize) {
+        printf("Error: at most %u jobs\n", App_JOBS_MAX);
+        return (-1);
+    }
+
+    status = Jobs_run(&jobsParams, &summary);
+    result->jobsPerSec = summary.jobsPerSec;
+    result->errors = summary.errors;
+
+    return (status);
+}
+
+/*
+ *  ======== App_execCalls ========
+ *  Run the rpc flow, the sums reading the start of the pool.
+ */
+static Int App_execCalls(const App_Params *params, App_Result *result)
+{
+    Calls_Params callsParams;
+    Calls_Summary summary;
+    App_Core *core;
+    Int status;
+    UInt32 i;
+
+    memset(&callsParams, 0, sizeof(Calls_Params));
+    callsParams.numCores = Module.numCores;
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        callsParams.names[i] = core->name;
+        callsParams.hostQues[i] = core->hostQue;
+        callsParams.slaveQues[i] = core->slaveQue;
+    }
+    callsParams.base = Module.base;
+    callsParams.armCached = params->policy.armCached;
+    callsParams.numCalls = params->numCalls;
+    callsParams.window = params->callWindow;
+    callsParams.bulkSize = params->payloadSize;
+    callsParams.numLoops = params->numLoops;
+    callsParams.warmupLoops = params->warmupLoops;
+
+    if (params->payloadSize > Module.poolSize) {
+        printf("Error: at most %u bytes per sum\n", Module.poolSize);
+        return (-1);
+    }
+
+    status = Calls_run(&callsParams, &summary);
+    result->callsPerSec = summary.asyncPerSec;
+    result->errors = summary.errors;
+
+    return (status);
+}
+
+/*
+ *  ======== App_execAsync ========
+ *  Run the async flow, the pipeline workers starting the calls.
+ */
+static Int App_execAsync(const App_Params *params, App_Result *result)
+{
+    Async_Params asyncParams;
+    Async_Summary summary;
+    Int status;
+    UInt32 i;
+
+    memset(&asyncParams, 0, sizeof(Async_Params));
+    asyncParams.numCores = Module.numCores;
+    for (i = 0; i < Module.numCores; i++) {
+        asyncParams.names[i] = Module.cores[i].name;
+        asyncParams.slaveQues[i] = Module.cores[i].slaveQue;
+    }
+    asyncParams.numThreads = (params->numWorkers > 0) ? params->numWorkers : 1;
+    asyncParams.numCalls = params->numCalls;
+    asyncParams.window = params->callWindow;
+    for (i = 0; i < params->numDepths; i++) {
+        asyncParams.depths[i] = params->depths[i];
+    }
+    asyncParams.numDepths = params->numDepths;
+    asyncParams.numLoops = params->numLoops;
+    asyncParams.warmupLoops = params->warmupLoops;
+
+    status = Async_run(&asyncParams, &summary);
+    result->callsPerSec = summary.peakPerSec;
+    result->errors = summary.errors;
+
+    return (status);
+}
+
+/*
+ *  ======== App_coreTrace ========
+ *  Have the DSP write its trace events to the ring at phys, or stop at
+ *  0, and wait for it to answer. Nothing else may be in flight to or
+ *  from the core.
+ */
+static Int App_coreTrace(App_Core *core, UInt32 phys)
+{
+    App_Msg *msg;
+    Int status;
+
+    msg = createAppMsg(core, App_CMD_TRACE);
+    if (msg == NULL) {
+        return -1;
+    }
+    msg->data.traceData.phyAddress = phys;
+    msg->data.traceData.size = sizeof(App_TraceRing);
+    MessageQ_put(core->slaveQue, (MessageQ_Msg)msg);
+
+    status = MessageQ_get(core->hostQue, (MessageQ_Msg *)&msg,
+        MessageQ_FOREVER);
+    if (status < 0) {
+        return status;
+    }
+    if (msg->cmd != App_CMD_TRACE) {
+        printf("Error: %s answered the trace command with 0x%x\n",
+            core->name, msg->cmd);
+        status = -1;
+    }
+    MessageQ_free((MessageQ_Msg)msg);
+
+    return status;
+}
+
+/*
+ *  ======== App_traceStart ========
+ *  Clear a ring per core in the pool's last window, sync each core's
+ *  clock and have it write its events there.
+ */
+static Int App_traceStart(const App_Params *params)
+{
+    Trace_Params traceParams;
+    Latency_Params latencyParams;
+    UInt32 offset = BIG_DATA_POOL_SIZE - App_TRACE_WINDOW;
+    App_Core *core;
+    UInt32 i;
+
+    Trace_Params_init(&traceParams);
+    traceParams.numCores = Module.numCores;
+    traceParams.armCached = params->policy.armCached;
+    for (i = 0; i < Module.numCores; i++) {
+        traceParams.names[i] = Module.cores[i].name;
+        traceParams.rings[i] = (App_TraceRing *)((char *)Module.base +
+            offset) + i;
+    }
+    Module.trace = Trace_create(&traceParams);
+    if (Module.trace == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        Latency_Params_init(&latencyParams);
+        latencyParams.name = core->name;
+        latencyParams.maxSamples = 0;
+        core->clock = Latency_create(&latencyParams);
+        if (core->clock == NULL) {
+            return -1;
+        }
+        if (App_coreTrace(core, Module.phys + offset +
+                i * sizeof(App_TraceRing)) < 0 ||
+                App_coreSync(core, core->clock) < 0) {
+            printf("Error: %s did not start its trace\n", core->name);
+            return -1;
+        }
+    }
+    printf("Trace: %u events per DSP ring at phys %x, to %s\n",
+        App_TRACE_RING_SIZE, Module.phys + offset, params->traceFile);
+
+    return 0;
+}
+
+/*
+ *  ======== App_traceStop ========
+ *  Stop the DSPs' traces, sync their clocks again and write the run's
+ *  trace file; later runs of the process insert their number before the
+ *  extension. A failed run leaves the DSPs alone, one may still be busy.
+ */
+static Void App_traceStop(const App_Params *params, Bool ok)
+{
+    Latency_Handle clocks[App_MAX_CORES];
+    String file = params->traceFile;
+    char name[256];
+    const char *ext;
+    App_Core *core;
+    UInt32 i;
+
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        if (ok && core->clock != NULL && (App_coreTrace(core, 0) < 0 ||
+                App_coreSync(core, core->clock) < 0)) {
+            printf("Warning: %s did not stop its trace\n", core->name);
+        }
+        clocks[i] = core->clock;
+    }
+    Trace_stop(Module.trace, clocks);
+
+    if (Module.traceRuns > 0) {
+        ext = strrchr(file, '.');
+        if (ext == NULL || strchr(ext, '/') != NULL) {
+            ext = file + strlen(file);
+        }
+        snprintf(name, sizeof(name), "%.*s-%u%s", (int)(ext - file), file,
+            Module.traceRuns, ext);
+        file = name;
+    }
+    if (Trace_write(Module.trace, file) == 0) {
+        Module.traceRuns++;
+    }
+
+    Trace_delete(&Module.trace);
+    for (i = 0; i < Module.numCores; i++) {
+        Latency_delete(&Module.cores[i].clock);
+    }
+}
+
 /*
  *  ======== App_exec ========
  */
-Int App_exec(UInt32 numLoops, UInt32 numBuffers, UInt32 payloadSize)
+Int App_exec(const App_Params *params, App_Result *result)
 {
     Int         status = 0;
     UInt32         loop;
-    UInt32         batch;
-    UInt32         msgCount = 0;
-    App_Msg *   msg;
-    struct timeval t1, t2;
-    double elapsedTime;
-    double minTime = DBL_MAX;
-    double maxTime = 0;
-    double averageTime = 0;
-    double avgTimePerMsg = 0;
+    const App_CachePolicy *policy = &params->policy;
+    UInt32 numBuffers = params->numBuffers;
+    UInt32 payloadSize = params->payloadSize;
+    UInt32 numDirs = (params->flow == App_FLOW_DUPLEX) ? 2 : 1;
     CMEM_AllocParams cmemAttrs;
     void *sharedRegionAllocPtr=NULL;
     Int pool_id;
+    Stats_Params statsParams;
+    Stats_Handle total = NULL;
+    Stats_Summary summary;
+    Sched_Usage usage;
+    App_Result unused;
+    UInt32 partSize;
+    UInt32 errors;
+    UInt32 started = 0;
+    Bool barrier = FALSE;
+    Bool cmem = FALSE;
+    App_Core *core;
     UInt32 i;
-    void* data;
-    UInt64 bytesRx = 0;
 
 
     printf("--> App_exec:\n");
 
-    printf("Number of Loops: %d\nSize of buffers: %d\nNumber of Buffers per loop: %d\nMessages per Loop: %d\n", numLoops, numBuffers, payloadSize, numBuffers);
+    if (result == NULL) {
+        result = &unused;
+    }
+    memset(result, 0, sizeof(App_Result));
+
+    Module.params = params;
+    for (i = 0; i < Module.numCores; i++) {
+        Module.cores[i].d2hStats = NULL;
+        Module.cores[i].h2dStats = NULL;
+        Module.cores[i].credit = NULL;
+        Module.cores[i].latency = NULL;
+        Module.cores[i].clock = NULL;
+        Module.cores[i].receive = NULL;
+        Module.cores[i].pipeline = NULL;
+    }
+
+    printf("Number of Loops: %d\nSize of buffers: %d\nNumber of Buffers per loop: %d\nMessages per Loop: %d\nWarm-up Loops: %d\n", params->numLoops, payloadSize, numBuffers, numBuffers, params->warmupLoops);
+    printf("Remote cores:");
+    for (i = 0; i < Module.numCores; i++) {
+        printf(" %s", Module.cores[i].name);
+    }
+    printf("\n");
+    printf("Direction: %s\n", App_flowName(params->flow));
+    printf("Payload element: %u bits\n", params->elemSize * 8);
+    printf("Cache policy: ARM %s, DSP %s\n",
+        policy->armCached ? "cached" : "non-cached",
+        !policy->dspCached ? "non-cached (MAR off)" :
+        policy->dspWbWait ? "cached (wait for write back)" :
+        "cached (no wait for write back)");
+    if ((params->flow & App_FLOW_D2H) && params->numWorkers > 0) {
+        printf("Host pipeline: %u workers per core, %s returns\n",
+            params->numWorkers, params->inOrder ? "in order" : "out of order");
+    }
+    else if (params->flow & App_FLOW_D2H) {
+        printf("Host pipeline: off, single thread receive loop\n");
+    }
+    if ((params->flow & App_FLOW_D2H) && params->verifyStride > 1) {
+        printf("Host verify: 1 in %u cache lines\n", params->verifyStride);
+    }
+    else if (params->flow & App_FLOW_D2H) {
+        printf("Host verify: %s\n", params->verifyStride ? "every cache line" :
+            "off");
+    }
+    if (params->flow & App_FLOW_SINGLE) {
+        printf("Latency: one buffer in flight, clocks synced over %u "
+            "round trips before and after\n", App_SYNC_ROUNDS);
+    }
+    if (params->spinUs > 0) {
+        printf("Host receive: polls up to %u us, adapted to the arrival "
+            "rate, before blocking\n", params->spinUs);
+    }
+    else {
+        printf("Host receive: blocks in MessageQ_get\n");
+    }
+    if ((params->flow & App_FLOW_D2H) && params->creditWindow > 0) {
+        printf("Credits: window %u, granted in batches of %u\n",
+            params->creditWindow, params->creditBatch);
+    }
+    else if (params->flow & App_FLOW_D2H) {
+        printf("Credits: off\n");
+    }
+
+    /* all cores together, the traffic the host has to keep up with */
+    Stats_Params_init(&statsParams);
+    statsParams.name = "all";
+    statsParams.warmupLoops = params->warmupLoops;
+    statsParams.maxSamples = 0;
+    total = Stats_create(&statsParams);
+    if (total == NULL) {
+        status = -1;
+        goto leave;
+    }
 
     status = CMEM_init();
     if (status < 0) {
@@ -195,134 +1258,177 @@ Int App_exec(UInt32 numLoops, UInt32 numBuffers, UInt32 payloadSize)
     }
     else {
         printf("CMEM_init success\n");
+        cmem = TRUE;
     }
 
     pool_id = CMEM_getPool(BIG_DATA_POOL_SIZE);
     if (pool_id < 0) {
         printf("CMEM_getPool failed\n");
+        status = -1;
         goto leave;
     }
     printf("CMEM_getPool success\n");
 
     cmemAttrs.type = CMEM_HEAP;
-#if ARM_CACHE_INV == 1
-    cmemAttrs.flags =  CMEM_CACHED;
-#else
-    cmemAttrs.flags =  CMEM_NONCACHED;
-#endif
+    cmemAttrs.flags = policy->armCached ? CMEM_CACHED : CMEM_NONCACHED;
     cmemAttrs.alignment = 0;
     sharedRegionAllocPtr = CMEM_allocPool(pool_id, &cmemAttrs);
     if (sharedRegionAllocPtr == NULL) {
         printf("CMEM_allocPool failed\n");
+        status = -1;
         goto leave;
     }
 
-    printf("CMEM_allocPool success: Allocated buffer %p, phys: %x\n", sharedRegionAllocPtr, CMEM_getPhys(sharedRegionAllocPtr));
+    printf("CMEM_allocPool success: Allocated buffer %p, phys: %x\n", sharedRegionAllocPtr, (UInt32)CMEM_getPhys(sharedRegionAllocPtr));
+    Module.base = sharedRegionAllocPtr;
+    Module.phys = (UInt32)CMEM_getPhys(sharedRegionAllocPtr);
+
+    /* have the page tables in place before anything is timed */
+    Sched_prefault(sharedRegionAllocPtr, BIG_DATA_POOL_SIZE);
+
+    /* the rings take the last window, the flows get the rest */
+    Module.poolSize = BIG_DATA_POOL_SIZE;
+    if (params->traceFile != NULL) {
+        Module.poolSize -= App_TRACE_WINDOW;
+        status = App_traceStart(params);
+        if (status < 0) {
+            goto leave;
+        }
+    }
 
-    printf("Tell DSP to initialize Ring Buffer\n");
-    msg = createAppMsg(App_CMD_INIT);
-    msg->data.initData.phyStartAddress = CMEM_getPhys(sharedRegionAllocPtr);
-    msg->data.initData.ringBufferSize = BIG_DATA_POOL_SIZE;
-    MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
+    /* the job flows share the whole pool as one queue, no partitions */
+    if (params->flow & (App_FLOW_STEAL | App_FLOW_PUSH)) {
+        status = App_execJobs(params, result);
+        goto leave;
+    }
+    if (params->flow == App_FLOW_RPC) {
+        status = App_execCalls(params, result);
+        goto leave;
+    }
+    if (params->flow == App_FLOW_ASYNC) {
+        status = App_execAsync(params, result);
+        goto leave;
+    }
+
+    /* every core gets its own slice of the pool */
+    partSize = Module.poolSize / Module.numCores;
+    if (partSize > App_PARTITION_ALIGN) {
+        partSize &= ~(App_PARTITION_ALIGN - 1);
+    }
+    for (i = 0; i < Module.numCores; i++) {
+        status = App_coreSetup(&Module.cores[i], i * partSize, partSize);
+        if (status < 0) {
+            goto leave;
+        }
+    }
+
+    if (pthread_barrier_init(&Module.barrier, NULL, Module.numCores + 1) != 0) {
+        printf("Error: failed to create the loop barrier\n");
+        status = -1;
+        goto leave;
+    }
+    barrier = TRUE;
 
     printf("Starting Transfers\n");
-    for(loop = 0; loop < numLoops; loop++)
+    Module.gate = 0;
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        if (pthread_create(&core->thread, NULL, App_coreThread, core) != 0) {
+            printf("Error: failed to start the %s thread\n", core->name);
+            status = -1;
+            break;
+        }
+        started++;
+    }
+
+    /* open the gate, or send the started threads home */
+    pthread_mutex_lock(&Module.gateLock);
+    Module.gate = (started == Module.numCores) ? 1 : -1;
+    pthread_cond_broadcast(&Module.gateCond);
+    pthread_mutex_unlock(&Module.gateLock);
+
+    for(loop = 0; status == 0 && loop < params->numLoops; loop++)
     {
-        msgCount = 0;
-        msg = createAppMsg(App_CMD_SEND);
-        msg->data.startData.numBuffers = numBuffers;
-        msg->data.startData.payloadSize = payloadSize; 
-        MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
-        gettimeofday(&t1, NULL);
-        do
-        {
-            status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg, MessageQ_FOREVER);
-            if(msg->cmd == App_CMD_BUFFER)
-            {
-                data = sharedRegionAllocPtr + msg->data.bufferData.offset;
-#if ARM_CACHE_INV == 1
-                CMEM_cacheInv(data, msg->data.bufferData.dataLen);
-#endif
-                for(i = 0; i < msg->data.bufferData.dataLen/sizeof(PayloadType); i++)
-                {
-                    if(i+msgCount != ((PayloadType*)data)[i])
-                        printf("error: expected: %d, read: %d\n", i, ((PayloadType*)data)[i]);
-                }
-                bytesRx += msg->data.bufferData.dataLen;
-                msgCount++;
-            }
-            MessageQ_setReplyQueue(Module.hostQue, (MessageQ_Msg)msg);
-            MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
-        }while(msgCount != numBuffers);
-        gettimeofday(&t2, NULL);
-        elapsedTime = (t2.tv_sec - t1.tv_sec) * 1000.0;      // sec to ms
-        elapsedTime += (t2.tv_usec - t1.tv_usec) / 1000.0;   // us to ms
-        minTime = (minTime>elapsedTime)?elapsedTime:minTime;
-        maxTime = (maxTime<elapsedTime)?elapsedTime:maxTime;
-        averageTime += elapsedTime;
-        printf("Bytes received: %llu, elapsed time: %f ms.\n", bytesRx, elapsedTime);
-        printf("Data Rate: %f MBps\n", ((double)bytesRx/((double)elapsedTime / 1000.0))/1024.0/1024.0);
-        printf("csvheader, Payload Size, Bandwidth (MB/s), Buffers Transferred, Payload Data Type Size (B), ARM Cache Inv, DSP Cache WB, Transfer Time (ms), Bytes Transferred\n");
-        printf("csv, %d, %f, %d, %d, %d, %d, %f, %llu\n", payloadSize, ((double)bytesRx/((double)elapsedTime / 1000.0))/1024.0/1024.0, numBuffers, sizeof(PayloadType), ARM_CACHE_INV, DSP_CACHE_WB, elapsedTime, bytesRx);
-/*
-        msgCount = 0;
-        gettimeofday(&t1, NULL);
-        for(batch = 0; batch < numBatches; batch++)
-        {
-            // Create the send message
-            msg = createAppMsg();
-            if(msg == NULL)
-                goto leave;
-            msg->cmd = App_CMD_SEND;
-            msg->numMessages = msgPerSend; 
-            msg->phyAddress = CMEM_getPhys(sharedRegionAllocPtr);
-            // TODO make sure this all power of 2
-            msg->messageSize = bufSize;
-            // Tell the DSP to start sending the ARM messages
-            MessageQ_put(Module.slaveQue, (MessageQ_Msg)msg);
-            // Loop, getting all the messages we told the DSP to send
-            do
-            {
-                status = MessageQ_get(Module.hostQue, (MessageQ_Msg *)&msg, MessageQ_FOREVER);
-                CMEM_cacheInv(sharedRegionAllocPtr, BIG_DATA_POOL_SIZE);
-                data = (UInt32*)sharedRegionAllocPtr;
-                printf("phyAddress: %x\n", msg->phyAddress);
-                data += (msg->phyAddress - CMEM_getPhys(sharedRegionAllocPtr))/sizeof(UInt32);
-                printf("shared: %p, data: %p\n", sharedRegionAllocPtr, data);
-                for(i = 0; i < bufSize; i++)
-                {
-                    if(i != data[i])
-                        printf("error: expected: %d, read: %d\n", i, data[i]);
-                }
-                if(status < 0)
-                {
-                    printf("Error: bad status from DSP message, status: %x\n", status);
-                    goto leave;
-                }
-                msgCount++;
-                MessageQ_free((MessageQ_Msg)msg);
-            } while (msgCount % msgPerSend != 0);
-        }
-        gettimeofday(&t2, NULL);
-        elapsedTime = (t2.tv_sec - t1.tv_sec) * 1000.0;      // sec to ms
-        elapsedTime += (t2.tv_usec - t1.tv_usec) / 1000.0;   // us to ms
-        minTime = (minTime>elapsedTime)?elapsedTime:minTime;
-        maxTime = (maxTime<elapsedTime)?elapsedTime:maxTime;
-        averageTime += elapsedTime;
-        printf("Number messages received: %d, elapsed time: %f ms.\n", msgCount, elapsedTime);
-        */
+        Stats_loopBegin(total);
+        pthread_barrier_wait(&Module.barrier);
+        if (loop == params->warmupLoops) {
+            /* every core thread has started by now */
+            Sched_usage(&usage);
+        }
+        pthread_barrier_wait(&Module.barrier);
+        Stats_add(total, (UInt64)Module.numCores * numDirs * numBuffers *
+            payloadSize, Module.numCores * numDirs * numBuffers);
+        Stats_loopEnd(total);
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(Module.cores[i].thread, NULL);
+    }
+    if (status < 0) {
+        goto leave;
     }
     printf("Transfers Complete\n");
-    averageTime = averageTime/numLoops;
-    printf("Min time: %f ms, Average Time: %f ms Max time: %f ms\n", minTime, averageTime, maxTime);
-    avgTimePerMsg = averageTime/(payloadSize*numBuffers);
-    printf("Average transfer time per message: %f ms\n", avgTimePerMsg);
+    Sched_usageSince(&usage, &Module.usage);
+    Sched_report();
+    printf("Host faults in measured loops: %llu minor, %llu major\n",
+        (unsigned long long)Module.usage.minorFaults,
+        (unsigned long long)Module.usage.majorFaults);
+    printf("Host context switches in measured loops: %llu voluntary, "
+        "%llu involuntary\n", (unsigned long long)Module.usage.voluntary,
+        (unsigned long long)Module.usage.involuntary);
+
+    /* the closing clock sync, to correct for drift over the run */
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        if (core->latency != NULL && core->status >= 0 &&
+                App_coreSync(core, core->latency) < 0) {
+            printf("Warning: %s clock sync after the run failed\n",
+                core->name);
+        }
+    }
+
+    errors = 0;
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        App_coreReport(core, result);
+        errors += core->errors + core->h2d.errors;
+        if (core->status < 0) {
+            status = core->status;
+        }
+    }
+    Stats_report(total, &summary);
+    App_printCsv(params, "all", params->flow, &summary, NULL, NULL, NULL,
+        NULL, errors);
+    result->mbps = summary.mbps;
+    result->msgPerSec = summary.msgPerSec;
+    result->errors = errors;
 
 leave:
     printf("<-- App_exec: %d\n", status);
+    /* stop the pipeline threads before the buffer goes away */
+    for (i = 0; i < Module.numCores; i++) {
+        core = &Module.cores[i];
+        Pipeline_delete(&core->pipeline);
+        Stats_delete(&core->d2hStats);
+        Stats_delete(&core->h2dStats);
+        Credit_delete(&core->credit);
+        Latency_delete(&core->latency);
+        Receive_delete(&core->receive);
+    }
+    if (barrier) {
+        pthread_barrier_destroy(&Module.barrier);
+    }
+    if (Module.trace != NULL) {
+        /* the DSPs stop writing before the rings go away */
+        App_traceStop(params, status >= 0);
+    }
     if (sharedRegionAllocPtr) {
         /* free the message */
         CMEM_free(sharedRegionAllocPtr, &cmemAttrs);
     }
+    if (cmem) {
+        CMEM_exit();
+    }
+    Stats_delete(&total);
     return(status);
 }
@@ -41,9 +41,74 @@
 extern "C" {
 #endif
 
-Int App_create(UInt16 remoteProcId);
+/* remote cores one run can drive at once */
+#define App_MAX_CORES   4
+
+/* cache handling of the shared CMEM buffer on each side */
+typedef struct {
+    Bool    armCached;      /* cached CMEM mapping, CMEM_cacheInv on receive */
+    Bool    dspCached;      /* DSP caches the region and writes back */
+    Bool    dspWbWait;      /* DSP waits for its Cache_wb to complete */
+} App_CachePolicy;
+
+/* data flow, App_FLOW_D2H | App_FLOW_H2D runs both directions at once */
+#define App_FLOW_D2H    0x1     /* DSP fills buffers, host verifies */
+#define App_FLOW_H2D    0x2     /* host fills slots, DSP verifies */
+#define App_FLOW_DUPLEX (App_FLOW_D2H | App_FLOW_H2D)
+#define App_FLOW_SINGLE 0x4     /* one buffer in flight, latency measured */
+#define App_FLOW_PING   (App_FLOW_D2H | App_FLOW_SINGLE)
+#define App_FLOW_STEAL  0x8     /* DSPs pull jobs from a queue in CMEM */
+#define App_FLOW_PUSH   0x10    /* host sends every job as a message */
+#define App_FLOW_RPC    0x20    /* typed calls, see Rpc.h */
+#define App_FLOW_ASYNC  0x40    /* typed calls, see RpcAsync.h */
+
+/* outstanding call counts one async run can step through */
+#define App_MAX_DEPTHS  8
+
+typedef struct {
+    UInt32          numLoops;
+    UInt32          numBuffers;     /* buffers the DSP sends per loop */
+    UInt32          payloadSize;
+    UInt32          warmupLoops;    /* leading loops left out of the stats */
+    UInt32          flow;           /* App_FLOW_xxx */
+    UInt32          numWorkers;     /* pipeline workers, 0 receives inline */
+    Bool            inOrder;        /* pipeline returns buffers in order */
+    UInt32          creditWindow;   /* DSP buffers in flight, 0 no credits */
+    UInt32          creditBatch;    /* finished buffers per credit grant */
+    UInt32          verifyStride;   /* host checks every Nth line, 0 none */
+    UInt32          elemSize;       /* App_ELEM_xxx, width of the ramp */
+    UInt32          spinUs;         /* receive polling cap, 0 blocks */
+    UInt32          loadPct;        /* background load running, for the csv */
+    UInt32          numJobs;        /* steal and push: jobs per loop */
+    UInt32          jobWork;        /* LCG steps of the median job */
+    UInt32          jobSpread;      /* largest over median job, 1 even */
+    UInt32          jobWindow;      /* push: jobs in flight per core */
+    UInt32          numCalls;       /* rpc: calls of each kind per loop */
+    UInt32          callWindow;     /* rpc and async: calls on the wire
+                                     * per core */
+    UInt32          depths[App_MAX_DEPTHS]; /* async: calls outstanding */
+    UInt32          numDepths;
+    App_CachePolicy policy;
+    String          traceFile;      /* Chrome trace of the run, NULL none */
+} App_Params;
+
+/* what one run measured, to compare runs against each other */
+typedef struct {
+    double          mbps;           /* all cores together */
+    double          msgPerSec;
+    double          p50Us;          /* the worst core's buffer interval */
+    double          p99Us;
+    double          oneWayP99Us;    /* the worst core's, ping only */
+    double          jobsPerSec;     /* steal and push only */
+    double          callsPerSec;    /* rpc in flight, async best depth */
+    UInt32          errors;
+} App_Result;
+
+Void App_Params_init(App_Params *params);
+String App_flowName(UInt32 flow);
+Int App_create(const UInt16 *procIds, UInt32 numProcs);
 Int App_delete();
-Int App_exec(UInt32 numLoops, UInt32 msgPerSend, UInt32 numBatches);
+Int App_exec(const App_Params *params, App_Result *result);
 
 
 #if defined (__cplusplus)
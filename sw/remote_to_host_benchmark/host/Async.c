@@ -0,0 +1,497 @@
+/*
+ *  ======== Async.c ========
+ *  Call rate and latency of RpcAsync against the calls outstanding.
+ *
+ *  For each depth the host threads keep depth echo calls outstanding
+ *  between them, spread round robin over the cores, and numCalls made
+ *  in all. A thread starts a call whenever one of its own is free and
+ *  never waits for a DSP otherwise; the calls finish in a callback on
+ *  the receive thread, which checks the result, keeps the latency and
+ *  hands the call back to its thread. Depths past window calls per core
+ *  wait in RpcAsync's backlog, so they show what holding calls on the
+ *  host costs and gains.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "../shared/Rpc.h"
+#include "Stats.h"
+#include "RpcAsync.h"
+#include "Async.h"
+
+typedef struct Async_Thread Async_Thread;
+
+/* one call outstanding */
+typedef struct {
+    RpcAsync_Future     future;
+    Async_Thread *      thread;
+    Rpc_echo_Out        out;
+    UInt32              expect;
+    UInt64              start;
+} Async_Call;
+
+/* one host thread starting calls */
+struct Async_Thread {
+    pthread_t           thread;
+    UInt32              id;
+    UInt32              depth;      // calls it keeps outstanding
+    UInt32              numCalls;
+    Async_Call *        calls;
+    Async_Call **       free;       // a stack, numFree of them
+    UInt32              numFree;
+    Bool                waiting;    // for a free call
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    UInt32 *            samples;    // ns per call, by the receive thread
+    UInt32              numSamples;
+    UInt32              errors;
+};
+
+/* one depth over the measured loops */
+typedef struct {
+    UInt64              calls;
+    UInt64              ns;
+    UInt32 *            samples;
+    UInt32              numSamples;
+    UInt32              maxBacklog;
+    UInt32              errors;
+} Async_Total;
+
+/* module structure */
+typedef struct {
+    const Async_Params *params;
+    RpcAsync_Handle     rpc;
+    UInt32              numThreads; // for the depth running
+    Async_Thread        threads[Async_MAX_THREADS];
+    pthread_mutex_t     gateLock;   // the threads start together
+    pthread_cond_t      gateCond;
+    Bool                gateOpen;
+    Bool                abort;
+    Async_Total         totals[Async_MAX_DEPTHS];
+    Bool                csvHeader;
+} Async_Module;
+
+/* private data */
+static Async_Module Module;
+
+
+/*
+ *  ======== Async_done ========
+ *  A call came back, on the receive thread.
+ */
+static Void Async_done(RpcAsync_Future *future, Ptr arg)
+{
+    Async_Call *call = (Async_Call *)arg;
+    Async_Thread *thread = call->thread;
+    UInt64 now = Stats_now();
+
+    if (future->status != Rpc_S_SUCCESS || call->out.value != call->expect) {
+        if (thread->errors++ < 8) {
+            printf("Error: call %u returned %d, 0x%x for 0x%x\n",
+                future->seq, future->status, call->out.value, call->expect);
+        }
+    }
+    else if (thread->numSamples < thread->numCalls) {
+        thread->samples[thread->numSamples++] = (UInt32)(now - call->start);
+    }
+
+    pthread_mutex_lock(&thread->lock);
+    thread->free[thread->numFree++] = call;
+    if (thread->waiting) {
+        pthread_cond_signal(&thread->cond);
+    }
+    pthread_mutex_unlock(&thread->lock);
+}
+
+/*
+ *  ======== Async_threadFxn ========
+ */
+static void *Async_threadFxn(void *arg)
+{
+    Async_Thread *thread = (Async_Thread *)arg;
+    UInt32 numCores = Module.params->numCores;
+    Async_Call *call;
+    Rpc_echo_In in;
+    UInt32 k;
+    Int status;
+
+    pthread_mutex_lock(&Module.gateLock);
+    while (!Module.gateOpen) {
+        pthread_cond_wait(&Module.gateCond, &Module.gateLock);
+    }
+    pthread_mutex_unlock(&Module.gateLock);
+    if (Module.abort) {
+        return (NULL);
+    }
+
+    for (k = 0; k < thread->numCalls; k++) {
+        pthread_mutex_lock(&thread->lock);
+        while (thread->numFree == 0) {
+            thread->waiting = TRUE;
+            pthread_cond_wait(&thread->cond, &thread->lock);
+        }
+        thread->waiting = FALSE;
+        call = thread->free[--thread->numFree];
+        pthread_mutex_unlock(&thread->lock);
+
+        in.value = (thread->id << 24) ^ k;
+        call->expect = in.value;
+        call->start = Stats_now();
+        status = RpcAsync_echo(Module.rpc, (k + thread->id) % numCores, &in,
+            &call->out, &call->future);
+        if (status < 0) {
+            printf("Error: thread %u call %u not started, %d\n", thread->id,
+                k, status);
+            pthread_mutex_lock(&thread->lock);
+            thread->errors++;
+            thread->free[thread->numFree++] = call;
+            pthread_mutex_unlock(&thread->lock);
+        }
+    }
+
+    /* until the last of them is back */
+    pthread_mutex_lock(&thread->lock);
+    while (thread->numFree < thread->depth) {
+        thread->waiting = TRUE;
+        pthread_cond_wait(&thread->cond, &thread->lock);
+    }
+    thread->waiting = FALSE;
+    pthread_mutex_unlock(&thread->lock);
+
+    return (NULL);
+}
+
+/*
+ *  ======== Async_depth ========
+ *  numCalls with depth outstanding, added to total when measured.
+ */
+static Int Async_depth(UInt32 depth, Async_Total *total, Bool measured,
+        double *perSec)
+{
+    const Async_Params *params = Module.params;
+    UInt32 numThreads = params->numThreads;
+    RpcAsync_Stats stats;
+    Async_Thread *thread;
+    UInt32 errors = 0;
+    UInt32 started = 0;
+    UInt64 start, ns;
+    UInt32 i, c;
+    Int status = 0;
+
+    if (numThreads > depth) {
+        numThreads = depth;
+    }
+    Module.numThreads = numThreads;
+
+    /* the threads split the depth and the calls */
+    for (i = 0; i < numThreads; i++) {
+        thread = &Module.threads[i];
+        memset(thread, 0, sizeof(Async_Thread));
+        pthread_mutex_init(&thread->lock, NULL);
+        pthread_cond_init(&thread->cond, NULL);
+        thread->id = i;
+        thread->depth = depth / numThreads + (i < depth % numThreads);
+        thread->numCalls = params->numCalls / numThreads +
+            (i < params->numCalls % numThreads);
+        thread->calls = (Async_Call *)calloc(thread->depth,
+            sizeof(Async_Call));
+        thread->free = (Async_Call **)malloc(thread->depth *
+            sizeof(Async_Call *));
+        thread->samples = (UInt32 *)malloc((thread->numCalls + 1) *
+            sizeof(UInt32));
+        if (thread->calls == NULL || thread->free == NULL ||
+                thread->samples == NULL) {
+            printf("Error: out of memory for depth %u\n", depth);
+            numThreads = i + 1;
+            status = -1;
+            goto leave;
+        }
+        for (c = 0; c < thread->depth; c++) {
+            RpcAsync_Future_init(&thread->calls[c].future, Async_done,
+                &thread->calls[c]);
+            thread->calls[c].thread = thread;
+            thread->free[c] = &thread->calls[c];
+        }
+        thread->numFree = thread->depth;
+    }
+
+    Module.gateOpen = FALSE;
+    Module.abort = FALSE;
+    for (i = 0; i < numThreads; i++) {
+        if (pthread_create(&Module.threads[i].thread, NULL, Async_threadFxn,
+                &Module.threads[i]) != 0) {
+            printf("Error: failed to start thread %u\n", i);
+            Module.abort = TRUE;
+            status = -1;
+            break;
+        }
+        started++;
+    }
+
+    pthread_mutex_lock(&Module.gateLock);
+    Module.gateOpen = TRUE;
+    start = Stats_now();
+    pthread_cond_broadcast(&Module.gateCond);
+    pthread_mutex_unlock(&Module.gateLock);
+    for (i = 0; i < started; i++) {
+        pthread_join(Module.threads[i].thread, NULL);
+    }
+    ns = Stats_now() - start;
+    if (status < 0) {
+        goto leave;
+    }
+
+    RpcAsync_stats(Module.rpc, &stats, TRUE);
+    for (i = 0; i < numThreads; i++) {
+        errors += Module.threads[i].errors;
+    }
+    *perSec = (ns > 0) ? params->numCalls / (ns / 1e9) : 0.0;
+
+    if (measured) {
+        total->calls += params->numCalls;
+        total->ns += ns;
+        total->errors += errors;
+        if (stats.maxBacklog > total->maxBacklog) {
+            total->maxBacklog = stats.maxBacklog;
+        }
+        for (i = 0; i < numThreads; i++) {
+            thread = &Module.threads[i];
+            memcpy(total->samples + total->numSamples, thread->samples,
+                thread->numSamples * sizeof(UInt32));
+            total->numSamples += thread->numSamples;
+        }
+    }
+
+leave:
+    for (i = 0; i < numThreads; i++) {
+        thread = &Module.threads[i];
+        pthread_cond_destroy(&thread->cond);
+        pthread_mutex_destroy(&thread->lock);
+        free(thread->calls);
+        free(thread->free);
+        free(thread->samples);
+        memset(thread, 0, sizeof(Async_Thread));
+    }
+
+    return (status);
+}
+
+/*
+ *  ======== Async_compare ========
+ */
+static int Async_compare(const void *a, const void *b)
+{
+    UInt32 x = *(const UInt32 *)a;
+    UInt32 y = *(const UInt32 *)b;
+
+    return ((x > y) - (x < y));
+}
+
+/*
+ *  ======== Async_percentile ========
+ *  In us, of sorted samples.
+ */
+static double Async_percentile(const Async_Total *total, double pct)
+{
+    UInt32 i;
+
+    if (total->numSamples == 0) {
+        return (0.0);
+    }
+    i = (UInt32)(pct / 100.0 * (total->numSamples - 1) + 0.5);
+
+    return (total->samples[i] / 1e3);
+}
+
+/*
+ *  ======== Async_open ========
+ *  The client, and the schema check on every core.
+ */
+static Int Async_open(Void)
+{
+    const Async_Params *params = Module.params;
+    RpcAsync_Params rpcParams;
+    RpcAsync_Future future;
+    UInt32 maxDepth = 0;
+    Rpc_info_In in;
+    Rpc_info_Out out;
+    UInt32 i;
+    Int status;
+
+    RpcAsync_Params_init(&rpcParams);
+    rpcParams.numCores = params->numCores;
+    for (i = 0; i < params->numCores; i++) {
+        rpcParams.slaveQues[i] = params->slaveQues[i];
+    }
+    for (i = 0; i < params->numDepths; i++) {
+        if (params->depths[i] > maxDepth) {
+            maxDepth = params->depths[i];
+        }
+    }
+    rpcParams.maxOutstanding = maxDepth;
+    rpcParams.window = params->window;
+    Module.rpc = RpcAsync_create(&rpcParams);
+    if (Module.rpc == NULL) {
+        printf("Error: failed to create the async client\n");
+        return (-1);
+    }
+
+    for (i = 0; i < params->numCores; i++) {
+        in.version = Rpc_VERSION;
+        RpcAsync_Future_init(&future, NULL, NULL);
+        status = RpcAsync_info(Module.rpc, i, &in, &out, &future);
+        if (status == 0) {
+            status = RpcAsync_wait(Module.rpc, &future, 1000000);
+        }
+        if (status == 0) {
+            status = future.status;
+        }
+        if (status == Rpc_E_VERSION) {
+            printf("Error: %s serves schema %u, the host has %u\n",
+                params->names[i], out.version, Rpc_VERSION);
+            return (-1);
+        }
+        if (status < 0) {
+            printf("Error: %s did not answer Rpc_info, %d\n",
+                params->names[i], status);
+            return (-1);
+        }
+        printf("Rpc: %s schema %u, Timestamp %u Hz\n", params->names[i],
+            out.version, out.tsFreq);
+    }
+    RpcAsync_stats(Module.rpc, NULL, TRUE);
+
+    return (0);
+}
+
+/*
+ *  ======== Async_print ========
+ */
+static Void Async_print(UInt32 loops, Async_Summary *summary)
+{
+    const Async_Params *params = Module.params;
+    Async_Total *total;
+    double s, perSec;
+    UInt32 d;
+
+    printf("Async: %u echo calls per depth, %u threads, %u on the wire per "
+        "core, %u loops measured\n", params->numCalls, params->numThreads,
+        params->window, loops);
+    printf("    depth      calls/s        us per call  p50 us     "
+        "p99 us     backlog    errors\n");
+    for (d = 0; d < params->numDepths; d++) {
+        total = &Module.totals[d];
+        qsort(total->samples, total->numSamples, sizeof(UInt32),
+            Async_compare);
+        s = total->ns / 1e9;
+        perSec = (s > 0) ? total->calls / s : 0.0;
+        printf("    %-10u %-14.1f %-12.3f %-10.2f %-10.2f %-10u %u\n",
+            params->depths[d], perSec,
+            total->calls > 0 ? total->ns / 1e3 / total->calls : 0.0,
+            Async_percentile(total, 50.0), Async_percentile(total, 99.0),
+            total->maxBacklog, total->errors);
+
+        if (perSec > summary->peakPerSec) {
+            summary->peakPerSec = perSec;
+            summary->peakDepth = params->depths[d];
+        }
+        summary->errors += total->errors;
+    }
+
+    if (!Module.csvHeader) {
+        printf("csvasyncheader, Depth, Cores, Threads, Window, Calls per Depth, Loops Measured, Calls, Time (ms), Calls/s, Host us per Call, p50 us, p99 us, Max Backlog, Errors\n");
+        Module.csvHeader = TRUE;
+    }
+    for (d = 0; d < params->numDepths; d++) {
+        total = &Module.totals[d];
+        s = total->ns / 1e9;
+        printf("csvasync, %u, %u, %u, %u, %u, %u, %llu, %f, %f, %f, %f, %f, %u, %u\n", params->depths[d], params->numCores, params->numThreads, params->window, params->numCalls, loops, (unsigned long long)total->calls, total->ns / 1e6, s > 0 ? total->calls / s : 0.0, total->calls > 0 ? total->ns / 1e3 / total->calls : 0.0, Async_percentile(total, 50.0), Async_percentile(total, 99.0), total->maxBacklog, total->errors);
+    }
+}
+
+/*
+ *  ======== Async_run ========
+ */
+Int Async_run(const Async_Params *params, Async_Summary *summary)
+{
+    UInt32 measured = params->numLoops - params->warmupLoops;
+    UInt32 loops = 0;
+    double perSec;
+    UInt32 loop, d;
+    Int status = 0;
+
+    memset(summary, 0, sizeof(Async_Summary));
+    memset(Module.totals, 0, sizeof(Module.totals));
+    Module.params = params;
+    pthread_mutex_init(&Module.gateLock, NULL);
+    pthread_cond_init(&Module.gateCond, NULL);
+
+    if (params->numCores == 0 || params->numCores > Async_MAX_CORES ||
+            params->numThreads == 0 ||
+            params->numThreads > Async_MAX_THREADS ||
+            params->numDepths == 0 || params->numDepths > Async_MAX_DEPTHS ||
+            params->numCalls == 0 || params->window == 0) {
+        printf("Error: bad async benchmark parameters\n");
+        return (-1);
+    }
+    for (d = 0; d < params->numDepths; d++) {
+        if (params->depths[d] == 0 ||
+                params->depths[d] > RpcAsync_MAX_OUTSTANDING) {
+            printf("Error: depth %u is not in 1..%u\n", params->depths[d],
+                RpcAsync_MAX_OUTSTANDING);
+            return (-1);
+        }
+        Module.totals[d].samples = (UInt32 *)malloc(
+            (UInt64)params->numCalls * measured * sizeof(UInt32) + 1);
+        if (Module.totals[d].samples == NULL) {
+            printf("Error: out of memory for the latency samples\n");
+            status = -1;
+            goto leave;
+        }
+    }
+
+    status = Async_open();
+    if (status < 0) {
+        goto leave;
+    }
+
+    for (loop = 0; loop < params->numLoops; loop++) {
+        printf("Async loop %u:", loop);
+        for (d = 0; d < params->numDepths; d++) {
+            status = Async_depth(params->depths[d], &Module.totals[d],
+                loop >= params->warmupLoops, &perSec);
+            if (status < 0) {
+                printf("\n");
+                goto leave;
+            }
+            printf(" %u %.0f/s%s", params->depths[d], perSec,
+                d + 1 < params->numDepths ? "," : "\n");
+        }
+        if (loop >= params->warmupLoops) {
+            loops++;
+        }
+    }
+
+    Async_print(loops, summary);
+
+leave:
+    RpcAsync_delete(&Module.rpc);
+    for (d = 0; d < Async_MAX_DEPTHS; d++) {
+        free(Module.totals[d].samples);
+        Module.totals[d].samples = NULL;
+    }
+    pthread_cond_destroy(&Module.gateCond);
+    pthread_mutex_destroy(&Module.gateLock);
+
+    return (status);
+}
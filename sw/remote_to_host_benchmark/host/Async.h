@@ -0,0 +1,41 @@
+/*
+ *  ======== Async.h ========
+ *  Call rate and latency of RpcAsync against the calls outstanding.
+ */
+
+#ifndef Async__include
+#define Async__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Async_MAX_CORES     4
+#define Async_MAX_DEPTHS    8
+#define Async_MAX_THREADS   8
+
+typedef struct {
+    UInt32              numCores;
+    String              names[Async_MAX_CORES];
+    MessageQ_QueueId    slaveQues[Async_MAX_CORES];
+    UInt32              numThreads; /* host threads starting calls */
+    UInt32              numCalls;   /* per depth and loop */
+    UInt32              window;     /* calls on the wire per core */
+    UInt32              depths[Async_MAX_DEPTHS]; /* calls outstanding */
+    UInt32              numDepths;
+    UInt32              numLoops;
+    UInt32              warmupLoops;
+} Async_Params;
+
+typedef struct {
+    double      peakPerSec;     /* best depth */
+    UInt32      peakDepth;
+    UInt32      errors;
+} Async_Summary;
+
+Int Async_run(const Async_Params *params, Async_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Async__include */
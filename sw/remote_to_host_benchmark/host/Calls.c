@@ -0,0 +1,423 @@
+/*
+ *  ======== Calls.c ========
+ *  Call rate of the typed calls in Rpc.h.
+ *
+ *  Each loop runs numCalls of every kind below, spread round robin over
+ *  the cores from one host thread, one RpcClient per core. The sync
+ *  kind waits for every call; the others keep up to window calls in
+ *  flight per core and wait for a core's oldest when it has no room.
+ *  A sum covers bulkSize bytes, copied Rpc_SUM_MAX bytes per call or
+ *  passed as one Rpc_Bulk. Every result is checked.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "../shared/Rpc.h"
+#include "Stats.h"
+#include "RpcClient.h"
+#include "Calls.h"
+
+/* the kinds of call a loop runs */
+#define Calls_ECHO_SYNC 0
+#define Calls_ECHO      1
+#define Calls_ADD       2
+#define Calls_SUM_COPY  3
+#define Calls_SUM_BULK  4
+#define Calls_NUM_KINDS 5
+
+/* one call in flight */
+typedef struct {
+    RpcClient_Future    future;
+    UInt32              expect;
+    union {
+        Rpc_echo_Out    echo;
+        Rpc_add_Out     add;
+        Rpc_sum_Out     sum;
+        Rpc_sumBulk_Out sumBulk;
+    } out;
+} Calls_Slot;
+
+/* one core */
+typedef struct {
+    RpcClient_Handle    client;
+    Calls_Slot *        slots;      // window of them, a ring
+    UInt32              head;       // oldest call in flight
+    UInt32              count;      // calls in flight
+    UInt32              tsFreq;     // DSP Timestamp
+} Calls_Core;
+
+/* one kind over the measured loops */
+typedef struct {
+    UInt64              calls;
+    UInt64              ops;        // sums, several calls each by copy
+    UInt64              ns;
+    double              dspUs;      // in the calls, all cores
+    UInt32              errors;
+} Calls_Total;
+
+/* module structure */
+typedef struct {
+    const Calls_Params *params;
+    Calls_Core          cores[Calls_MAX_CORES];
+    UInt8 *             bulk;       // params->base
+    UInt32              numChunks;  // by-copy calls per sum
+    UInt32 *            chunkSums;
+    UInt32              bulkSum;
+    Calls_Total         totals[Calls_NUM_KINDS];
+    Bool                csvHeader;
+} Calls_Module;
+
+/* private data */
+static Calls_Module Module;
+
+static String Calls_kindNames[Calls_NUM_KINDS] = {
+    "echo sync", "echo", "add", "sum copy", "sum bulk"
+};
+
+
+/*
+ *  ======== Calls_bytes ========
+ */
+static UInt32 Calls_bytes(const UInt8 *data, UInt32 size)
+{
+    UInt32 sum = 0;
+    UInt32 i;
+
+    for (i = 0; i < size; i++) {
+        sum += data[i];
+    }
+
+    return (sum);
+}
+
+/*
+ *  ======== Calls_finish ========
+ *  Wait for a core's oldest call and check what came back.
+ */
+static Int Calls_finish(Calls_Core *core, UInt32 kind, Calls_Total *total)
+{
+    Calls_Slot *slot = &core->slots[core->head];
+    UInt32 got;
+    Int status;
+
+    status = RpcClient_wait(core->client, &slot->future);
+    if (status < 0) {
+        return (status);
+    }
+
+    switch (kind) {
+        case Calls_ECHO_SYNC:
+        case Calls_ECHO:        got = slot->out.echo.value; break;
+        case Calls_ADD:         got = (UInt32)slot->out.add.sum; break;
+        case Calls_SUM_COPY:    got = slot->out.sum.sum; break;
+        default:                got = slot->out.sumBulk.sum; break;
+    }
+    if (slot->future.status != Rpc_S_SUCCESS || got != slot->expect) {
+        if (total->errors < 8) {
+            printf("Error: %s call %u returned %d, 0x%x for 0x%x\n",
+                Calls_kindNames[kind], slot->future.seq,
+                slot->future.status, got, slot->expect);
+        }
+        total->errors++;
+    }
+    if (core->tsFreq > 0) {
+        total->dspUs += slot->future.ticks * 1e6 / core->tsFreq;
+    }
+
+    core->head = (core->head + 1) % Module.params->window;
+    core->count--;
+
+    return (0);
+}
+
+/*
+ *  ======== Calls_issue ========
+ *  Call k of a kind on a core, waiting for room in its window.
+ */
+static Int Calls_issue(Calls_Core *core, UInt32 kind, UInt32 k,
+        Calls_Total *total)
+{
+    const Calls_Params *params = Module.params;
+    UInt32 window = (kind == Calls_ECHO_SYNC) ? 1 : params->window;
+    Calls_Slot *slot;
+    Rpc_echo_In echo;
+    Rpc_add_In add;
+    Rpc_sum_In sum;
+    Rpc_sumBulk_In sumBulk;
+    UInt32 chunk;
+    Int status;
+
+    while (core->count >= window) {
+        status = Calls_finish(core, kind, total);
+        if (status < 0) {
+            return (status);
+        }
+    }
+    slot = &core->slots[(core->head + core->count) % params->window];
+
+    switch (kind) {
+        case Calls_ECHO_SYNC:
+        case Calls_ECHO:
+            echo.value = k;
+            slot->expect = k;
+            status = RpcClient_echoStart(core->client, &echo, &slot->out.echo,
+                &slot->future);
+            break;
+
+        case Calls_ADD:
+            add.a = (Int32)k;
+            add.b = 7 - 2 * (Int32)k;
+            slot->expect = (UInt32)(add.a + add.b);
+            status = RpcClient_addStart(core->client, &add, &slot->out.add,
+                &slot->future);
+            break;
+
+        case Calls_SUM_COPY:
+            chunk = k % Module.numChunks;
+            sum.size = params->bulkSize - chunk * Rpc_SUM_MAX;
+            if (sum.size > Rpc_SUM_MAX) {
+                sum.size = Rpc_SUM_MAX;
+            }
+            memcpy(sum.data, Module.bulk + chunk * Rpc_SUM_MAX, sum.size);
+            slot->expect = Module.chunkSums[chunk];
+            status = RpcClient_sumStart(core->client, &sum, &slot->out.sum,
+                &slot->future);
+            break;
+
+        default:
+            RpcClient_bulk(&sumBulk.data, Module.bulk, params->bulkSize,
+                params->armCached);
+            slot->expect = Module.bulkSum;
+            status = RpcClient_sumBulkStart(core->client, &sumBulk,
+                &slot->out.sumBulk, &slot->future);
+            break;
+    }
+    if (status < 0) {
+        return (status);
+    }
+    core->count++;
+    total->calls++;
+
+    return (0);
+}
+
+/*
+ *  ======== Calls_kind ========
+ *  numCalls of one kind over every core, returns the time taken.
+ */
+static Int Calls_kind(UInt32 kind, Calls_Total *total)
+{
+    const Calls_Params *params = Module.params;
+    UInt32 numCalls = params->numCalls;
+    UInt64 start;
+    UInt32 k, i;
+    Int status = 0;
+
+    if (kind == Calls_SUM_COPY) {
+        numCalls *= Module.numChunks;
+    }
+
+    start = Stats_now();
+    for (k = 0; status == 0 && k < numCalls; k++) {
+        status = Calls_issue(&Module.cores[k % params->numCores], kind, k,
+            total);
+    }
+    for (i = 0; i < params->numCores; i++) {
+        while (status == 0 && Module.cores[i].count > 0) {
+            status = Calls_finish(&Module.cores[i], kind, total);
+        }
+    }
+    total->ns += Stats_now() - start;
+    total->ops += params->numCalls;
+
+    return (status);
+}
+
+/*
+ *  ======== Calls_open ========
+ *  A client per core, and the schema check.
+ */
+static Int Calls_open(Void)
+{
+    const Calls_Params *params = Module.params;
+    RpcClient_Params clientParams;
+    Calls_Core *core;
+    Rpc_info_In in;
+    Rpc_info_Out out;
+    UInt32 i;
+    Int status;
+
+    for (i = 0; i < params->numCores; i++) {
+        core = &Module.cores[i];
+        RpcClient_Params_init(&clientParams);
+        clientParams.hostQue = params->hostQues[i];
+        clientParams.slaveQue = params->slaveQues[i];
+        clientParams.maxPending = params->window;
+        core->client = RpcClient_create(&clientParams);
+        core->slots = (Calls_Slot *)calloc(params->window, sizeof(Calls_Slot));
+        if (core->client == NULL || core->slots == NULL) {
+            printf("Error: failed to create the %s client\n",
+                params->names[i]);
+            return (-1);
+        }
+
+        in.version = Rpc_VERSION;
+        status = RpcClient_info(core->client, &in, &out);
+        if (status == Rpc_E_VERSION) {
+            printf("Error: %s serves schema %u, the host has %u\n",
+                params->names[i], out.version, Rpc_VERSION);
+            return (-1);
+        }
+        if (status < 0) {
+            printf("Error: %s did not answer Rpc_info, %d\n",
+                params->names[i], status);
+            return (-1);
+        }
+        core->tsFreq = out.tsFreq;
+        printf("Rpc: %s schema %u, Timestamp %u Hz\n", params->names[i],
+            out.version, out.tsFreq);
+    }
+
+    return (0);
+}
+
+/*
+ *  ======== Calls_print ========
+ */
+static Void Calls_print(UInt32 loops, Calls_Summary *summary)
+{
+    const Calls_Params *params = Module.params;
+    Calls_Total *total;
+    double s, perSec, mbps;
+    UInt32 kind;
+
+    printf("Calls: %u per kind, %u in flight per core, %u byte sums, "
+        "%u loops measured\n", params->numCalls, params->window,
+        params->bulkSize, loops);
+    printf("    call       in flight  calls/s        us per call  "
+        "DSP us/call  MB/s       errors\n");
+    for (kind = 0; kind < Calls_NUM_KINDS; kind++) {
+        total = &Module.totals[kind];
+        s = total->ns / 1e9;
+        perSec = (s > 0) ? total->calls / s : 0.0;
+        mbps = (kind >= Calls_SUM_COPY && s > 0) ?
+            total->ops * (double)params->bulkSize / s / 1e6 : 0.0;
+        printf("    %-10s %-10u %-14.1f %-12.3f %-12.3f %-10.3f %u\n",
+            Calls_kindNames[kind],
+            kind == Calls_ECHO_SYNC ? 1 : params->window, perSec,
+            total->calls > 0 ? total->ns / 1e3 / total->calls : 0.0,
+            total->calls > 0 ? total->dspUs / total->calls : 0.0, mbps,
+            total->errors);
+
+        switch (kind) {
+            case Calls_ECHO_SYNC:   summary->callsPerSec = perSec; break;
+            case Calls_ECHO:        summary->asyncPerSec = perSec; break;
+            case Calls_SUM_COPY:    summary->copyMBps = mbps; break;
+            case Calls_SUM_BULK:    summary->bulkMBps = mbps; break;
+            default:                break;
+        }
+        summary->errors += total->errors;
+    }
+
+    if (!Module.csvHeader) {
+        printf("csvcallsheader, Call, Cores, Calls per Kind, In Flight, Sum Bytes, Loops Measured, Calls, Time (ms), Calls/s, Host us per Call, DSP us per Call, MB/s, ARM Cached, Errors\n");
+        Module.csvHeader = TRUE;
+    }
+    for (kind = 0; kind < Calls_NUM_KINDS; kind++) {
+        total = &Module.totals[kind];
+        s = total->ns / 1e9;
+        printf("csvcalls, %s, %u, %u, %u, %u, %u, %llu, %f, %f, %f, %f, %f, %d, %u\n", Calls_kindNames[kind], params->numCores, params->numCalls, kind == Calls_ECHO_SYNC ? 1 : params->window, params->bulkSize, loops, (unsigned long long)total->calls, total->ns / 1e6, s > 0 ? total->calls / s : 0.0, total->calls > 0 ? total->ns / 1e3 / total->calls : 0.0, total->calls > 0 ? total->dspUs / total->calls : 0.0, (kind >= Calls_SUM_COPY && s > 0) ? total->ops * (double)params->bulkSize / s / 1e6 : 0.0, params->armCached, total->errors);
+    }
+}
+
+/*
+ *  ======== Calls_run ========
+ */
+Int Calls_run(const Calls_Params *params, Calls_Summary *summary)
+{
+    Calls_Total loopTotals[Calls_NUM_KINDS];
+    Calls_Total *total;
+    UInt32 loops = 0;
+    UInt32 loop, kind, i;
+    Int status = 0;
+
+    memset(summary, 0, sizeof(Calls_Summary));
+    memset(Module.cores, 0, sizeof(Module.cores));
+    memset(Module.totals, 0, sizeof(Module.totals));
+    Module.params = params;
+    Module.bulk = (UInt8 *)params->base;
+    Module.numChunks = (params->bulkSize + Rpc_SUM_MAX - 1) / Rpc_SUM_MAX;
+    Module.chunkSums = (UInt32 *)calloc(Module.numChunks, sizeof(UInt32));
+
+    if (params->numCores > Calls_MAX_CORES || params->window == 0 ||
+            params->bulkSize == 0 || Module.chunkSums == NULL) {
+        printf("Error: bad call benchmark parameters\n");
+        status = -1;
+        goto leave;
+    }
+
+    /* the bulk data and what every sum of it comes to */
+    for (i = 0; i < params->bulkSize; i++) {
+        Module.bulk[i] = (UInt8)(i * 7 + 3);
+    }
+    Module.bulkSum = Calls_bytes(Module.bulk, params->bulkSize);
+    for (i = 0; i < Module.numChunks; i++) {
+        Module.chunkSums[i] = Calls_bytes(Module.bulk + i * Rpc_SUM_MAX,
+            (i + 1 < Module.numChunks) ? Rpc_SUM_MAX :
+            params->bulkSize - i * Rpc_SUM_MAX);
+    }
+
+    status = Calls_open();
+    if (status < 0) {
+        goto leave;
+    }
+
+    for (loop = 0; loop < params->numLoops; loop++) {
+        memset(loopTotals, 0, sizeof(loopTotals));
+        for (kind = 0; kind < Calls_NUM_KINDS; kind++) {
+            status = Calls_kind(kind, &loopTotals[kind]);
+            if (status < 0) {
+                goto leave;
+            }
+        }
+        printf("Calls loop %u: echo %.1f/s sync, %.1f/s in flight\n", loop,
+            loopTotals[Calls_ECHO_SYNC].calls /
+            (loopTotals[Calls_ECHO_SYNC].ns / 1e9),
+            loopTotals[Calls_ECHO].calls / (loopTotals[Calls_ECHO].ns / 1e9));
+
+        if (loop < params->warmupLoops) {
+            continue;
+        }
+        loops++;
+        for (kind = 0; kind < Calls_NUM_KINDS; kind++) {
+            total = &Module.totals[kind];
+            total->calls += loopTotals[kind].calls;
+            total->ops += loopTotals[kind].ops;
+            total->ns += loopTotals[kind].ns;
+            total->dspUs += loopTotals[kind].dspUs;
+            total->errors += loopTotals[kind].errors;
+        }
+    }
+
+    Calls_print(loops, summary);
+
+leave:
+    for (i = 0; i < Calls_MAX_CORES; i++) {
+        RpcClient_delete(&Module.cores[i].client);
+        free(Module.cores[i].slots);
+        Module.cores[i].slots = NULL;
+    }
+    free(Module.chunkSums);
+    Module.chunkSums = NULL;
+
+    return (status);
+}
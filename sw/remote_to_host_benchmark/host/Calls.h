@@ -0,0 +1,43 @@
+/*
+ *  ======== Calls.h ========
+ *  Call rate of the typed calls in Rpc.h, waited for one at a time and
+ *  kept in flight, and bulk data by copy against by CMEM reference.
+ */
+
+#ifndef Calls__include
+#define Calls__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Calls_MAX_CORES 4
+
+typedef struct {
+    UInt32              numCores;
+    String              names[Calls_MAX_CORES];
+    MessageQ_Handle     hostQues[Calls_MAX_CORES];
+    MessageQ_QueueId    slaveQues[Calls_MAX_CORES];
+    void *              base;       /* host mapping of the bulk buffer */
+    Bool                armCached;  /* write the bulk buffer back per call */
+    UInt32              numCalls;   /* per kind of call and loop */
+    UInt32              window;     /* calls in flight per core */
+    UInt32              bulkSize;   /* bytes each sum covers */
+    UInt32              numLoops;
+    UInt32              warmupLoops;
+} Calls_Params;
+
+typedef struct {
+    double      callsPerSec;    /* waited for one at a time */
+    double      asyncPerSec;    /* window in flight */
+    double      copyMBps;       /* sum, bulk copied in the messages */
+    double      bulkMBps;       /* sum, bulk by CMEM reference */
+    UInt32      errors;
+} Calls_Summary;
+
+Int Calls_run(const Calls_Params *params, Calls_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Calls__include */
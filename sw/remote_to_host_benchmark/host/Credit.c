@@ -0,0 +1,248 @@
+/*
+ *  ======== Credit.c ========
+ *  Host side of the DSP to host credit flow control.
+ *
+ *  The App_CMD_SEND that starts a loop grants the DSP window credits. The
+ *  DSP spends one on every buffer it sends and stops when it has none
+ *  left, even with free ring buffers. The host earns a credit back for
+ *  every buffer it has finished with, but only passes them on, piggy
+ *  backed on the App_CMD_BUFFER return, once batch of them have built up;
+ *  a batch above one gives the grants some hysteresis so the DSP is not
+ *  woken for every single buffer.
+ *
+ *  Both ends count their stalls. The DSP stamps each buffer with the
+ *  number of times it ran dry this loop and for how long; the host counts
+ *  the times every granted buffer had arrived while the loop still wanted
+ *  more, up to the grant that ended it. Both can be called from different
+ *  threads.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* local header files */
+#include "Stats.h"
+#include "Credit.h"
+
+typedef struct Credit_Object {
+    char                prefix[32];     /* "name " or empty */
+    UInt32              window;
+    UInt32              batch;
+    UInt32              warmupLoops;
+    UInt32              loop;           /* index of the current loop */
+    pthread_mutex_t     lock;
+
+    /* current loop */
+    UInt32              target;         /* buffers in the loop */
+    UInt32              granted;
+    UInt32              received;
+    UInt32              owed;           /* finished, not granted yet */
+    UInt32              grants;
+    UInt32              hostStalls;
+    UInt64              hostStallNs;
+    Bool                stalled;
+    UInt64              stallStart;
+    UInt32              dspStalls;      /* last reported by the DSP */
+    UInt32              dspStallUs;
+
+    /* measured loops */
+    Credit_Summary      total;
+} Credit_Object;
+
+
+/*
+ *  ======== Credit_Params_init ========
+ */
+Void Credit_Params_init(Credit_Params *params)
+{
+    params->name = NULL;
+    params->window = 0;
+    params->batch = 1;
+    params->warmupLoops = 0;
+}
+
+/*
+ *  ======== Credit_create ========
+ */
+Credit_Handle Credit_create(const Credit_Params *params)
+{
+    Credit_Object *obj;
+
+    obj = (Credit_Object *)calloc(1, sizeof(Credit_Object));
+    if (obj == NULL) {
+        printf("Credit_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    if (params->name != NULL) {
+        snprintf(obj->prefix, sizeof(obj->prefix), "%s ", params->name);
+    }
+    obj->window = params->window;
+    obj->batch = params->batch;
+    obj->warmupLoops = params->warmupLoops;
+    pthread_mutex_init(&obj->lock, NULL);
+
+    /* a batch larger than the window would never be granted */
+    if (obj->batch > obj->window) {
+        obj->batch = obj->window;
+    }
+    if (obj->batch == 0) {
+        obj->batch = 1;
+    }
+    obj->total.window = obj->window;
+    obj->total.batch = obj->window > 0 ? obj->batch : 0;
+
+    return obj;
+}
+
+/*
+ *  ======== Credit_delete ========
+ */
+Void Credit_delete(Credit_Handle *handle)
+{
+    Credit_Object *obj = *handle;
+
+    if (obj != NULL) {
+        pthread_mutex_destroy(&obj->lock);
+        free(obj);
+        *handle = NULL;
+    }
+}
+
+/*
+ *  ======== Credit_loopBegin ========
+ *  Returns the initial grant to send with App_CMD_SEND, 0 for no limit.
+ */
+UInt32 Credit_loopBegin(Credit_Handle handle, UInt32 numBuffers)
+{
+    UInt32 grant;
+
+    pthread_mutex_lock(&handle->lock);
+    grant = handle->window < numBuffers ? handle->window : numBuffers;
+    handle->target = numBuffers;
+    handle->granted = grant;
+    handle->received = 0;
+    handle->owed = 0;
+    handle->grants = 0;
+    handle->hostStalls = 0;
+    handle->hostStallNs = 0;
+    handle->stalled = FALSE;
+    handle->dspStalls = 0;
+    handle->dspStallUs = 0;
+    pthread_mutex_unlock(&handle->lock);
+
+    return grant;
+}
+
+/*
+ *  ======== Credit_received ========
+ *  A buffer has arrived from the DSP, with the DSP's stall counters.
+ */
+Void Credit_received(Credit_Handle handle, UInt32 dspStalls,
+        UInt32 dspStallUs)
+{
+    if (handle->window == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&handle->lock);
+    handle->received++;
+    handle->dspStalls = dspStalls;
+    handle->dspStallUs = dspStallUs;
+    if (handle->received == handle->granted &&
+            handle->received < handle->target) {
+        /* the DSP cannot send more until the next grant */
+        handle->stalled = TRUE;
+        handle->stallStart = Stats_now();
+    }
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Credit_release ========
+ *  The host has finished with a buffer and is about to return it.
+ *  Returns the credits to grant with it, 0 to hold them back.
+ */
+UInt32 Credit_release(Credit_Handle handle)
+{
+    UInt32 grant = 0;
+
+    if (handle->window == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&handle->lock);
+    handle->owed++;
+    if (handle->owed >= handle->batch && handle->granted < handle->target) {
+        grant = handle->owed;
+        if (grant > handle->target - handle->granted) {
+            grant = handle->target - handle->granted;
+        }
+        handle->granted += grant;
+        handle->owed = 0;
+        handle->grants++;
+        if (handle->stalled) {
+            handle->hostStalls++;
+            handle->hostStallNs += Stats_now() - handle->stallStart;
+            handle->stalled = FALSE;
+        }
+    }
+    pthread_mutex_unlock(&handle->lock);
+
+    return grant;
+}
+
+/*
+ *  ======== Credit_loopEnd ========
+ *  Called once every buffer of the loop has been returned.
+ */
+Void Credit_loopEnd(Credit_Handle handle)
+{
+    Credit_Summary *total = &handle->total;
+
+    pthread_mutex_lock(&handle->lock);
+    if (handle->loop >= handle->warmupLoops) {
+        total->grants += handle->grants;
+        total->dspStalls += handle->dspStalls;
+        total->dspStallUs += handle->dspStallUs;
+        total->hostStalls += handle->hostStalls;
+        total->hostStallUs += (double)handle->hostStallNs / 1e3;
+    }
+    handle->loop++;
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Credit_report ========
+ *  Summarize the measured loops, totalMs is their combined loop time.
+ */
+Void Credit_report(Credit_Handle handle, double totalMs,
+        Credit_Summary *summary)
+{
+    pthread_mutex_lock(&handle->lock);
+    *summary = handle->total;
+    pthread_mutex_unlock(&handle->lock);
+
+    if (handle->window == 0) {
+        printf("%sCredits: off, the DSP is only held up by its ring\n",
+            handle->prefix);
+        return;
+    }
+
+    printf("%sCredits: window %u, granted in batches of %u\n",
+        handle->prefix, summary->window, summary->batch);
+    printf("    grants            : %llu\n",
+        (unsigned long long)summary->grants);
+    printf("    DSP stalls        : %llu, %.3f us (%.1f%% of loop time)\n",
+        (unsigned long long)summary->dspStalls, summary->dspStallUs,
+        totalMs > 0 ? summary->dspStallUs / 10.0 / totalMs : 0.0);
+    printf("    host stalls       : %llu, %.3f us (%.1f%% of loop time)\n",
+        (unsigned long long)summary->hostStalls, summary->hostStallUs,
+        totalMs > 0 ? summary->hostStallUs / 10.0 / totalMs : 0.0);
+}
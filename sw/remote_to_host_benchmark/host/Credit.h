@@ -0,0 +1,48 @@
+/*
+ *  ======== Credit.h ========
+ *  Host side of the DSP to host credit flow control.
+ */
+
+#ifndef Credit__include
+#define Credit__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Credit_Object *Credit_Handle;
+
+typedef struct {
+    String  name;           /* printed with the report, may be NULL */
+    UInt32  window;         /* buffers the DSP may have in flight, 0 off */
+    UInt32  batch;          /* finished buffers held back before a grant */
+    UInt32  warmupLoops;    /* leading loops not accumulated */
+} Credit_Params;
+
+/* result of all measured (non warm-up) loops */
+typedef struct {
+    UInt32  window;
+    UInt32  batch;
+    UInt64  grants;         /* grant messages, the initial one excluded */
+    UInt64  dspStalls;      /* DSP had a free buffer but no credit */
+    double  dspStallUs;
+    UInt64  hostStalls;     /* every granted buffer had arrived */
+    double  hostStallUs;
+} Credit_Summary;
+
+Void Credit_Params_init(Credit_Params *params);
+Credit_Handle Credit_create(const Credit_Params *params);
+Void Credit_delete(Credit_Handle *handle);
+
+UInt32 Credit_loopBegin(Credit_Handle handle, UInt32 numBuffers);
+Void Credit_received(Credit_Handle handle, UInt32 dspStalls,
+        UInt32 dspStallUs);
+UInt32 Credit_release(Credit_Handle handle);
+Void Credit_loopEnd(Credit_Handle handle);
+Void Credit_report(Credit_Handle handle, double totalMs,
+        Credit_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Credit__include */
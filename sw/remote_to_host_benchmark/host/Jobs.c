@@ -0,0 +1,626 @@
+/*
+ *  ======== Jobs.c ========
+ *  Run a batch of jobs on the DSPs, pulled or pushed.
+ *
+ *  Steal: the host writes the job table into the region, gives every
+ *  core an even share of it as its deque and sends each core one
+ *  App_CMD_JOBS. The DSPs then run, and steal, jobs until every deque
+ *  is empty, while the host drains their completion rings. The host
+ *  takes no part in the scheduling and there is no message per job.
+ *
+ *  Push: one host thread per core keeps window App_CMD_JOB messages in
+ *  flight to its core, taking the next job from a shared counter, so
+ *  the cores are balanced the same way but every job costs a round
+ *  trip through MessageQ.
+ *
+ *  Every job's result is checked against the host's own run of the
+ *  kernel, outside the timed part, so a job lost or run twice by the
+ *  stealing shows up as an error.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/cmem.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "Stats.h"
+#include "JobSize.h"
+#include "Jobs.h"
+
+#define Jobs_NONE 0xFFFFFFFF
+
+/* one push thread */
+typedef struct {
+    UInt32              index;
+    pthread_t           thread;
+    Int                 status;
+    UInt64              jobs;
+    UInt64              busyTicks;
+    UInt32              freq;
+    UInt64              rttNs;
+} Jobs_Push;
+
+/* module structure */
+typedef struct {
+    const Jobs_Params * params;
+    App_JobQueue *      queue;      // host mapping of the region
+    App_Job *           table;
+    UInt32 *            results;
+    UInt8 *             seen;       // times each job came back
+    UInt64 *            sentNs;     // push: when each job went out
+    UInt32              errors;     // this loop
+    Jobs_Push           push[App_JOBS_MAX_CORES];
+    pthread_mutex_t     lock;       // next, and the gate
+    UInt32              next;       // push: next job to hand out
+    pthread_cond_t      gateCond;
+    Int                 gate;       // 0 wait, 1 run, -1 give up
+    Bool                csvHeader;
+} Jobs_Module;
+
+/* private data */
+static Jobs_Module Module = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .gateCond = PTHREAD_COND_INITIALIZER,
+};
+
+
+/*
+ *  ======== Jobs_regionSize ========
+ */
+UInt32 Jobs_regionSize(UInt32 numJobs)
+{
+    return (sizeof(App_JobQueue) + numJobs * sizeof(App_Job));
+}
+
+/*
+ *  ======== Jobs_kernel ========
+ *  The DSP's kernel: work LCG steps from seed.
+ */
+static UInt32 Jobs_kernel(UInt32 work, UInt32 seed)
+{
+    UInt32 x = seed;
+    UInt32 i;
+
+    for (i = 0; i < work; i++) {
+        x = x * 1664525 + 1013904223;
+    }
+
+    return (x);
+}
+
+/*
+ *  ======== Jobs_makeTable ========
+ *  Log-uniform job sizes, the median job being work, the same every run.
+ */
+static Void Jobs_makeTable(const Jobs_Params *params, App_Job *table)
+{
+    UInt32  seed = 1;
+    UInt32  i;
+
+    for (i = 0; i < params->numJobs; i++) {
+        table[i].work = JobSize_next(&seed, params->work, params->spread);
+        table[i].seed = seed;
+    }
+}
+
+/*
+ *  ======== Jobs_record ========
+ */
+static Void Jobs_record(UInt32 job, UInt32 result)
+{
+    if (job >= Module.params->numJobs) {
+        Module.errors++;
+        return;
+    }
+    Module.results[job] = result;
+    if (Module.seen[job] < 255) {
+        Module.seen[job]++;
+    }
+}
+
+/*
+ *  ======== Jobs_check ========
+ *  Every job back exactly once with the right result.
+ */
+static Void Jobs_check(Void)
+{
+    const App_Job *job;
+    UInt32 i;
+
+    for (i = 0; i < Module.params->numJobs; i++) {
+        job = &Module.table[i];
+        if (Module.seen[i] != 1 ||
+                Module.results[i] != Jobs_kernel(job->work, job->seed)) {
+            if (Module.errors < 8) {
+                printf("Error: job %u came back %u times, result 0x%x\n", i,
+                    Module.seen[i], Module.results[i]);
+            }
+            Module.errors++;
+        }
+    }
+}
+
+/*
+ *  ======== Jobs_fill ========
+ *  Lay out the queue for a steal loop, each core's deque an even share.
+ */
+static Void Jobs_fill(Void)
+{
+    const Jobs_Params *params = Module.params;
+    App_JobQueue *queue = Module.queue;
+    UInt32 share = params->numJobs / params->numCores;
+    UInt32 extra = params->numJobs % params->numCores;
+    UInt32 first = 0;
+    UInt32 i;
+
+    memset(queue, 0, sizeof(App_JobQueue));
+    queue->numCores = params->numCores;
+    queue->numJobs = params->numJobs;
+    for (i = 0; i < params->numCores; i++) {
+        queue->deques[i].head = first;
+        first += share + (i < extra ? 1 : 0);
+        queue->deques[i].tail = first;
+    }
+    memcpy(queue + 1, Module.table, params->numJobs * sizeof(App_Job));
+
+    if (params->armCached) {
+        CMEM_cacheWb(queue, Jobs_regionSize(params->numJobs));
+    }
+}
+
+/*
+ *  ======== Jobs_drain ========
+ *  Take the results waiting in a core's ring, returns how many.
+ */
+static UInt32 Jobs_drain(UInt32 core)
+{
+    App_JobRing *ring = &Module.queue->rings[core];
+    UInt32 read = ring->read;
+    UInt32 write;
+    UInt32 from, n;
+
+    if (Module.params->armCached) {
+        CMEM_cacheInv((void *)&ring->write, sizeof(UInt32));
+    }
+    write = ring->write;
+    if (write == read) {
+        return (0);
+    }
+    __sync_synchronize();
+
+    if (Module.params->armCached) {
+        /* the entries, in up to two pieces where they wrap */
+        from = read & (App_JOBS_RING_SIZE - 1);
+        n = write - read;
+        if (from + n > App_JOBS_RING_SIZE) {
+            CMEM_cacheInv(&ring->done[0],
+                (from + n - App_JOBS_RING_SIZE) * sizeof(App_JobDone));
+            n = App_JOBS_RING_SIZE - from;
+        }
+        CMEM_cacheInv(&ring->done[from], n * sizeof(App_JobDone));
+    }
+
+    for (n = read; n != write; n++) {
+        from = n & (App_JOBS_RING_SIZE - 1);
+        Jobs_record(ring->done[from].job, ring->done[from].result);
+    }
+
+    /* hand the entries back */
+    __sync_synchronize();
+    ring->read = write;
+    if (Module.params->armCached) {
+        CMEM_cacheWb((void *)&ring->read, sizeof(UInt32));
+    }
+
+    return (write - read);
+}
+
+/*
+ *  ======== Jobs_stealLoop ========
+ *  One batch pulled by the DSPs; the host only drains the rings.
+ */
+static Int Jobs_stealLoop(Jobs_Data *data, UInt64 *ns)
+{
+    const Jobs_Params *params = Module.params;
+    App_Msg *msg;
+    Bool replied[App_JOBS_MAX_CORES];
+    UInt32 numReplied = 0;
+    UInt32 done = 0;
+    UInt32 got, i;
+    UInt64 start;
+    Int status;
+
+    Jobs_fill();
+    memset(replied, 0, sizeof(replied));
+
+    start = Stats_now();
+    for (i = 0; i < params->numCores; i++) {
+        msg = (App_Msg *)MessageQ_alloc(App_MsgHeapId, sizeof(App_Msg));
+        if (msg == NULL) {
+            printf("Error: failed to allocate message\n");
+            return (-1);
+        }
+        MessageQ_setReplyQueue(params->hostQues[i], (MessageQ_Msg)msg);
+        msg->cmd = App_CMD_JOBS;
+        msg->data.jobsData.phyAddress = params->phys;
+        msg->data.jobsData.size = Jobs_regionSize(params->numJobs);
+        msg->data.jobsData.core = i;
+        MessageQ_put(params->slaveQues[i], (MessageQ_Msg)msg);
+    }
+
+    /* drain every ring until each core has run dry and said so */
+    while (numReplied < params->numCores || done < params->numJobs) {
+        got = 0;
+        for (i = 0; i < params->numCores; i++) {
+            got += Jobs_drain(i);
+        }
+        done += got;
+        if (got > 0) {
+            continue;
+        }
+
+        for (i = 0; i < params->numCores; i++) {
+            if (replied[i]) {
+                continue;
+            }
+            status = MessageQ_get(params->hostQues[i], (MessageQ_Msg *)&msg,
+                0);
+            if (status == MessageQ_E_TIMEOUT) {
+                continue;
+            }
+            if (status < 0) {
+                return (status);
+            }
+            if (msg->cmd != App_CMD_JOBS) {
+                printf("Error: %s answered the job queue with 0x%x\n",
+                    params->names[i], msg->cmd);
+                MessageQ_free((MessageQ_Msg)msg);
+                return (-1);
+            }
+            data[i] = msg->data.jobsData;
+            replied[i] = TRUE;
+            numReplied++;
+            MessageQ_free((MessageQ_Msg)msg);
+        }
+
+        /* every core is done but results are missing: they are lost */
+        if (numReplied == params->numCores) {
+            for (i = 0; i < params->numCores; i++) {
+                done += Jobs_drain(i);
+            }
+            if (done < params->numJobs) {
+                printf("Error: %u jobs never completed\n",
+                    params->numJobs - done);
+                Module.errors += params->numJobs - done;
+            }
+            break;
+        }
+        sched_yield();
+    }
+    *ns = Stats_now() - start;
+
+    return (0);
+}
+
+/*
+ *  ======== Jobs_nextJob ========
+ */
+static UInt32 Jobs_nextJob(Void)
+{
+    UInt32 job = Jobs_NONE;
+
+    pthread_mutex_lock(&Module.lock);
+    if (Module.next < Module.params->numJobs) {
+        job = Module.next++;
+    }
+    pthread_mutex_unlock(&Module.lock);
+
+    return (job);
+}
+
+/*
+ *  ======== Jobs_send ========
+ *  Send job in msg, FALSE when there are no jobs left.
+ */
+static Bool Jobs_send(Jobs_Push *push, App_Msg *msg)
+{
+    const Jobs_Params *params = Module.params;
+    UInt32 job = Jobs_nextJob();
+
+    if (job == Jobs_NONE) {
+        return (FALSE);
+    }
+
+    MessageQ_setReplyQueue(params->hostQues[push->index], (MessageQ_Msg)msg);
+    msg->cmd = App_CMD_JOB;
+    msg->data.jobData.job = job;
+    msg->data.jobData.work = Module.table[job].work;
+    msg->data.jobData.seed = Module.table[job].seed;
+    Module.sentNs[job] = Stats_now();
+    MessageQ_put(params->slaveQues[push->index], (MessageQ_Msg)msg);
+
+    return (TRUE);
+}
+
+/*
+ *  ======== Jobs_pushThread ========
+ *  Keep window jobs in flight to one core until none are left.
+ */
+static void *Jobs_pushThread(void *arg)
+{
+    Jobs_Push *push = (Jobs_Push *)arg;
+    const Jobs_Params *params = Module.params;
+    App_Msg *msg;
+    UInt32 inFlight = 0;
+    UInt32 job;
+    Int gate;
+    Int status = 0;
+
+    /* wait until every core has a thread */
+    pthread_mutex_lock(&Module.lock);
+    while (Module.gate == 0) {
+        pthread_cond_wait(&Module.gateCond, &Module.lock);
+    }
+    gate = Module.gate;
+    pthread_mutex_unlock(&Module.lock);
+
+    if (gate < 0) {
+        push->status = -1;
+        return (NULL);
+    }
+
+    while (inFlight < params->window) {
+        msg = (App_Msg *)MessageQ_alloc(App_MsgHeapId, sizeof(App_Msg));
+        if (msg == NULL) {
+            printf("Error: failed to allocate message\n");
+            status = -1;
+            break;
+        }
+        if (!Jobs_send(push, msg)) {
+            MessageQ_free((MessageQ_Msg)msg);
+            break;
+        }
+        inFlight++;
+    }
+
+    while (inFlight > 0) {
+        status = MessageQ_get(params->hostQues[push->index],
+            (MessageQ_Msg *)&msg, MessageQ_FOREVER);
+        if (status < 0) {
+            break;
+        }
+        if (msg->cmd != App_CMD_JOB) {
+            printf("Error: %s answered a job with 0x%x\n",
+                params->names[push->index], msg->cmd);
+            MessageQ_free((MessageQ_Msg)msg);
+            status = -1;
+            break;
+        }
+        inFlight--;
+
+        job = msg->data.jobData.job;
+        if (job < params->numJobs) {
+            push->rttNs += Stats_now() - Module.sentNs[job];
+        }
+        pthread_mutex_lock(&Module.lock);
+        Jobs_record(job, msg->data.jobData.result);
+        pthread_mutex_unlock(&Module.lock);
+        push->jobs++;
+        push->busyTicks += msg->data.jobData.ticks;
+        push->freq = msg->data.jobData.freq;
+
+        /* the message carries the next job, if there is one */
+        if (status == 0 && Jobs_send(push, msg)) {
+            inFlight++;
+        }
+        else {
+            MessageQ_free((MessageQ_Msg)msg);
+        }
+    }
+    push->status = status;
+
+    return (NULL);
+}
+
+/*
+ *  ======== Jobs_pushLoop ========
+ *  One batch pushed by the host, a thread per core.
+ */
+static Int Jobs_pushLoop(UInt64 *ns)
+{
+    const Jobs_Params *params = Module.params;
+    Jobs_Push *push;
+    UInt32 started = 0;
+    UInt64 start;
+    Int status = 0;
+    UInt32 i;
+
+    Module.next = 0;
+    Module.gate = 0;
+    for (i = 0; i < params->numCores; i++) {
+        push = &Module.push[i];
+        memset(push, 0, sizeof(Jobs_Push));
+        push->index = i;
+        if (pthread_create(&push->thread, NULL, Jobs_pushThread, push) != 0) {
+            printf("Error: failed to start the %s job thread\n",
+                params->names[i]);
+            status = -1;
+            break;
+        }
+        started++;
+    }
+
+    /* open the gate, or send the started threads home */
+    start = Stats_now();
+    pthread_mutex_lock(&Module.lock);
+    Module.gate = (status == 0) ? 1 : -1;
+    pthread_cond_broadcast(&Module.gateCond);
+    pthread_mutex_unlock(&Module.lock);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(Module.push[i].thread, NULL);
+        if (Module.push[i].status < 0) {
+            status = Module.push[i].status;
+        }
+    }
+    *ns = Stats_now() - start;
+
+    return (status);
+}
+
+/*
+ *  ======== Jobs_run ========
+ */
+Int Jobs_run(const Jobs_Params *params, Jobs_Summary *summary)
+{
+    Jobs_Data data[App_JOBS_MAX_CORES];
+    Jobs_Core *core;
+    Jobs_Push *push;
+    String mode = params->steal ? "steal" : "push";
+    UInt64 ns, totalNs = 0;
+    double utilization = 0.0;
+    double lockUs = 0.0;
+    UInt64 stolen = 0;
+    UInt32 loop, i;
+    Int status = 0;
+
+    memset(summary, 0, sizeof(Jobs_Summary));
+    Module.params = params;
+    Module.queue = (App_JobQueue *)params->base;
+    Module.table = (App_Job *)malloc(params->numJobs * sizeof(App_Job));
+    Module.results = (UInt32 *)malloc(params->numJobs * sizeof(UInt32));
+    Module.seen = (UInt8 *)malloc(params->numJobs);
+    Module.sentNs = (UInt64 *)malloc(params->numJobs * sizeof(UInt64));
+
+    if (Module.table == NULL || Module.results == NULL ||
+            Module.seen == NULL || Module.sentNs == NULL) {
+        printf("Error: failed to allocate %u jobs\n", params->numJobs);
+        status = -1;
+        goto leave;
+    }
+    if (params->numCores > App_JOBS_MAX_CORES ||
+            Jobs_regionSize(params->numJobs) > params->size) {
+        printf("Error: %u jobs on %u cores do not fit the job queue\n",
+            params->numJobs, params->numCores);
+        status = -1;
+        goto leave;
+    }
+    Jobs_makeTable(params, Module.table);
+
+    for (loop = 0; loop < params->numLoops; loop++) {
+        Module.errors = 0;
+        memset(Module.seen, 0, params->numJobs);
+        memset(data, 0, sizeof(data));
+
+        if (params->steal) {
+            status = Jobs_stealLoop(data, &ns);
+        }
+        else {
+            status = Jobs_pushLoop(&ns);
+        }
+        if (status < 0) {
+            goto leave;
+        }
+
+        Jobs_check();
+        summary->errors += Module.errors;
+        printf("Jobs loop %u (%s): %.3f ms, %.1f jobs/s, %u errors\n", loop,
+            mode, ns / 1e6, params->numJobs / (ns / 1e9), Module.errors);
+
+        if (loop < params->warmupLoops) {
+            continue;
+        }
+        summary->loops++;
+        summary->jobs += params->numJobs;
+        totalNs += ns;
+        for (i = 0; i < params->numCores; i++) {
+            core = &summary->cores[i];
+            if (params->steal) {
+                core->jobs += data[i].jobs;
+                core->stolen += data[i].stolen;
+                core->steals += data[i].steals;
+                core->busyMs += data[i].busyUs / 1e3;
+                core->lockUs += data[i].lockUs;
+                core->ringUs += data[i].ringUs;
+            }
+            else {
+                push = &Module.push[i];
+                core->jobs += push->jobs;
+                core->busyMs += (push->freq > 0) ?
+                    push->busyTicks * 1e3 / push->freq : 0.0;
+                core->rttUs += push->rttNs / 1e3;
+            }
+        }
+    }
+
+    if (summary->loops == 0) {
+        goto leave;
+    }
+
+    summary->ms = totalNs / 1e6;
+    summary->jobsPerSec = summary->jobs / (totalNs / 1e9);
+    summary->usPerJob = totalNs / 1e3 / summary->jobs;
+
+    printf("Jobs (%s): %u jobs of %u steps, spread %u, %u loops measured\n",
+        mode, params->numJobs, params->work, params->spread, summary->loops);
+    if (params->steal) {
+        printf("    core   jobs       stolen     steals     busy (ms)   "
+            "util    lock (us/job)  ring wait (us)\n");
+    }
+    else {
+        printf("    core   jobs       window     busy (ms)   util    "
+            "rtt (us)\n");
+    }
+    for (i = 0; i < params->numCores; i++) {
+        core = &summary->cores[i];
+        core->utilization = core->busyMs / summary->ms;
+        utilization += core->utilization / params->numCores;
+        stolen += core->stolen;
+        if (params->steal) {
+            lockUs += core->lockUs;
+            printf("    %-6s %-10llu %-10llu %-10llu %-11.3f %-7.3f %-14.3f "
+                "%.1f\n", params->names[i], (unsigned long long)core->jobs,
+                (unsigned long long)core->stolen,
+                (unsigned long long)core->steals, core->busyMs,
+                core->utilization, core->jobs > 0 ?
+                core->lockUs / core->jobs : 0.0, core->ringUs);
+        }
+        else {
+            core->rttUs = core->jobs > 0 ? core->rttUs / core->jobs : 0.0;
+            printf("    %-6s %-10llu %-10u %-11.3f %-7.3f %.3f\n",
+                params->names[i], (unsigned long long)core->jobs,
+                params->window, core->busyMs, core->utilization,
+                core->rttUs);
+        }
+    }
+    printf("    all    %.1f jobs/s, %.3f us per job, utilization %.3f, "
+        "%u errors\n", summary->jobsPerSec, summary->usPerJob, utilization,
+        summary->errors);
+
+    if (!Module.csvHeader) {
+        printf("csvjobsheader, Mode, Cores, Jobs, Work, Spread, Window, Loops Measured, Time (ms), Jobs/s, Wall per Job (us), Utilization, Stolen, DSP Lock per Job (us), ARM Cached, Errors\n");
+        Module.csvHeader = TRUE;
+    }
+    printf("csvjobs, %s, %u, %u, %u, %u, %u, %u, %f, %f, %f, %f, %llu, %f, %d, %u\n", mode, params->numCores, params->numJobs, params->work, params->spread, params->steal ? 0 : params->window, summary->loops, summary->ms, summary->jobsPerSec, summary->usPerJob, utilization, (unsigned long long)stolen, lockUs / summary->jobs, params->armCached, summary->errors);
+
+leave:
+    free(Module.table);
+    free(Module.results);
+    free(Module.seen);
+    free(Module.sentNs);
+    Module.table = NULL;
+    Module.results = NULL;
+    Module.seen = NULL;
+    Module.sentNs = NULL;
+
+    return (status);
+}
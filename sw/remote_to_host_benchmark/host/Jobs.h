@@ -0,0 +1,62 @@
+/*
+ *  ======== Jobs.h ========
+ *  Run a batch of jobs on the DSPs, either pulled by them from the job
+ *  queue in CMEM with work stealing, or pushed one MessageQ message per
+ *  job by the host.
+ */
+
+#ifndef Jobs__include
+#define Jobs__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct {
+    UInt32              numCores;
+    String              names[App_JOBS_MAX_CORES];
+    MessageQ_Handle     hostQues[App_JOBS_MAX_CORES];
+    MessageQ_QueueId    slaveQues[App_JOBS_MAX_CORES];
+    void *              base;       /* host mapping of the region */
+    UInt32              phys;
+    UInt32              size;       /* at least Jobs_regionSize */
+    Bool                armCached;  /* write back and invalidate the queue */
+    Bool                steal;      /* DSPs pull, else the host pushes */
+    UInt32              numJobs;
+    UInt32              work;       /* LCG steps of the median job */
+    UInt32              spread;     /* jobs from work / spread to
+                                       work * spread, 1 for even jobs */
+    UInt32              window;     /* push: jobs in flight per core */
+    UInt32              numLoops;   /* batches of numJobs */
+    UInt32              warmupLoops;
+} Jobs_Params;
+
+/* one core's part of the measured loops */
+typedef struct {
+    UInt64  jobs;
+    UInt64  stolen;         /* steal: jobs it took from other deques */
+    UInt64  steals;
+    double  busyMs;         /* DSP time in the kernel */
+    double  lockUs;         /* steal: DSP time taking and holding locks */
+    double  ringUs;         /* steal: DSP time waiting on a full ring */
+    double  rttUs;          /* push: mean host send to reply */
+    double  utilization;    /* busyMs over the measured time */
+} Jobs_Core;
+
+typedef struct {
+    UInt32      loops;      /* measured */
+    UInt64      jobs;       /* measured */
+    double      ms;         /* measured, first send to last result */
+    double      jobsPerSec;
+    double      usPerJob;   /* wall time per job, all cores together */
+    UInt32      errors;     /* jobs lost, repeated or wrong, every loop */
+    Jobs_Core   cores[App_JOBS_MAX_CORES];
+} Jobs_Summary;
+
+UInt32 Jobs_regionSize(UInt32 numJobs);
+Int Jobs_run(const Jobs_Params *params, Jobs_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Jobs__include */
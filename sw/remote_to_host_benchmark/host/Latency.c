@@ -0,0 +1,406 @@
+/*
+ *  ======== Latency.c ========
+ *  One-way DSP to host latency of single buffers, against an estimate of
+ *  the DSP clock taken from round trips at the start and end of the run.
+ *
+ *  The DSP stamps every buffer with its Timestamp once the fill and write
+ *  back are complete, the host stamps it on receive with
+ *  CLOCK_MONOTONIC_RAW. To compare the two the host sends App_CMD_SYNC a
+ *  few times and the DSP answers with its Timestamp; the round trip with
+ *  the lowest time is taken and the DSP stamp placed at its midpoint, so
+ *  the offset is known to within half that round trip. A second sync at
+ *  the end of the run gives the rate of the DSP clock against the host
+ *  as well, which takes out the drift between the two crystals; with a
+ *  single sync the DSP's nominal frequency is used.
+ *
+ *  The samples are kept raw and only converted at the report, once both
+ *  syncs are in.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* local header files */
+#include "Latency.h"
+
+#define Latency_BAR 40      /* histogram bar of the fullest bucket */
+
+/* histogram bucket upper bounds in us, the last bucket is open ended */
+static const double Latency_buckets[] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+#define Latency_NUM_BUCKETS \
+    (sizeof(Latency_buckets) / sizeof(Latency_buckets[0]) + 1)
+
+/* a DSP Timestamp and the host time it corresponds to */
+typedef struct {
+    UInt64      dspTicks;
+    UInt64      hostNs;         /* midpoint of the round trip */
+    UInt64      rttNs;
+} Latency_Point;
+
+typedef struct {
+    UInt64      sendNs;
+    UInt64      dspTicks;
+    UInt64      recvNs;
+} Latency_Sample;
+
+typedef struct Latency_Object {
+    char            prefix[32];     /* "name " or empty */
+    UInt64          freq;           /* DSP Timestamp ticks per second */
+
+    /* sync in progress, best round trip so far */
+    Latency_Point   best;
+    UInt32          rounds;
+
+    /* first and last sync */
+    Latency_Point   sync[2];
+    UInt32          numSyncs;
+
+    Latency_Sample *samples;
+    UInt32          maxSamples;
+    UInt32          numSamples;
+    UInt32          droppedSamples;
+} Latency_Object;
+
+
+/*
+ *  ======== Latency_Params_init ========
+ */
+Void Latency_Params_init(Latency_Params *params)
+{
+    params->name = NULL;
+    params->maxSamples = 0x10000;
+}
+
+/*
+ *  ======== Latency_create ========
+ */
+Latency_Handle Latency_create(const Latency_Params *params)
+{
+    Latency_Object *obj;
+
+    obj = (Latency_Object *)calloc(1, sizeof(Latency_Object));
+    if (obj == NULL) {
+        printf("Latency_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    if (params->name != NULL) {
+        snprintf(obj->prefix, sizeof(obj->prefix), "%s ", params->name);
+    }
+    obj->maxSamples = params->maxSamples;
+
+    if (obj->maxSamples > 0) {
+        obj->samples = (Latency_Sample *)malloc(obj->maxSamples *
+            sizeof(Latency_Sample));
+        if (obj->samples == NULL) {
+            printf("Latency_create: failed to allocate %u samples\n",
+                obj->maxSamples);
+            free(obj);
+            return NULL;
+        }
+    }
+
+    return obj;
+}
+
+/*
+ *  ======== Latency_delete ========
+ */
+Void Latency_delete(Latency_Handle *handle)
+{
+    Latency_Object *obj = *handle;
+
+    if (obj != NULL) {
+        free(obj->samples);
+        free(obj);
+        *handle = NULL;
+    }
+}
+
+/*
+ *  ======== Latency_now ========
+ *  Time in nanoseconds, not slewed by NTP so it keeps to the crystal.
+ */
+UInt64 Latency_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Latency_syncSample ========
+ *  One App_CMD_SYNC round trip, sent at sendNs and answered at recvNs
+ *  with the DSP's Timestamp in between.
+ */
+Void Latency_syncSample(Latency_Handle handle, UInt64 sendNs,
+        UInt64 dspTicks, UInt64 dspFreq, UInt64 recvNs)
+{
+    UInt64 rtt = recvNs - sendNs;
+
+    handle->freq = dspFreq;
+    if (handle->rounds == 0 || rtt < handle->best.rttNs) {
+        handle->best.dspTicks = dspTicks;
+        handle->best.hostNs = sendNs + rtt / 2;
+        handle->best.rttNs = rtt;
+    }
+    handle->rounds++;
+}
+
+/*
+ *  ======== Latency_syncEnd ========
+ *  Keep the best round trip of the sync; the first sync of the run and
+ *  the last one are fitted.
+ */
+Int Latency_syncEnd(Latency_Handle handle)
+{
+    if (handle->rounds == 0 || handle->freq == 0) {
+        printf("%sLatency: no usable clock sync\n", handle->prefix);
+        return -1;
+    }
+
+    handle->sync[handle->numSyncs > 0 ? 1 : 0] = handle->best;
+    if (handle->numSyncs < 2) {
+        handle->numSyncs++;
+    }
+    handle->rounds = 0;
+
+    return 0;
+}
+
+/*
+ *  ======== Latency_record ========
+ *  A buffer asked for at sendNs, stamped by the DSP at dspTicks and
+ *  received at recvNs.
+ */
+Void Latency_record(Latency_Handle handle, UInt64 sendNs, UInt64 dspTicks,
+        UInt64 recvNs)
+{
+    Latency_Sample *sample;
+
+    if (handle->numSamples < handle->maxSamples) {
+        sample = &handle->samples[handle->numSamples++];
+        sample->sendNs = sendNs;
+        sample->dspTicks = dspTicks;
+        sample->recvNs = recvNs;
+    }
+    else {
+        handle->droppedSamples++;
+    }
+}
+
+/*
+ *  ======== Latency_nsPerTick ========
+ *  Host ns per DSP tick, measured between the syncs when there are two.
+ */
+static double Latency_nsPerTick(Latency_Handle handle)
+{
+    const Latency_Point *a = &handle->sync[0];
+    const Latency_Point *b = &handle->sync[1];
+
+    if (handle->numSyncs == 2 && b->dspTicks > a->dspTicks) {
+        return ((double)(Int64)(b->hostNs - a->hostNs) /
+            (double)(b->dspTicks - a->dspTicks));
+    }
+
+    return (1e9 / (double)handle->freq);
+}
+
+/*
+ *  ======== Latency_toHostNs ========
+ *  The host time of a DSP Timestamp on the fitted clock, 0 before the
+ *  first sync.
+ */
+UInt64 Latency_toHostNs(Latency_Handle handle, UInt64 dspTicks)
+{
+    const Latency_Point *a = &handle->sync[0];
+
+    if (handle->numSyncs == 0) {
+        return 0;
+    }
+
+    return (a->hostNs + (UInt64)(Int64)((double)(Int64)(dspTicks -
+        a->dspTicks) * Latency_nsPerTick(handle)));
+}
+
+/*
+ *  ======== Latency_compare ========
+ */
+static int Latency_compare(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ *  ======== Latency_percentile ========
+ *  Nearest rank percentile of n sorted values.
+ */
+static double Latency_percentile(const double *sorted, UInt32 n, double pct)
+{
+    UInt32 rank;
+
+    if (n == 0) {
+        return 0.0;
+    }
+    rank = (UInt32)(pct / 100.0 * n + 0.999999);
+    rank = rank < 1 ? 1 : rank;
+    rank = rank > n ? n : rank;
+
+    return sorted[rank - 1];
+}
+
+/*
+ *  ======== Latency_histogram ========
+ *  Bucket the sorted one-way latencies, from the first bucket in use to
+ *  the last.
+ */
+static Void Latency_histogram(const double *sorted, UInt32 n)
+{
+    static const char bar[] = "########################################";
+    UInt32 counts[Latency_NUM_BUCKETS];
+    UInt32 first = Latency_NUM_BUCKETS, last = 0, most = 0;
+    UInt32 i, b = 0;
+    char label[32];
+    int len;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < n; i++) {
+        while (b < Latency_NUM_BUCKETS - 1 && sorted[i] >= Latency_buckets[b]) {
+            b++;
+        }
+        counts[b]++;
+    }
+    for (b = 0; b < Latency_NUM_BUCKETS; b++) {
+        if (counts[b] > 0) {
+            first = b < first ? b : first;
+            last = b;
+            most = counts[b] > most ? counts[b] : most;
+        }
+    }
+
+    printf("    one-way histogram :\n");
+    for (b = first; b <= last && b < Latency_NUM_BUCKETS; b++) {
+        if (b == 0) {
+            snprintf(label, sizeof(label), "< %g us", Latency_buckets[0]);
+        }
+        else if (b == Latency_NUM_BUCKETS - 1) {
+            snprintf(label, sizeof(label), ">= %g us", Latency_buckets[b - 1]);
+        }
+        else {
+            snprintf(label, sizeof(label), "%g - %g us",
+                Latency_buckets[b - 1], Latency_buckets[b]);
+        }
+        len = (int)((UInt64)counts[b] * Latency_BAR / most);
+        printf("      %-16s: %8u %5.1f%%%s%.*s\n", label, counts[b],
+            counts[b] * 100.0 / n, len > 0 ? " " : "", len, bar);
+    }
+}
+
+/*
+ *  ======== Latency_report ========
+ *  Convert the samples with the fitted DSP clock and print the report.
+ */
+Void Latency_report(Latency_Handle handle, Latency_Summary *summary)
+{
+    const Latency_Point *a = &handle->sync[0];
+    const Latency_Point *b = &handle->sync[1];
+    double nominal, nsPerTick;
+    double *oneWay = NULL, *rtt = NULL;
+    const Latency_Sample *s;
+    UInt32 n = handle->numSamples;
+    UInt32 i;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->syncs = handle->numSyncs;
+    summary->samples = n;
+
+    if (handle->numSyncs == 0) {
+        printf("%sLatency: not measured, the clocks were never synced\n",
+            handle->prefix);
+        return;
+    }
+
+    nominal = 1e9 / (double)handle->freq;
+    nsPerTick = Latency_nsPerTick(handle);
+    summary->syncErrUs = a->rttNs / 2e3;
+    if (handle->numSyncs == 2 && b->dspTicks > a->dspTicks) {
+        summary->driftPpm = (nsPerTick / nominal - 1.0) * 1e6;
+        if (b->rttNs > a->rttNs) {
+            summary->syncErrUs = b->rttNs / 2e3;
+        }
+    }
+
+    if (n > 0) {
+        oneWay = (double *)malloc(n * sizeof(double));
+        rtt = (double *)malloc(n * sizeof(double));
+        if (oneWay == NULL || rtt == NULL) {
+            printf("%sLatency: failed to allocate the report\n",
+                handle->prefix);
+            free(oneWay);
+            free(rtt);
+            return;
+        }
+    }
+
+    /* differences first, the absolute times are too large for a double */
+    for (i = 0; i < n; i++) {
+        s = &handle->samples[i];
+        oneWay[i] = ((double)(Int64)(s->recvNs - a->hostNs) -
+            (double)(Int64)(s->dspTicks - a->dspTicks) * nsPerTick) / 1e3;
+        rtt[i] = (double)(s->recvNs - s->sendNs) / 1e3;
+    }
+    qsort(oneWay, n, sizeof(double), Latency_compare);
+    qsort(rtt, n, sizeof(double), Latency_compare);
+
+    if (n > 0) {
+        summary->minUs = oneWay[0];
+        summary->p50Us = Latency_percentile(oneWay, n, 50.0);
+        summary->p90Us = Latency_percentile(oneWay, n, 90.0);
+        summary->p99Us = Latency_percentile(oneWay, n, 99.0);
+        summary->p999Us = Latency_percentile(oneWay, n, 99.9);
+        summary->maxUs = oneWay[n - 1];
+        summary->rttP50Us = Latency_percentile(rtt, n, 50.0);
+        summary->rttP99Us = Latency_percentile(rtt, n, 99.0);
+    }
+
+    printf("%sLatency:\n", handle->prefix);
+    if (handle->numSyncs == 2) {
+        printf("    clock sync        : +/- %.3f us, DSP clock %+.2f ppm "
+            "from nominal\n", summary->syncErrUs, summary->driftPpm);
+    }
+    else {
+        printf("    clock sync        : +/- %.3f us, start only, no drift "
+            "correction\n", summary->syncErrUs);
+    }
+    printf("    buffers           : %llu\n",
+        (unsigned long long)summary->samples);
+    if (n > 0) {
+        printf("    one-way (us)      : min %.3f, p50 %.3f, p90 %.3f, "
+            "p99 %.3f, p99.9 %.3f, max %.3f\n",
+            summary->minUs, summary->p50Us, summary->p90Us, summary->p99Us,
+            summary->p999Us, summary->maxUs);
+        printf("    round trip (us)   : min %.3f, p50 %.3f, p99 %.3f, "
+            "max %.3f\n", rtt[0], summary->rttP50Us, summary->rttP99Us,
+            rtt[n - 1]);
+        Latency_histogram(oneWay, n);
+    }
+    if (handle->droppedSamples > 0) {
+        printf("    latency samples   : %u kept, %u dropped\n",
+            handle->numSamples, handle->droppedSamples);
+    }
+
+    free(oneWay);
+    free(rtt);
+}
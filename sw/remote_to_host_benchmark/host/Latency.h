@@ -0,0 +1,53 @@
+/*
+ *  ======== Latency.h ========
+ *  One-way DSP to host latency of single buffers, against an estimate of
+ *  the DSP clock taken from round trips at the start and end of the run.
+ */
+
+#ifndef Latency__include
+#define Latency__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Latency_Object *Latency_Handle;
+
+typedef struct {
+    String  name;           /* printed with every line, may be NULL */
+    UInt32  maxSamples;     /* buffers kept for the report */
+} Latency_Params;
+
+/* result of all recorded buffers */
+typedef struct {
+    UInt32  syncs;          /* clock syncs fitted, 2 corrects drift */
+    double  syncErrUs;      /* half the best round trip of the worst sync */
+    double  driftPpm;       /* DSP clock against the host, 0 with one sync */
+    UInt64  samples;
+    double  minUs;          /* one-way percentiles */
+    double  p50Us;
+    double  p90Us;
+    double  p99Us;
+    double  p999Us;
+    double  maxUs;
+    double  rttP50Us;       /* App_CMD_SEND to buffer received */
+    double  rttP99Us;
+} Latency_Summary;
+
+Void Latency_Params_init(Latency_Params *params);
+Latency_Handle Latency_create(const Latency_Params *params);
+Void Latency_delete(Latency_Handle *handle);
+
+UInt64 Latency_now(Void);
+Void Latency_syncSample(Latency_Handle handle, UInt64 sendNs,
+        UInt64 dspTicks, UInt64 dspFreq, UInt64 recvNs);
+Int Latency_syncEnd(Latency_Handle handle);
+UInt64 Latency_toHostNs(Latency_Handle handle, UInt64 dspTicks);
+Void Latency_record(Latency_Handle handle, UInt64 sendNs, UInt64 dspTicks,
+        UInt64 recvNs);
+Void Latency_report(Latency_Handle handle, Latency_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Latency__include */
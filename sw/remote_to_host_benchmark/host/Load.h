@@ -0,0 +1,45 @@
+/*
+ *  ======== Load.h ========
+ *  Background CPU, memory bandwidth and cache load run alongside a
+ *  benchmark.
+ */
+
+#ifndef Load__include
+#define Load__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Load_Object *Load_Handle;
+
+typedef struct {
+    UInt32  spinThreads;    /* busy loops, CPU time only */
+    UInt32  streamThreads;  /* memcpy through a buffer far larger than L2 */
+    UInt32  thrashThreads;  /* scattered line updates, evicting the caches */
+    UInt32  streamKB;       /* per stream thread, half source half dest */
+    UInt32  thrashKB;       /* per thrash thread, rounded down to 2^n */
+    UInt32  intensity;      /* % of every period each thread works, 1..100 */
+} Load_Params;
+
+/* what the load threads got done while they ran */
+typedef struct {
+    double  seconds;
+    double  spinMps;        /* million spin iterations per second */
+    double  streamMBps;     /* MB copied per second, read once written once */
+    double  thrashMlps;     /* million cache lines updated per second */
+} Load_Summary;
+
+Void Load_Params_init(Load_Params *params);
+Int Load_parse(Load_Params *params, String spec);
+Bool Load_isIdle(const Load_Params *params);
+
+Load_Handle Load_create(const Load_Params *params);
+Void Load_stop(Load_Handle handle);
+Void Load_report(Load_Handle handle, Load_Summary *summary);
+Void Load_delete(Load_Handle *handle);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Load__include */
@@ -0,0 +1,581 @@
+/*
+ *  ======== Pipeline.c ========
+ *  Multi-threaded host receive pipeline.
+ *
+ *  receiver : Receive_get, records the arrival, queues the buffer;
+ *             host to DSP slots coming back are passed to the caller
+ *  workers  : CMEM_cacheInv and verify (see Verify.c), one buffer at a
+ *             time each
+ *  returner : puts the buffer back to the DSP, either as soon as it is
+ *             processed or in the order the DSP sent it, along with any
+ *             credits the host is ready to grant
+ *
+ *  The threads live as long as the pipeline; Pipeline_waitLoop() blocks
+ *  the caller until a loop's buffers have all been returned and gives the
+ *  time the last one went back. Every stage
+ *  times the work it does between blocking waits, which is reported as
+ *  its utilization of the measured loop time.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/cmem.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "Stats.h"
+#include "Credit.h"
+#include "Verify.h"
+#include "Receive.h"
+#include "Sched.h"
+#include "Latency.h"
+#include "Trace.h"
+#include "Pipeline.h"
+
+/* queue depth and in order window, well above the DSP's buffer count */
+#define Pipeline_QUEUE_SIZE     64
+
+/* bounded blocking FIFO of messages */
+typedef struct {
+    App_Msg *           msgs[Pipeline_QUEUE_SIZE];
+    UInt32              head;
+    UInt32              count;
+    Bool                closed;
+    pthread_mutex_t     lock;
+    pthread_cond_t      notEmpty;
+    pthread_cond_t      notFull;
+} Pipeline_Queue;
+
+/* time spent working by one thread */
+typedef struct {
+    UInt64              busyNs;
+    UInt32              buffers;
+    UInt32              errors;
+} Pipeline_StageStats;
+
+typedef struct {
+    struct Pipeline_Object *pipeline;
+    pthread_t           thread;
+    Pipeline_StageStats stats;
+    Verify_Cost         verify;
+} Pipeline_Worker;
+
+typedef struct Pipeline_Object {
+    Pipeline_Params     params;
+    Pipeline_Queue      workQ;
+    Pipeline_Queue      doneQ;
+    Pipeline_Queue      h2dQ;           /* App_CMD_H2D_RETURN messages */
+    pthread_t           receiver;
+    pthread_t           returner;
+    Pipeline_Worker *   workers;
+    UInt32              numWorkers;     /* worker threads started */
+    Bool                receiverUp;
+    Bool                returnerUp;
+
+    /* loop completion, signalled by the returner */
+    pthread_mutex_t     lock;
+    pthread_cond_t      loopDone;
+    UInt32              returned;
+    UInt32              target;         /* buffers in the current loop */
+    UInt64              doneTime;       /* when returned reached target */
+    UInt32              nextSeq;        /* next buffer to return in order */
+    UInt32              errors;
+
+    /* utilization */
+    UInt64              activeStart;
+    UInt64              activeNs;
+    Pipeline_StageStats receiverStats;
+    Pipeline_StageStats returnerStats;
+} Pipeline_Object;
+
+/* private functions */
+static Void Pipeline_queueInit(Pipeline_Queue *q);
+static Void Pipeline_queueDestroy(Pipeline_Queue *q);
+static Void Pipeline_queueClose(Pipeline_Queue *q);
+static Bool Pipeline_queuePut(Pipeline_Queue *q, App_Msg *msg);
+static App_Msg *Pipeline_queueGet(Pipeline_Queue *q);
+static void *Pipeline_receiverFxn(void *arg);
+static void *Pipeline_workerFxn(void *arg);
+static void *Pipeline_returnerFxn(void *arg);
+static Void Pipeline_putBack(Pipeline_Object *obj, App_Msg *msg);
+
+
+/*
+ *  ======== Pipeline_create ========
+ */
+Pipeline_Handle Pipeline_create(const Pipeline_Params *params)
+{
+    Pipeline_Object *obj;
+    UInt32 i;
+
+    obj = (Pipeline_Object *)calloc(1, sizeof(Pipeline_Object));
+    if (obj == NULL) {
+        printf("Pipeline_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    obj->params = *params;
+    Pipeline_queueInit(&obj->workQ);
+    Pipeline_queueInit(&obj->doneQ);
+    Pipeline_queueInit(&obj->h2dQ);
+    pthread_mutex_init(&obj->lock, NULL);
+    pthread_cond_init(&obj->loopDone, NULL);
+
+    obj->workers = (Pipeline_Worker *)calloc(params->numWorkers,
+        sizeof(Pipeline_Worker));
+    if (obj->workers == NULL) {
+        printf("Pipeline_create: failed to allocate %u workers\n",
+            params->numWorkers);
+        goto fail;
+    }
+
+    /* start the stages from the back so nothing waits on a missing one */
+    if (pthread_create(&obj->returner, NULL, Pipeline_returnerFxn, obj) != 0) {
+        printf("Pipeline_create: failed to start returner\n");
+        goto fail;
+    }
+    obj->returnerUp = TRUE;
+
+    for (i = 0; i < params->numWorkers; i++) {
+        obj->workers[i].pipeline = obj;
+        if (pthread_create(&obj->workers[i].thread, NULL, Pipeline_workerFxn,
+                &obj->workers[i]) != 0) {
+            printf("Pipeline_create: failed to start worker %u\n", i);
+            goto fail;
+        }
+        obj->numWorkers++;
+    }
+
+    if (pthread_create(&obj->receiver, NULL, Pipeline_receiverFxn, obj) != 0) {
+        printf("Pipeline_create: failed to start receiver\n");
+        goto fail;
+    }
+    obj->receiverUp = TRUE;
+
+    return obj;
+
+fail:
+    Pipeline_delete(&obj);
+    return NULL;
+}
+
+/*
+ *  ======== Pipeline_delete ========
+ *  Stop the stages front to back so queued buffers drain to the DSP.
+ */
+Void Pipeline_delete(Pipeline_Handle *handle)
+{
+    Pipeline_Object *obj = *handle;
+    UInt32 i;
+
+    if (obj == NULL) {
+        return;
+    }
+
+    if (obj->receiverUp) {
+        MessageQ_unblock(obj->params.hostQue);
+        pthread_join(obj->receiver, NULL);
+    }
+    Pipeline_queueClose(&obj->h2dQ);
+
+    Pipeline_queueClose(&obj->workQ);
+    for (i = 0; i < obj->numWorkers; i++) {
+        pthread_join(obj->workers[i].thread, NULL);
+    }
+
+    Pipeline_queueClose(&obj->doneQ);
+    if (obj->returnerUp) {
+        pthread_join(obj->returner, NULL);
+    }
+
+    Pipeline_queueDestroy(&obj->workQ);
+    Pipeline_queueDestroy(&obj->doneQ);
+    Pipeline_queueDestroy(&obj->h2dQ);
+    pthread_mutex_destroy(&obj->lock);
+    pthread_cond_destroy(&obj->loopDone);
+    free(obj->workers);
+    free(obj);
+    *handle = NULL;
+}
+
+/*
+ *  ======== Pipeline_loopBegin ========
+ *  Called just before the DSP is asked for a loop's numBuffers buffers.
+ */
+Void Pipeline_loopBegin(Pipeline_Handle handle, UInt32 numBuffers)
+{
+    pthread_mutex_lock(&handle->lock);
+    handle->target = numBuffers;
+    handle->activeStart = Stats_now();
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Pipeline_waitLoop ========
+ *  Block until the loop's buffers have been returned to the DSP, then
+ *  rearm for the next loop. Returns the verify errors of the loop and,
+ *  in doneTime, when the last buffer was returned.
+ */
+Int Pipeline_waitLoop(Pipeline_Handle handle, UInt64 *doneTime)
+{
+    Int errors;
+
+    pthread_mutex_lock(&handle->lock);
+    while (handle->returned < handle->target) {
+        pthread_cond_wait(&handle->loopDone, &handle->lock);
+    }
+    handle->returned -= handle->target;
+    handle->target = 0;
+    handle->nextSeq = 0;
+    errors = handle->errors;
+    handle->errors = 0;
+    handle->activeNs += handle->doneTime - handle->activeStart;
+    *doneTime = handle->doneTime;
+    pthread_mutex_unlock(&handle->lock);
+
+    return errors;
+}
+
+/*
+ *  ======== Pipeline_getH2dReturn ========
+ *  Next host to DSP slot handed back by the DSP, NULL once deleted.
+ */
+App_Msg *Pipeline_getH2dReturn(Pipeline_Handle handle)
+{
+    return Pipeline_queueGet(&handle->h2dQ);
+}
+
+/*
+ *  ======== Pipeline_resetStats ========
+ *  Drop the utilization counters, e.g. at the end of the warm-up.
+ */
+Void Pipeline_resetStats(Pipeline_Handle handle)
+{
+    UInt32 i;
+
+    pthread_mutex_lock(&handle->lock);
+    handle->activeNs = 0;
+    memset(&handle->receiverStats, 0, sizeof(Pipeline_StageStats));
+    memset(&handle->returnerStats, 0, sizeof(Pipeline_StageStats));
+    for (i = 0; i < handle->numWorkers; i++) {
+        memset(&handle->workers[i].stats, 0, sizeof(Pipeline_StageStats));
+        memset(&handle->workers[i].verify, 0, sizeof(Verify_Cost));
+    }
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Pipeline_getVerifyCost ========
+ *  Time all the workers spent verifying since the last reset.
+ */
+Void Pipeline_getVerifyCost(Pipeline_Handle handle, Verify_Cost *cost)
+{
+    UInt32 i;
+
+    memset(cost, 0, sizeof(Verify_Cost));
+    pthread_mutex_lock(&handle->lock);
+    for (i = 0; i < handle->numWorkers; i++) {
+        Verify_add(cost, &handle->workers[i].verify);
+    }
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Pipeline_report ========
+ */
+Void Pipeline_report(Pipeline_Handle handle)
+{
+    double active;
+    Pipeline_StageStats *stats;
+    UInt32 i;
+
+    pthread_mutex_lock(&handle->lock);
+    active = (double)handle->activeNs;
+    printf("Pipeline: %u workers, %s returns, %.3f ms active\n",
+        handle->numWorkers, handle->params.inOrder ? "in order" :
+        "out of order", active / 1e6);
+    printf("    receiver          : %5.1f%% busy, %u buffers\n",
+        active > 0 ? handle->receiverStats.busyNs * 100.0 / active : 0.0,
+        handle->receiverStats.buffers);
+    for (i = 0; i < handle->numWorkers; i++) {
+        stats = &handle->workers[i].stats;
+        printf("    worker %-2u         : %5.1f%% busy, %u buffers, "
+            "%u errors\n", i, active > 0 ?
+            stats->busyNs * 100.0 / active : 0.0, stats->buffers,
+            stats->errors);
+    }
+    printf("    returner          : %5.1f%% busy, %u buffers\n",
+        active > 0 ? handle->returnerStats.busyNs * 100.0 / active : 0.0,
+        handle->returnerStats.buffers);
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Pipeline_receiverFxn ========
+ */
+static void *Pipeline_receiverFxn(void *arg)
+{
+    Pipeline_Object *obj = (Pipeline_Object *)arg;
+    char name[32];
+    App_Msg *msg;
+    Bool buffer;
+    UInt64 t;
+    Int status;
+
+    snprintf(name, sizeof(name), "%s receiver", obj->params.name);
+    Sched_thread(name);
+
+    while (TRUE) {
+        status = Receive_get(obj->params.receive, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+        if (status == MessageQ_E_UNBLOCKED) {
+            break;
+        }
+        if (status < 0) {
+            printf("Pipeline: MessageQ_get failed: %d\n", status);
+            break;
+        }
+        t = Stats_now();
+        Trace_event(App_TRACE_RECV, msg->cmd, obj->params.core);
+        buffer = (msg->cmd == App_CMD_BUFFER);
+
+        if (buffer) {
+            Stats_message(obj->params.stats, msg->data.bufferData.dataLen);
+            Credit_received(obj->params.credit,
+                msg->data.bufferData.creditStalls,
+                msg->data.bufferData.creditStallUs);
+        }
+
+        /* counted before the message moves on, so the loop cannot be
+         * done, nor the stats reset, with this one still to come */
+        pthread_mutex_lock(&obj->lock);
+        obj->receiverStats.buffers += buffer;
+        obj->receiverStats.busyNs += Stats_now() - t;
+        pthread_mutex_unlock(&obj->lock);
+
+        if (buffer) {
+            Pipeline_queuePut(&obj->workQ, msg);
+        }
+        else if (msg->cmd == App_CMD_H2D_RETURN) {
+            Pipeline_queuePut(&obj->h2dQ, msg);
+        }
+        else {
+            /* nothing to process, hand it straight back */
+            Pipeline_queuePut(&obj->doneQ, msg);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ *  ======== Pipeline_workerFxn ========
+ */
+static void *Pipeline_workerFxn(void *arg)
+{
+    Pipeline_Worker *worker = (Pipeline_Worker *)arg;
+    Pipeline_Object *obj = worker->pipeline;
+    Pipeline_StageStats *stats = &worker->stats;
+    Verify_Cost verify;
+    char name[32];
+    App_Msg *msg;
+    UInt32 errors;
+    UInt64 t;
+
+    snprintf(name, sizeof(name), "%s worker %d", obj->params.name,
+        (Int)(worker - obj->workers));
+    Sched_thread(name);
+
+    while ((msg = Pipeline_queueGet(&obj->workQ)) != NULL) {
+        t = Stats_now();
+        Trace_event(App_TRACE_VERIFY_BEGIN, msg->data.bufferData.seq,
+            obj->params.core);
+        memset(&verify, 0, sizeof(Verify_Cost));
+        errors = Verify_buffer((char *)obj->params.base +
+            msg->data.bufferData.offset, msg->data.bufferData.dataLen,
+            obj->params.elemSize, msg->data.bufferData.seq,
+            obj->params.armCached, obj->params.verifyStride, &verify);
+        Trace_event(App_TRACE_VERIFY_END, msg->data.bufferData.seq,
+            obj->params.core);
+
+        /* as in the receiver, counted before the buffer moves on */
+        pthread_mutex_lock(&obj->lock);
+        Verify_add(&worker->verify, &verify);
+        stats->buffers++;
+        stats->errors += errors;
+        stats->busyNs += Stats_now() - t;
+        obj->errors += errors;
+        pthread_mutex_unlock(&obj->lock);
+
+        Pipeline_queuePut(&obj->doneQ, msg);
+    }
+
+    return NULL;
+}
+
+/*
+ *  ======== Pipeline_returnerFxn ========
+ */
+static void *Pipeline_returnerFxn(void *arg)
+{
+    Pipeline_Object *obj = (Pipeline_Object *)arg;
+    App_Msg *window[Pipeline_QUEUE_SIZE];
+    App_Msg *msg;
+    UInt32 seq, slot, returned;
+    char name[32];
+    UInt64 t;
+
+    snprintf(name, sizeof(name), "%s returner", obj->params.name);
+    Sched_thread(name);
+
+    memset(window, 0, sizeof(window));
+
+    while ((msg = Pipeline_queueGet(&obj->doneQ)) != NULL) {
+        t = Stats_now();
+        returned = 0;
+
+        if (msg->cmd != App_CMD_BUFFER || !obj->params.inOrder) {
+            returned = (msg->cmd == App_CMD_BUFFER);
+            Pipeline_putBack(obj, msg);
+        }
+        else {
+            /* hold it until everything sent before it has gone back */
+            seq = msg->data.bufferData.seq;
+            window[seq % Pipeline_QUEUE_SIZE] = msg;
+
+            pthread_mutex_lock(&obj->lock);
+            seq = obj->nextSeq;
+            pthread_mutex_unlock(&obj->lock);
+
+            while ((msg = window[(slot = seq % Pipeline_QUEUE_SIZE)]) != NULL
+                    && msg->data.bufferData.seq == seq) {
+                window[slot] = NULL;
+                Pipeline_putBack(obj, msg);
+                seq++;
+                returned++;
+            }
+        }
+
+        /* counted before the loop is signalled done so a stats reset
+         * at the end of the warm-up cannot race with it */
+        pthread_mutex_lock(&obj->lock);
+        obj->returnerStats.busyNs += Stats_now() - t;
+        if (returned > 0) {
+            obj->returnerStats.buffers += returned;
+            obj->returned += returned;
+            if (obj->params.inOrder) {
+                obj->nextSeq += returned;
+            }
+            if (obj->returned >= obj->target) {
+                obj->doneTime = Stats_now();
+            }
+            pthread_cond_signal(&obj->loopDone);
+        }
+        pthread_mutex_unlock(&obj->lock);
+    }
+
+    return NULL;
+}
+
+/*
+ *  ======== Pipeline_putBack ========
+ *  Return a message to the DSP, a buffer carries the credits due.
+ */
+static Void Pipeline_putBack(Pipeline_Object *obj, App_Msg *msg)
+{
+    if (msg->cmd == App_CMD_BUFFER) {
+        msg->data.bufferData.credits = Credit_release(obj->params.credit);
+        Trace_event(App_TRACE_RETURN, msg->data.bufferData.seq,
+            obj->params.core);
+    }
+    MessageQ_setReplyQueue(obj->params.hostQue, (MessageQ_Msg)msg);
+    MessageQ_put(obj->params.slaveQue, (MessageQ_Msg)msg);
+}
+
+/*
+ *  ======== Pipeline_queueInit ========
+ */
+static Void Pipeline_queueInit(Pipeline_Queue *q)
+{
+    memset(q->msgs, 0, sizeof(q->msgs));
+    q->head = 0;
+    q->count = 0;
+    q->closed = FALSE;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->notEmpty, NULL);
+    pthread_cond_init(&q->notFull, NULL);
+}
+
+/*
+ *  ======== Pipeline_queueDestroy ========
+ */
+static Void Pipeline_queueDestroy(Pipeline_Queue *q)
+{
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->notEmpty);
+    pthread_cond_destroy(&q->notFull);
+}
+
+/*
+ *  ======== Pipeline_queueClose ========
+ *  Wake every reader, Pipeline_queueGet returns NULL once it is drained.
+ */
+static Void Pipeline_queueClose(Pipeline_Queue *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = TRUE;
+    pthread_cond_broadcast(&q->notEmpty);
+    pthread_cond_broadcast(&q->notFull);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/*
+ *  ======== Pipeline_queuePut ========
+ */
+static Bool Pipeline_queuePut(Pipeline_Queue *q, App_Msg *msg)
+{
+    Bool queued = FALSE;
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == Pipeline_QUEUE_SIZE && !q->closed) {
+        pthread_cond_wait(&q->notFull, &q->lock);
+    }
+    if (!q->closed) {
+        q->msgs[(q->head + q->count) % Pipeline_QUEUE_SIZE] = msg;
+        q->count++;
+        pthread_cond_signal(&q->notEmpty);
+        queued = TRUE;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return queued;
+}
+
+/*
+ *  ======== Pipeline_queueGet ========
+ */
+static App_Msg *Pipeline_queueGet(Pipeline_Queue *q)
+{
+    App_Msg *msg = NULL;
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->notEmpty, &q->lock);
+    }
+    if (q->count > 0) {
+        msg = q->msgs[q->head];
+        q->head = (q->head + 1) % Pipeline_QUEUE_SIZE;
+        q->count--;
+        pthread_cond_signal(&q->notFull);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return msg;
+}
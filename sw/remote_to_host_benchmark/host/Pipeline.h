@@ -0,0 +1,46 @@
+/*
+ *  ======== Pipeline.h ========
+ *  Multi-threaded host receive pipeline: one receiver thread dequeues
+ *  buffers from the DSP, a pool of workers invalidates and verifies them
+ *  and a returner thread hands them back to the DSP.
+ */
+
+#ifndef Pipeline__include
+#define Pipeline__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Pipeline_Object *Pipeline_Handle;
+
+typedef struct {
+    String              name;       /* names the threads, e.g. the core */
+    UInt32              core;       /* index, in the trace events */
+    UInt32              numWorkers;
+    Bool                inOrder;    /* return buffers in DSP send order */
+    Bool                armCached;  /* CMEM_cacheInv each buffer */
+    UInt32              verifyStride; /* check every Nth line, 0 none */
+    UInt32              elemSize;   /* App_ELEM_xxx */
+    void *              base;       /* host mapping of the shared region */
+    MessageQ_Handle     hostQue;
+    MessageQ_QueueId    slaveQue;
+    Stats_Handle        stats;      /* fed by the receiver thread */
+    Credit_Handle       credit;     /* grants sent with the returns */
+    Receive_Handle      receive;    /* used by the receiver thread */
+} Pipeline_Params;
+
+Pipeline_Handle Pipeline_create(const Pipeline_Params *params);
+Void Pipeline_delete(Pipeline_Handle *handle);
+
+Void Pipeline_loopBegin(Pipeline_Handle handle, UInt32 numBuffers);
+Int Pipeline_waitLoop(Pipeline_Handle handle, UInt64 *doneTime);
+App_Msg *Pipeline_getH2dReturn(Pipeline_Handle handle);
+Void Pipeline_resetStats(Pipeline_Handle handle);
+Void Pipeline_getVerifyCost(Pipeline_Handle handle, Verify_Cost *cost);
+Void Pipeline_report(Pipeline_Handle handle);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Pipeline__include */
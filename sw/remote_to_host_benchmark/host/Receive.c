@@ -0,0 +1,255 @@
+/*
+ *  ======== Receive.c ========
+ *  MessageQ receive that polls the queue for a while before it blocks.
+ *
+ *  A blocking MessageQ_get puts the thread to sleep and every message
+ *  then costs a wakeup. When messages arrive close together it is
+ *  cheaper to poll with a zero timeout for a short while and only block
+ *  once the poll has run out of budget.
+ *
+ *  The budget follows the stream: every call measures how long the
+ *  caller waited for its message and keeps a moving average of it.
+ *  Twice that average is polled, up to maxSpinUs; once the average is
+ *  above maxSpinUs polling would mostly be wasted and the receive blocks
+ *  straight away, with a full budget probe every Receive_PROBE messages
+ *  to notice when the stream speeds up again. Wakeups avoided are
+ *  counted against the CPU time spent polling.
+ *
+ *  A handle belongs to one receiving thread. The counters are kept under
+ *  a lock, so resetStats and report may be called from another thread
+ *  while it receives, e.g. at the end of the warm-up.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+
+/* module header file */
+#include "Receive.h"
+
+#define Receive_AVG_SHIFT   3       /* moving average over ~8 messages */
+#define Receive_PROBE       32      /* blocked receives between probes */
+
+typedef struct Receive_Object {
+    char                prefix[32];     /* "name " or empty */
+    MessageQ_Handle     queue;
+    UInt64              maxSpinNs;
+    UInt64              budgetNs;
+    UInt64              gapNs;          /* moving average wait */
+    UInt32              sinceProbe;
+    pthread_mutex_t     lock;           /* stats */
+    Receive_Summary     stats;
+} Receive_Object;
+
+
+/*
+ *  ======== Receive_now ========
+ */
+static UInt64 Receive_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Receive_count ========
+ *  Add one call to the counters: its polling, the part of it that ended
+ *  in a block anyway, and whether a message came and how.
+ */
+static Void Receive_count(Receive_Object *obj, UInt64 spinNs, UInt64 missNs,
+        Int status, Bool polled)
+{
+    Receive_Summary *stats = &obj->stats;
+
+    pthread_mutex_lock(&obj->lock);
+    stats->spinNs += spinNs;
+    stats->missNs += missNs;
+    if (status >= 0) {
+        stats->messages++;
+        if (polled) {
+            stats->spinHits++;
+        }
+        else {
+            stats->blocks++;
+        }
+    }
+    pthread_mutex_unlock(&obj->lock);
+}
+
+/*
+ *  ======== Receive_adapt ========
+ *  Fold the wait for the last message into the average and set the next
+ *  budget from it.
+ */
+static Void Receive_adapt(Receive_Object *obj, UInt64 waitNs)
+{
+    Int64 diff = (Int64)waitNs - (Int64)obj->gapNs;
+
+    obj->gapNs = (UInt64)((Int64)obj->gapNs + (diff >> Receive_AVG_SHIFT));
+
+    if (obj->gapNs > obj->maxSpinNs) {
+        obj->budgetNs = 0;
+    }
+    else {
+        obj->budgetNs = 2 * obj->gapNs;
+        if (obj->budgetNs > obj->maxSpinNs) {
+            obj->budgetNs = obj->maxSpinNs;
+        }
+    }
+}
+
+/*
+ *  ======== Receive_Params_init ========
+ */
+Void Receive_Params_init(Receive_Params *params)
+{
+    params->name = NULL;
+    params->queue = NULL;
+    params->maxSpinUs = 0;
+}
+
+/*
+ *  ======== Receive_create ========
+ */
+Receive_Handle Receive_create(const Receive_Params *params)
+{
+    Receive_Object *obj;
+
+    obj = (Receive_Object *)calloc(1, sizeof(Receive_Object));
+    if (obj == NULL) {
+        printf("Receive_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    if (params->name != NULL) {
+        snprintf(obj->prefix, sizeof(obj->prefix), "%s ", params->name);
+    }
+    obj->queue = params->queue;
+    obj->maxSpinNs = (UInt64)params->maxSpinUs * 1000;
+    pthread_mutex_init(&obj->lock, NULL);
+
+    /* start optimistic, a slow stream drops to blocking within a few */
+    obj->budgetNs = obj->maxSpinNs;
+    obj->gapNs = obj->maxSpinNs / 2;
+
+    return obj;
+}
+
+/*
+ *  ======== Receive_delete ========
+ */
+Void Receive_delete(Receive_Handle *handle)
+{
+    Receive_Object *obj = *handle;
+
+    if (obj != NULL) {
+        pthread_mutex_destroy(&obj->lock);
+        free(obj);
+        *handle = NULL;
+    }
+}
+
+/*
+ *  ======== Receive_get ========
+ *  MessageQ_get on the handle's queue, timeout in us as for MessageQ_get.
+ */
+Int Receive_get(Receive_Handle handle, MessageQ_Msg *msg, UInt timeout)
+{
+    UInt64 budget = handle->budgetNs;
+    UInt64 start, now;
+    UInt64 spun = 0;
+    Int status;
+
+    if (budget == 0 && handle->maxSpinNs > 0 &&
+            ++handle->sinceProbe >= Receive_PROBE) {
+        handle->sinceProbe = 0;
+        budget = handle->maxSpinNs;
+    }
+
+    start = Receive_now();
+    if (budget > 0 && timeout != 0) {
+        do {
+            status = MessageQ_get(handle->queue, msg, 0);
+            now = Receive_now();
+        } while (status == MessageQ_E_TIMEOUT && now - start < budget);
+
+        spun = now - start;
+        if (status != MessageQ_E_TIMEOUT) {
+            if (status >= 0) {
+                Receive_adapt(handle, spun);
+            }
+            Receive_count(handle, spun, 0, status, TRUE);
+            return status;
+        }
+
+        /* whatever is left of a finite timeout */
+        if (timeout != MessageQ_FOREVER) {
+            if (spun / 1000 >= timeout) {
+                Receive_count(handle, spun, spun, MessageQ_E_TIMEOUT, TRUE);
+                return MessageQ_E_TIMEOUT;
+            }
+            timeout -= (UInt)(spun / 1000);
+        }
+    }
+
+    status = MessageQ_get(handle->queue, msg, timeout);
+    if (status >= 0) {
+        Receive_adapt(handle, Receive_now() - start);
+    }
+    Receive_count(handle, spun, spun, status, FALSE);
+
+    return status;
+}
+
+/*
+ *  ======== Receive_resetStats ========
+ *  Drop the counters, e.g. at the end of the warm-up. The budget is kept.
+ */
+Void Receive_resetStats(Receive_Handle handle)
+{
+    pthread_mutex_lock(&handle->lock);
+    memset(&handle->stats, 0, sizeof(Receive_Summary));
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== Receive_report ========
+ */
+Void Receive_report(Receive_Handle handle, Receive_Summary *summary)
+{
+    pthread_mutex_lock(&handle->lock);
+    *summary = handle->stats;
+    pthread_mutex_unlock(&handle->lock);
+    summary->budgetUs = handle->budgetNs / 1e3;
+    summary->gapUs = handle->gapNs / 1e3;
+
+    if (handle->maxSpinNs == 0) {
+        printf("%sReceive: always blocks, %llu messages\n", handle->prefix,
+            (unsigned long long)summary->messages);
+        return;
+    }
+
+    printf("%sReceive: polls up to %.0f us before blocking\n",
+        handle->prefix, handle->maxSpinNs / 1e3);
+    printf("    messages          : %llu, %llu caught polling (%.1f%%), "
+        "%llu blocked\n", (unsigned long long)summary->messages,
+        (unsigned long long)summary->spinHits, summary->messages > 0 ?
+        summary->spinHits * 100.0 / summary->messages : 0.0,
+        (unsigned long long)summary->blocks);
+    printf("    polling (us)      : %.3f total, %.3f of it before blocking "
+        "anyway\n", summary->spinNs / 1e3, summary->missNs / 1e3);
+    printf("    wakeups avoided   : %llu, %.3f us polled per wakeup avoided\n",
+        (unsigned long long)summary->spinHits, summary->spinHits > 0 ?
+        summary->spinNs / 1e3 / summary->spinHits : 0.0);
+    printf("    budget (us)       : %.3f now, average wait %.3f\n",
+        summary->budgetUs, summary->gapUs);
+}
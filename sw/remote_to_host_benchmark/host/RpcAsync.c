@@ -0,0 +1,499 @@
+/*
+ *  ======== RpcAsync.c ========
+ *  Asynchronous typed calls to several cores, completed by a receive
+ *  thread.
+ *
+ *  Every outstanding call holds a slot, taken from a free list when it
+ *  starts and given back when its reply comes in; the slot index is the
+ *  low half of the request id and a serial the high half, so a late
+ *  reply never finishes the slot's next call. A call that finds its
+ *  core's window full waits in the core's backlog, a list through the
+ *  slots, with its message already built. The lock is never held
+ *  across MessageQ_put or a callback.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "../shared/Rpc.h"
+#include "RpcAsync.h"
+
+#define RpcAsync_NONE       0xFFFFFFFF
+#define RpcAsync_SLOT_MASK  (RpcAsync_MAX_OUTSTANDING - 1)
+
+/* one outstanding call */
+typedef struct {
+    RpcAsync_Future *   future;     // NULL while the slot is free
+    Rpc_Msg *           msg;        // built, waiting in the backlog
+    UInt32              next;       // backlog link
+} RpcAsync_Slot;
+
+/* one core's calls */
+typedef struct {
+    UInt32              inFlight;   // on the wire
+    UInt32              head;       // backlog, oldest first
+    UInt32              tail;
+    UInt32              backlog;
+} RpcAsync_Core;
+
+typedef struct RpcAsync_Object {
+    RpcAsync_Params     params;
+    MessageQ_Handle     que;        // replies from every core
+    pthread_t           thread;
+    Bool                running;    // receive thread started
+    pthread_mutex_t     lock;       // everything below
+    pthread_cond_t      doneCond;   // a waited for call is done
+    UInt32              waiters;
+    RpcAsync_Slot *     slots;
+    UInt32 *            freeSlots;
+    UInt32              numFree;
+    UInt32              serial;
+    RpcAsync_Core       cores[RpcAsync_MAX_CORES];
+    RpcAsync_Stats      stats;
+} RpcAsync_Object;
+
+/* private functions */
+static void *RpcAsync_receiveThread(void *arg);
+static Void RpcAsync_finish(RpcAsync_Object *obj, RpcAsync_Future *future,
+        Rpc_Msg *msg, Int status);
+
+
+/*
+ *  ======== RpcAsync_Params_init ========
+ */
+Void RpcAsync_Params_init(RpcAsync_Params *params)
+{
+    memset(params, 0, sizeof(RpcAsync_Params));
+    params->maxOutstanding = 4096;
+    params->window = 64;
+}
+
+/*
+ *  ======== RpcAsync_create ========
+ */
+RpcAsync_Handle RpcAsync_create(const RpcAsync_Params *params)
+{
+    RpcAsync_Object *obj;
+    MessageQ_Params msgqParams;
+    UInt32 i;
+
+    if (params->numCores == 0 || params->numCores > RpcAsync_MAX_CORES ||
+            params->maxOutstanding == 0 ||
+            params->maxOutstanding > RpcAsync_MAX_OUTSTANDING ||
+            params->window == 0) {
+        printf("RpcAsync_create: bad parameters\n");
+        return (NULL);
+    }
+
+    obj = (RpcAsync_Object *)calloc(1, sizeof(RpcAsync_Object));
+    if (obj == NULL) {
+        return (NULL);
+    }
+    obj->params = *params;
+    pthread_mutex_init(&obj->lock, NULL);
+    pthread_cond_init(&obj->doneCond, NULL);
+
+    obj->slots = (RpcAsync_Slot *)calloc(params->maxOutstanding,
+        sizeof(RpcAsync_Slot));
+    obj->freeSlots = (UInt32 *)malloc(params->maxOutstanding *
+        sizeof(UInt32));
+    if (obj->slots == NULL || obj->freeSlots == NULL) {
+        goto fail;
+    }
+    for (i = 0; i < params->maxOutstanding; i++) {
+        obj->freeSlots[i] = params->maxOutstanding - 1 - i;
+    }
+    obj->numFree = params->maxOutstanding;
+    for (i = 0; i < params->numCores; i++) {
+        obj->cores[i].head = RpcAsync_NONE;
+        obj->cores[i].tail = RpcAsync_NONE;
+    }
+
+    /* one unnamed queue for the replies of every core */
+    MessageQ_Params_init(&msgqParams);
+    obj->que = MessageQ_create(NULL, &msgqParams);
+    if (obj->que == NULL) {
+        printf("RpcAsync_create: failed creating the reply queue\n");
+        goto fail;
+    }
+
+    if (pthread_create(&obj->thread, NULL, RpcAsync_receiveThread,
+            obj) != 0) {
+        printf("RpcAsync_create: failed to start the receive thread\n");
+        goto fail;
+    }
+    obj->running = TRUE;
+
+    return (obj);
+
+fail:
+    RpcAsync_delete(&obj);
+    return (NULL);
+}
+
+/*
+ *  ======== RpcAsync_delete ========
+ *  Outstanding calls are given a second since the last one came back.
+ */
+Void RpcAsync_delete(RpcAsync_Handle *handle)
+{
+    RpcAsync_Object *obj = *handle;
+    struct timespec until;
+    UInt32 numFree;
+    UInt32 i;
+
+    if (obj == NULL) {
+        return;
+    }
+
+    if (obj->running) {
+        pthread_mutex_lock(&obj->lock);
+        obj->waiters++;
+        while (obj->numFree < obj->params.maxOutstanding) {
+            numFree = obj->numFree;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += 1;
+            while (obj->numFree == numFree &&
+                    pthread_cond_timedwait(&obj->doneCond, &obj->lock,
+                    &until) != ETIMEDOUT) {
+            }
+            if (obj->numFree == numFree) {
+                break;
+            }
+        }
+        obj->waiters--;
+        if (obj->numFree < obj->params.maxOutstanding) {
+            printf("RpcAsync_delete: %u calls never came back\n",
+                obj->params.maxOutstanding - obj->numFree);
+        }
+        pthread_mutex_unlock(&obj->lock);
+
+        MessageQ_unblock(obj->que);
+        pthread_join(obj->thread, NULL);
+    }
+    if (obj->stats.strays > 0) {
+        printf("RpcAsync_delete: %u replies to no call\n", obj->stats.strays);
+    }
+
+    /* calls that never left the backlog */
+    if (obj->slots != NULL) {
+        for (i = 0; i < obj->params.maxOutstanding; i++) {
+            if (obj->slots[i].msg != NULL) {
+                MessageQ_free((MessageQ_Msg)obj->slots[i].msg);
+            }
+        }
+    }
+    if (obj->que != NULL) {
+        MessageQ_delete(&obj->que);
+    }
+    pthread_cond_destroy(&obj->doneCond);
+    pthread_mutex_destroy(&obj->lock);
+    free(obj->slots);
+    free(obj->freeSlots);
+    free(obj);
+    *handle = NULL;
+}
+
+/*
+ *  ======== RpcAsync_Future_init ========
+ */
+Void RpcAsync_Future_init(RpcAsync_Future *future,
+        RpcAsync_Callback callback, Ptr arg)
+{
+    memset(future, 0, sizeof(RpcAsync_Future));
+    future->callback = callback;
+    future->arg = arg;
+}
+
+/*
+ *  ======== RpcAsync_start ========
+ */
+Int RpcAsync_start(RpcAsync_Handle handle, UInt32 core, UInt32 call,
+        const void *in, UInt32 inSize, void *out, UInt32 outSize,
+        RpcAsync_Future *future)
+{
+    RpcAsync_Object *obj = handle;
+    UInt32 argsSize = (inSize > outSize) ? inSize : outSize;
+    RpcAsync_Core *rc;
+    UInt32 outstanding;
+    Rpc_Msg *msg;
+    Bool send;
+    UInt32 slot;
+    Int status;
+
+    if (core >= obj->params.numCores || argsSize > Rpc_ARGS_MAX) {
+        return (Rpc_E_ARGS);
+    }
+
+    /* build the message before taking the lock */
+    msg = (Rpc_Msg *)MessageQ_alloc(App_MsgHeapId, Rpc_MSG_SIZE(argsSize));
+    if (msg == NULL) {
+        printf("RpcAsync_start: failed to allocate message\n");
+        return (-1);
+    }
+    MessageQ_setReplyQueue(obj->que, (MessageQ_Msg)msg);
+    msg->cmd = App_CMD_RPC | call;
+    msg->status = Rpc_S_SUCCESS;
+    msg->ticks = 0;
+    memcpy(msg->args, in, inSize);
+
+    future->core = core;
+    future->call = call;
+    future->out = out;
+    future->outSize = outSize;
+    future->done = FALSE;
+    future->status = Rpc_S_SUCCESS;
+    future->ticks = 0;
+
+    pthread_mutex_lock(&obj->lock);
+    if (obj->numFree == 0) {
+        obj->stats.full++;
+        pthread_mutex_unlock(&obj->lock);
+        MessageQ_free((MessageQ_Msg)msg);
+        return (RpcAsync_E_FULL);
+    }
+    slot = obj->freeSlots[--obj->numFree];
+    future->seq = (obj->serial++ << 16) | slot;
+    msg->seq = future->seq;
+    obj->slots[slot].future = future;
+    obj->slots[slot].msg = NULL;
+    obj->slots[slot].next = RpcAsync_NONE;
+
+    /* on the wire now, or behind the core's backlog */
+    rc = &obj->cores[core];
+    send = (rc->inFlight < obj->params.window && rc->backlog == 0);
+    if (send) {
+        rc->inFlight++;
+    }
+    else {
+        obj->slots[slot].msg = msg;
+        if (rc->tail == RpcAsync_NONE) {
+            rc->head = slot;
+        }
+        else {
+            obj->slots[rc->tail].next = slot;
+        }
+        rc->tail = slot;
+        rc->backlog++;
+        obj->stats.backlogged++;
+        if (rc->backlog > obj->stats.maxBacklog) {
+            obj->stats.maxBacklog = rc->backlog;
+        }
+    }
+    obj->stats.started++;
+    outstanding = obj->params.maxOutstanding - obj->numFree;
+    if (outstanding > obj->stats.maxOutstanding) {
+        obj->stats.maxOutstanding = outstanding;
+    }
+    pthread_mutex_unlock(&obj->lock);
+
+    if (send) {
+        status = MessageQ_put(obj->params.slaveQues[core], (MessageQ_Msg)msg);
+        if (status < 0) {
+            MessageQ_free((MessageQ_Msg)msg);
+            RpcAsync_finish(obj, future, NULL, RpcAsync_E_SEND);
+        }
+    }
+
+    return (0);
+}
+
+/*
+ *  ======== RpcAsync_finish ========
+ *  Free the call's slot, send the next call of its core's backlog and
+ *  complete the future, from msg or with status.
+ */
+static Void RpcAsync_finish(RpcAsync_Object *obj, RpcAsync_Future *future,
+        Rpc_Msg *msg, Int status)
+{
+    UInt32 slot = future->seq & RpcAsync_SLOT_MASK;
+    RpcAsync_Core *rc = &obj->cores[future->core];
+    Rpc_Msg *next = NULL;
+    UInt32 size;
+
+    pthread_mutex_lock(&obj->lock);
+    obj->slots[slot].future = NULL;
+    obj->freeSlots[obj->numFree++] = slot;
+    rc->inFlight--;
+    if (rc->backlog > 0) {
+        next = obj->slots[rc->head].msg;
+        obj->slots[rc->head].msg = NULL;
+        rc->head = obj->slots[rc->head].next;
+        if (rc->head == RpcAsync_NONE) {
+            rc->tail = RpcAsync_NONE;
+        }
+        rc->backlog--;
+        rc->inFlight++;
+    }
+    obj->stats.completed++;
+    pthread_mutex_unlock(&obj->lock);
+
+    if (next != NULL && MessageQ_put(obj->params.slaveQues[future->core],
+            (MessageQ_Msg)next) < 0) {
+        /* the call behind it fails the same way */
+        RpcAsync_finish(obj, obj->slots[next->seq & RpcAsync_SLOT_MASK].future,
+            NULL, RpcAsync_E_SEND);
+        MessageQ_free((MessageQ_Msg)next);
+    }
+
+    if (msg != NULL) {
+        status = msg->status;
+        future->ticks = msg->ticks;
+        size = MessageQ_getMsgSize(msg) - Rpc_MSG_SIZE(0);
+        if (status == Rpc_S_SUCCESS) {
+            memcpy(future->out, msg->args,
+                size < future->outSize ? size : future->outSize);
+        }
+    }
+    future->status = status;
+
+    if (future->callback != NULL) {
+        future->done = TRUE;
+        future->callback(future, future->arg);
+    }
+    else {
+        pthread_mutex_lock(&obj->lock);
+        future->done = TRUE;
+        if (obj->waiters > 0) {
+            pthread_cond_broadcast(&obj->doneCond);
+        }
+        pthread_mutex_unlock(&obj->lock);
+    }
+}
+
+/*
+ *  ======== RpcAsync_receiveThread ========
+ */
+static void *RpcAsync_receiveThread(void *arg)
+{
+    RpcAsync_Object *obj = (RpcAsync_Object *)arg;
+    RpcAsync_Future *future;
+    Rpc_Msg *msg;
+    UInt32 slot;
+    Int status;
+
+    while (TRUE) {
+        status = MessageQ_get(obj->que, (MessageQ_Msg *)&msg,
+            MessageQ_FOREVER);
+        if (status < 0) {
+            if (status != MessageQ_E_UNBLOCKED) {
+                printf("RpcAsync: receive failed, %d\n", status);
+            }
+            break;
+        }
+
+        slot = msg->seq & RpcAsync_SLOT_MASK;
+        future = NULL;
+        pthread_mutex_lock(&obj->lock);
+        if (slot < obj->params.maxOutstanding &&
+                obj->slots[slot].future != NULL &&
+                obj->slots[slot].future->seq == msg->seq &&
+                obj->slots[slot].msg == NULL) {
+            future = obj->slots[slot].future;
+        }
+        else {
+            obj->stats.strays++;
+        }
+        pthread_mutex_unlock(&obj->lock);
+
+        if (future != NULL) {
+            RpcAsync_finish(obj, future, msg, Rpc_S_SUCCESS);
+        }
+        MessageQ_free((MessageQ_Msg)msg);
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== RpcAsync_wait ========
+ *  For a future without a callback; timeout in us or MessageQ_FOREVER.
+ */
+Int RpcAsync_wait(RpcAsync_Handle handle, RpcAsync_Future *future,
+        UInt timeout)
+{
+    RpcAsync_Object *obj = handle;
+    struct timespec until;
+    Int status = 0;
+
+    if (timeout != MessageQ_FOREVER) {
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += timeout / 1000000;
+        until.tv_nsec += (timeout % 1000000) * 1000;
+        if (until.tv_nsec >= 1000000000) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&obj->lock);
+    obj->waiters++;
+    while (!future->done && status == 0) {
+        if (timeout == MessageQ_FOREVER) {
+            pthread_cond_wait(&obj->doneCond, &obj->lock);
+        }
+        else if (pthread_cond_timedwait(&obj->doneCond, &obj->lock,
+                &until) == ETIMEDOUT) {
+            status = future->done ? 0 : RpcAsync_E_TIMEOUT;
+        }
+    }
+    obj->waiters--;
+    pthread_mutex_unlock(&obj->lock);
+
+    return (status);
+}
+
+/*
+ *  ======== RpcAsync_outstanding ========
+ */
+UInt32 RpcAsync_outstanding(RpcAsync_Handle handle)
+{
+    UInt32 outstanding;
+
+    pthread_mutex_lock(&handle->lock);
+    outstanding = handle->params.maxOutstanding - handle->numFree;
+    pthread_mutex_unlock(&handle->lock);
+
+    return (outstanding);
+}
+
+/*
+ *  ======== RpcAsync_stats ========
+ */
+Void RpcAsync_stats(RpcAsync_Handle handle, RpcAsync_Stats *stats,
+        Bool reset)
+{
+    pthread_mutex_lock(&handle->lock);
+    if (stats != NULL) {
+        *stats = handle->stats;
+    }
+    if (reset) {
+        memset(&handle->stats, 0, sizeof(RpcAsync_Stats));
+    }
+    pthread_mutex_unlock(&handle->lock);
+}
+
+/*
+ *  ======== RpcAsync_<name> ========
+ */
+#define RpcAsync_STUBS(name, id) \
+Int RpcAsync_##name(RpcAsync_Handle handle, UInt32 core, \
+        const Rpc_##name##_In *in, Rpc_##name##_Out *out, \
+        RpcAsync_Future *future) \
+{ \
+    return (RpcAsync_start(handle, core, Rpc_ID_##name, in, sizeof(*in), \
+        out, sizeof(*out), future)); \
+}
+Rpc_CALLS(RpcAsync_STUBS)
+#undef RpcAsync_STUBS
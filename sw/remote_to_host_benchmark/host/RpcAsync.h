@@ -0,0 +1,97 @@
+/*
+ *  ======== RpcAsync.h ========
+ *  Asynchronous typed calls to several cores, completed by a receive
+ *  thread.
+ *
+ *  RpcAsync_<name> never waits for a DSP: the call goes out at once if
+ *  its core has fewer than window calls on the wire, else it waits in
+ *  the host's backlog for that core and goes out as earlier calls come
+ *  back. Every core replies to one host queue, read by one receive
+ *  thread that finds each reply's future by request id, in any order.
+ *  A done future either runs its callback on the receive thread or
+ *  wakes RpcAsync_wait. Any thread may start calls and wait.
+ *
+ *  Include after MessageQ.h, AppCommon.h and Rpc.h.
+ */
+
+#ifndef RpcAsync__include
+#define RpcAsync__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define RpcAsync_MAX_CORES      4
+
+/* the request id keeps the slot in its low 16 bits */
+#define RpcAsync_MAX_OUTSTANDING 0x10000
+
+/* status besides Rpc_S_xxx and Rpc_E_xxx */
+#define RpcAsync_E_FULL         -20 /* maxOutstanding calls already */
+#define RpcAsync_E_TIMEOUT      -21 /* RpcAsync_wait gave up */
+#define RpcAsync_E_SEND         -22 /* MessageQ_put failed */
+
+typedef struct RpcAsync_Object *RpcAsync_Handle;
+typedef struct RpcAsync_Future RpcAsync_Future;
+
+/* runs on the receive thread; the future is the callback's from here */
+typedef Void (*RpcAsync_Callback)(RpcAsync_Future *future, Ptr arg);
+
+/* one call, the caller's until it is done */
+struct RpcAsync_Future {
+    RpcAsync_Callback   callback;   /* NULL to use RpcAsync_wait */
+    Ptr                 arg;
+    UInt32              seq;        /* request id */
+    UInt32              core;
+    UInt32              call;       /* Rpc_ID_xxx */
+    void *              out;        /* results land here */
+    UInt32              outSize;
+    volatile Bool       done;
+    Int                 status;     /* Rpc_S_xxx, Rpc_E_xxx, RpcAsync_E_xxx */
+    UInt32              ticks;      /* DSP Timestamp ticks of the call */
+};
+
+typedef struct {
+    UInt32              numCores;
+    MessageQ_QueueId    slaveQues[RpcAsync_MAX_CORES];
+    UInt32              maxOutstanding; /* all cores, default 4096 */
+    UInt32              window;         /* on the wire per core, default 64 */
+} RpcAsync_Params;
+
+typedef struct {
+    UInt64              started;
+    UInt64              completed;
+    UInt64              backlogged;     /* had to wait for window room */
+    UInt32              maxBacklog;     /* longest any core's backlog got */
+    UInt32              maxOutstanding; /* most calls outstanding at once */
+    UInt32              full;           /* starts refused, RpcAsync_E_FULL */
+    UInt32              strays;         /* replies to no call */
+} RpcAsync_Stats;
+
+Void RpcAsync_Params_init(RpcAsync_Params *params);
+RpcAsync_Handle RpcAsync_create(const RpcAsync_Params *params);
+Void RpcAsync_delete(RpcAsync_Handle *handle);
+
+Void RpcAsync_Future_init(RpcAsync_Future *future,
+        RpcAsync_Callback callback, Ptr arg);
+Int RpcAsync_start(RpcAsync_Handle handle, UInt32 core, UInt32 call,
+        const void *in, UInt32 inSize, void *out, UInt32 outSize,
+        RpcAsync_Future *future);
+Int RpcAsync_wait(RpcAsync_Handle handle, RpcAsync_Future *future,
+        UInt timeout);
+UInt32 RpcAsync_outstanding(RpcAsync_Handle handle);
+Void RpcAsync_stats(RpcAsync_Handle handle, RpcAsync_Stats *stats,
+        Bool reset);
+
+/* RpcAsync_<name>, future set up by RpcAsync_Future_init */
+#define RpcAsync_DECLARE(name, id) \
+    Int RpcAsync_##name(RpcAsync_Handle handle, UInt32 core, \
+            const Rpc_##name##_In *in, Rpc_##name##_Out *out, \
+            RpcAsync_Future *future);
+Rpc_CALLS(RpcAsync_DECLARE)
+#undef RpcAsync_DECLARE
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* RpcAsync__include */
@@ -0,0 +1,277 @@
+/*
+ *  ======== RpcClient.c ========
+ *  Host side of the typed calls in Rpc.h.
+ *
+ *  A call in flight sits in the slot its request id picks, modulo
+ *  maxPending. Starting a call whose slot is still taken takes replies
+ *  until it frees, so maxPending also bounds the calls in flight.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/cmem.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "../shared/Rpc.h"
+#include "RpcClient.h"
+
+typedef struct RpcClient_Object {
+    RpcClient_Params        params;
+    UInt32                  nextSeq;
+    UInt32                  numPending;
+    UInt32                  strays;     // replies no call was waiting for
+    RpcClient_Future **     pending;    // by seq % maxPending
+} RpcClient_Object;
+
+
+/*
+ *  ======== RpcClient_Params_init ========
+ */
+Void RpcClient_Params_init(RpcClient_Params *params)
+{
+    params->hostQue = NULL;
+    params->slaveQue = MessageQ_INVALIDMESSAGEQ;
+    params->maxPending = 64;
+}
+
+/*
+ *  ======== RpcClient_create ========
+ */
+RpcClient_Handle RpcClient_create(const RpcClient_Params *params)
+{
+    RpcClient_Object *obj;
+
+    if (params->hostQue == NULL || params->maxPending == 0) {
+        printf("RpcClient_create: needs a host queue and maxPending\n");
+        return (NULL);
+    }
+
+    obj = (RpcClient_Object *)calloc(1, sizeof(RpcClient_Object));
+    if (obj == NULL) {
+        return (NULL);
+    }
+    obj->params = *params;
+    obj->pending = (RpcClient_Future **)calloc(params->maxPending,
+        sizeof(RpcClient_Future *));
+    if (obj->pending == NULL) {
+        free(obj);
+        return (NULL);
+    }
+
+    return (obj);
+}
+
+/*
+ *  ======== RpcClient_delete ========
+ *  Calls still in flight are waited for, a second each at most.
+ */
+Void RpcClient_delete(RpcClient_Handle *handle)
+{
+    RpcClient_Object *obj = *handle;
+
+    if (obj == NULL) {
+        return;
+    }
+
+    while (obj->numPending > 0) {
+        if (RpcClient_poll(obj, 1000000) < 0) {
+            printf("RpcClient_delete: %u calls never came back\n",
+                obj->numPending);
+            break;
+        }
+    }
+    if (obj->strays > 0) {
+        printf("RpcClient_delete: %u replies to no call\n", obj->strays);
+    }
+
+    free(obj->pending);
+    free(obj);
+    *handle = NULL;
+}
+
+/*
+ *  ======== RpcClient_start ========
+ */
+Int RpcClient_start(RpcClient_Handle handle, UInt32 call, const void *in,
+        UInt32 inSize, void *out, UInt32 outSize, RpcClient_Future *future)
+{
+    RpcClient_Object *obj = handle;
+    UInt32 seq = obj->nextSeq;
+    UInt32 slot = seq % obj->params.maxPending;
+    UInt32 argsSize = (inSize > outSize) ? inSize : outSize;
+    Rpc_Msg *msg;
+    Int status;
+
+    if (argsSize > Rpc_ARGS_MAX) {
+        return (Rpc_E_SIZE);
+    }
+
+    /* the slot is free once its call has come back */
+    while (obj->pending[slot] != NULL) {
+        status = RpcClient_poll(obj, MessageQ_FOREVER);
+        if (status < 0) {
+            return (status);
+        }
+    }
+
+    msg = (Rpc_Msg *)MessageQ_alloc(App_MsgHeapId, Rpc_MSG_SIZE(argsSize));
+    if (msg == NULL) {
+        printf("RpcClient_start: failed to allocate message\n");
+        return (-1);
+    }
+    MessageQ_setReplyQueue(obj->params.hostQue, (MessageQ_Msg)msg);
+    msg->cmd = App_CMD_RPC | call;
+    msg->seq = seq;
+    msg->status = Rpc_S_SUCCESS;
+    msg->ticks = 0;
+    memcpy(msg->args, in, inSize);
+
+    future->seq = seq;
+    future->call = call;
+    future->out = out;
+    future->outSize = outSize;
+    future->done = FALSE;
+    future->status = Rpc_S_SUCCESS;
+    future->ticks = 0;
+
+    obj->pending[slot] = future;
+    obj->numPending++;
+    obj->nextSeq++;
+
+    status = MessageQ_put(obj->params.slaveQue, (MessageQ_Msg)msg);
+    if (status < 0) {
+        obj->pending[slot] = NULL;
+        obj->numPending--;
+        MessageQ_free((MessageQ_Msg)msg);
+        return (status);
+    }
+
+    return (0);
+}
+
+/*
+ *  ======== RpcClient_poll ========
+ *  Take one reply and finish its call. MessageQ_E_TIMEOUT when none came
+ *  within timeout us.
+ */
+Int RpcClient_poll(RpcClient_Handle handle, UInt timeout)
+{
+    RpcClient_Object *obj = handle;
+    RpcClient_Future *future;
+    Rpc_Msg *msg;
+    UInt32 size;
+    Int status;
+
+    status = MessageQ_get(obj->params.hostQue, (MessageQ_Msg *)&msg,
+        timeout);
+    if (status < 0) {
+        return (status);
+    }
+
+    future = obj->pending[msg->seq % obj->params.maxPending];
+    if (future == NULL || future->seq != msg->seq ||
+            (msg->cmd & App_CMD_MASK) != App_CMD_RPC) {
+        obj->strays++;
+        MessageQ_free((MessageQ_Msg)msg);
+        return (0);
+    }
+
+    /* a reply too short for the results fills in what it has */
+    size = MessageQ_getMsgSize(msg) - Rpc_MSG_SIZE(0);
+    if (size > future->outSize) {
+        size = future->outSize;
+    }
+    if (msg->status == Rpc_S_SUCCESS) {
+        memcpy(future->out, msg->args, size);
+    }
+    future->status = msg->status;
+    future->ticks = msg->ticks;
+    future->done = TRUE;
+
+    obj->pending[msg->seq % obj->params.maxPending] = NULL;
+    obj->numPending--;
+    MessageQ_free((MessageQ_Msg)msg);
+
+    return (0);
+}
+
+/*
+ *  ======== RpcClient_wait ========
+ */
+Int RpcClient_wait(RpcClient_Handle handle, RpcClient_Future *future)
+{
+    Int status;
+
+    while (!future->done) {
+        status = RpcClient_poll(handle, MessageQ_FOREVER);
+        if (status < 0) {
+            return (status);
+        }
+    }
+
+    return (0);
+}
+
+/*
+ *  ======== RpcClient_pending ========
+ */
+UInt32 RpcClient_pending(RpcClient_Handle handle)
+{
+    return (handle->numPending);
+}
+
+/*
+ *  ======== RpcClient_bulk ========
+ */
+Void RpcClient_bulk(Rpc_Bulk *bulk, void *buf, UInt32 size, Bool cached)
+{
+    if (cached) {
+        CMEM_cacheWb(buf, size);
+    }
+    bulk->phys = (UInt32)CMEM_getPhys(buf);
+    bulk->size = size;
+}
+
+/*
+ *  ======== RpcClient_bulkDone ========
+ */
+Void RpcClient_bulkDone(void *buf, UInt32 size, Bool cached)
+{
+    if (cached) {
+        CMEM_cacheInv(buf, size);
+    }
+}
+
+/*
+ *  ======== RpcClient_<name> and RpcClient_<name>Start ========
+ */
+#define RpcClient_STUBS(name, id) \
+Int RpcClient_##name##Start(RpcClient_Handle handle, \
+        const Rpc_##name##_In *in, Rpc_##name##_Out *out, \
+        RpcClient_Future *future) \
+{ \
+    return (RpcClient_start(handle, Rpc_ID_##name, in, sizeof(*in), out, \
+        sizeof(*out), future)); \
+} \
+\
+Int RpcClient_##name(RpcClient_Handle handle, const Rpc_##name##_In *in, \
+        Rpc_##name##_Out *out) \
+{ \
+    RpcClient_Future future; \
+    Int status; \
+\
+    status = RpcClient_##name##Start(handle, in, out, &future); \
+    if (status == 0) { \
+        status = RpcClient_wait(handle, &future); \
+    } \
+    return (status < 0 ? status : future.status); \
+}
+Rpc_CALLS(RpcClient_STUBS)
+#undef RpcClient_STUBS
@@ -0,0 +1,69 @@
+/*
+ *  ======== RpcClient.h ========
+ *  Host side of the typed calls in Rpc.h.
+ *
+ *  Every call in Rpc_CALLS gets two stubs: RpcClient_<name> waits for
+ *  the results, RpcClient_<name>Start sends the call and returns, its
+ *  future done once RpcClient_wait or RpcClient_poll has taken the
+ *  reply. Calls complete in any order; the request id in each reply
+ *  finds its future. A client belongs to one thread and is the only
+ *  reader of its host queue.
+ *
+ *  Include after MessageQ.h, AppCommon.h and Rpc.h.
+ */
+
+#ifndef RpcClient__include
+#define RpcClient__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct RpcClient_Object *RpcClient_Handle;
+
+typedef struct {
+    MessageQ_Handle     hostQue;        /* replies, read by no one else */
+    MessageQ_QueueId    slaveQue;       /* the DSP's queue */
+    UInt32              maxPending;     /* calls in flight, default 64 */
+} RpcClient_Params;
+
+/* one call in flight, the caller's until it is done */
+typedef struct {
+    UInt32              seq;            /* request id */
+    UInt32              call;           /* Rpc_ID_xxx */
+    void *              out;            /* results land here */
+    UInt32              outSize;
+    Bool                done;
+    Int                 status;         /* Rpc_S_xxx or Rpc_E_xxx once done */
+    UInt32              ticks;          /* DSP Timestamp ticks of the call */
+} RpcClient_Future;
+
+Void RpcClient_Params_init(RpcClient_Params *params);
+RpcClient_Handle RpcClient_create(const RpcClient_Params *params);
+Void RpcClient_delete(RpcClient_Handle *handle);
+
+Int RpcClient_start(RpcClient_Handle handle, UInt32 call, const void *in,
+        UInt32 inSize, void *out, UInt32 outSize, RpcClient_Future *future);
+Int RpcClient_wait(RpcClient_Handle handle, RpcClient_Future *future);
+Int RpcClient_poll(RpcClient_Handle handle, UInt timeout);
+UInt32 RpcClient_pending(RpcClient_Handle handle);
+
+/* a CMEM buffer as a call argument, written back if the mapping is
+ * cached, and the invalidate for a buffer the DSP has written */
+Void RpcClient_bulk(Rpc_Bulk *bulk, void *buf, UInt32 size, Bool cached);
+Void RpcClient_bulkDone(void *buf, UInt32 size, Bool cached);
+
+/* RpcClient_<name> and RpcClient_<name>Start */
+#define RpcClient_DECLARE(name, id) \
+    Int RpcClient_##name(RpcClient_Handle handle, \
+            const Rpc_##name##_In *in, Rpc_##name##_Out *out); \
+    Int RpcClient_##name##Start(RpcClient_Handle handle, \
+            const Rpc_##name##_In *in, Rpc_##name##_Out *out, \
+            RpcClient_Future *future);
+Rpc_CALLS(RpcClient_DECLARE)
+#undef RpcClient_DECLARE
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* RpcClient__include */
@@ -0,0 +1,44 @@
+/*
+ *  ======== Sched.h ========
+ *  Real-time scheduling, CPU affinity and memory locking for the host
+ *  benchmark threads.
+ */
+
+#ifndef Sched__include
+#define Sched__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+typedef struct {
+    Int     priority;       /* SCHED_FIFO priority, 0 keeps SCHED_OTHER */
+    String  cpus;           /* "1" or "0,1" or "0-1", NULL any CPU */
+    Bool    lockMemory;     /* mlockall and pre-fault the stack */
+} Sched_Params;
+
+/* process counters from getrusage */
+typedef struct {
+    UInt64  minorFaults;
+    UInt64  majorFaults;
+    UInt64  voluntary;      /* context switches, mostly blocking */
+    UInt64  involuntary;    /* context switches, preempted */
+} Sched_Usage;
+
+Void Sched_Params_init(Sched_Params *params);
+Int Sched_setup(const Sched_Params *params);
+Int Sched_thread(String name);
+Void Sched_prefault(void *base, size_t size);
+Void Sched_usage(Sched_Usage *usage);
+Void Sched_usageSince(const Sched_Usage *start, Sched_Usage *delta);
+UInt32 Sched_cpuMask(Void);
+Int Sched_priority(Void);
+Bool Sched_locked(Void);
+Void Sched_report(Void);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Sched__include */
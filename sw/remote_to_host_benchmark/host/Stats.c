@@ -0,0 +1,297 @@
+/*
+ *  ======== Stats.c ========
+ *  Throughput and message interval statistics for the host benchmark
+ *  loop.
+ *
+ *  A loop runs from Stats_loopBegin() to Stats_loopEnd(). Every message
+ *  received in between is recorded by Stats_message() along with its
+ *  interval: the time since the previous message of the loop, or since
+ *  the loop began for the first one. This is the inter-arrival time, not
+ *  a latency, see Latency.c for that. All times come from
+ *  CLOCK_MONOTONIC.
+ *
+ *  The first warmupLoops loops are printed but left out of the summary.
+ */
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <time.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+
+/* local header files */
+#include "Stats.h"
+
+#define Stats_MB (1024.0 * 1024.0)
+
+typedef struct Stats_Object {
+    char        prefix[32];     /* "name " or empty */
+    UInt32      warmupLoops;
+    UInt32      maxSamples;
+    UInt32      loop;           /* index of the current loop */
+
+    /* current loop */
+    UInt64      loopStart;
+    UInt64      lastMark;
+    UInt64      loopBytes;
+    UInt32      loopMsgs;
+
+    /* measured loops */
+    UInt32      loops;
+    UInt64      bytes;
+    UInt64      messages;
+    UInt64      totalNs;
+    UInt64      minLoopNs;
+    UInt64      maxLoopNs;
+
+    /* message intervals of the measured loops, in ns */
+    UInt64 *    samples;
+    UInt32      numSamples;
+    UInt32      droppedSamples;
+} Stats_Object;
+
+
+/*
+ *  ======== Stats_Params_init ========
+ */
+Void Stats_Params_init(Stats_Params *params)
+{
+    params->name = NULL;
+    params->warmupLoops = 0;
+    params->maxSamples = 0x10000;
+}
+
+/*
+ *  ======== Stats_create ========
+ */
+Stats_Handle Stats_create(const Stats_Params *params)
+{
+    Stats_Object *obj;
+
+    obj = (Stats_Object *)calloc(1, sizeof(Stats_Object));
+    if (obj == NULL) {
+        printf("Stats_create: failed to allocate object\n");
+        return NULL;
+    }
+
+    if (params->name != NULL) {
+        snprintf(obj->prefix, sizeof(obj->prefix), "%s ", params->name);
+    }
+    obj->warmupLoops = params->warmupLoops;
+    obj->maxSamples = params->maxSamples;
+    obj->minLoopNs = ~0ULL;
+
+    if (obj->maxSamples > 0) {
+        obj->samples = (UInt64 *)malloc(obj->maxSamples * sizeof(UInt64));
+        if (obj->samples == NULL) {
+            printf("Stats_create: failed to allocate %u samples\n",
+                obj->maxSamples);
+            free(obj);
+            return NULL;
+        }
+    }
+
+    return obj;
+}
+
+/*
+ *  ======== Stats_delete ========
+ */
+Void Stats_delete(Stats_Handle *handle)
+{
+    Stats_Object *obj = *handle;
+
+    if (obj != NULL) {
+        free(obj->samples);
+        free(obj);
+        *handle = NULL;
+    }
+}
+
+/*
+ *  ======== Stats_now ========
+ *  Monotonic time in nanoseconds.
+ */
+UInt64 Stats_now(Void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UInt64)ts.tv_sec * 1000000000ULL + (UInt64)ts.tv_nsec);
+}
+
+/*
+ *  ======== Stats_loopBegin ========
+ */
+Void Stats_loopBegin(Stats_Handle handle)
+{
+    handle->loopBytes = 0;
+    handle->loopMsgs = 0;
+    handle->loopStart = Stats_now();
+    handle->lastMark = handle->loopStart;
+}
+
+/*
+ *  ======== Stats_message ========
+ */
+Void Stats_message(Stats_Handle handle, UInt32 bytes)
+{
+    UInt64 now = Stats_now();
+
+    handle->loopBytes += bytes;
+    handle->loopMsgs++;
+
+    if (handle->loop >= handle->warmupLoops) {
+        if (handle->numSamples < handle->maxSamples) {
+            handle->samples[handle->numSamples++] = now - handle->lastMark;
+        }
+        else {
+            handle->droppedSamples++;
+        }
+    }
+    handle->lastMark = now;
+}
+
+/*
+ *  ======== Stats_add ========
+ *  Count data moved in the loop without taking an interval sample, e.g.
+ *  the totals of several cores.
+ */
+Void Stats_add(Stats_Handle handle, UInt64 bytes, UInt32 msgs)
+{
+    handle->loopBytes += bytes;
+    handle->loopMsgs += msgs;
+}
+
+/*
+ *  ======== Stats_loopEnd ========
+ */
+Void Stats_loopEnd(Stats_Handle handle)
+{
+    Stats_loopEndAt(handle, Stats_now());
+}
+
+/*
+ *  ======== Stats_loopEndAt ========
+ *  End the loop at a time taken earlier, e.g. by another thread.
+ */
+Void Stats_loopEndAt(Stats_Handle handle, UInt64 end)
+{
+    UInt64  ns = end - handle->loopStart;
+    Bool    warmup = (handle->loop < handle->warmupLoops);
+    double  sec = (double)ns / 1e9;
+
+    printf("%sLoop %u%s: %llu bytes, %u msgs, %.3f ms, %.2f MB/s, %.0f msg/s\n",
+        handle->prefix, handle->loop, warmup ? " (warm-up)" : "",
+        (unsigned long long)handle->loopBytes, handle->loopMsgs,
+        (double)ns / 1e6,
+        sec > 0 ? (double)handle->loopBytes / sec / Stats_MB : 0.0,
+        sec > 0 ? (double)handle->loopMsgs / sec : 0.0);
+
+    if (!warmup) {
+        handle->loops++;
+        handle->bytes += handle->loopBytes;
+        handle->messages += handle->loopMsgs;
+        handle->totalNs += ns;
+        handle->minLoopNs = ns < handle->minLoopNs ? ns : handle->minLoopNs;
+        handle->maxLoopNs = ns > handle->maxLoopNs ? ns : handle->maxLoopNs;
+    }
+    handle->loop++;
+}
+
+/*
+ *  ======== Stats_compare ========
+ */
+static int Stats_compare(const void *a, const void *b)
+{
+    UInt64 x = *(const UInt64 *)a;
+    UInt64 y = *(const UInt64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ *  ======== Stats_percentile ========
+ *  Nearest rank percentile of the sorted samples, in us.
+ */
+static double Stats_percentile(Stats_Handle handle, double pct)
+{
+    UInt32 rank;
+
+    if (handle->numSamples == 0) {
+        return 0.0;
+    }
+    rank = (UInt32)(pct / 100.0 * handle->numSamples + 0.999999);
+    rank = rank < 1 ? 1 : rank;
+    rank = rank > handle->numSamples ? handle->numSamples : rank;
+
+    return (double)handle->samples[rank - 1] / 1e3;
+}
+
+/*
+ *  ======== Stats_report ========
+ *  Summarize the measured loops and print the report.
+ */
+Void Stats_report(Stats_Handle handle, Stats_Summary *summary)
+{
+    double sec = (double)handle->totalNs / 1e9;
+
+    memset(summary, 0, sizeof(*summary));
+
+    qsort(handle->samples, handle->numSamples, sizeof(UInt64),
+        Stats_compare);
+
+    summary->loops = handle->loops;
+    summary->bytes = handle->bytes;
+    summary->messages = handle->messages;
+
+    if (handle->loops > 0) {
+        summary->totalMs = (double)handle->totalNs / 1e6;
+        summary->minLoopMs = (double)handle->minLoopNs / 1e6;
+        summary->avgLoopMs = summary->totalMs / handle->loops;
+        summary->maxLoopMs = (double)handle->maxLoopNs / 1e6;
+    }
+    if (sec > 0) {
+        summary->mbps = (double)handle->bytes / sec / Stats_MB;
+        summary->msgPerSec = (double)handle->messages / sec;
+    }
+    if (handle->messages > 0) {
+        summary->avgMsgUs = (double)handle->totalNs / 1e3 / handle->messages;
+    }
+    if (handle->numSamples > 0) {
+        summary->minUs = (double)handle->samples[0] / 1e3;
+        summary->p50Us = Stats_percentile(handle, 50.0);
+        summary->p90Us = Stats_percentile(handle, 90.0);
+        summary->p99Us = Stats_percentile(handle, 99.0);
+        summary->p999Us = Stats_percentile(handle, 99.9);
+        summary->maxUs = (double)handle->samples[handle->numSamples - 1] / 1e3;
+    }
+
+    printf("%sStatistics:\n", handle->prefix);
+    printf("    loops measured    : %u (%u warm-up discarded)\n",
+        summary->loops, handle->loop - handle->loops);
+    printf("    bytes             : %llu\n",
+        (unsigned long long)summary->bytes);
+    printf("    messages          : %llu\n",
+        (unsigned long long)summary->messages);
+    printf("    loop time (ms)    : min %.3f, avg %.3f, max %.3f, total %.3f\n",
+        summary->minLoopMs, summary->avgLoopMs, summary->maxLoopMs,
+        summary->totalMs);
+    printf("    throughput        : %.2f MB/s, %.0f msg/s\n",
+        summary->mbps, summary->msgPerSec);
+    printf("    time per msg (us) : %.3f\n", summary->avgMsgUs);
+    if (handle->numSamples > 0) {
+        printf("    msg interval (us) : min %.3f, p50 %.3f, p90 %.3f, "
+            "p99 %.3f, p99.9 %.3f, max %.3f\n",
+            summary->minUs, summary->p50Us, summary->p90Us, summary->p99Us,
+            summary->p999Us, summary->maxUs);
+    }
+    if (handle->droppedSamples > 0) {
+        printf("    interval samples  : %u kept, %u dropped\n",
+            handle->numSamples, handle->droppedSamples);
+    }
+}
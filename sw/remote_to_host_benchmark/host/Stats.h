@@ -0,0 +1,57 @@
+/*
+ *  ======== Stats.h ========
+ *  Throughput and message interval statistics for the host benchmark
+ *  loop.
+ */
+
+#ifndef Stats__include
+#define Stats__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct Stats_Object *Stats_Handle;
+
+typedef struct {
+    String  name;           /* printed with every line, may be NULL */
+    UInt32  warmupLoops;    /* leading loops reported but not accumulated */
+    UInt32  maxSamples;     /* per message samples kept for percentiles */
+} Stats_Params;
+
+/* result of all measured (non warm-up) loops */
+typedef struct {
+    UInt32  loops;
+    UInt64  bytes;
+    UInt64  messages;
+    double  totalMs;
+    double  minLoopMs;
+    double  avgLoopMs;
+    double  maxLoopMs;
+    double  mbps;           /* cumulative bytes over cumulative time */
+    double  msgPerSec;
+    double  avgMsgUs;       /* mean time per message */
+    double  minUs;          /* message interval percentiles */
+    double  p50Us;
+    double  p90Us;
+    double  p99Us;
+    double  p999Us;
+    double  maxUs;
+} Stats_Summary;
+
+Void Stats_Params_init(Stats_Params *params);
+Stats_Handle Stats_create(const Stats_Params *params);
+Void Stats_delete(Stats_Handle *handle);
+
+UInt64 Stats_now(Void);
+Void Stats_loopBegin(Stats_Handle handle);
+Void Stats_message(Stats_Handle handle, UInt32 bytes);
+Void Stats_add(Stats_Handle handle, UInt64 bytes, UInt32 msgs);
+Void Stats_loopEnd(Stats_Handle handle);
+Void Stats_loopEndAt(Stats_Handle handle, UInt64 end);
+Void Stats_report(Stats_Handle handle, Stats_Summary *summary);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Stats__include */
@@ -0,0 +1,522 @@
+/*
+ *  ======== Trace.c ========
+ *  Host side of the trace rings, and the host's own events.
+ *
+ *  Every event, the host's and the drained DSP ones, takes the next
+ *  entry of one array, claimed with an atomic add so the hot path never
+ *  locks; once the array is full events are counted and lost. A host
+ *  thread is named on its first event of the trace from the name
+ *  Sched_thread gave it. Only the drain thread reads the rings while the
+ *  trace runs, and it hands the slots back by writing the ring's read
+ *  count, the DSP's only input from the host.
+ */
+
+/* pthread_getname_np is a GNU extension */
+#define _GNU_SOURCE
+
+/* host header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/cmem.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "Latency.h"
+#include "Trace.h"
+
+/* host threads told apart in one trace */
+#define Trace_MAX_THREADS   32
+
+/* one recorded event */
+typedef struct {
+    UInt64              time;       // host ns, DSP ticks until Trace_stop
+    UInt32              id;         // App_TRACE_xxx
+    UInt32              arg0;
+    UInt32              arg1;
+    UInt32              seq;        // recording order, breaks time ties
+    UInt16              pid;        // 0 host, else 1 + core
+    UInt16              tid;        // host thread, 1 + index
+} Trace_Entry;
+
+/* how an event is shown */
+typedef struct {
+    String              name;
+    char                phase;      // 'B', 'E' or 'i'
+    String              arg0;       // NULL not shown
+    String              arg1;
+    Bool                hex0;       // arg0 is a command
+} Trace_Kind;
+
+typedef struct Trace_Object {
+    Trace_Params        params;
+    UInt32              serial;     // tells the threads a new trace began
+    Trace_Entry *       entries;
+    UInt32              numEntries; // claimed, may run past maxEvents
+    UInt32              lost;       // past maxEvents
+    UInt32              read[Trace_MAX_CORES];
+    UInt32              drained[Trace_MAX_CORES];
+    UInt32              dropped[Trace_MAX_CORES];
+    UInt32              unplaced;   // DSP events without a clock
+    pthread_mutex_t     lock;       // threads below
+    char                threads[Trace_MAX_THREADS][16];
+    UInt32              numThreads;
+    pthread_t           drainer;
+    volatile Bool       draining;
+    Bool                drainerUp;
+} Trace_Object;
+
+/* module structure */
+typedef struct {
+    Trace_Object * volatile active; // receives Trace_event, NULL none
+    UInt32              serial;
+} Trace_Module;
+
+/* private data */
+static Trace_Module Module;
+static __thread UInt32 Trace_threadSerial;
+static __thread UInt16 Trace_threadTid;
+
+static const Trace_Kind Trace_kinds[App_TRACE_MAX_ID] = {
+    [App_TRACE_GET]             = { "get", 'i', "cmd", NULL, TRUE },
+    [App_TRACE_FILL_BEGIN]      = { "fill", 'B', "seq", "bytes", FALSE },
+    [App_TRACE_FILL_END]        = { "fill", 'E', "seq", "bytes", FALSE },
+    [App_TRACE_PUT]             = { "put", 'i', "seq", "credits", FALSE },
+    [App_TRACE_STALL]           = { "stall", 'i', "seq", NULL, FALSE },
+    [App_TRACE_CONSUME_BEGIN]   = { "consume", 'B', "seq", "bytes", FALSE },
+    [App_TRACE_CONSUME_END]     = { "consume", 'E', "seq", "bytes", FALSE },
+    [App_TRACE_JOB_BEGIN]       = { "job", 'B', "job", "work", FALSE },
+    [App_TRACE_JOB_END]         = { "job", 'E', "job", "work", FALSE },
+    [App_TRACE_RPC_BEGIN]       = { "rpc", 'B', "call", NULL, FALSE },
+    [App_TRACE_RPC_END]         = { "rpc", 'E', "call", NULL, FALSE },
+    [App_TRACE_SEND]            = { "send", 'i', "cmd", "core", TRUE },
+    [App_TRACE_RECV]            = { "recv", 'i', "cmd", "core", TRUE },
+    [App_TRACE_VERIFY_BEGIN]    = { "verify", 'B', "seq", "core", FALSE },
+    [App_TRACE_VERIFY_END]      = { "verify", 'E', "seq", "core", FALSE },
+    [App_TRACE_RETURN]          = { "return", 'i', "seq", "core", FALSE },
+};
+
+/* private functions */
+static void *Trace_drainThread(void *arg);
+static Void Trace_drain(Trace_Object *obj, UInt32 core);
+
+
+/*
+ *  ======== Trace_Params_init ========
+ */
+Void Trace_Params_init(Trace_Params *params)
+{
+    memset(params, 0, sizeof(Trace_Params));
+    params->armCached = TRUE;
+    params->maxEvents = 1 << 20;
+    params->drainUs = 1000;
+}
+
+/*
+ *  ======== Trace_create ========
+ *  Clear the rings, start draining them and take the host's events.
+ */
+Trace_Handle Trace_create(const Trace_Params *params)
+{
+    Trace_Object *obj;
+    App_TraceRing *ring;
+    UInt32 i;
+
+    if (params->numCores > Trace_MAX_CORES || params->maxEvents == 0 ||
+            params->maxEvents >= 0x80000000) {
+        printf("Trace_create: bad parameters\n");
+        return (NULL);
+    }
+
+    obj = (Trace_Object *)calloc(1, sizeof(Trace_Object));
+    if (obj == NULL) {
+        return (NULL);
+    }
+    obj->params = *params;
+    obj->serial = ++Module.serial;
+    pthread_mutex_init(&obj->lock, NULL);
+
+    obj->entries = (Trace_Entry *)malloc(params->maxEvents *
+        sizeof(Trace_Entry));
+    if (obj->entries == NULL) {
+        printf("Trace_create: failed to allocate %u events\n",
+            params->maxEvents);
+        goto fail;
+    }
+
+    for (i = 0; i < params->numCores; i++) {
+        ring = params->rings[i];
+        ring->write = 0;
+        ring->dropped = 0;
+        ring->read = 0;
+        if (params->armCached) {
+            CMEM_cacheWb(ring, (char *)&ring->events[0] - (char *)ring);
+        }
+    }
+
+    obj->draining = TRUE;
+    if (pthread_create(&obj->drainer, NULL, Trace_drainThread, obj) != 0) {
+        printf("Trace_create: failed to start the drain thread\n");
+        goto fail;
+    }
+    obj->drainerUp = TRUE;
+    Module.active = obj;
+
+    return (obj);
+
+fail:
+    Trace_delete(&obj);
+    return (NULL);
+}
+
+/*
+ *  ======== Trace_delete ========
+ */
+Void Trace_delete(Trace_Handle *handle)
+{
+    Trace_Object *obj = *handle;
+
+    if (obj == NULL) {
+        return;
+    }
+
+    if (Module.active == obj) {
+        Module.active = NULL;
+    }
+    if (obj->drainerUp) {
+        obj->draining = FALSE;
+        pthread_join(obj->drainer, NULL);
+    }
+    pthread_mutex_destroy(&obj->lock);
+    free(obj->entries);
+    free(obj);
+    *handle = NULL;
+}
+
+/*
+ *  ======== Trace_add ========
+ *  Take the next entry, or count the event lost.
+ */
+static Void Trace_add(Trace_Object *obj, UInt64 time, UInt32 id,
+        UInt32 arg0, UInt32 arg1, UInt16 pid, UInt16 tid)
+{
+    Trace_Entry *e;
+    UInt32 n;
+
+    n = __sync_fetch_and_add(&obj->numEntries, 1);
+    if (n >= obj->params.maxEvents) {
+        __sync_fetch_and_add(&obj->lost, 1);
+        return;
+    }
+
+    e = &obj->entries[n];
+    e->time = time;
+    e->id = id;
+    e->arg0 = arg0;
+    e->arg1 = arg1;
+    e->seq = n;
+    e->pid = pid;
+    e->tid = tid;
+}
+
+/*
+ *  ======== Trace_threadAdd ========
+ *  First event of the calling thread in this trace, look up its name.
+ */
+static Void Trace_threadAdd(Trace_Object *obj)
+{
+    char name[16];
+    UInt32 i;
+
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) != 0) {
+        snprintf(name, sizeof(name), "thread");
+    }
+
+    pthread_mutex_lock(&obj->lock);
+    for (i = 0; i < obj->numThreads; i++) {
+        if (strcmp(obj->threads[i], name) == 0) {
+            break;
+        }
+    }
+    if (i == obj->numThreads && i < Trace_MAX_THREADS) {
+        snprintf(obj->threads[i], sizeof(obj->threads[i]), "%s", name);
+        obj->numThreads++;
+    }
+    pthread_mutex_unlock(&obj->lock);
+
+    /* threads past the table share its last line */
+    Trace_threadTid = (i < Trace_MAX_THREADS ? i : Trace_MAX_THREADS - 1) + 1;
+    Trace_threadSerial = obj->serial;
+}
+
+/*
+ *  ======== Trace_event ========
+ *  An event of the calling host thread, nothing without a trace.
+ */
+Void Trace_event(UInt32 id, UInt32 arg0, UInt32 arg1)
+{
+    Trace_Object *obj = Module.active;
+
+    if (obj == NULL) {
+        return;
+    }
+    if (Trace_threadSerial != obj->serial) {
+        Trace_threadAdd(obj);
+    }
+    Trace_add(obj, Latency_now(), id, arg0, arg1, 0, Trace_threadTid);
+}
+
+/*
+ *  ======== Trace_drain ========
+ *  Copy what the core wrote since the last drain and hand the slots
+ *  back to it.
+ */
+static Void Trace_drain(Trace_Object *obj, UInt32 core)
+{
+    App_TraceRing *ring = obj->params.rings[core];
+    App_TraceEvent *ev;
+    UInt32 read = obj->read[core];
+    UInt32 write;
+    UInt32 from, n;
+
+    if (obj->params.armCached) {
+        CMEM_cacheInv((void *)&ring->write, sizeof(UInt32));
+    }
+    write = ring->write;
+    if (write == read) {
+        return;
+    }
+    __sync_synchronize();
+
+    if (obj->params.armCached) {
+        /* the events may wrap past the end of the ring */
+        from = read & (App_TRACE_RING_SIZE - 1);
+        n = write - read;
+        if (from + n > App_TRACE_RING_SIZE) {
+            CMEM_cacheInv(&ring->events[0],
+                (from + n - App_TRACE_RING_SIZE) * sizeof(App_TraceEvent));
+            n = App_TRACE_RING_SIZE - from;
+        }
+        CMEM_cacheInv(&ring->events[from], n * sizeof(App_TraceEvent));
+    }
+
+    for (; read != write; read++) {
+        ev = &ring->events[read & (App_TRACE_RING_SIZE - 1)];
+        Trace_add(obj, ((UInt64)ev->stampHi << 32) | ev->stampLo, ev->id,
+            ev->arg0, ev->arg1, (UInt16)(core + 1), 1);
+        obj->drained[core]++;
+    }
+
+    /* the slots are copied, the DSP may write them again */
+    __sync_synchronize();
+    ring->read = write;
+    if (obj->params.armCached) {
+        CMEM_cacheWb((void *)&ring->read, sizeof(UInt32));
+    }
+    obj->read[core] = write;
+}
+
+/*
+ *  ======== Trace_drainThread ========
+ */
+static void *Trace_drainThread(void *arg)
+{
+    Trace_Object *obj = (Trace_Object *)arg;
+    UInt32 i;
+
+    while (obj->draining) {
+        for (i = 0; i < obj->params.numCores; i++) {
+            Trace_drain(obj, i);
+        }
+        usleep(obj->params.drainUs);
+    }
+
+    return NULL;
+}
+
+/*
+ *  ======== Trace_stop ========
+ *  Take no more host events and drain the rings a last time, the DSPs
+ *  must have stopped writing. Every DSP event is then put on the host
+ *  clock with its core's entry of clocks, synced before and after the
+ *  run; events of a core without a clock are left out.
+ */
+Void Trace_stop(Trace_Handle handle, const Latency_Handle *clocks)
+{
+    Trace_Object *obj = handle;
+    App_TraceRing *ring;
+    Latency_Handle clock;
+    Trace_Entry *e;
+    UInt32 n, i;
+
+    if (Module.active == obj) {
+        Module.active = NULL;
+    }
+    if (obj->drainerUp) {
+        obj->draining = FALSE;
+        pthread_join(obj->drainer, NULL);
+        obj->drainerUp = FALSE;
+    }
+
+    for (i = 0; i < obj->params.numCores; i++) {
+        Trace_drain(obj, i);
+        ring = obj->params.rings[i];
+        if (obj->params.armCached) {
+            CMEM_cacheInv((void *)&ring->dropped, sizeof(UInt32));
+        }
+        obj->dropped[i] = ring->dropped;
+    }
+
+    n = obj->numEntries < obj->params.maxEvents ? obj->numEntries :
+        obj->params.maxEvents;
+    for (i = 0; i < n; i++) {
+        e = &obj->entries[i];
+        if (e->pid == 0) {
+            continue;
+        }
+        clock = (clocks != NULL) ? clocks[e->pid - 1] : NULL;
+        e->time = (clock != NULL) ? Latency_toHostNs(clock, e->time) : 0;
+        if (e->time == 0) {
+            obj->unplaced++;
+        }
+    }
+}
+
+/*
+ *  ======== Trace_compare ========
+ */
+static int Trace_compare(const void *a, const void *b)
+{
+    const Trace_Entry *x = (const Trace_Entry *)a;
+    const Trace_Entry *y = (const Trace_Entry *)b;
+
+    if (x->time != y->time) {
+        return (x->time > y->time) ? 1 : -1;
+    }
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+/*
+ *  ======== Trace_writeArgs ========
+ */
+static Void Trace_writeArgs(FILE *file, const Trace_Kind *kind,
+        const Trace_Entry *e)
+{
+    if (kind->arg0 == NULL) {
+        return;
+    }
+    if (kind->hex0) {
+        fprintf(file, ",\"args\":{\"%s\":\"0x%x\"", kind->arg0, e->arg0);
+    }
+    else {
+        fprintf(file, ",\"args\":{\"%s\":%u", kind->arg0, e->arg0);
+    }
+    if (kind->arg1 != NULL) {
+        fprintf(file, ",\"%s\":%u", kind->arg1, e->arg1);
+    }
+    fprintf(file, "}");
+}
+
+/*
+ *  ======== Trace_write ========
+ *  Sort the events of a stopped trace by time and write them as a
+ *  Chrome trace, the host as process 0 and each core as 1 + its index;
+ *  times are in microseconds from the first event.
+ */
+Int Trace_write(Trace_Handle handle, String fileName)
+{
+    Trace_Object *obj = handle;
+    const Trace_Kind *kind;
+    Trace_Kind unknown;
+    char unknownName[16];
+    UInt32 hostEvents = 0;
+    UInt32 dspEvents = 0;
+    UInt32 dropped = 0;
+    Trace_Entry *e;
+    UInt64 t0 = 0;
+    FILE *file;
+    UInt32 n, i;
+
+    n = obj->numEntries < obj->params.maxEvents ? obj->numEntries :
+        obj->params.maxEvents;
+    qsort(obj->entries, n, sizeof(Trace_Entry), Trace_compare);
+
+    file = fopen(fileName, "w");
+    if (file == NULL) {
+        printf("Trace_write: cannot open %s\n", fileName);
+        return (-1);
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+        "\"args\":{\"name\":\"host\"}}");
+    for (i = 0; i < obj->numThreads; i++) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+            "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", i + 1, obj->threads[i]);
+    }
+    for (i = 0; i < obj->params.numCores; i++) {
+        fprintf(file, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}", i + 1, obj->params.names[i]);
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,"
+            "\"tid\":1,\"args\":{\"name\":\"server\"}}", i + 1);
+    }
+
+    for (i = 0; i < n; i++) {
+        e = &obj->entries[i];
+        if (e->time == 0) {
+            continue;
+        }
+        if (t0 == 0) {
+            t0 = e->time;
+        }
+        if (e->id < App_TRACE_MAX_ID && Trace_kinds[e->id].name != NULL) {
+            kind = &Trace_kinds[e->id];
+        }
+        else {
+            snprintf(unknownName, sizeof(unknownName), "0x%x", e->id);
+            unknown.name = unknownName;
+            unknown.phase = 'i';
+            unknown.arg0 = "arg0";
+            unknown.arg1 = "arg1";
+            unknown.hex0 = FALSE;
+            kind = &unknown;
+        }
+
+        fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+            "\"ts\":%.3f,\"pid\":%u,\"tid\":%u", kind->name,
+            e->pid == 0 ? "host" : obj->params.names[e->pid - 1],
+            kind->phase, (e->time - t0) / 1e3, e->pid, e->tid);
+        if (kind->phase == 'i') {
+            fprintf(file, ",\"s\":\"t\"");
+        }
+        Trace_writeArgs(file, kind, e);
+        fprintf(file, "}");
+
+        if (e->pid == 0) {
+            hostEvents++;
+        }
+        else {
+            dspEvents++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    for (i = 0; i < obj->params.numCores; i++) {
+        printf("Trace %s: %u events drained, %u lost to a full ring\n",
+            obj->params.names[i], obj->drained[i], obj->dropped[i]);
+        dropped += obj->dropped[i];
+    }
+    printf("Trace: %u host and %u DSP events written to %s, %u lost on "
+        "the DSPs, %u past the host's %u, %u without a clock sync\n",
+        hostEvents, dspEvents, fileName, dropped, obj->lost,
+        obj->params.maxEvents, obj->unplaced);
+
+    return (0);
+}
@@ -0,0 +1,49 @@
+/*
+ *  ======== Trace.h ========
+ *  Host side of the trace rings: drains the binary events every DSP
+ *  writes to its App_TraceRing in CMEM, records the host's own, and
+ *  writes both on one timeline as a Chrome trace (JSON), which
+ *  chrome://tracing and Perfetto open.
+ *
+ *  Trace_create clears the rings and starts a thread that drains them
+ *  while the run goes on, so a ring only has to hold what the DSP writes
+ *  between two drains. From then until Trace_stop, Trace_event records
+ *  an event of the calling thread. DSP events carry the DSP's
+ *  Timestamp and are put on the host clock at Trace_stop, with the
+ *  clock fitted by a Latency handle per core.
+ *
+ *  Include after AppCommon.h and Latency.h.
+ */
+
+#ifndef Trace__include
+#define Trace__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Trace_MAX_CORES     4
+
+typedef struct Trace_Object *Trace_Handle;
+
+typedef struct {
+    UInt32          numCores;
+    String          names[Trace_MAX_CORES];
+    App_TraceRing * rings[Trace_MAX_CORES]; /* host mapping of each */
+    Bool            armCached;      /* rings mapped cached, CMEM_cacheInv */
+    UInt32          maxEvents;      /* host and DSP events kept */
+    UInt32          drainUs;        /* period of the drain thread */
+} Trace_Params;
+
+Void Trace_Params_init(Trace_Params *params);
+Trace_Handle Trace_create(const Trace_Params *params);
+Void Trace_delete(Trace_Handle *handle);
+
+Void Trace_event(UInt32 id, UInt32 arg0, UInt32 arg1);
+Void Trace_stop(Trace_Handle handle, const Latency_Handle *clocks);
+Int Trace_write(Trace_Handle handle, String fileName);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Trace__include */
@@ -0,0 +1,306 @@
+/*
+ *  ======== Verify.c ========
+ *  Host check of the ramp the DSP writes into every buffer, and the fill
+ *  of the host's own buffers with the same ramp.
+ *
+ *  Element i of buffer seq holds the low bits of i + seq, in elements of
+ *  App_ELEM_8 to App_ELEM_64 bytes; Verify_KERNELS instantiates the fill
+ *  and check for each width. A buffer is checked one cache line at a
+ *  time: the differences of a whole line are OR'ed together without a
+ *  branch, which the compiler vectorizes on NEON (the 64 bit line has
+ *  hand written NEON as ARMv7 lacks a 64 bit compare), and only a line
+ *  that comes out non-zero is walked again to count its bad elements. A
+ *  line stride above one samples every lineStride'th line instead of
+ *  reading the whole buffer, so the checker costs less than the transfer
+ *  it is checking.
+ */
+
+/* host header files */
+#include <stdio.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+/* package header files */
+#include <ti/ipc/Std.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/cmem.h>
+
+/* local header files */
+#include "../shared/AppCommon.h"
+#include "Stats.h"
+#include "Verify.h"
+
+#define Verify_MB           (1024.0 * 1024.0)
+
+/*
+ *  ======== Verify_LINE ========
+ *  Check one full line of type T elements starting at element first.
+ */
+#define Verify_LINE(T, bits)                                                \
+static inline Bool Verify_lineOk##bits(const T *p, T first)                 \
+{                                                                           \
+    T acc = 0;                                                              \
+    UInt32 i;                                                               \
+                                                                            \
+    /* no early exit so the compiler can vectorize it */                   \
+    for (i = 0; i < Verify_LINE_SIZE / sizeof(T); i++) {                    \
+        acc |= p[i] ^ (T)(first + i);                                       \
+    }                                                                       \
+    return acc == 0;                                                        \
+}
+
+/*
+ *  ======== Verify_KERNELS ========
+ *  Fill and sampled check for elements of type T.
+ */
+#define Verify_KERNELS(T, bits)                                             \
+static Void Verify_fill##bits(T *p, UInt32 n, UInt32 seq)                   \
+{                                                                           \
+    UInt32 i;                                                               \
+                                                                            \
+    for (i = 0; i < n; i++) {                                               \
+        p[i] = (T)(i + seq);                                                \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static UInt32 Verify_ramp##bits(const T *p, UInt32 n, UInt32 seq,           \
+        UInt32 lineStride, UInt32 *firstBad)                                \
+{                                                                           \
+    const UInt32 perLine = Verify_LINE_SIZE / sizeof(T);                    \
+    UInt32 step = perLine * lineStride;                                     \
+    UInt32 errors = 0;                                                      \
+    UInt32 i, j, end;                                                       \
+                                                                            \
+    for (i = 0; i < n; i += step) {                                         \
+        end = (n - i < perLine) ? n : i + perLine;                          \
+        if (end - i == perLine && Verify_lineOk##bits(p + i, (T)(i + seq))) { \
+            continue;                                                       \
+        }                                                                   \
+                                                                            \
+        /* a short tail or a bad line, count element by element */         \
+        for (j = i; j < end; j++) {                                         \
+            if (p[j] != (T)(j + seq)) {                                     \
+                if (errors++ == 0) {                                        \
+                    *firstBad = j;                                          \
+                }                                                           \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    return errors;                                                          \
+}
+
+Verify_LINE(UInt8, 8)
+Verify_LINE(UInt16, 16)
+Verify_LINE(UInt32, 32)
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+/*
+ *  ======== Verify_lineOk64 ========
+ *  ARMv7 NEON has no 64 bit compare, XOR and OR instead.
+ */
+static inline Bool Verify_lineOk64(const UInt64 *p, UInt64 first)
+{
+    const uint64x2_t step = vdupq_n_u64(2);
+    uint64x2_t expect = vcombine_u64(vcreate_u64(first),
+        vcreate_u64(first + 1));
+    uint64x2_t acc = vdupq_n_u64(0);
+    UInt32 i;
+
+    for (i = 0; i < Verify_LINE_SIZE / sizeof(UInt64); i += 2) {
+        acc = vorrq_u64(acc, veorq_u64(vld1q_u64(p + i), expect));
+        expect = vaddq_u64(expect, step);
+    }
+
+    return (vgetq_lane_u64(acc, 0) | vgetq_lane_u64(acc, 1)) == 0;
+}
+#else
+Verify_LINE(UInt64, 64)
+#endif
+
+Verify_KERNELS(UInt8, 8)
+Verify_KERNELS(UInt16, 16)
+Verify_KERNELS(UInt32, 32)
+Verify_KERNELS(UInt64, 64)
+
+
+/*
+ *  ======== Verify_isValidElemSize ========
+ */
+Bool Verify_isValidElemSize(UInt32 elemSize)
+{
+    return (elemSize == App_ELEM_8 || elemSize == App_ELEM_16 ||
+        elemSize == App_ELEM_32 || elemSize == App_ELEM_64);
+}
+
+/*
+ *  ======== Verify_fill ========
+ *  Write the ramp for buffer seq over len bytes.
+ */
+Void Verify_fill(void *data, UInt32 len, UInt32 elemSize, UInt32 seq)
+{
+    switch (elemSize) {
+        case App_ELEM_8:
+            Verify_fill8((UInt8 *)data, len, seq);
+            break;
+        case App_ELEM_16:
+            Verify_fill16((UInt16 *)data, len / 2, seq);
+            break;
+        case App_ELEM_32:
+            Verify_fill32((UInt32 *)data, len / 4, seq);
+            break;
+        default:
+            Verify_fill64((UInt64 *)data, len / 8, seq);
+            break;
+    }
+}
+
+/*
+ *  ======== Verify_ramp ========
+ *  Check len bytes against the ramp of buffer seq, every lineStride'th
+ *  line only. Returns the bad elements; the index of the first one goes
+ *  to firstBad.
+ */
+UInt32 Verify_ramp(const void *data, UInt32 len, UInt32 elemSize,
+        UInt32 seq, UInt32 lineStride, UInt32 *firstBad)
+{
+    switch (elemSize) {
+        case App_ELEM_8:
+            return Verify_ramp8((const UInt8 *)data, len, seq, lineStride,
+                firstBad);
+        case App_ELEM_16:
+            return Verify_ramp16((const UInt16 *)data, len / 2, seq,
+                lineStride, firstBad);
+        case App_ELEM_32:
+            return Verify_ramp32((const UInt32 *)data, len / 4, seq,
+                lineStride, firstBad);
+        default:
+            return Verify_ramp64((const UInt64 *)data, len / 8, seq,
+                lineStride, firstBad);
+    }
+}
+
+/*
+ *  ======== Verify_element ========
+ */
+static UInt64 Verify_element(const void *data, UInt32 elemSize, UInt32 i)
+{
+    switch (elemSize) {
+        case App_ELEM_8:    return ((const UInt8 *)data)[i];
+        case App_ELEM_16:   return ((const UInt16 *)data)[i];
+        case App_ELEM_32:   return ((const UInt32 *)data)[i];
+        default:            return ((const UInt64 *)data)[i];
+    }
+}
+
+/*
+ *  ======== Verify_buffer ========
+ *  Invalidate and check one received buffer of len bytes, lineStride 0
+ *  skips both. Returns the bad elements and adds the time taken to cost.
+ */
+UInt32 Verify_buffer(void *data, UInt32 len, UInt32 elemSize, UInt32 seq,
+        Bool armCached, UInt32 lineStride, Verify_Cost *cost)
+{
+    UInt32 used = len / elemSize * elemSize;
+    UInt32 lines, sampled, checked;
+    UInt32 errors, bad = 0;
+    UInt64 expect;
+    UInt64 t0, t1, t2;
+
+    cost->buffers++;
+    cost->bytes += len;
+    if (lineStride == 0) {
+        return 0;
+    }
+
+    t0 = Stats_now();
+    if (armCached) {
+        CMEM_cacheInv(data, len);
+    }
+    t1 = Stats_now();
+    errors = Verify_ramp(data, len, elemSize, seq, lineStride, &bad);
+    t2 = Stats_now();
+
+    if (errors > 0) {
+        expect = (UInt64)bad + seq;
+        if (elemSize < App_ELEM_64) {
+            expect &= (1ULL << (8 * elemSize)) - 1;
+        }
+        printf("error: buffer %u element %u: expected: %llu, read: %llu "
+            "(%u bad)\n", seq, bad, (unsigned long long)expect,
+            (unsigned long long)Verify_element(data, elemSize, bad), errors);
+    }
+
+    /* the last line may be short, it is only read when sampled */
+    lines = (used + Verify_LINE_SIZE - 1) / Verify_LINE_SIZE;
+    sampled = (lines + lineStride - 1) / lineStride;
+    checked = sampled * Verify_LINE_SIZE;
+    if (lines > 0 && (lines - 1) % lineStride == 0) {
+        checked -= lines * Verify_LINE_SIZE - used;
+    }
+
+    cost->invNs += t1 - t0;
+    cost->checkNs += t2 - t1;
+    cost->bytesChecked += checked;
+    cost->errors += errors;
+
+    return errors;
+}
+
+/*
+ *  ======== Verify_add ========
+ */
+Void Verify_add(Verify_Cost *total, const Verify_Cost *cost)
+{
+    total->invNs += cost->invNs;
+    total->checkNs += cost->checkNs;
+    total->buffers += cost->buffers;
+    total->bytes += cost->bytes;
+    total->bytesChecked += cost->bytesChecked;
+    total->errors += cost->errors;
+}
+
+/*
+ *  ======== Verify_report ========
+ *  totalMs is the measured loop time; onPath tells whether the checks
+ *  ran on the receive path or on pipeline workers alongside it.
+ */
+Void Verify_report(String name, UInt32 lineStride, const Verify_Cost *cost,
+        double totalMs, Bool onPath)
+{
+    double buffers = cost->buffers > 0 ? (double)cost->buffers : 1.0;
+    double verifyMs = (double)(cost->invNs + cost->checkNs) / 1e6;
+    double leftMs = totalMs - verifyMs;
+
+    if (lineStride == 0) {
+        printf("%s Verify: off\n", name);
+        return;
+    }
+    if (lineStride == 1) {
+        printf("%s Verify: every cache line\n", name);
+    }
+    else {
+        printf("%s Verify: 1 in %u cache lines\n", name, lineStride);
+    }
+
+    printf("    checked           : %llu of %llu bytes (%.1f%%)\n",
+        (unsigned long long)cost->bytesChecked,
+        (unsigned long long)cost->bytes, cost->bytes > 0 ?
+        cost->bytesChecked * 100.0 / cost->bytes : 0.0);
+    printf("    invalidate (us)   : %.3f total, %.3f per buffer\n",
+        cost->invNs / 1e3, cost->invNs / 1e3 / buffers);
+    printf("    check (us)        : %.3f total, %.3f per buffer, %.2f MB/s\n",
+        cost->checkNs / 1e3, cost->checkNs / 1e3 / buffers,
+        cost->checkNs > 0 ?
+        cost->bytesChecked / (cost->checkNs / 1e9) / Verify_MB : 0.0);
+    if (onPath) {
+        printf("    receive path      : %.1f%% of loop time, %.2f MB/s "
+            "without it\n", totalMs > 0 ? verifyMs * 100.0 / totalMs : 0.0,
+            leftMs > 0 ? cost->bytes / (leftMs / 1e3) / Verify_MB : 0.0);
+    }
+    else {
+        printf("    worker time       : %.1f%% of loop time, off the "
+            "receive path\n", totalMs > 0 ? verifyMs * 100.0 / totalMs : 0.0);
+    }
+}
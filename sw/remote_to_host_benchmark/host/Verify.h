@@ -0,0 +1,40 @@
+/*
+ *  ======== Verify.h ========
+ *  Host check of the ramp the DSP writes into every buffer, and the fill
+ *  of the host's own buffers with the same ramp.
+ */
+
+#ifndef Verify__include
+#define Verify__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* Cortex-A15 L1/L2 line */
+#define Verify_LINE_SIZE    64
+
+/* time spent checking buffers, kept per thread */
+typedef struct {
+    UInt64  invNs;          /* CMEM_cacheInv */
+    UInt64  checkNs;        /* reading and comparing */
+    UInt64  buffers;
+    UInt64  bytes;          /* payload bytes of the buffers */
+    UInt64  bytesChecked;   /* of which read and compared */
+    UInt32  errors;
+} Verify_Cost;
+
+Bool Verify_isValidElemSize(UInt32 elemSize);
+Void Verify_fill(void *data, UInt32 len, UInt32 elemSize, UInt32 seq);
+UInt32 Verify_ramp(const void *data, UInt32 len, UInt32 elemSize,
+        UInt32 seq, UInt32 lineStride, UInt32 *firstBad);
+UInt32 Verify_buffer(void *data, UInt32 len, UInt32 elemSize, UInt32 seq,
+        Bool armCached, UInt32 lineStride, Verify_Cost *cost);
+Void Verify_add(Verify_Cost *total, const Verify_Cost *cost);
+Void Verify_report(String name, UInt32 lineStride, const Verify_Cost *cost,
+        double totalMs, Bool onPath);
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Verify__include */
@@ -38,6 +38,7 @@
 /* cstdlib header files */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 /* package header files */
@@ -49,18 +50,32 @@
 
 /* local header files */
 #include "App.h"
+#include "Verify.h"
+#include "Sched.h"
+#include "Load.h"
 
 /* private functions */
 static Int Main_main(Void);
 static Int Main_parseArgs(Int argc, Char *argv[]);
+static Int Main_execLoads(Void);
+static Void Main_printLoadCurve(Void);
+static Int Main_execJobs(Void);
+static Void Main_printJobs(Void);
+
+/* background load intensities one run can step through */
+#define Main_MAX_LEVELS 8
+
+/* job sizes one run can step through */
+#define Main_MAX_WORKS 8
 
 
 #define Main_USAGE "\
 Usage:\n\
-    app_host [options] procName\n\
+    app_host [options] procName [procName...]\n\
 \n\
 Arguments:\n\
-    procName      : the name of the remote processor\n\
+    procName      : the name of a remote processor, every one named runs\n\
+                    at once on its own part of the CMEM pool\n\
 \n\
 Options:\n\
     h   : print this help message\n\
@@ -68,18 +83,127 @@ Options:\n\
     i [interations]   : set the number of times the transfers loop for\n\
     p [payload]   : set the payload size\n\
     b [batches]   : set the number of batches of messages the DSP sends per loop\n\
+    f [flow]      : d2h: the DSP fills buffers and the host verifies them,\n\
+                    h2d: the host fills buffers and the DSP verifies them,\n\
+                    duplex: both at once over split halves of the pool,\n\
+                    ping: d2h one buffer at a time, with the one-way\n\
+                    DSP to host latency of each,\n\
+                    steal: the DSPs pull jobs from a queue in CMEM and\n\
+                    steal from each other when their own share runs out,\n\
+                    push: the host sends each job as a message, keeping\n\
+                    -q jobs in flight per core,\n\
+                    jobs: steal then push, compared,\n\
+                    rpc: the typed calls of Rpc.h, one at a time and\n\
+                    -q in flight per core, and -p byte sums copied in the\n\
+                    messages against passed by CMEM reference,\n\
+                    async: echo calls kept -D outstanding by -t threads\n\
+                    that never wait for a DSP, finished on a receive\n\
+                    thread, -q of them on the wire per core, default d2h\n\
+    a [0|1]       : ARM side CMEM buffer cached, invalidated on receive and\n\
+                    written back after filling (1) or mapped non-cached (0),\n\
+                    default 1\n\
+    d [0|1]       : DSP caches the region, writes back each buffer it fills\n\
+                    and invalidates each buffer it reads (1) or has the\n\
+                    region's MAR bits cleared (0), default 1\n\
+    w [0|1]       : DSP waits for its cache write back to complete, default 1\n\
+    m             : sweep every cache policy combination in one run\n\
+    u [loops]     : leading loops left out of the statistics, default 1\n\
+                    when more than one loop is run\n\
+    t [workers]   : host worker threads that invalidate and verify buffers,\n\
+                    0 receives, verifies and returns on one thread, default 2.\n\
+                    async: threads starting calls, at most 8\n\
+    o             : return buffers to the DSP as soon as they are processed\n\
+                    instead of in the order they were sent\n\
+    c [credits]   : buffers the DSP may send before the host grants more,\n\
+                    0 lets the DSP run until its ring is empty, default 4\n\
+    g [batch]     : finished buffers the host collects before it grants\n\
+                    them back to the DSP, default 1\n\
+    v [lines]     : host checks 1 in every lines cache lines of a buffer,\n\
+                    1 checks all of it, 0 none, default 1\n\
+    e [bytes]     : payload element size, 1, 2, 4 or 8, default 8\n\
+    r [us]        : poll the host queue for up to us microseconds, adapted\n\
+                    to the arrival rate, before blocking, default 0\n\
+    P [priority]  : run the host threads SCHED_FIFO at priority, 1 to 99,\n\
+                    needs root or CAP_SYS_NICE, default 0 (SCHED_OTHER).\n\
+                    A polling (-r) thread at FIFO priority starves\n\
+                    everything below it on its CPU, keep a CPU spare\n\
+    C [cpus]      : pin the host threads, round robin, to the CPUs of the\n\
+                    list, e.g. 1 or 0,1 or 0-1, default any CPU\n\
+    M             : lock the process memory (mlockall) and pre-fault the\n\
+                    stacks and the CMEM buffer before the transfers\n\
+    L [load]      : run background load threads with every transfer,\n\
+                    spin:N CPU loops, stream:N[:KB] memcpy through a\n\
+                    large buffer (default 32768 KB), thrash:N[:KB]\n\
+                    scattered cache line updates (default 8192 KB),\n\
+                    e.g. spin:1,stream:2\n\
+    I [levels]    : load intensities to run, % of the time every load\n\
+                    thread works, e.g. 0,25,50,100, default 100.\n\
+                    Prints how bandwidth and the p99 message interval,\n\
+                    the one-way latency for ping, degrade against the\n\
+                    first level\n\
+    j [jobs]      : steal and push: jobs per loop, default 1000\n\
+    k [steps]     : steal and push: LCG steps of the median job, a list\n\
+                    runs each size, e.g. 100,10000, default 1000\n\
+    x [spread]    : steal and push: job sizes from steps / spread to\n\
+                    steps * spread, log-uniform, 1 for equal jobs, default 1\n\
+    q [window]    : push, rpc and async: jobs or calls in flight per core,\n\
+                    at most 128, default 4 jobs and 16 calls\n\
+    n [calls]     : rpc: calls of each kind per loop, async: calls per\n\
+                    depth and loop, default 10000\n\
+    D [depths]    : async: calls outstanding across the cores, a list runs\n\
+                    each, at most 65536, default 1,4,16,64,256,1024,4096\n\
+    T [file]      : trace the DSPs' and the host's events to file, a\n\
+                    Chrome trace for chrome://tracing or Perfetto; every\n\
+                    further run numbers its own, e.g. trace-1.json\n\
 \n\
 Examples:\n\
     app_host DSP\n\
+    app_host -m -i 5 -b 64 -p 65536 DSP1\n\
+    app_host -i 100 -u 10 -b 64 -p 65536 DSP1\n\
+    app_host -t 0 -i 100 -b 64 -p 65536 DSP1\n\
+    app_host -f duplex -i 100 -b 64 -p 65536 DSP1\n\
+    app_host -f ping -i 10 -b 1000 -p 64 DSP1\n\
+    app_host -c 2 -g 2 -i 100 -b 64 -p 65536 DSP1\n\
+    app_host -v 16 -i 100 -b 64 -p 65536 DSP1\n\
+    app_host -e 2 -i 100 -b 64 -p 65536 DSP1\n\
+    app_host -r 50 -t 0 -i 100 -b 64 -p 4096 DSP1\n\
+    app_host -P 80 -C 1 -M -f ping -i 10 -b 1000 -p 64 DSP1\n\
+    app_host -L stream:2,thrash:1 -I 0,25,50,100 -i 20 -b 64 -p 65536 DSP1\n\
+    app_host -f async -i 3 -t 2 -D 1,16,256,4096 DSP1 DSP2\n\
+    app_host -i 100 -b 64 -p 65536 DSP1 DSP2\n\
+    app_host -f jobs -i 5 -j 2000 -k 100,10000 -x 8 DSP1 DSP2\n\
+    app_host -f rpc -i 3 -n 20000 -q 32 -p 4096 DSP1 DSP2\n\
+    app_host -T trace.json -i 3 -b 64 -p 65536 DSP1 DSP2\n\
     app_host -l\n\
     app_host -h\n\
 \n"
 
 /* private data */
-static String   Main_remoteProcName = NULL;
-static UInt32          Main_loops = 1;
-static UInt32          Main_payloadSize = 100;
-static UInt32          Main_numBuffers = 10;
+static String          Main_procNames[App_MAX_CORES];
+static UInt32          Main_numProcs = 0;
+static App_Params      Main_params;
+static Int             Main_warmupLoops = -1;   /* -1 until set by -u */
+static Bool            Main_sweep = FALSE;
+static Sched_Params    Main_sched;
+static Load_Params     Main_load;
+static UInt32          Main_levels[Main_MAX_LEVELS] = { 100 };
+static UInt32          Main_numLevels = 1;
+static App_Result      Main_results[Main_MAX_LEVELS];
+static Load_Summary    Main_loads[Main_MAX_LEVELS];
+static Bool            Main_jobs = FALSE;       /* -f jobs, steal and push */
+static UInt32          Main_works[Main_MAX_WORKS] = { 1000 };
+static UInt32          Main_numWorks = 1;
+static App_Result      Main_jobResults[Main_MAX_WORKS][2];
+
+/* policies run by -m; waiting only matters when the DSP writes back */
+static const App_CachePolicy Main_policyMatrix[] = {
+    { TRUE,  TRUE,  TRUE  },
+    { TRUE,  TRUE,  FALSE },
+    { TRUE,  FALSE, FALSE },
+    { FALSE, TRUE,  TRUE  },
+    { FALSE, TRUE,  FALSE },
+    { FALSE, FALSE, FALSE },
+};
 
 
 /*
@@ -101,6 +225,13 @@ Int main(Int argc, Char* argv[])
         goto leave;
     }
 
+    /* before Ipc_start so the transport's threads inherit the policy */
+    status = Sched_setup(&Main_sched);
+
+    if (status < 0) {
+        goto leave;
+    }
+
     /* Ipc initialization */
     status = Ipc_start();
 
@@ -129,24 +260,43 @@ leave:
  */
 Int Main_main(Void)
 {
-    UInt16      remoteProcId;
+    UInt16      procIds[App_MAX_CORES];
     Int         status = 0;
+    UInt32      i;
 
     printf("--> Main_main:\n");
 
-    remoteProcId = MultiProc_getId(Main_remoteProcName);
+    for (i = 0; i < Main_numProcs; i++) {
+        procIds[i] = MultiProc_getId(Main_procNames[i]);
+        if (procIds[i] == MultiProc_INVALIDID) {
+            printf("Error: unknown remote processor %s\n", Main_procNames[i]);
+            status = -1;
+            goto leave;
+        }
+    }
 
     /* application create phase */
-    status = App_create(remoteProcId);
+    status = App_create(procIds, Main_numProcs);
 
     if (status < 0) {
         goto leave;
     }
 
     /* application execute phase */
-    status = App_exec(Main_loops, Main_numBuffers, Main_payloadSize);
-    if (status < 0) {
-        goto leave;
+    if (Main_sweep) {
+        for (i = 0; i < sizeof(Main_policyMatrix) / sizeof(Main_policyMatrix[0]); i++) {
+            Main_params.policy = Main_policyMatrix[i];
+            status = Main_execLoads();
+            if (status < 0) {
+                goto leave;
+            }
+        }
+    }
+    else {
+        status = Main_execLoads();
+        if (status < 0) {
+            goto leave;
+        }
     }
 
     /* application delete phase */
@@ -164,6 +314,156 @@ leave:
 }
 
 
+/*
+ *  ======== Main_execLoads ========
+ *  One run per load level, the load threads going for the whole run.
+ */
+static Int Main_execLoads(Void)
+{
+    Load_Handle load = NULL;
+    Int status = 0;
+    UInt32 i;
+
+    if (Main_params.flow & (App_FLOW_STEAL | App_FLOW_PUSH)) {
+        return Main_execJobs();
+    }
+    if (Main_params.flow & (App_FLOW_RPC | App_FLOW_ASYNC)) {
+        return App_exec(&Main_params, &Main_results[0]);
+    }
+
+    memset(Main_loads, 0, sizeof(Main_loads));
+    for (i = 0; i < Main_numLevels; i++) {
+        Main_load.intensity = Main_levels[i];
+        Main_params.loadPct = Load_isIdle(&Main_load) ? 0 : Main_levels[i];
+        if (Main_params.loadPct > 0) {
+            load = Load_create(&Main_load);
+            if (load == NULL) {
+                return -1;
+            }
+        }
+
+        status = App_exec(&Main_params, &Main_results[i]);
+
+        if (load != NULL) {
+            Load_stop(load);
+            Load_report(load, &Main_loads[i]);
+            Load_delete(&load);
+        }
+        if (status < 0) {
+            return status;
+        }
+    }
+
+    if (!Load_isIdle(&Main_load)) {
+        Main_printLoadCurve();
+    }
+
+    return status;
+}
+
+/*
+ *  ======== Main_printLoadCurve ========
+ *  Bandwidth and p99 at every load level against the first one: the
+ *  message interval, or the one-way latency for ping.
+ */
+static Void Main_printLoadCurve(Void)
+{
+    const App_Result *base = &Main_results[0];
+    const App_Result *r;
+    double p99, baseP99;
+    UInt32 i;
+
+    /* ping runs are judged on the one-way time, the rest per buffer */
+    baseP99 = (Main_params.flow & App_FLOW_SINGLE) ? base->oneWayP99Us :
+        base->p99Us;
+
+    printf("Load degradation (%s, against %u%% load):\n",
+        App_flowName(Main_params.flow), Main_levels[0]);
+    printf("    load %%   load MB/s   MB/s         vs first   p99 (us)     "
+        "vs first\n");
+    for (i = 0; i < Main_numLevels; i++) {
+        r = &Main_results[i];
+        p99 = (Main_params.flow & App_FLOW_SINGLE) ? r->oneWayP99Us :
+            r->p99Us;
+        printf("    %-8u %-11.1f %-12.3f %6.1f%%    %-12.3f %5.2fx\n",
+            Main_levels[i], Main_loads[i].streamMBps, r->mbps,
+            base->mbps > 0 ? r->mbps * 100.0 / base->mbps : 0.0, p99,
+            baseP99 > 0 ? p99 / baseP99 : 0.0);
+    }
+
+    printf("csvloadheader, Load (%%), Spin Threads, Stream Threads, Thrash Threads, Load Stream (MB/s), Load Thrash (M lines/s), Bandwidth (MB/s), Messages/s, Interval p50 (us), Interval p99 (us), One-way p99 (us), Bandwidth vs First (%%), p99 vs First (x), Verify Errors\n");
+    for (i = 0; i < Main_numLevels; i++) {
+        r = &Main_results[i];
+        p99 = (Main_params.flow & App_FLOW_SINGLE) ? r->oneWayP99Us :
+            r->p99Us;
+        printf("csvload, %u, %u, %u, %u, %f, %f, %f, %f, %f, %f, %f, %f, %f, %u\n", Main_levels[i], Main_load.spinThreads, Main_load.streamThreads, Main_load.thrashThreads, Main_loads[i].streamMBps, Main_loads[i].thrashMlps, r->mbps, r->msgPerSec, r->p50Us, r->p99Us, r->oneWayP99Us, base->mbps > 0 ? r->mbps * 100.0 / base->mbps : 0.0, baseP99 > 0 ? p99 / baseP99 : 0.0, r->errors);
+    }
+}
+
+/*
+ *  ======== Main_execJobs ========
+ *  One run per job size and flow, steal before push for -f jobs.
+ */
+static Int Main_execJobs(Void)
+{
+    static const UInt32 flows[2] = { App_FLOW_STEAL, App_FLOW_PUSH };
+    UInt32 flow = Main_params.flow;
+    Int status = 0;
+    UInt32 i, f;
+
+    memset(Main_jobResults, 0, sizeof(Main_jobResults));
+    for (i = 0; i < Main_numWorks; i++) {
+        Main_params.jobWork = Main_works[i];
+        for (f = 0; f < 2; f++) {
+            if (!Main_jobs && flows[f] != flow) {
+                continue;
+            }
+            Main_params.flow = flows[f];
+            status = App_exec(&Main_params, &Main_jobResults[i][f]);
+            if (status < 0) {
+                goto leave;
+            }
+        }
+    }
+
+    if (Main_jobs) {
+        Main_printJobs();
+    }
+
+leave:
+    Main_params.flow = flow;
+    return status;
+}
+
+/*
+ *  ======== Main_printJobs ========
+ *  Jobs per second of the DSPs pulling against the host pushing.
+ */
+static Void Main_printJobs(Void)
+{
+    const App_Result *steal, *push;
+    UInt32 i;
+
+    printf("Steal against push (%u jobs, spread %u, push window %u):\n",
+        Main_params.numJobs, Main_params.jobSpread, Main_params.jobWindow);
+    printf("    steps      steal jobs/s   push jobs/s    steal/push\n");
+    for (i = 0; i < Main_numWorks; i++) {
+        steal = &Main_jobResults[i][0];
+        push = &Main_jobResults[i][1];
+        printf("    %-10u %-14.1f %-14.1f %.2fx\n", Main_works[i],
+            steal->jobsPerSec, push->jobsPerSec, push->jobsPerSec > 0 ?
+            steal->jobsPerSec / push->jobsPerSec : 0.0);
+    }
+
+    printf("csvstealheader, Steps, Jobs, Spread, Push Window, Steal Jobs/s, Push Jobs/s, Steal over Push, Steal Errors, Push Errors\n");
+    for (i = 0; i < Main_numWorks; i++) {
+        steal = &Main_jobResults[i][0];
+        push = &Main_jobResults[i][1];
+        printf("csvsteal, %u, %u, %u, %u, %f, %f, %f, %u, %u\n", Main_works[i], Main_params.numJobs, Main_params.jobSpread, Main_params.jobWindow, steal->jobsPerSec, push->jobsPerSec, push->jobsPerSec > 0 ? steal->jobsPerSec / push->jobsPerSec : 0.0, steal->errors, push->errors);
+    }
+}
+
+
 /*
  *  ======== Main_parseArgs ========
  */
@@ -172,10 +472,15 @@ Int Main_parseArgs(Int argc, Char *argv[])
     Int             opt;
     UInt16          i, numProcs;
     String          name;
+    UInt32          depth;
     Int             status = 0;
 
+    App_Params_init(&Main_params);
+    Sched_Params_init(&Main_sched);
+    Load_Params_init(&Main_load);
+
     /* parse the command line options */
-    while ((opt = getopt(argc, argv, "lhi:b:p:")) != -1) 
+    while ((opt = getopt(argc, argv, "lhi:b:p:a:d:w:mu:t:of:c:g:v:e:r:P:C:ML:I:j:k:x:q:n:D:T:")) != -1) 
     {
         switch (opt) {
             case 'h': /* -h */
@@ -184,15 +489,210 @@ Int Main_parseArgs(Int argc, Char *argv[])
                 break;
 
             case 'i': /* -i */
-                Main_loops = strtoul(optarg,NULL,10);
+                Main_params.numLoops = strtoul(optarg,NULL,10);
                 break;
 
             case 'p': /* -p */
-                Main_payloadSize = strtoul(optarg,NULL,10);
+                Main_params.payloadSize = strtoul(optarg,NULL,10);
                 break;
 
             case 'b': /* -b */
-                Main_numBuffers = strtoul(optarg,NULL,10);
+                Main_params.numBuffers = strtoul(optarg,NULL,10);
+                break;
+
+            case 'a': /* -a */
+                Main_params.policy.armCached = (strtoul(optarg,NULL,10) != 0);
+                break;
+
+            case 'd': /* -d */
+                Main_params.policy.dspCached = (strtoul(optarg,NULL,10) != 0);
+                break;
+
+            case 'w': /* -w */
+                Main_params.policy.dspWbWait = (strtoul(optarg,NULL,10) != 0);
+                break;
+
+            case 'm': /* -m */
+                Main_sweep = TRUE;
+                break;
+
+            case 'u': /* -u */
+                Main_warmupLoops = strtol(optarg,NULL,10);
+                break;
+
+            case 't': /* -t */
+                Main_params.numWorkers = strtoul(optarg,NULL,10);
+                break;
+
+            case 'o': /* -o */
+                Main_params.inOrder = FALSE;
+                break;
+
+            case 'c': /* -c */
+                Main_params.creditWindow = strtoul(optarg,NULL,10);
+                break;
+
+            case 'g': /* -g */
+                Main_params.creditBatch = strtoul(optarg,NULL,10);
+                break;
+
+            case 'v': /* -v */
+                Main_params.verifyStride = strtoul(optarg,NULL,10);
+                break;
+
+            case 'e': /* -e */
+                Main_params.elemSize = strtoul(optarg,NULL,10);
+                if (!Verify_isValidElemSize(Main_params.elemSize)) {
+                    printf("Error: element size %s is not 1, 2, 4 or 8\n",
+                        optarg);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'r': /* -r */
+                Main_params.spinUs = strtoul(optarg,NULL,10);
+                break;
+
+            case 'P': /* -P */
+                Main_sched.priority = strtol(optarg,NULL,10);
+                break;
+
+            case 'C': /* -C */
+                Main_sched.cpus = optarg;
+                break;
+
+            case 'M': /* -M */
+                Main_sched.lockMemory = TRUE;
+                break;
+
+            case 'L': /* -L */
+                if (Load_parse(&Main_load, optarg) < 0) {
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'I': /* -I */
+                Main_numLevels = 0;
+                for (name = optarg; *name != '\0' &&
+                        Main_numLevels < Main_MAX_LEVELS; ) {
+                    Main_levels[Main_numLevels] = strtoul(name, &name, 10);
+                    if (Main_levels[Main_numLevels++] > 100 ||
+                            (*name != ',' && *name != '\0')) {
+                        printf("Error: bad load levels %s, expected e.g. "
+                            "0,50,100\n", optarg);
+                        status = -1;
+                        goto leave;
+                    }
+                    name += (*name == ',');
+                }
+                if (Main_numLevels == 0 || *name != '\0') {
+                    printf("Error: 1 to %d load levels\n", Main_MAX_LEVELS);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'j': /* -j */
+                Main_params.numJobs = strtoul(optarg,NULL,10);
+                break;
+
+            case 'k': /* -k */
+                Main_numWorks = 0;
+                for (name = optarg; *name != '\0' &&
+                        Main_numWorks < Main_MAX_WORKS; ) {
+                    Main_works[Main_numWorks] = strtoul(name, &name, 10);
+                    if (Main_works[Main_numWorks++] == 0 ||
+                            (*name != ',' && *name != '\0')) {
+                        printf("Error: bad job sizes %s, expected e.g. "
+                            "100,10000\n", optarg);
+                        status = -1;
+                        goto leave;
+                    }
+                    name += (*name == ',');
+                }
+                if (Main_numWorks == 0 || *name != '\0') {
+                    printf("Error: 1 to %d job sizes\n", Main_MAX_WORKS);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'x': /* -x */
+                Main_params.jobSpread = strtoul(optarg,NULL,10);
+                break;
+
+            case 'q': /* -q */
+                Main_params.jobWindow = strtoul(optarg,NULL,10);
+                Main_params.callWindow = Main_params.jobWindow;
+                break;
+
+            case 'n': /* -n */
+                Main_params.numCalls = strtoul(optarg,NULL,10);
+                break;
+
+            case 'D': /* -D */
+                Main_params.numDepths = 0;
+                for (name = optarg; *name != '\0' &&
+                        Main_params.numDepths < App_MAX_DEPTHS; ) {
+                    depth = strtoul(name, &name, 10);
+                    Main_params.depths[Main_params.numDepths++] = depth;
+                    if (depth == 0 || depth > 65536 ||
+                            (*name != ',' && *name != '\0')) {
+                        printf("Error: bad depths %s, expected e.g. "
+                            "1,64,4096\n", optarg);
+                        status = -1;
+                        goto leave;
+                    }
+                    name += (*name == ',');
+                }
+                if (Main_params.numDepths == 0 || *name != '\0') {
+                    printf("Error: 1 to %d depths\n", App_MAX_DEPTHS);
+                    status = -1;
+                    goto leave;
+                }
+                break;
+
+            case 'T': /* -T */
+                Main_params.traceFile = optarg;
+                break;
+
+            case 'f': /* -f */
+                if (strcmp(optarg, "d2h") == 0) {
+                    Main_params.flow = App_FLOW_D2H;
+                }
+                else if (strcmp(optarg, "h2d") == 0) {
+                    Main_params.flow = App_FLOW_H2D;
+                }
+                else if (strcmp(optarg, "duplex") == 0) {
+                    Main_params.flow = App_FLOW_DUPLEX;
+                }
+                else if (strcmp(optarg, "ping") == 0) {
+                    Main_params.flow = App_FLOW_PING;
+                }
+                else if (strcmp(optarg, "steal") == 0) {
+                    Main_params.flow = App_FLOW_STEAL;
+                }
+                else if (strcmp(optarg, "push") == 0) {
+                    Main_params.flow = App_FLOW_PUSH;
+                }
+                else if (strcmp(optarg, "jobs") == 0) {
+                    Main_params.flow = App_FLOW_STEAL;
+                    Main_jobs = TRUE;
+                }
+                else if (strcmp(optarg, "rpc") == 0) {
+                    Main_params.flow = App_FLOW_RPC;
+                }
+                else if (strcmp(optarg, "async") == 0) {
+                    Main_params.flow = App_FLOW_ASYNC;
+                }
+                else {
+                    printf("Error: unknown flow %s\n", optarg);
+                    printf("%s", Main_USAGE);
+                    status = -1;
+                    goto leave;
+                }
                 break;
 
             case 'l': /* -l */
@@ -224,18 +724,92 @@ Int Main_parseArgs(Int argc, Char *argv[])
                 goto leave;
         }
     }
-    if(optind < argc)
-        Main_remoteProcName = argv[optind];
-    else
-        printf("%s", Main_USAGE);
+    while (optind < argc && Main_numProcs < App_MAX_CORES)
+        Main_procNames[Main_numProcs++] = argv[optind++];
 
     /* validate command line arguments */
-    if (Main_remoteProcName == NULL) {
+    if (Main_numProcs == 0) {
         printf("Error: missing procName argument\n");
         printf("%s", Main_USAGE);
         status = -1;
         goto leave;
     }
+    if (optind < argc) {
+        printf("Error: at most %d procName arguments\n", App_MAX_CORES);
+        status = -1;
+        goto leave;
+    }
+
+    /* discard the first loop by default, but always measure one */
+    if (Main_warmupLoops < 0) {
+        Main_warmupLoops = (Main_params.numLoops > 1 ? 1 : 0);
+    }
+    else if ((UInt32)Main_warmupLoops >= Main_params.numLoops) {
+        printf("Warning: %d warm-up loops leave none of %u loops to "
+            "measure, measuring all\n", Main_warmupLoops,
+            Main_params.numLoops);
+        Main_warmupLoops = 0;
+    }
+    Main_params.warmupLoops = Main_warmupLoops;
+
+    /* with one buffer in flight there is nothing to pipeline or limit */
+    if (Main_params.flow & App_FLOW_SINGLE) {
+        Main_params.numWorkers = 0;
+        Main_params.creditWindow = 0;
+    }
+
+    /* the job flows keep their own queue and window */
+    if (Main_params.flow & (App_FLOW_STEAL | App_FLOW_PUSH)) {
+        if (Main_params.numJobs == 0) {
+            printf("Error: no jobs to run\n");
+            status = -1;
+            goto leave;
+        }
+        if (Main_params.jobWindow == 0) {
+            Main_params.jobWindow = 1;
+        }
+        if (Main_params.jobSpread == 0) {
+            Main_params.jobSpread = 1;
+        }
+        if (!Load_isIdle(&Main_load)) {
+            printf("Warning: -L is not run with the job flows\n");
+        }
+    }
+
+    /* a call in flight holds one of the DSP's 256 message blocks */
+    if (Main_params.flow & (App_FLOW_RPC | App_FLOW_ASYNC)) {
+        if (Main_params.numCalls == 0) {
+            printf("Error: no calls to make\n");
+            status = -1;
+            goto leave;
+        }
+        if (Main_params.callWindow == 0 || Main_params.callWindow > 128) {
+            printf("Error: %u calls in flight is not in 1..128\n",
+                Main_params.callWindow);
+            status = -1;
+            goto leave;
+        }
+        if (!Load_isIdle(&Main_load)) {
+            printf("Warning: -L is not run with the %s flow\n",
+                App_flowName(Main_params.flow));
+        }
+    }
+    if (Main_params.flow == App_FLOW_ASYNC && Main_params.numWorkers > 8) {
+        printf("Error: at most 8 threads start calls\n");
+        status = -1;
+        goto leave;
+    }
+
+    /* a grant has to fit in the window or the DSP would wait forever */
+    if (Main_params.creditWindow > 0 &&
+            Main_params.creditBatch > Main_params.creditWindow) {
+        printf("Warning: credit batch %u is larger than the window, "
+            "using %u\n", Main_params.creditBatch, Main_params.creditWindow);
+        Main_params.creditBatch = Main_params.creditWindow;
+    }
+    if (Main_params.creditBatch == 0) {
+        Main_params.creditBatch = 1;
+    }
 
 leave:
     return(status);
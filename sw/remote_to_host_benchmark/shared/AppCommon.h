@@ -53,23 +53,81 @@ extern "C" {
 #define App_CMD_SHUTDOWN        0x02000000  /* cc------ */
 #define App_CMD_INIT            0x03000000
 #define App_CMD_BUFFER          0x04000000
+#define App_CMD_H2D_BUFFER      0x05000000  /* host filled slot to consume */
+#define App_CMD_H2D_RETURN      0x06000000  /* slot consumed, host may refill */
+#define App_CMD_SYNC            0x07000000  /* DSP answers with its Timestamp */
+#define App_CMD_JOBS            0x08000000  /* run the shared job queue dry */
+#define App_CMD_JOB             0x09000000  /* run the one job in the message */
+#define App_CMD_RPC             0x0A000000  /* cc-iiiii, typed call, Rpc.h */
+#define App_CMD_TRACE           0x0B000000  /* start or stop the trace ring */
+
+/* DSP handling of the shared CMEM region, carried in App_CMD_INIT */
+#define App_DSP_CACHE_WB        0   /* cached, Cache_wb after every fill */
+#define App_DSP_CACHE_NONE      1   /* MAR bit cleared, region not cached */
 
 typedef struct {
     UInt32 phyStartAddress;
-    UInt32 ringBufferSize;
+    UInt32 ringBufferSize;      /* DSP to host ring, from phyStartAddress */
+    UInt32 regionSize;          /* whole shared region, both directions */
+    UInt32 dspCacheMode;        /* App_DSP_CACHE_xxx */
+    UInt32 dspCacheWait;        /* wait for Cache_wb to complete */
+    UInt32 elemSize;            /* App_ELEM_xxx, both directions */
 } Init_Data;
 
 typedef struct {
     UInt32 numBuffers;
     UInt32 payloadSize;
+    UInt32 credits;             /* initial grant, 0 for no credit limit */
+    UInt32 firstSeq;            /* seq of the first buffer sent */
 } Start_Data;
 
 typedef struct {
     UInt32 phyAddress;
     UInt32 offset;
     UInt32 dataLen;
+    UInt32 seq;                 /* index of the buffer within its loop */
+    UInt32 errors;              /* App_CMD_H2D_RETURN: DSP verify errors */
+    UInt32 credits;             /* App_CMD_BUFFER to the DSP: more granted */
+    UInt32 creditStalls;        /* App_CMD_BUFFER from the DSP: times it ran */
+    UInt32 creditStallUs;       /* out of credits this loop, and for how long */
+    UInt32 stampHi;             /* App_CMD_BUFFER from the DSP: Timestamp */
+    UInt32 stampLo;             /* once the fill and write back completed */
 } Buffer_Data;
 
+typedef struct {
+    UInt32 stampHi;             /* DSP Timestamp as the reply is sent */
+    UInt32 stampLo;
+    UInt32 freqHi;              /* Timestamp ticks per second */
+    UInt32 freqLo;
+} Sync_Data;
+
+typedef struct {
+    UInt32 phyAddress;          /* App_JobQueue */
+    UInt32 size;                /* of the region, job table included */
+    UInt32 core;                /* this core's deque and ring */
+    UInt32 jobs;                /* reply: jobs run */
+    UInt32 stolen;              /* reply: of them taken from other deques */
+    UInt32 steals;              /* reply: successful steals */
+    UInt32 busyUs;              /* reply: time in the kernel */
+    UInt32 lockUs;              /* reply: time taking and holding locks */
+    UInt32 ringUs;              /* reply: time waiting on a full ring */
+    UInt32 totalUs;             /* reply: App_CMD_JOBS to the queue dry */
+} Jobs_Data;
+
+typedef struct {
+    UInt32 job;                 /* host's index, returned as is */
+    UInt32 work;
+    UInt32 seed;
+    UInt32 result;              /* reply */
+    UInt32 ticks;               /* reply: Timestamp ticks of the kernel */
+    UInt32 freq;                /* reply: Timestamp ticks per second */
+} Job_Data;
+
+typedef struct {
+    UInt32 phyAddress;          /* App_TraceRing, 0 stops the trace */
+    UInt32 size;                /* of the ring, its window goes uncached */
+} Trace_Data;
+
 typedef struct {
     MessageQ_MsgHeader  reserved;
     UInt32              cmd;
@@ -77,18 +135,134 @@ typedef struct {
         Init_Data initData;
         Start_Data startData;
         Buffer_Data bufferData;
+        Sync_Data syncData;
+        Jobs_Data jobsData;
+        Job_Data jobData;
+        Trace_Data traceData;
     } data;
 } App_Msg;
 
 
 
 #define App_MsgHeapId           0
-#define App_HostMsgQueName      "HOST:MsgQ:01"
+#define App_HostMsgQueName      "HOST:MsgQ:%s" /* %s is the slave served */
 #define App_SlaveMsgQueName     "%s:MsgQ:01"  /* %s is each slave's Proc Name */
 
-#define ARM_CACHE_INV (1)
-#define DSP_CACHE_WB (1)
-typedef UInt64 PayloadType ;
+/* payload element width in bytes: element i of buffer seq holds the low
+ * bits of i + seq */
+#define App_ELEM_8              1
+#define App_ELEM_16             2
+#define App_ELEM_32             4
+#define App_ELEM_64             8
+
+/*
+ *  ======== Job queue ========
+ *  A table of jobs in CMEM that the DSPs pull from, App_CMD_JOBS. Each
+ *  core owns a deque, a range [head, tail) of the table that the host
+ *  fills evenly; the owner takes jobs from the head and a core whose
+ *  deque is empty steals the top half of the fullest one. The results
+ *  go to the core's completion ring, which the host drains.
+ *
+ *  The C66x has no atomic read-modify-write to DDR, so each deque is
+ *  guarded by a Lamport bakery lock, plain ticket numbers read and
+ *  written through the uncached region. Only the DSPs take the locks.
+ *  Fields written by different sides are a DSP cache line apart so the
+ *  host can write back or invalidate one without touching the other.
+ */
+#define App_JOBS_MAX_CORES      4
+#define App_JOBS_LINE           128     /* DSP L2 line */
+#define App_JOBS_RING_SIZE      1024    /* completions, a power of 2 */
+#define App_JOBS_MAX            0x100000
+
+/* one job of the table, work LCG steps from seed */
+typedef struct {
+    UInt32 work;
+    UInt32 seed;
+} App_Job;
+
+/* one finished job in a completion ring */
+typedef struct {
+    UInt32 job;                 /* index in the table */
+    UInt32 result;
+} App_JobDone;
+
+typedef struct {
+    volatile UInt32 choosing[App_JOBS_MAX_CORES];
+    volatile UInt32 number[App_JOBS_MAX_CORES];
+    UInt8 pad[App_JOBS_LINE - 8 * App_JOBS_MAX_CORES];
+} App_JobLock;
+
+typedef struct {
+    App_JobLock lock;
+    volatile UInt32 head;       /* next job for the owner */
+    volatile UInt32 tail;       /* one past the last, thieves lower it */
+    UInt8 pad[App_JOBS_LINE - 8];
+} App_JobDeque;
+
+typedef struct {
+    volatile UInt32 write;      /* DSP: entries written, ever */
+    UInt8 pad0[App_JOBS_LINE - 4];
+    volatile UInt32 read;       /* host: entries consumed, ever */
+    UInt8 pad1[App_JOBS_LINE - 4];
+    App_JobDone done[App_JOBS_RING_SIZE];
+} App_JobRing;
+
+/* start of the region, the job table follows it */
+typedef struct {
+    UInt32 numCores;
+    UInt32 numJobs;
+    UInt8 pad[App_JOBS_LINE - 8];
+    App_JobDeque deques[App_JOBS_MAX_CORES];
+    App_JobRing rings[App_JOBS_MAX_CORES];
+} App_JobQueue;
+
+/*
+ *  ======== Trace ring ========
+ *  Binary events a DSP writes to a ring of its own in CMEM, App_CMD_TRACE,
+ *  for the host to drain and put on one timeline with its own. The rings
+ *  sit in a window of the pool that the DSPs do not cache, so an event
+ *  is a Timestamp and five stores. The DSP never waits for the host: an
+ *  event that finds the ring full is counted and lost.
+ */
+#define App_TRACE_RING_SIZE     4096    /* events per core, a power of 2 */
+
+/* DSP events; a _BEGIN and its _END make a span on the core's line */
+#define App_TRACE_GET           0x01    /* message taken: cmd, 0 */
+#define App_TRACE_FILL_BEGIN    0x02    /* d2h buffer: seq, bytes */
+#define App_TRACE_FILL_END      0x03
+#define App_TRACE_PUT           0x04    /* App_CMD_BUFFER sent: seq, credits */
+#define App_TRACE_STALL         0x05    /* out of credits: next seq, 0 */
+#define App_TRACE_CONSUME_BEGIN 0x06    /* h2d buffer: seq, bytes */
+#define App_TRACE_CONSUME_END   0x07
+#define App_TRACE_JOB_BEGIN     0x08    /* job, work */
+#define App_TRACE_JOB_END       0x09
+#define App_TRACE_RPC_BEGIN     0x0A    /* call id, 0 */
+#define App_TRACE_RPC_END       0x0B
+
+/* host events, on the thread that saw them */
+#define App_TRACE_SEND          0x81    /* message sent: cmd, core */
+#define App_TRACE_RECV          0x82    /* message received: cmd, core */
+#define App_TRACE_VERIFY_BEGIN  0x83    /* d2h buffer: seq, core */
+#define App_TRACE_VERIFY_END    0x84
+#define App_TRACE_RETURN        0x85    /* buffer back to the DSP: seq, core */
+#define App_TRACE_MAX_ID        0x86
+
+typedef struct {
+    UInt32 stampHi;             /* DSP Timestamp */
+    UInt32 stampLo;
+    UInt32 id;                  /* App_TRACE_xxx */
+    UInt32 arg0;
+    UInt32 arg1;
+} App_TraceEvent;
+
+typedef struct {
+    volatile UInt32 write;      /* DSP: events written, ever */
+    volatile UInt32 dropped;    /* DSP: events lost to a full ring */
+    UInt8 pad0[App_JOBS_LINE - 8];
+    volatile UInt32 read;       /* host: events drained, ever */
+    UInt8 pad1[App_JOBS_LINE - 4];
+    App_TraceEvent events[App_TRACE_RING_SIZE];
+} App_TraceRing;
 
 
 #if defined (__cplusplus)
@@ -0,0 +1,104 @@
+/*
+ *  ======== Rpc.h ========
+ *  Typed calls over MessageQ, generated from the lists in RpcSchema.h.
+ *
+ *  A call goes to the DSP as one Rpc_Msg: App_CMD_RPC with the call id
+ *  in the low bits, a request id the host picks, and the call's _In
+ *  struct. The DSP runs the call and sends the same message back with
+ *  the status, the Timestamp ticks the call took and the _Out struct in
+ *  place of the _In one, so a call allocates nothing on the DSP.
+ *
+ *  Include after MessageQ.h and AppCommon.h.
+ */
+
+#ifndef Rpc__include
+#define Rpc__include
+
+#include <stddef.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* a CMEM buffer passed by reference */
+typedef struct {
+    UInt32              phys;
+    UInt32              size;
+} Rpc_Bulk;
+
+#include "RpcSchema.h"
+
+/* call status, in the reply */
+#define Rpc_S_SUCCESS           0
+#define Rpc_E_CALL              -1  /* no such call on the DSP */
+#define Rpc_E_SIZE              -2  /* message too small for the call */
+#define Rpc_E_ARGS              -3  /* the call refused its arguments */
+#define Rpc_E_VERSION           -4  /* Rpc_info: schemas differ */
+
+/* bytes of arguments or results a message can carry */
+#define Rpc_ARGS_MAX            440
+
+typedef struct {
+    MessageQ_MsgHeader  reserved;
+    UInt32              cmd;        /* App_CMD_RPC | call id */
+    UInt32              seq;        /* request id, sent back as is */
+    Int32               status;     /* reply: Rpc_S_xxx or Rpc_E_xxx */
+    UInt32              ticks;      /* reply: DSP Timestamp ticks of the call */
+    UInt8               args[Rpc_ARGS_MAX];  /* _In, then _Out */
+} Rpc_Msg;
+
+/* a message with room for n bytes of arguments or results */
+#define Rpc_MSG_SIZE(n)         ((UInt32)(offsetof(Rpc_Msg, args) + (n)))
+
+/* call ids, Rpc_ID_<name> */
+#define Rpc_ID_ENUM(name, id)   Rpc_ID_##name = id,
+enum {
+    Rpc_CALLS(Rpc_ID_ENUM)
+    Rpc_ID_END
+};
+#undef Rpc_ID_ENUM
+
+/* Rpc_<name>_In and Rpc_<name>_Out */
+#define Rpc_FIELD(type, field)          type field;
+#define Rpc_ARRAY(type, field, count)   type field[count];
+#define Rpc_STRUCTS(name, id) \
+    typedef struct { \
+        Rpc_##name##_IN(Rpc_FIELD, Rpc_ARRAY) \
+    } Rpc_##name##_In; \
+    typedef struct { \
+        Rpc_##name##_OUT(Rpc_FIELD, Rpc_ARRAY) \
+    } Rpc_##name##_Out;
+Rpc_CALLS(Rpc_STRUCTS)
+#undef Rpc_STRUCTS
+#undef Rpc_FIELD
+#undef Rpc_ARRAY
+
+/* the build fails unless every struct is packed and fits a message */
+#define Rpc_ASSERT(name, cond)  typedef char name[(cond) ? 1 : -1];
+#define Rpc_SIZE_FIELD(type, field)         + sizeof(type)
+#define Rpc_SIZE_ARRAY(type, field, count)  + sizeof(type) * (count)
+#define Rpc_CHECKS(name, id) \
+    Rpc_ASSERT(Rpc_##name##_InPacked, sizeof(Rpc_##name##_In) == \
+        0 Rpc_##name##_IN(Rpc_SIZE_FIELD, Rpc_SIZE_ARRAY)) \
+    Rpc_ASSERT(Rpc_##name##_OutPacked, sizeof(Rpc_##name##_Out) == \
+        0 Rpc_##name##_OUT(Rpc_SIZE_FIELD, Rpc_SIZE_ARRAY)) \
+    Rpc_ASSERT(Rpc_##name##_InFits, sizeof(Rpc_##name##_In) <= Rpc_ARGS_MAX) \
+    Rpc_ASSERT(Rpc_##name##_OutFits, sizeof(Rpc_##name##_Out) <= Rpc_ARGS_MAX)
+Rpc_CALLS(Rpc_CHECKS)
+Rpc_ASSERT(Rpc_argsAligned, offsetof(Rpc_Msg, args) % 8 == 0)
+Rpc_ASSERT(Rpc_msgFits, sizeof(Rpc_Msg) <= 496)
+#undef Rpc_CHECKS
+#undef Rpc_SIZE_FIELD
+#undef Rpc_SIZE_ARRAY
+#undef Rpc_ASSERT
+
+/* the larger of a call's _In and _Out, what its message must hold */
+#define Rpc_ARGS_SIZE(name) \
+    (sizeof(Rpc_##name##_In) > sizeof(Rpc_##name##_Out) ? \
+        sizeof(Rpc_##name##_In) : sizeof(Rpc_##name##_Out))
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* Rpc__include */
@@ -0,0 +1,77 @@
+/*
+ *  ======== RpcSchema.h ========
+ *  The calls the DSPs serve, declared once for the host and the DSPs.
+ *
+ *  Rpc_CALLS lists every call as CALL(name, id). The arguments of a call
+ *  are Rpc_<name>_IN(F, A) and its results Rpc_<name>_OUT(F, A), each a
+ *  list of F(type, field) for one value and A(type, field, count) for a
+ *  fixed array. Rpc.h turns the lists into the structs, the layout
+ *  checks, the host stubs and the DSP dispatch.
+ *
+ *  Use only the fixed width types, UInt8, UInt16, UInt32, Int32 and
+ *  Rpc_Bulk, and order the fields so no padding is needed: the build
+ *  fails if a struct has padding or does not fit a message, so the A15
+ *  and the C66x always agree on the layout. Every list needs at least
+ *  one field. Bump Rpc_VERSION whenever a call changes; the host checks
+ *  it against the DSP's with Rpc_info before anything else.
+ *
+ *  A Rpc_Bulk is a CMEM buffer passed by its physical address instead
+ *  of being copied into the message. The host writes it back before the
+ *  call, the DSP invalidates it before reading.
+ */
+
+#ifndef RpcSchema__include
+#define RpcSchema__include
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define Rpc_VERSION             1
+
+/* bytes a by-copy sum carries */
+#define Rpc_SUM_MAX             256
+
+#define Rpc_CALLS(CALL) \
+    CALL(info, 1) \
+    CALL(echo, 2) \
+    CALL(add,  3) \
+    CALL(sum,  4) \
+    CALL(sumBulk, 5)
+
+/* the DSP's schema version and clock */
+#define Rpc_info_IN(F, A) \
+    F(UInt32, version)
+#define Rpc_info_OUT(F, A) \
+    F(UInt32, version) \
+    F(UInt32, tsFreq)
+
+/* the value back, the smallest call there is */
+#define Rpc_echo_IN(F, A) \
+    F(UInt32, value)
+#define Rpc_echo_OUT(F, A) \
+    F(UInt32, value)
+
+#define Rpc_add_IN(F, A) \
+    F(Int32, a) \
+    F(Int32, b)
+#define Rpc_add_OUT(F, A) \
+    F(Int32, sum)
+
+/* sum of the first size bytes of data, copied in the message */
+#define Rpc_sum_IN(F, A) \
+    F(UInt32, size) \
+    A(UInt8, data, Rpc_SUM_MAX)
+#define Rpc_sum_OUT(F, A) \
+    F(UInt32, sum)
+
+/* sum of the bytes of a CMEM buffer, passed by reference */
+#define Rpc_sumBulk_IN(F, A) \
+    F(Rpc_Bulk, data)
+#define Rpc_sumBulk_OUT(F, A) \
+    F(UInt32, sum)
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* RpcSchema__include */